@@ -211,7 +211,7 @@ static int omap3_mpu_set_rate(struct device *dev, unsigned long rate)
 	/* Send pre notification to CPUFreq */
 	//cpufreq_notify_transition(&freqs_notify, CPUFREQ_PRECHANGE);
 
-	if(ds_status.flag_run_dvs == 0){
+	if(DS_CPU_OP_BY_CPUFREQ()){
 		freqs_notify.old = cur_rate / 1000;
 		freqs_notify.new = rate / 1000;
 		freqs_notify.cpu = 0;
@@ -239,7 +239,7 @@ static int omap3_mpu_set_rate(struct device *dev, unsigned long rate)
 	/* Send a post notification to CPUFreq */
 	//cpufreq_notify_transition(&freqs_notify, CPUFREQ_POSTCHANGE);
 
-	if(ds_status.flag_run_dvs == 0){
+	if(DS_CPU_OP_BY_CPUFREQ()){
 		cpufreq_notify_transition(&freqs_notify, CPUFREQ_POSTCHANGE);
 	}
 	else{	// LG-DVFS is runnig.
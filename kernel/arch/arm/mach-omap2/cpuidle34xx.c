@@ -24,6 +24,10 @@
 
 #include <linux/sched.h>
 #include <linux/cpuidle.h>
+#include <linux/bitops.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/tick.h>
 
 #include <plat/prcm.h>
 #include <plat/irqs.h>
@@ -31,8 +35,11 @@
 #include <plat/clockdomain.h>
 #include <plat/control.h>
 #include <plat/serial.h>
+#include <plat/gpio.h>
 
 #include "pm.h"
+#include "prm.h"
+#include "prm-regbits-34xx.h"
 
 #ifdef CONFIG_CPU_IDLE
 
@@ -88,6 +95,190 @@ static struct cpuidle_params cpuidle_params_table[] = {
 	{1, 10000, 30000, 300000},
 };
 
+/*
+ * Wakeup source interval predictor.
+ *
+ * The modem SPI SRDY line, touch and the sensors wake us up at very
+ * regular intervals, which the static thresholds above know nothing
+ * about. For every source that wakes us up we keep the time of the
+ * last wakeup and the average interval between wakeups; once the interval
+ * has been stable for a few wakeups in a row the source is trusted to
+ * come again at last + interval. Timer (GPTIMER1, the clockevent) wakeups
+ * are not predicted, the next timer event is known from the tick code.
+ *
+ * A source is an INTC line, a single GPIO for the GPIO bank lines, or a
+ * PM_WKST bit of the WKUP, CORE or PER domain for the PRCM line, see
+ * omap3_idle_wakeup_source().
+ *
+ * omap3_enter_idle_bm() drops to a shallower state when the predicted
+ * idle time is shorter than the target residency of the chosen one.
+ */
+#define OMAP3_IDLE_GPIO_SOURCES		INTCPS_NR_IRQS
+#define OMAP3_IDLE_PRCM_SOURCES		(OMAP3_IDLE_GPIO_SOURCES + \
+					 OMAP_MAX_GPIO_LINES)
+#define OMAP3_IDLE_NR_SOURCES		(OMAP3_IDLE_PRCM_SOURCES + \
+					 ARRAY_SIZE(omap3_idle_wkst_mods) * 32)
+#define OMAP3_IDLE_TIMER_IRQ		INT_24XX_GPTIMER1
+#define OMAP3_IDLE_MIN_HITS		3	/* stable intervals to trust */
+#define OMAP3_IDLE_TOLERANCE_SHIFT	3	/* stable = within 1/8 */
+#define OMAP3_IDLE_MAX_INTERVAL_US	(2 * USEC_PER_SEC)
+
+static const s16 omap3_idle_wkst_mods[] = {
+	WKUP_MOD, CORE_MOD, OMAP3430_PER_MOD,
+};
+
+struct omap3_idle_source {
+	s64 last_ns;
+	u32 interval_us;
+	u8 hits;
+};
+
+static struct omap3_idle_source omap3_idle_sources[OMAP3_IDLE_NR_SOURCES];
+static DECLARE_BITMAP(omap3_idle_trusted, OMAP3_IDLE_NR_SOURCES);
+static u32 omap3_idle_predict_enabled = 1;
+
+/* Residency histogram bucket upper bounds, in usec */
+static const u32 omap3_idle_hist_us[] = {
+	100, 1000, 5000, 20000, 100000, UINT_MAX,
+};
+#define OMAP3_IDLE_HIST_BUCKETS	ARRAY_SIZE(omap3_idle_hist_us)
+
+struct omap3_idle_stats {
+	u32 usage;
+	u32 demoted;		/* chosen by the predictor over the governor */
+	u32 too_deep;		/* woke up before the target residency */
+	u32 too_shallow;	/* stayed long enough for a deeper state */
+	u32 hist[OMAP3_IDLE_HIST_BUCKETS];
+};
+
+static struct omap3_idle_stats omap3_idle_stats[OMAP3_MAX_STATES];
+
+/*
+ * Returns the source that woke us up, or -1. Called right after wakeup,
+ * before the pending interrupts are handled: the PRCM line is resolved
+ * through PM_WKST, the GPIO bank lines through the bank's IRQSTATUS.
+ */
+static int omap3_idle_wakeup_source(void)
+{
+	int irq = omap_irq_first_pending(INT_34XX_PRCM_MPU_IRQ);
+	int i, gpio_irq;
+	u32 wkst;
+
+	if (irq >= INT_34XX_GPIO_BANK1 && irq <= INT_34XX_GPIO_BANK6) {
+		gpio_irq = omap2_gpio_first_pending(irq);
+		if (gpio_irq >= 0)
+			return OMAP3_IDLE_GPIO_SOURCES + irq_to_gpio(gpio_irq);
+	} else if (irq == INT_34XX_PRCM_MPU_IRQ) {
+		for (i = 0; i < ARRAY_SIZE(omap3_idle_wkst_mods); i++) {
+			wkst = prm_read_mod_reg(omap3_idle_wkst_mods[i],
+						PM_WKST1) &
+			       prm_read_mod_reg(omap3_idle_wkst_mods[i],
+						OMAP3430_PM_MPUGRPSEL);
+			if (wkst)
+				return OMAP3_IDLE_PRCM_SOURCES + i * 32 +
+					__ffs(wkst);
+		}
+	}
+
+	return irq;
+}
+
+static void omap3_idle_note_wakeup(int irq, s64 now_ns)
+{
+	struct omap3_idle_source *src = &omap3_idle_sources[irq];
+	s64 delta_ns = now_ns - src->last_ns;
+	u32 interval_us;
+
+	src->last_ns = now_ns;
+
+	if (delta_ns <= 0 ||
+	    delta_ns > (s64)OMAP3_IDLE_MAX_INTERVAL_US * NSEC_PER_USEC) {
+		src->hits = 0;
+		src->interval_us = 0;
+		clear_bit(irq, omap3_idle_trusted);
+		return;
+	}
+
+	interval_us = div_u64(delta_ns, NSEC_PER_USEC);
+
+	if (src->interval_us &&
+	    abs((int)interval_us - (int)src->interval_us) <=
+	    (src->interval_us >> OMAP3_IDLE_TOLERANCE_SHIFT)) {
+		if (src->hits < OMAP3_IDLE_MIN_HITS)
+			src->hits++;
+		src->interval_us = (src->interval_us * 3 + interval_us) / 4;
+	} else {
+		src->hits = 0;
+		src->interval_us = interval_us;
+	}
+
+	if (src->hits >= OMAP3_IDLE_MIN_HITS)
+		set_bit(irq, omap3_idle_trusted);
+	else
+		clear_bit(irq, omap3_idle_trusted);
+}
+
+/*
+ * Returns the predicted idle time in usec: the earlier of the next timer
+ * event and the next expected wakeup of a trusted source.
+ */
+static u32 omap3_idle_predict_us(void)
+{
+	struct timespec ts_now;
+	s64 now_ns;
+	s64 predicted_us = ktime_to_us(tick_nohz_get_sleep_length());
+	int irq;
+
+	getnstimeofday(&ts_now);
+	now_ns = timespec_to_ns(&ts_now);
+
+	for_each_set_bit(irq, omap3_idle_trusted, OMAP3_IDLE_NR_SOURCES) {
+		struct omap3_idle_source *src = &omap3_idle_sources[irq];
+		s64 left_us = div_s64(src->last_ns - now_ns, NSEC_PER_USEC) +
+				src->interval_us;
+
+		/* Overdue by more than an interval: it went quiet */
+		if (left_us < -(s64)src->interval_us) {
+			src->hits = 0;
+			clear_bit(irq, omap3_idle_trusted);
+			continue;
+		}
+		if (left_us >= 0 && left_us < predicted_us)
+			predicted_us = left_us;
+	}
+
+	return predicted_us > UINT_MAX ? UINT_MAX : predicted_us;
+}
+
+static void omap3_idle_account(struct omap3_processor_cx *cx, u32 idle_us)
+{
+	struct omap3_idle_stats *st = &omap3_idle_stats[cx->type];
+	int i;
+
+	st->usage++;
+
+	for (i = 0; i < OMAP3_IDLE_HIST_BUCKETS; i++) {
+		if (idle_us < omap3_idle_hist_us[i]) {
+			st->hist[i]++;
+			break;
+		}
+	}
+
+	if (idle_us < cx->threshold) {
+		st->too_deep++;
+		return;
+	}
+
+	/* The next deeper state we could have used */
+	for (i = cx->type + 1; i < OMAP3_MAX_STATES; i++) {
+		if (!omap3_power_states[i].valid)
+			continue;
+		if (idle_us >= omap3_power_states[i].threshold)
+			st->too_shallow++;
+		break;
+	}
+}
+
 static int omap3_idle_bm_check(void)
 {
 	if (!omap3_can_sleep())
@@ -123,6 +314,9 @@ static int omap3_enter_idle(struct cpuidle_device *dev,
 	struct omap3_processor_cx *cx = cpuidle_get_statedata(state);
 	struct timespec ts_preidle, ts_postidle, ts_idle;
 	u32 mpu_state = cx->mpu_state, core_state = cx->core_state;
+	u32 idle_us;
+	int wakeup_irq = -1;
+	int slept = 0;
 
 	current_cx_state = *cx;
 
@@ -146,6 +340,10 @@ static int omap3_enter_idle(struct cpuidle_device *dev,
 	/* Execute ARM wfi */
 	omap_sram_idle();
 
+	/* What woke us up is still pending */
+	wakeup_irq = omap3_idle_wakeup_source();
+	slept = 1;
+
 	if (cx->type == OMAP3_STATE_C1 || cx->type == OMAP3_STATE_C2) {
 		pwrdm_for_each_clkdm(mpu_pd, _cpuidle_allow_idle);
 		pwrdm_for_each_clkdm(core_pd, _cpuidle_allow_idle);
@@ -154,11 +352,19 @@ static int omap3_enter_idle(struct cpuidle_device *dev,
 return_sleep_time:
 	getnstimeofday(&ts_postidle);
 	ts_idle = timespec_sub(ts_postidle, ts_preidle);
+	idle_us = ts_idle.tv_nsec / NSEC_PER_USEC + ts_idle.tv_sec * USEC_PER_SEC;
+
+	if (slept) {
+		if (wakeup_irq >= 0 && wakeup_irq != OMAP3_IDLE_TIMER_IRQ)
+			omap3_idle_note_wakeup(wakeup_irq,
+					       timespec_to_ns(&ts_postidle));
+		omap3_idle_account(cx, idle_us);
+	}
 
 	local_irq_enable();
 	local_fiq_enable();
 
-	return ts_idle.tv_nsec / NSEC_PER_USEC + ts_idle.tv_sec * USEC_PER_SEC;
+	return idle_us;
 }
 
 /**
@@ -239,6 +445,25 @@ static int omap3_enter_idle_bm(struct cpuidle_device *dev,
 	if ((state->flags & CPUIDLE_FLAG_CHECK_BM) && omap3_idle_bm_check()) {
 		BUG_ON(!dev->safe_state);
 		new_state = dev->safe_state;
+	} else if (omap3_idle_predict_enabled) {
+		struct cpuidle_state *predicted = new_state;
+		u32 predicted_us = omap3_idle_predict_us();
+		int idx = new_state - dev->states;
+
+		/* Drop to the deepest state that pays off before the
+		 * predicted wakeup. */
+		while (idx > 0 &&
+		       dev->states[idx].target_residency > predicted_us)
+			idx--;
+		if (&dev->states[idx] != new_state)
+			predicted = next_valid_state(dev, &dev->states[idx]);
+
+		/* Only count it when we go shallower than the governor */
+		if (predicted < new_state) {
+			omap3_idle_stats[((struct omap3_processor_cx *)
+				cpuidle_get_statedata(predicted))->type].demoted++;
+			new_state = predicted;
+		}
 	}
 
 	dev->last_state = new_state;
@@ -466,6 +691,77 @@ int __init omap3_idle_init(void)
 
 	return 0;
 }
+
+#ifdef CONFIG_DEBUG_FS
+static int omap3_idle_stats_show(struct seq_file *s, void *unused)
+{
+	int i, j;
+
+	seq_printf(s, "state usage demoted too_deep too_shallow |");
+	for (j = 0; j < OMAP3_IDLE_HIST_BUCKETS - 1; j++)
+		seq_printf(s, " <%uus", omap3_idle_hist_us[j]);
+	seq_printf(s, " more\n");
+
+	for (i = OMAP3_STATE_C1; i < OMAP3_MAX_STATES; i++) {
+		struct omap3_idle_stats *st = &omap3_idle_stats[i];
+
+		if (!omap3_power_states[i].valid)
+			continue;
+		seq_printf(s, "C%d %u %u %u %u |", i + 1, st->usage,
+			   st->demoted, st->too_deep, st->too_shallow);
+		for (j = 0; j < OMAP3_IDLE_HIST_BUCKETS; j++)
+			seq_printf(s, " %u", st->hist[j]);
+		seq_printf(s, "\n");
+	}
+
+	seq_printf(s, "\ntrusted wakeup sources (irq interval_us):\n");
+	for_each_set_bit(i, omap3_idle_trusted, OMAP3_IDLE_NR_SOURCES)
+		seq_printf(s, "%d %u\n", i, omap3_idle_sources[i].interval_us);
+
+	return 0;
+}
+
+static int omap3_idle_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, omap3_idle_stats_show, NULL);
+}
+
+/* Any write clears the statistics */
+static ssize_t omap3_idle_stats_write(struct file *file,
+		const char __user *buf, size_t count, loff_t *ppos)
+{
+	local_irq_disable();
+	memset(omap3_idle_stats, 0, sizeof(omap3_idle_stats));
+	local_irq_enable();
+
+	return count;
+}
+
+static const struct file_operations omap3_idle_stats_fops = {
+	.open		= omap3_idle_stats_open,
+	.read		= seq_read,
+	.write		= omap3_idle_stats_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init omap3_idle_debugfs_init(void)
+{
+	struct dentry *d;
+
+	d = debugfs_create_dir("omap3_idle", NULL);
+	if (IS_ERR_OR_NULL(d))
+		return 0;
+
+	(void) debugfs_create_file("stats", S_IRUGO | S_IWUSR, d, NULL,
+				   &omap3_idle_stats_fops);
+	(void) debugfs_create_u32("predict", S_IRUGO | S_IWUSR, d,
+				  &omap3_idle_predict_enabled);
+
+	return 0;
+}
+late_initcall(omap3_idle_debugfs_init);
+#endif /* CONFIG_DEBUG_FS */
 #else
 int __init omap3_idle_init(void)
 {
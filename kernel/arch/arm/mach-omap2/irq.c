@@ -197,6 +197,36 @@ int omap_irq_pending(void)
 	return 0;
 }
 
+/*
+ * Returns the lowest numbered pending INTC interrupt other than 'ignore',
+ * 'ignore' if that is the only one pending, or -1 if none is. Used after
+ * wakeup from idle, with interrupts still disabled, to tell what woke us
+ * up; 'ignore' is the PRCM line, which comes along with most wakeups.
+ */
+int omap_irq_first_pending(int ignore)
+{
+	int i, found = -1;
+
+	for (i = 0; i < ARRAY_SIZE(irq_banks); i++) {
+		struct omap_irq_bank *bank = irq_banks + i;
+		int irq;
+
+		for (irq = 0; irq < bank->nr_irqs; irq += 32) {
+			u32 pending = intc_bank_read_reg(bank,
+				INTC_PENDING_IRQ0 + ((irq >> 5) << 5));
+
+			if (ignore >= irq && ignore < irq + 32 &&
+			    (pending & (1 << (ignore - irq)))) {
+				pending &= ~(1 << (ignore - irq));
+				found = ignore;
+			}
+			if (pending)
+				return irq + __ffs(pending);
+		}
+	}
+	return found;
+}
+
 // 20110425 prime@sdcmicro.com Patch for INTC autoidle management to make sure it is done in atomic operation with interrupt disabled [START]
 static int omap3_intc_idle_notifier(struct notifier_block *n,
 				      unsigned long val,
@@ -151,7 +151,7 @@ static int omap_target(struct cpufreq_policy *policy,
 	freqs.old = omap_getspeed(policy->cpu);;
 	/* 20110331 sookyoung.kim@lge.com LG-DVFS [START_LGE] */
 	//freqs_notify.new = clk_round_rate(mpu_clk, target_freq * 1000) / 1000;
-	if(ds_status.flag_run_dvs == 0){
+	if(DS_CPU_OP_BY_CPUFREQ()){
 		freqs_notify.new = clk_round_rate(mpu_clk, target_freq * 1000) / 1000;
 	}
 	else{	// LG-DVFS is running.
@@ -174,7 +174,7 @@ static int omap_target(struct cpufreq_policy *policy,
 
 #if 1
 	/* 20110331 sookyoung.kim@lge.com LG-DVFS [START_LGE] */
-	if(ds_status.flag_run_dvs == 0 ||
+	if(DS_CPU_OP_BY_CPUFREQ() ||
 		ds_status.flag_correct_cpu_op_update_path == 1)
 	{
 	/* 20110331 sookyoung.kim@lge.com LG-DVFS [END_LGE] */
@@ -329,7 +329,7 @@ static int omap_target(struct cpufreq_policy *policy,
 
 #if 1
 	/* 20110331 sookyoung.kim@lge.com LG-DVFS [START_LGE] */
-	if(ds_status.flag_run_dvs == 0 ||
+	if(DS_CPU_OP_BY_CPUFREQ() ||
 		ds_status.flag_correct_cpu_op_update_path == 1)
 	{
 	/* 20110331 sookyoung.kim@lge.com LG-DVFS [END_LGE] */
@@ -2341,6 +2341,35 @@ void omap2_gpio_resume_after_idle(bool restore_context)
 #endif
 }
 
+/*
+ * Returns the interrupt of the lowest pending and enabled GPIO of the bank
+ * behind INTC line 'bank_irq', or -1. Used after wakeup from idle to tell
+ * which GPIO of a bank woke us up.
+ */
+int omap2_gpio_first_pending(int bank_irq)
+{
+#if defined(CONFIG_ARCH_OMAP2) || defined(CONFIG_ARCH_OMAP3)
+	int i;
+
+	for (i = 0; i < gpio_bank_count; i++) {
+		struct gpio_bank *bank = &gpio_bank[i];
+		u32 isr;
+
+		if (bank->irq != bank_irq)
+			continue;
+		if (bank->method != METHOD_GPIO_24XX || !bank->mod_usage)
+			break;
+
+		isr = __raw_readl(bank->base + OMAP24XX_GPIO_IRQSTATUS1) &
+			__raw_readl(bank->base + OMAP24XX_GPIO_IRQENABLE1);
+		if (isr)
+			return bank->virtual_irq_start + __ffs(isr);
+		break;
+	}
+#endif
+	return -1;
+}
+
 static const struct dev_pm_ops gpio_pm_ops = {
 	.suspend	 = omap_gpio_suspend,
 	.resume		 = omap_gpio_resume,
@@ -31,6 +31,16 @@ struct dmm_mgrattrs {
 
 #define DMMPOOLSIZE      0x10000000
 
+/* Usage and fragmentation of the DSP virtual space, in bytes */
+struct dmm_stats {
+	u32 pool_size;
+	u32 free_bytes;
+	u32 largest_free;	/* Biggest free block */
+	u32 free_regions;
+	u32 reserved_regions;
+	u32 mapped_blocks;
+};
+
 /*
  *  ======== dmm_get_handle ========
  *  Purpose:
@@ -67,4 +77,11 @@ extern void dmm_exit(void);
 
 extern int dmm_create_tables(struct dmm_object *dmm_mgr,
 				    u32 addr, u32 size);
+
+extern int dmm_get_stats(struct dmm_object *dmm_mgr,
+				OUT struct dmm_stats *stats);
+
+struct dentry;
+
+extern void dmm_debugfs_init(struct dentry *dir);
 #endif /* DMM_ */
@@ -36,6 +36,7 @@
 #define WMDIOCTL_INTERRUPTDSP       (WMDIOCTL_RESERVEDBASE + 0x50)
 /* DMMU */
 #define WMDIOCTL_SETMMUCONFIG       (WMDIOCTL_RESERVEDBASE + 0x60)
+#define WMDIOCTL_MAPCACHE_FLUSH     (WMDIOCTL_RESERVEDBASE + 0x61)
 /* PWR */
 #define WMDIOCTL_PWRCONTROL         (WMDIOCTL_RESERVEDBASE + 0x70)
 
@@ -96,6 +96,7 @@ extern int gpio_bank_count;
 
 extern void omap2_gpio_prepare_for_idle(bool save_context);
 extern void omap2_gpio_resume_after_idle(bool restore_context);
+extern int omap2_gpio_first_pending(int bank_irq);
 extern void omap_set_gpio_debounce(int gpio, int enable);
 extern void omap_set_gpio_debounce_time(int gpio, int enable);
 /*-------------------------------------------------------------------------*/
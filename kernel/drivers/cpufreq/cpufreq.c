@@ -682,6 +682,31 @@ static ssize_t show_turn_on_lg_dvfs(struct cpufreq_policy *policy, char *buf)
     return sprintf(buf, "%x\n", ds_configuration.on_dvs);
 }
 
+#ifdef CONFIG_LG_DVFS_HOOK_STATS
+/* Cost of the LG-DVFS context switch hook, accumulated by ld_do_dvs_suite().
+ * Compare against turn_on_lg_dvfs = 0 to measure the overhead of the
+ * DVS schemes; any write resets the counters.
+ */
+static ssize_t store_lg_dvfs_overhead(struct cpufreq_policy *policy, const char *buf,
+                        size_t count)
+{
+	ds_counter.hook_calls = 0;
+	ds_counter.hook_ns = 0;
+
+	return count;
+}
+
+static ssize_t show_lg_dvfs_overhead(struct cpufreq_policy *policy, char *buf)
+{
+	unsigned long calls = ds_counter.hook_calls;
+	u64 total_ns = ds_counter.hook_ns;
+
+	return sprintf(buf, "calls %lu total_ns %llu avg_ns %llu\n",
+		calls, (unsigned long long)total_ns,
+		calls ? (unsigned long long)div64_u64(total_ns, calls) : 0ULL);
+}
+#endif
+
 /* 20110331 sookyoung.kim@lge.com LG-DVFS [END_LGE] */
 
 /**
@@ -714,6 +739,9 @@ cpufreq_freq_attr_rw(scaling_max_freq);
 cpufreq_freq_attr_rw(scaling_governor);
 cpufreq_freq_attr_rw(scaling_setspeed);
 cpufreq_freq_attr_rw(turn_on_lg_dvfs); // 110331 sookyoung.kim@lge.com LG-DVFS
+#ifdef CONFIG_LG_DVFS_HOOK_STATS
+cpufreq_freq_attr_rw(lg_dvfs_overhead);
+#endif
 
 static struct attribute *default_attrs[] = {
 	&cpuinfo_min_freq.attr,
@@ -728,6 +756,9 @@ static struct attribute *default_attrs[] = {
 	&scaling_available_governors.attr,
 	&scaling_setspeed.attr,
 	&turn_on_lg_dvfs.attr,	// 110331 sookyoung.kim@lge.com LG-DVFS
+#ifdef CONFIG_LG_DVFS_HOOK_STATS
+	&lg_dvfs_overhead.attr,
+#endif
 	NULL
 };
 
@@ -0,0 +1,176 @@
+/*
+ * drivers/cpufreq/cpufreq_lgdvfs.c
+ *
+ * 'lgdvfs' cpufreq governor.
+ *
+ * LG-DVFS (drivers/cpufreq/lg_dvfs.c) detects the type of every task at
+ * context switch and predicts the CPU_OP to use by GPScheDVS/AIDVS. By
+ * itself it then sets the MPU/IVA/L3 rates directly, bypassing cpufreq.
+ * This governor keeps the detection and the predictor but applies their
+ * decisions through the cpufreq driver, i.e. on the OPPs of the MPU from
+ * plat-omap/opp.c, so that LG-DVFS can be compared with the other
+ * governors by cpufreq_stats and the lg_dvfs tracepoints.
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ */
+
+#include <linux/cpufreq.h>
+#include <linux/init.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/sched.h>
+#include <linux/workqueue.h>
+
+#include <linux/dvs_suite.h>
+#include <trace/events/lg_dvfs.h>
+
+static struct cpufreq_policy *lgdvfs_policy;
+static DEFINE_MUTEX(lgdvfs_mutex);
+
+static struct workqueue_struct *lgdvfs_wq;
+static struct work_struct lgdvfs_work;
+
+/* The last request of LG-DVFS, in kHz, and when it was made */
+static unsigned int lgdvfs_target_freq;
+static u64 lgdvfs_request_ns;
+
+/* ds_configuration.on_dvs before this governor took over */
+static int lgdvfs_saved_on_dvs;
+
+/*
+ * Called by ds_update_cpu_op() on the way back to user space with
+ * interrupts disabled. The transition may sleep, so defer it.
+ */
+void cpufreq_lgdvfs_request(unsigned int target_cpu_op_index)
+{
+	lgdvfs_target_freq = target_cpu_op_index / 1000;
+	lgdvfs_request_ns = sched_clock();
+	queue_work(lgdvfs_wq, &lgdvfs_work);
+}
+
+static void cpufreq_lgdvfs_work(struct work_struct *work)
+{
+	struct cpufreq_policy *policy;
+	unsigned int target_freq;
+	unsigned int old_freq;
+	u64 request_ns;
+	u64 now_ns;
+
+	mutex_lock(&lgdvfs_mutex);
+
+	policy = lgdvfs_policy;
+	if (!policy)
+		goto out;
+
+	local_irq_disable();
+	target_freq = lgdvfs_target_freq;
+	request_ns = lgdvfs_request_ns;
+	local_irq_enable();
+
+	old_freq = policy->cur;
+	if (target_freq == old_freq)
+		goto out;
+
+	__cpufreq_driver_target(policy, target_freq, CPUFREQ_RELATION_L);
+
+	now_ns = sched_clock();
+	trace_lg_dvfs_transition(old_freq, policy->cur,
+				 now_ns > request_ns ? now_ns - request_ns : 0);
+out:
+	mutex_unlock(&lgdvfs_mutex);
+}
+
+static int cpufreq_lgdvfs_notifier(struct notifier_block *nb,
+				   unsigned long val, void *data)
+{
+	struct cpufreq_freqs *freqs = data;
+
+	if (val == CPUFREQ_POSTCHANGE && ds_status.flag_cpufreq_gov == 1)
+		ds_sync_cpu_op(freqs->new);
+
+	return 0;
+}
+
+static struct notifier_block cpufreq_lgdvfs_notifier_block = {
+	.notifier_call = cpufreq_lgdvfs_notifier,
+};
+
+static int cpufreq_governor_lgdvfs(struct cpufreq_policy *policy,
+				   unsigned int event)
+{
+	switch (event) {
+	case CPUFREQ_GOV_START:
+		if (!cpu_online(policy->cpu))
+			return -EINVAL;
+
+		/* From now on the OPPs are changed only through cpufreq */
+		lgdvfs_saved_on_dvs = ds_configuration.on_dvs;
+		ds_status.flag_cpufreq_gov = 1;
+		cpufreq_register_notifier(&cpufreq_lgdvfs_notifier_block,
+					  CPUFREQ_TRANSITION_NOTIFIER);
+
+		mutex_lock(&lgdvfs_mutex);
+		lgdvfs_policy = policy;
+		/* Begin with the max. perf., as LG-DVFS does. */
+		__cpufreq_driver_target(policy, policy->max,
+					CPUFREQ_RELATION_H);
+		mutex_unlock(&lgdvfs_mutex);
+
+		ds_sync_cpu_op(policy->cur);
+		ds_configuration.on_dvs = 1;
+		break;
+
+	case CPUFREQ_GOV_STOP:
+		ds_configuration.on_dvs = lgdvfs_saved_on_dvs;
+		if (lgdvfs_saved_on_dvs == 0)
+			ds_status.flag_run_dvs = 0;
+		ds_status.flag_cpufreq_gov = 0;
+
+		cpufreq_unregister_notifier(&cpufreq_lgdvfs_notifier_block,
+					    CPUFREQ_TRANSITION_NOTIFIER);
+
+		mutex_lock(&lgdvfs_mutex);
+		lgdvfs_policy = NULL;
+		mutex_unlock(&lgdvfs_mutex);
+
+		cancel_work_sync(&lgdvfs_work);
+		break;
+
+	case CPUFREQ_GOV_LIMITS:
+		mutex_lock(&lgdvfs_mutex);
+		if (policy->max < policy->cur)
+			__cpufreq_driver_target(policy,
+					policy->max, CPUFREQ_RELATION_H);
+		else if (policy->min > policy->cur)
+			__cpufreq_driver_target(policy,
+					policy->min, CPUFREQ_RELATION_L);
+		mutex_unlock(&lgdvfs_mutex);
+		break;
+	}
+	return 0;
+}
+
+struct cpufreq_governor cpufreq_gov_lgdvfs = {
+	.name = "lgdvfs",
+	.governor = cpufreq_governor_lgdvfs,
+	.max_transition_latency = 10000000,
+	.owner = THIS_MODULE,
+};
+
+static int __init cpufreq_lgdvfs_init(void)
+{
+	lgdvfs_wq = create_rt_workqueue("klgdvfs");
+	if (!lgdvfs_wq)
+		return -ENOMEM;
+
+	INIT_WORK(&lgdvfs_work, cpufreq_lgdvfs_work);
+
+	return cpufreq_register_governor(&cpufreq_gov_lgdvfs);
+}
+
+module_init(cpufreq_lgdvfs_init);
+
+MODULE_DESCRIPTION("'lgdvfs' - cpufreq governor driven by LG-DVFS");
+MODULE_LICENSE("GPL");
@@ -16,6 +16,9 @@
 
 #include "lg_dvfs.h"
 
+#define CREATE_TRACE_POINTS
+#include <trace/events/lg_dvfs.h>
+
 /* LKM START ***********************/
 #define DRIVER_AUTHOR	"Sookyoung Kim <sookyoung.kim@lge.com>"
 #define DRIVER_DESC		"LG-DVFS"
@@ -66,976 +69,6 @@ DS_GPSCHEDVS_STAT_STRUCT ds_gpschedvs_status;
  * Function definitions
  ****************************************************************************************/
 
-/*====================================================================
-	The functions involved with U(20,12) fixed point format arithmetic.
-	====================================================================*/
-
-#if 0	// {
-
-/* The unsigned multiplication function for U(20,12) format
-	 fixed point fractional numbers.
-	 Multiplicand and multiplier should be converted to
-	 U(20,12) format fixed point number by << 12 before using the function.
-	 Keep in mind that the calculation result should not exceed
-	 0xffffffff or 1048575.999755859375, the maximum value U(20,12) can represent.
-	 Otherwise, this function will cause segmentation error.
- */
-void ds_fpmul12(
-unsigned long multiplicand,
-unsigned long multiplier,
-unsigned long *multiplied)
-{
-
-/* umull	r4, r3, %1, %2		%1 = multiplicand, %2 = multiplier, 
- * 					r3 = higher 32 bits, r4 = lower 32 bits.
- * mov		r4, r4, lsr #12		Logical right shift r4 by 12 bits
- * mov		r3, r3, lsl #20		Logical left shift r3 by 20 bits
- * orr		%0, r3, r4		Logical OR r3 and r4 and save it to *multimpied.
- */
-
-//	printk(KERN_INFO "0x%lx * 0x%lx = ", multiplicand, multiplier);
-
-	__asm__ __volatile__("umull	r4, r3, %1, %2\n\t"
-					 "mov	r4, r4, lsr #12\n\t"
-					 "mov	r3, r3, lsl #20\n\t"
-					 "orr	%0, r3, r4"
-											 : "=r" (*multiplied)
-											 : "r" (multiplicand), "r" (multiplier)
-					 : "r4", "r3");
-
-//	printk(KERN_INFO "0x%lx\n", *multiplied);
-
-	return;
-}
-
-#endif	// }
-
-/* The unsigned division function for U(20,12) format fixed point fractional numbers.
-	 Dividend and divisor should be converted to U(20,12) format fixed point number
-	 by << 12 before using the function.
-	 Keep in mind that the calculation result should not exceed 0xffffffff or
-	 1048575.999755859375, the maximum value U(20,12) can represent.
-	 Otherwise, this function will cause segmentation error.
- */
-void ds_fpdiv12(
-unsigned long dividend,
-unsigned long divisor,
-unsigned long *quotient,
-unsigned long *remainder)
-{
-
-	unsigned long long lc_dividend;
-
-	lc_dividend = (unsigned long long)dividend;
-	lc_dividend = lc_dividend << 12;
-
-	//printk(KERN_INFO "0x%lx / 0x%lx = ", dividend, divisor);
-
-	do_div(lc_dividend, divisor);
-
-	*quotient = (unsigned long)lc_dividend;
-	*remainder = 0;
-
-	//printk(KERN_INFO "0x%lx + 0x%lx\n", *quotient, *remainder);
-
- return;
-}
-
-/* Normal 32-bit division.
-	 With this function, we can obtain both of the quotient and remainder at a time.
- */
-void ds_div12(
-unsigned long dividend,
-unsigned long divisor,
-unsigned long *quotient,
-unsigned long *remainder)
-{
-
-	unsigned long long lc_dividend;
-
-	lc_dividend = (unsigned long long)dividend;
-
-//	printk(KERN_INFO "0x%lx / 0x%lx = ", dividend, divisor);
-
-	do_div(lc_dividend, divisor);
-
-	*quotient = (unsigned long)lc_dividend;
-	*remainder = 0;
-
-//	printk(KERN_INFO "0x%lx + 0x%lx\n", *quotient, *remainder);
-
- return;
-}
-
-int ds_find_first1_in_integer_part(unsigned long target_value){
-
-	if(target_value == 0){
-		return(0);
-	}
-	else{
-		switch(target_value & 0xf0000000){
-			case 0xf0000000: return(32);
-			case 0xe0000000: return(32);
-			case 0xd0000000: return(32);
-			case 0xc0000000: return(32);
-			case 0xb0000000: return(32);
-			case 0xa0000000: return(32);
-			case 0x90000000: return(32);
-			case 0x80000000: return(32);
-			case 0x70000000: return(31);
-			case 0x60000000: return(31);
-			case 0x50000000: return(31);
-			case 0x40000000: return(31);
-			case 0x30000000: return(30);
-			case 0x20000000: return(30);
-			case 0x10000000: return(29);
-		}
-		switch(target_value & 0xf000000){
-			case 0xf000000: return(28);
-			case 0xe000000: return(28);
-			case 0xd000000: return(28);
-			case 0xc000000: return(28);
-			case 0xb000000: return(28);
-			case 0xa000000: return(28);
-			case 0x9000000: return(28);
-			case 0x8000000: return(28);
-			case 0x7000000: return(27);
-			case 0x6000000: return(27);
-			case 0x5000000: return(27);
-			case 0x4000000: return(27);
-			case 0x3000000: return(26);
-			case 0x2000000: return(26);
-			case 0x1000000: return(25);
-		}
-		switch(target_value & 0xf00000){
-			case 0xf00000: return(24);
-			case 0xe00000: return(24);
-			case 0xd00000: return(24);
-			case 0xc00000: return(24);
-			case 0xb00000: return(24);
-			case 0xa00000: return(24);
-			case 0x900000: return(24);
-			case 0x800000: return(24);
-			case 0x700000: return(23);
-			case 0x600000: return(23);
-			case 0x500000: return(23);
-			case 0x400000: return(23);
-			case 0x300000: return(22);
-			case 0x200000: return(22);
-			case 0x100000: return(21);
-		}
-		switch(target_value & 0xf0000){
-			case 0xf0000: return(20);
-			case 0xe0000: return(20);
-			case 0xd0000: return(20);
-			case 0xc0000: return(20);
-			case 0xb0000: return(20);
-			case 0xa0000: return(20);
-			case 0x90000: return(20);
-			case 0x80000: return(20);
-			case 0x70000: return(19);
-			case 0x60000: return(19);
-			case 0x50000: return(19);
-			case 0x40000: return(19);
-			case 0x30000: return(18);
-			case 0x20000: return(18);
-			case 0x10000: return(17);
-		}
-		switch(target_value & 0xf000){
-			case 0xf000: return(16);
-			case 0xe000: return(16);
-			case 0xd000: return(16);
-			case 0xc000: return(16);
-			case 0xb000: return(16);
-			case 0xa000: return(16);
-			case 0x9000: return(16);
-			case 0x8000: return(16);
-			case 0x7000: return(15);
-			case 0x6000: return(15);
-			case 0x5000: return(15);
-			case 0x4000: return(15);
-			case 0x3000: return(14);
-			case 0x2000: return(14);
-			case 0x1000: return(13);
-		}
-		switch(target_value & 0xf00){
-			case 0xf00: return(12);
-			case 0xe00: return(12);
-			case 0xd00: return(12);
-			case 0xc00: return(12);
-			case 0xb00: return(12);
-			case 0xa00: return(12);
-			case 0x900: return(12);
-			case 0x800: return(12);
-			case 0x700: return(11);
-			case 0x600: return(11);
-			case 0x500: return(11);
-			case 0x400: return(11);
-			case 0x300: return(10);
-			case 0x200: return(10);
-			case 0x100: return(9);
-		}
-		switch(target_value & 0xf0){
-			case 0xf0: return(8);
-			case 0xe0: return(8);
-			case 0xd0: return(8);
-			case 0xc0: return(8);
-			case 0xb0: return(8);
-			case 0xa0: return(8);
-			case 0x90: return(8);
-			case 0x80: return(8);
-			case 0x70: return(7);
-			case 0x60: return(7);
-			case 0x50: return(7);
-			case 0x40: return(7);
-			case 0x30: return(6);
-			case 0x20: return(6);
-			case 0x10: return(5);
-		}
-		switch(target_value & 0xf){
-			case 0xf: return(4);
-			case 0xe: return(4);
-			case 0xd: return(4);
-			case 0xc: return(4);
-			case 0xb: return(4);
-			case 0xa: return(4);
-			case 0x9: return(4);
-			case 0x8: return(4);
-			case 0x7: return(3);
-			case 0x6: return(3);
-			case 0x5: return(3);
-			case 0x4: return(3);
-			case 0x3: return(2);
-			case 0x2: return(2);
-			case 0x1: return(1);
-		}
-	}
-
-	return(0);
-}
-
-int ds_find_first1_in_fraction_part(unsigned long target_value){
-
-	if(target_value == 0){
-		return(0);
-	}
-	else{
-		switch(target_value & 0xf00){
-			case 0xf00: return(1);
-			case 0xe00: return(1);
-			case 0xd00: return(1);
-			case 0xc00: return(1);
-			case 0xb00: return(1);
-			case 0xa00: return(1);
-			case 0x900: return(1);
-			case 0x800: return(1);
-			case 0x700: return(2);
-			case 0x600: return(2);
-			case 0x500: return(2);
-			case 0x400: return(2);
-			case 0x300: return(3);
-			case 0x200: return(3);
-			case 0x100: return(4);
-		}
-		switch(target_value & 0xf0){
-			case 0xf0: return(5);
-			case 0xe0: return(5);
-			case 0xd0: return(5);
-			case 0xc0: return(5);
-			case 0xb0: return(5);
-			case 0xa0: return(5);
-			case 0x90: return(5);
-			case 0x80: return(5);
-			case 0x70: return(6);
-			case 0x60: return(6);
-			case 0x50: return(6);
-			case 0x40: return(6);
-			case 0x30: return(7);
-			case 0x20: return(7);
-			case 0x10: return(8);
-		}
-		switch(target_value & 0xf){
-			case 0xf: return(9);
-			case 0xe: return(9);
-			case 0xd: return(9);
-			case 0xc: return(9);
-			case 0xb: return(9);
-			case 0xa: return(9);
-			case 0x9: return(9);
-			case 0x8: return(9);
-			case 0x7: return(10);
-			case 0x6: return(10);
-			case 0x5: return(10);
-			case 0x4: return(10);
-			case 0x3: return(11);
-			case 0x2: return(11);
-			case 0x1: return(12);
-		}
-	}
-
-	return(0);
-}
-
-/* A sub function for ds_fpdiv().
-	 This function compares (1 bit carry + 32 bits integer part + 12 bits fraction part)
-	 of operand and operator.
- */
-int ds_compare45bits(
-int operand_carry, unsigned long operand_int_ulong, unsigned long operand_fra_fp12,
-int operator_carry, unsigned long operator_int_ulong, unsigned long operator_fra_fp12)
-{
-	int lc_result = 0;
-
-	lc_result = (operand_carry > operator_carry ? DS_LARGER :
-							(operand_carry < operator_carry ? DS_SMALLER : 
-							(operand_int_ulong > operator_int_ulong ? DS_LARGER :
-							(operand_int_ulong < operator_int_ulong ? DS_SMALLER :
-							(operand_fra_fp12 > operator_fra_fp12 ? DS_LARGER :
-							(operand_fra_fp12 < operator_fra_fp12 ? DS_SMALLER : DS_EQUAL
-							))))));
-
-	return(lc_result);
-}
-
-/* A sub function for ds_fpdiv().
-	 The carry for operand should be 0.
- */
-int ds_shiftleft44bits(
-int operand_carry, unsigned long operand_int_ulong, unsigned long operand_fra_fp12,
-int shift,
-int *operated_carry, unsigned long *operated_int_ulong, unsigned long *operated_fra_fp12)
-{
-	unsigned long targ_int_ulong = 0;
-	unsigned long targ_fra_fp12 = 0;
-	int operand_int_first1 = 0;
-
-	*operated_carry = 0;
-	*operated_int_ulong = 0;
-	*operated_fra_fp12 = 0;
-
-	if(operand_carry != 0){
-		printk(KERN_INFO "[ds_shiftleft44bits] Error1: Shift left beyond 33 bits.\n");
-		return(-1);
-	}
-
-	operand_int_first1 = ds_find_first1_in_integer_part(operand_int_ulong);
-
-	if(operand_int_first1+shift > 33){
-		printk(KERN_INFO "[ds_shiftleft44bits] Error2: Shift left beyond 33 bits.\n");
-		return(-1);
-	}
-	else{
-		if(operand_int_first1+shift == 33) *operated_carry = 1;
-		targ_int_ulong = operand_int_ulong << shift;
-		if(shift >= 12){
-			targ_int_ulong |= operand_fra_fp12 << (shift-12);
-			targ_fra_fp12 = 0x0;
-		}
-		else{
-			switch(shift){
-				case 11:
-					targ_int_ulong |= operand_fra_fp12 >> 1;
-					targ_fra_fp12 = (operand_fra_fp12 & 0x1) << 11;
-					break;
-				case 10:
-					targ_int_ulong |= operand_fra_fp12 >> 2;
-					targ_fra_fp12 = (operand_fra_fp12 & 0x3) << 10;
-					break;
-				case 9:
-					targ_int_ulong |= operand_fra_fp12 >> 3;
-					targ_fra_fp12 = (operand_fra_fp12 & 0x7) << 9;
-					break;
-				case 8:
-					targ_int_ulong |= operand_fra_fp12 >> 4;
-					targ_fra_fp12 = (operand_fra_fp12 & 0xf) << 8;
-					break;
-				case 7:
-					targ_int_ulong |= operand_fra_fp12 >> 5;
-					targ_fra_fp12 = (operand_fra_fp12 & 0x1f) << 7;
-					break;
-				case 6:
-					targ_int_ulong |= operand_fra_fp12 >> 6;
-					targ_fra_fp12 = (operand_fra_fp12 & 0x3f) << 6;
-					break;
-				case 5:
-					targ_int_ulong |= operand_fra_fp12 >> 7;
-					targ_fra_fp12 = (operand_fra_fp12 & 0x7f) << 5;
-					break;
-				case 4:
-					targ_int_ulong |= operand_fra_fp12 >> 8;
-					targ_fra_fp12 = (operand_fra_fp12 & 0xff) << 4;
-					break;
-				case 3:
-					targ_int_ulong |= operand_fra_fp12 >> 9;
-					targ_fra_fp12 = (operand_fra_fp12 & 0x1ff) << 3;
-					break;
-				case 2:
-					targ_int_ulong |= operand_fra_fp12 >> 10;
-					targ_fra_fp12 = (operand_fra_fp12 & 0x3ff) << 2;
-					break;
-				case 1:
-					targ_int_ulong |= operand_fra_fp12 >> 11;
-					targ_fra_fp12 = (operand_fra_fp12 & 0x7ff) << 1;
-					break;
-				case 0:
-					targ_fra_fp12 |= operand_fra_fp12 & 0xfff;
-			}
-		}
-		*operated_int_ulong = targ_int_ulong;
-		*operated_fra_fp12 = targ_fra_fp12;
-		return(0);
-	}
-}
-
-/* A sub function for ds_fpdiv().
-	 Operand should be larger than operator.
- */
-int ds_subtract44bits(
-int operand_carry, unsigned long operand_int_ulong, unsigned long operand_fra_fp12,
-int operator_carry, unsigned long operator_int_ulong, unsigned long operator_fra_fp12,
-int *operated_carry, unsigned long *operated_int_ulong, unsigned long *operated_fra_fp12)
-{
-	if(operand_carry == operator_carry){
-		*operated_carry = 0;
-		if(operand_fra_fp12 >= operator_fra_fp12){
-			*operated_fra_fp12 = operand_fra_fp12 - operator_fra_fp12;
-			*operated_int_ulong = operand_int_ulong - operator_int_ulong;
-		}
-		else{
-			*operated_fra_fp12 = operand_fra_fp12 + 0x1000 - operator_fra_fp12;
-			*operated_int_ulong = operand_int_ulong - 0x1 - operator_int_ulong;
-		}
-	}
-	/* If operand_carry != operator_carry,
-		 natually operand_carry == 1 and operator_carry == 0 */
-	else{
-		if(operand_int_ulong >= operator_int_ulong){
-			*operated_carry = 1;
-			if(operand_fra_fp12 >= operator_fra_fp12){
-				*operated_fra_fp12 = operand_fra_fp12 - operator_fra_fp12;
-				*operated_int_ulong = operand_int_ulong - operator_int_ulong;
-			}
-			else{
-				*operated_fra_fp12 = operand_fra_fp12 + 0x1000 - operator_fra_fp12;
-				*operated_int_ulong = operand_int_ulong - 0x1 - operator_int_ulong;
-			}
-		}
-		else{
-			*operated_carry = 0;
-			if(operand_fra_fp12 >= operator_fra_fp12){
-				*operated_fra_fp12 = operand_fra_fp12 - operator_fra_fp12;
-				*operated_int_ulong = (0xffffffff - operator_int_ulong) + 1 + operand_int_ulong;
-			}
-			else{
-				*operated_fra_fp12 = operand_fra_fp12 + 0x1000 - operator_fra_fp12;
-				*operated_int_ulong = (0xffffffff - operator_int_ulong) + operand_int_ulong;
-			}
-		}
-	}
-
-	return(0);
-}
-
-/* ds_fpmul12 can treat only the case where the entire value
-	 (integer part + fractional part) of the multiplicand, multiplier,
-	 and multiplied all can be expressed in U(20,12) fixed point fractional number format,
-	 i.e., max. 20 bits of integer part (for fractional parts, we don't need to worry about
-	 because, whatever the fractional value is, it will be expressed in fixed 12 bits).
-
-	 This function covers the rest cases that ds_fpmul12 can not treat by repeated additions
-	 instead of the direct multiplication using ds_fpmul12.
-	 For the case that ds_fpmul12 can treat, this function uses ds_fpmul12.
-
-	 Note that multiplicand_fra_fp12 and multiplier_fra_fp12 should not include integer part.
-
-	 multiplicand_int_ulong is the integer part of multiplicand.
-	 multiplicand_fra_fp12 is the fraction part of multiplicand.
-	 multiplier_int_ulong is the integer part of multiplier.
-	 multiplier_fra_fp12 is the fraction part of multiplier.
-	 multiplied_int_ulong is the integer part of multiplied.
-	 multiplied_fra_fp12 is the fraction part of multiplied.
- */
-int ds_fpmul(unsigned long multiplicand_int_ulong, unsigned long multiplicand_fra_fp12,
-						 unsigned long multiplier_int_ulong, unsigned long multiplier_fra_fp12,
-						 unsigned long *multiplied_int_ulong, unsigned long *multiplied_fra_fp12)
-{
-	int multiplicand_int_digits = 0;
-	int multiplier_int_digits = 0;
-	int i = 0;
-
-	unsigned long operand_fp12 = 0;
-	unsigned long operand_int_ulong = 0;
-	unsigned long operand_fra_fp12 = 0;
-	unsigned long operand_int_ulong_rest = 0;
-	unsigned long operand_fp12_rest = 0;
-
-	unsigned long operator_fp12 = 0;
-	unsigned long operator_int_ulong = 0;
-	unsigned long operator_fra_fp12 = 0;
-
-	unsigned long operated_fp12 = 0;
-	unsigned long operated_int_ulong = 0;
-	unsigned long operated_fra_fp12 = 0;
-
-	int operand_int_digits = 0;
-	int operator_int_digits = 0;
-
-	*multiplied_int_ulong = 0;
-	*multiplied_fra_fp12 = 0;
-
-	/* (1) Check if the integer part of the multiplied value will not be able to expressed
-				 by a 32-bit unsigned long variable.
-	 */
-	multiplicand_int_digits = ds_find_first1_in_integer_part(multiplicand_int_ulong);
-	multiplier_int_digits = ds_find_first1_in_integer_part(multiplier_int_ulong);
-	if(multiplicand_int_digits + multiplier_int_digits > 32){
-		printk(KERN_INFO "[ds_fpmul] multiplicand_int_ulong digits %d + \
-										 multiplier_int_ulong digits %d exceeds 32\n",
-					 multiplicand_int_digits, multiplier_int_digits);
-		return(-1);
-	}
-	else{
-		/* (2) If the integer + fraction of the multiplicand, multiplier, and multiplied
-					 all can be represented in U(20,12), directly use ds_fpmul12.
-		 */
-		if(multiplicand_int_digits <= 20 &&
-			 multiplier_int_digits <= 20 &&
-			 multiplicand_int_digits + multiplier_int_digits <= 20)
-		{
-			operand_fp12 = DS_ULONG2FP12(multiplicand_int_ulong) | multiplicand_fra_fp12;
-			operator_fp12 = DS_ULONG2FP12(multiplier_int_ulong) | multiplier_fra_fp12;
-			ds_fpmul12(operand_fp12, operator_fp12, &operated_fp12);
-			*multiplied_int_ulong = DS_GETFP12INT(operated_fp12);
-			*multiplied_fra_fp12 = DS_GETFP12FRA(operated_fp12);
-		}
-		/* (3) If the integer + fraction of the multiplicand, multiplier, and multiplied
-					 can not all be represented in U(20,12), use subsequent additions.
-
-					 Now possible cases are
-
-					 1. The integer + fraction of both the multiplicand and multiplier
-							can be represented in U(20,12), but not for the multiplied.
-
-					 2. The integer + fraction of either the multiplicand or multiplier
-							can not be represented in U(20,12), and natually not for the multiplied.
-
-					 Note that it is impossible that the integer + fraction of both the
-					 multiplicand and multiplier can not be represented in U(20,12)
-					 because such cases should have been filtered out by (1).
-		 */
-		else{
-
-			/* Take one between the multiplicand and multiplier that can be respresented in
-				 U(20,12) as operator.
-			 */
-			if(multiplicand_int_digits >= multiplier_int_digits){
-				operand_int_digits = multiplicand_int_digits;
-				operand_int_ulong = multiplicand_int_ulong;
-				operand_fra_fp12 = multiplicand_fra_fp12;
-
-				operator_int_digits = multiplier_int_digits;
-				operator_int_ulong = multiplier_int_ulong;
-				operator_fra_fp12 = multiplier_fra_fp12;
-				operator_fp12 = DS_ULONG2FP12(multiplier_int_ulong) | multiplier_fra_fp12;
-			}
-			else{
-				operand_int_digits = multiplier_int_digits;
-				operand_int_ulong = multiplier_int_ulong;
-				operand_fra_fp12 = multiplier_fra_fp12;
-
-				operator_int_digits = multiplicand_int_digits;
-				operator_int_ulong = multiplicand_int_ulong;
-				operator_fra_fp12 = multiplicand_fra_fp12;
-				operator_fp12 = DS_ULONG2FP12(multiplicand_int_ulong) | multiplicand_fra_fp12;
-			}
-
-			/* A multiplication is the sum of the operator shifted by each 1 in operand.
-				 Thus, we repeatly add the operator (entire 32 bits) shifted by each 1 in operand
-				 until the remaineder of the integer part of the operand becomes sufficiently small
-				 such that the integer part of the operated is smaller than 20 bits.
-				 Once the remainder of the integer part of the operand becomes sufficiently small,
-				 then we use ds_fpmul12 for the remainder.
-			 */
-			for(i=operand_int_digits-1;i>(19-operator_int_digits);i--){
-
-				/* Repeatedly add the shifted operator upon every 1 in operand */
-				if((operand_int_ulong & (1<<i)) != 0){
-					operated_int_ulong += operator_int_ulong << i;
-					/* If the shift is not smaller than 12,
-						 the entire operator_fra_fp12 becomes integer value.
-						 Thus, just add the shifted operator_fra_fp12
-						 to the integer part of the result. */
-					if(i >= 12){
-						operated_int_ulong += operator_fra_fp12 << (i-12);
-					}
-					/* If the shift is smaller than 12,
-						 a fraction of operator_fra_fp12 will remains as fractional value.
-						 Thus, just add the shifted operator_fra_fp12
-						 to the integer part of the result. */
-					else{
-						switch(i){
-							case 11:
-								operated_int_ulong += operator_fra_fp12 >> 1;
-								operated_fra_fp12 += (operator_fra_fp12 & 0x1) << 11;
-								break;
-							case 10:
-								operated_int_ulong += operator_fra_fp12 >> 2;
-								operated_fra_fp12 += (operator_fra_fp12 & 0x3) << 10;
-								break;
-							case 9:
-								operated_int_ulong += operator_fra_fp12 >> 3;
-								operated_fra_fp12 += (operator_fra_fp12 & 0x7) << 9;
-								break;
-							case 8:
-								operated_int_ulong += operator_fra_fp12 >> 4;
-								operated_fra_fp12 += (operator_fra_fp12 & 0xf) << 8;
-								break;
-							case 7:
-								operated_int_ulong += operator_fra_fp12 >> 5;
-								operated_fra_fp12 += (operator_fra_fp12 & 0x1f) << 7;
-								break;
-							case 6:
-								operated_int_ulong += operator_fra_fp12 >> 6;
-								operated_fra_fp12 += (operator_fra_fp12 & 0x3f) << 6;
-								break;
-							case 5:
-								operated_int_ulong += operator_fra_fp12 >> 7;
-								operated_fra_fp12 += (operator_fra_fp12 & 0x7f) << 5;
-								break;
-							case 4:
-								operated_int_ulong += operator_fra_fp12 >> 8;
-								operated_fra_fp12 += (operator_fra_fp12 & 0xff) << 4;
-								break;
-							case 3:
-								operated_int_ulong += operator_fra_fp12 >> 9;
-								operated_fra_fp12 += (operator_fra_fp12 & 0x1ff) << 3;
-								break;
-							case 2:
-								operated_int_ulong += operator_fra_fp12 >> 10;
-								operated_fra_fp12 += (operator_fra_fp12 & 0x3ff) << 2;
-								break;
-							case 1:
-								operated_int_ulong += operator_fra_fp12 >> 11;
-								operated_fra_fp12 += (operator_fra_fp12 & 0x7ff) << 1;
-								break;
-							case 0:
-								operated_fra_fp12 += operator_fra_fp12 & 0xfff;
-						}
-						operated_int_ulong += DS_GETFP12INT(operated_fra_fp12);
-						operated_fra_fp12 = DS_GETFP12FRA(operated_fra_fp12);
-					}
-				}
-			}
-
-			/* Now we can use ds_fpmul12.
-				 Extract the remained operand,
-				 i.e., the lower (20-operator_int_digits) digits only */
-			switch(operator_int_digits){
-				case 20: operand_int_ulong_rest = 0; break;
-				case 19: operand_int_ulong_rest = operand_int_ulong & 0x1; break;
-				case 18: operand_int_ulong_rest = operand_int_ulong & 0x3; break;
-				case 17: operand_int_ulong_rest = operand_int_ulong & 0x7; break;
-				case 16: operand_int_ulong_rest = operand_int_ulong & 0xf; break;
-				case 15: operand_int_ulong_rest = operand_int_ulong & 0x1f; break;
-				case 14: operand_int_ulong_rest = operand_int_ulong & 0x3f; break;
-				case 13: operand_int_ulong_rest = operand_int_ulong & 0x7f; break;
-				case 12: operand_int_ulong_rest = operand_int_ulong & 0xff; break;
-				case 11: operand_int_ulong_rest = operand_int_ulong & 0x1ff; break;
-				case 10: operand_int_ulong_rest = operand_int_ulong & 0x3ff; break;
-				case 9: operand_int_ulong_rest = operand_int_ulong & 0x7ff; break;
-				case 8: operand_int_ulong_rest = operand_int_ulong & 0xfff; break;
-				case 7: operand_int_ulong_rest = operand_int_ulong & 0x1fff; break;
-				case 6: operand_int_ulong_rest = operand_int_ulong & 0x3fff; break;
-				case 5: operand_int_ulong_rest = operand_int_ulong & 0x7fff; break;
-				case 4: operand_int_ulong_rest = operand_int_ulong & 0xffff; break;
-				case 3: operand_int_ulong_rest = operand_int_ulong & 0x1ffff; break;
-				case 2: operand_int_ulong_rest = operand_int_ulong & 0x3ffff; break;
-				case 1: operand_int_ulong_rest = operand_int_ulong & 0x7ffff; break;
-				case 0: operand_int_ulong_rest = operand_int_ulong & 0xfffff;
-			}
-
-			/* Call ds_fpmul12 */
-			operand_fp12_rest = DS_ULONG2FP12(operand_int_ulong_rest) | operand_fra_fp12;
-			operator_fp12 = DS_ULONG2FP12(operator_int_ulong) | operator_fra_fp12;
-			ds_fpmul12(operand_fp12_rest, operator_fp12, &operated_fp12);
-			operated_int_ulong += DS_GETFP12INT(operated_fp12);
-			operated_fra_fp12 += DS_GETFP12FRA(operated_fp12);
-			operated_int_ulong += DS_GETFP12INT(operated_fra_fp12);
-			operated_fra_fp12 = DS_GETFP12FRA(operated_fra_fp12);
-			*multiplied_int_ulong = operated_int_ulong;
-			*multiplied_fra_fp12 = operated_fra_fp12;
-		}
-		return(0);
-	}
-}
-
-/* ds_fpdiv12 can treat only in the case where the entire value
-	 (integer part + fractional part) of the dividend, divisor,
-	 and divided all can be expressed in U(20,12) fixed point fractional number format,
-	 i.e., max. 20 bits of integer part (for fractional parts, we don't need to worry about
-	 because, whatever the fractional value is, it will be expressed in fixed 12 bits.).
-
-	 This function covers the rest cases that ds_fpdiv12 can not treat by repeated
-	 subtraction instead of the direct division using ds_fpidv12.
-	 For the case that ds_fpidv12 can treat, this function uses ds_fpidv12.
-
-	 Note that dividend_fra_fp12 and divisor_fra_fp12 should not include integer part.
-
-	 dividend_int_ulong is the integer part of dividend.
-	 dividend_fra_fp12 is the fraction part of dividend.
-	 divisor_int_ulong is the integer part of divisor.
-	 divisor_fra_fp12 is the fraction part of divisor.
-	 divided_int_ulong is the integer part of divided.
-	 divided_fra_fp12 is the fraction part of divided.
- */
-int ds_fpdiv(unsigned long dividend_int_ulong, unsigned long dividend_fra_fp12,
-						 unsigned long divisor_int_ulong, unsigned long divisor_fra_fp12,
-						 unsigned long *divided_int_ulong, unsigned long *divided_fra_fp12)
-{
-	int dividend_int_digits = 0;
-	int divisor_int_digits = 0;
-	int divisor_fra_digits = 0;
-	int i = 0;
-
-	unsigned long operand_fp12 = 0;
-	unsigned long operand_int_ulong = 0;
-	unsigned long operand_fra_fp12 = 0;
-
-	unsigned long operand_int_ulong_shifted = 0;
-	unsigned long operand_fra_fp12_shifted = 0;
-
-	int operand_carry = 0;
-	int operand_carry_shifted = 0;
-
-	unsigned long operator_fp12 = 0;
-	unsigned long operator_int_ulong = 0;
-	unsigned long operator_fra_fp12 = 0;
-	unsigned long operator_int_ulong_shifted = 0;
-	unsigned long operator_fra_fp12_shifted = 0;
-
-	int operator_carry = 0;
-	int operator_carry_shifted = 0;
-
-	unsigned long operated_fp12 = 0;
-	unsigned long operated_int_ulong = 0;
-	unsigned long operated_fra_fp12 = 0;
-
-	unsigned long tmp_ulong = 0;
-
-	int accumulated_operand_shifted_digits = 0;
-
-	*divided_int_ulong = 0;
-	*divided_fra_fp12 = 0;
-
-	if(divisor_int_ulong == 0 && divisor_fra_fp12 == 0){
-		printk(KERN_INFO "[ds_fpdiv] Error1: Divided by 0 \
-											(divisor_int_ulong == 0 divisor_fra_fp12 == 0).\n");
-		return(-1);
-	}
-
-	if(dividend_int_ulong == 0 && dividend_fra_fp12 == 0){
-		*divided_int_ulong = 0;
-		*divided_fra_fp12 = 0;
-		return(0);
-	}
-
-	if(dividend_int_ulong == divisor_int_ulong && dividend_fra_fp12 == divisor_fra_fp12){
-		*divided_int_ulong = 1;
-		*divided_fra_fp12 = 0;
-		return(0);
-	}
-
-	/* (1) Check if the integer part of the multiplied value will not be able to expressed
-				 by a 32-bit unsigned long variable.
-	 */
-	dividend_int_digits = ds_find_first1_in_integer_part(dividend_int_ulong);
-	divisor_int_digits = ds_find_first1_in_integer_part(divisor_int_ulong);
-	divisor_fra_digits = ds_find_first1_in_fraction_part(divisor_fra_fp12);
-	if(divisor_int_ulong == 0 && dividend_int_digits + divisor_fra_digits > 32){
-		printk(KERN_INFO "[ds_fpdiv] Error2: divisor_int_ulong == 0 && \
-										 dividend_int_digits %d + divisor_fra_digits %d > 32.\n",
-					 dividend_int_digits, divisor_fra_digits);
-		return(-1);
-	}
-	else{
-
-		/* (2) If the integer + fraction of the dividend, divisor, and divided
-					 all can be represented in U(20,12), directly use ds_fpdiv12.
-		 */
-		if(dividend_int_digits <= 20 &&
-			 divisor_int_digits <= 20 &&
-			 dividend_int_digits + divisor_fra_digits <= 20)
-		{
-			operand_fp12 = DS_ULONG2FP12(dividend_int_ulong) | dividend_fra_fp12;
-			operator_fp12 = DS_ULONG2FP12(divisor_int_ulong) | divisor_fra_fp12;
-			ds_fpdiv12(operand_fp12, operator_fp12, &operated_fp12, &tmp_ulong);
-			*divided_int_ulong = DS_GETFP12INT(operated_fp12);
-			*divided_fra_fp12 = DS_GETFP12FRA(operated_fp12);
-		}
-		/* (3) If the integer + fraction of the dividend, divisor, and divided
-					 can not all be represented in U(20,12), use subsequent subtractions.
-
-					 Now possible cases are
-
-					 1. The integer + fraction of both the dividend and divisor
-							can be represented in U(20,12),
-							but the integer + fraction of divided can not be represented in U(20,12).
-
-					 2. The integer + fraction of the dividend can not be represented in U(20,12)
-							but that of the divisor can be.
-							In this case, the integer + fraction of the divided may or may not be
-							represented in U(20,12).
-
-					 3. The integer + fraction of the dividend can be represented in U(20,12)
-							but that of the divisor can not be.
-							In this case, the integer + fraction of the divided always can be
-							represented in U(20,12).
-
-					 4. The integer + fraction of neigther the dividend nor divisor can be
-							represented in U(20,12).
-							In this case, the integer + fraction of the divided always can be
-							represented in U(20,12).
-		 */
-		else{
-			operand_carry = 0;
-			operand_int_ulong = dividend_int_ulong;
-			operand_fra_fp12 = dividend_fra_fp12;
-
-			operator_carry = 0;
-			operator_int_ulong = divisor_int_ulong;
-			operator_fra_fp12 = divisor_fra_fp12;
-
-			/* Calculate the integer part of the operated
-				 as long as the operand is larger than the operator.
-			 */
-			while(ds_compare45bits(operand_carry,
-														 operand_int_ulong,
-														 operand_fra_fp12,
-														 operator_carry,
-														 operator_int_ulong,
-														 operator_fra_fp12) == DS_LARGER)
-			{
-				/* Find the maximum number of digits
-					 the operator can be shifted without exceeding the operand */
-				i = 0;
-				do{
-					i ++;
-					if(ds_shiftleft44bits(operator_carry,
-																operator_int_ulong,
-																operator_fra_fp12,
-																i,
-																&operator_carry_shifted,
-																&operator_int_ulong_shifted,
-																&operator_fra_fp12_shifted) < 0)
-						return(-1);
-				}while(ds_compare45bits(operator_carry_shifted,
-																operator_int_ulong_shifted,
-																operator_fra_fp12_shifted,
-																operand_carry,
-																operand_int_ulong,
-																operand_fra_fp12) != DS_LARGER);
-				/* The found number of digit to shift is i-1 */
-
-				/* The found digit number is a fraction of the quotient */
-				operated_int_ulong |= 1<<(i-1);
-
-				/* Shift the operator left by the found digit number */
-				if(ds_shiftleft44bits(operator_carry,
-															operator_int_ulong,
-															operator_fra_fp12, i-1,
-															&operator_carry_shifted,
-															&operator_int_ulong_shifted,
-															&operator_fra_fp12_shifted) < 0) return(-1);
-
-				/* Then, subtract the shifted operator
-					 from the operand to get the remained value of the operand */
-				ds_subtract44bits(operand_carry,
-													operand_int_ulong,
-													operand_fra_fp12,
-													operator_carry_shifted,
-													operator_int_ulong_shifted,
-													operator_fra_fp12_shifted,
-													&operand_carry,
-													&operand_int_ulong,
-													&operand_fra_fp12);
-
-				/* If no remained value exists in the operand, it's the end of division */
-				if(operand_carry == 0 && operand_int_ulong == 0 && operand_fra_fp12 == 0){
-					*divided_int_ulong = operated_int_ulong;
-					*divided_fra_fp12 = 0;
-					return(0);
-				}
-			}
-
-			/* Calculate the fractional part of the operated after the operand becomes
-				 smaller than the operator.
-				 This calculation needs to be repeated just until the LSB of the 12-bits
-				 fraction part of result is determined.
-				 And, obviously, the LSB is determined when the accumulated shifted digit
-				 number of the operand reaches 12.
-			 */
-			accumulated_operand_shifted_digits = 0;
-			while(accumulated_operand_shifted_digits < 12){
-				/* Find the minimum number of digits the operand should be shifted to be
-					 same or larger than the operator */
-				i = 0;
-				do{
-					i ++;
-					if(ds_shiftleft44bits(operand_carry,
-																operand_int_ulong,
-																operand_fra_fp12, i,
-																&operand_carry_shifted,
-																&operand_int_ulong_shifted,
-																&operand_fra_fp12_shifted) < 0) return(-1);
-				}while(ds_compare45bits(operand_carry_shifted,
-																operand_int_ulong_shifted,
-																operand_fra_fp12_shifted,
-																operator_carry,
-																operator_int_ulong,
-																operator_fra_fp12) == DS_SMALLER);
-				/* The found number of digit to shift is i */
-
-				/* Update accumulated_operand_shifted_digits */
-				accumulated_operand_shifted_digits += i;
-
-				/* After the finding, if accumulated shifted digit number of the operand
-					 exceeds 12, stop calculation */
-				if(accumulated_operand_shifted_digits > 12){
-					*divided_int_ulong = operated_int_ulong;
-					*divided_fra_fp12 = operated_fra_fp12;
-					return(0);
-				}
-
-				/* The found digit number is a fraction of the fractional part of the result */
-				operated_fra_fp12 |= 1<<(12-accumulated_operand_shifted_digits);
-
-				/* Subtract the operator from the shifted operand to get the remained value
-					 of the shifted operand */
-				ds_subtract44bits(operand_carry_shifted,
-													operand_int_ulong_shifted,
-													operand_fra_fp12_shifted,
-													operator_carry,
-													operator_int_ulong,
-													operator_fra_fp12,
-													&operand_carry,
-													&operand_int_ulong,
-													&operand_fra_fp12);
-
-				/* If no remained value exists in the operand, it's the end of division */
-				if(operand_carry == 0 && operand_int_ulong == 0 && operand_fra_fp12 == 0){
-					*divided_int_ulong = operated_int_ulong;
-					*divided_fra_fp12 = operated_fra_fp12;
-					return(0);
-				}
-			}
-
-			*divided_int_ulong = operated_int_ulong;
-			*divided_fra_fp12 = operated_fra_fp12;
-		}
-		return(0);
-	}
-}
-
 /*====================================================================
 	The function which finds and returns the next high CPU_OP index.
 	====================================================================*/
@@ -1150,133 +183,6 @@ unsigned long perf_requirement_fra_fp12)
 		}
 	}
 }
-
-/*====================================================================
-	The function which updates the fractions of
-	busy (= task + schedule + dvs suite) and idle time at each CPU_OP.
-	====================================================================*/
-
-int ds_update_time_counter(void){
-
-	unsigned long lc_sec_interval = 0;
-	unsigned long lc_usec_interval = 0;
-	unsigned long lc_usec_interval_fse = 0;
-	unsigned long lc_usec_interval_fse_fra_fp12 = 0;
-
-	/* (1) No rdtsc support in ARM.
-			So, we instead use ds_status.cpu_op_index for the last time interval
-			to calculate the full speed equivalent elapsed time.
-			I.e., the fse elapsed time = 
-			elapsed time (measured by do_gettimeofday) * scaling factor
-	 */
-
-	do_gettimeofday(&ds_timeval);
-	ds_status.tv_sec_curr = ds_timeval.tv_sec;
-	ds_status.tv_usec_curr = ds_timeval.tv_usec;
-
-	if(ds_status.flag_time_base_initialized == 0){
-		lc_usec_interval = 0;
-		ds_status.flag_time_base_initialized = 1;
-	}
-	else{
-		if(ds_status.tv_sec_curr == ds_status.tv_sec_base){
-			if(ds_status.tv_usec_curr >= ds_status.tv_usec_base){
-				lc_usec_interval = ds_status.tv_usec_curr - ds_status.tv_usec_base;
-			}
-			else{
-				/* Time inversion. 
-					This happens due to the inaccuracy in do_gettimeofday() function
-					when it is called consecutively in a very short time inverval.
-					In this case, we apply 1msec, which is the minimum context switch interval, 
-					as default.
-				 */
-				lc_usec_interval = 1000;
-			}
-		}
-		else{
-			/* ds_status.tv_usec_curr should be ds_status.tv_usec_base + 1.
-				This is because of that, 
-				no matter how long the interval between two consecutive 
-				ds_update_time_counter() calls is, it never ever able to 
-				exceed 1 sec in Linux kernel since the function is called
-				4 times at every context swtiching.
-			 */
-			lc_usec_interval = ds_status.tv_usec_curr + 1000000 - ds_status.tv_usec_base;
-		}
-
-	}
-	ds_status.tv_sec_base = ds_status.tv_sec_curr;
-	ds_status.tv_usec_base = ds_status.tv_usec_curr;
-
-	switch(ds_status.cpu_op_index){
-		case DS_CPU_OP_INDEX_0:
-		lc_usec_interval_fse = lc_usec_interval;
-		lc_usec_interval_fse_fra_fp12 = 0x0;
-		break;
-	case DS_CPU_OP_INDEX_1:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x96c, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_2:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x95b, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_3:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x94a, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_4:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x93c, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_5:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x92b, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_6:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x91a, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_7:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x90c, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_8:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x80b, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_9:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x70a, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_10:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x60c, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_11:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x50b, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_12:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x40a, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_13:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x30c, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_14:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x20b, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_15:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x10a, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-	default:
-		lc_usec_interval_fse = lc_usec_interval;
-		lc_usec_interval_fse_fra_fp12 = 0x0;
-		break;
-	}
 #else
 	if(perf_requirement_int_ulong > 0){
 		return(DS_CPU_OP_INDEX_0);
@@ -1332,579 +238,107 @@ unsigned long perf_requirement_int_ulong,
 unsigned long perf_requirement_fra_fp12)
 {
 
-	/* If perf_requirement_int_ulong > 0,
-		 which means that the required performance is greater than 1,
-		 apply the maximum CPU_OP. */
-	if(perf_requirement_int_ulong > 0){
-		return(DS_CPU_OP_INDEX_0);
-	}
-	else if((perf_requirement_fra_fp12 & 0xff) != 0){
-		switch(perf_requirement_fra_fp12 & 0xf00){
-			case 0xf00: return(DS_CPU_OP_INDEX_3);	/* > 0.9375 and < 1 */
-			case 0xe00: return(DS_CPU_OP_INDEX_3);	/* > 0.875 and < 0.9375 */
-			case 0xd00: return(DS_CPU_OP_INDEX_3);	/* > 0.8125 and < 0.875 */
-			case 0xc00: return(DS_CPU_OP_INDEX_6);	/* > 0.75 and < 0.8125 */
-			case 0xb00: return(DS_CPU_OP_INDEX_6);	/* > 0.6875 and < 0.75 */
-			case 0xa00: return(DS_CPU_OP_INDEX_6);	/* > 0.625 and < 0.6875 */
-			case 0x900: return(DS_CPU_OP_INDEX_9);	/* > 0.5625 and < 0.625 */
-			case 0x800: return(DS_CPU_OP_INDEX_9);	/* > 0.5 and < 0.5625 */
-			case 0x700: return(DS_CPU_OP_INDEX_9);	/* > 0.4375 and < 0.5 */
-			case 0x600: return(DS_CPU_OP_INDEX_9);	/* > 0.375 and < 0.4375 */
-			case 0x500: return(DS_CPU_OP_INDEX_9);	/* > 0.3125 and < 0.375 */
-			case 0x400: return(DS_CPU_OP_INDEX_9);	/* > 0.25 and < 0.3125 */
-			case 0x300: return(DS_CPU_OP_INDEX_9);	/* > 0.1875 and < 0.25 */
-			case 0x200: return(DS_CPU_OP_INDEX_9);	/* > 0.125 and < 0.1875 */
-			case 0x100: return(DS_CPU_OP_INDEX_9);	/* > 0.0625 and < 0.125 */
-			default: return(DS_CPU_OP_INDEX_9);	/* < 0.0625 */
-		}
-	}
-	else{
-		switch(perf_requirement_fra_fp12){
-			case 0xf00: return(DS_CPU_OP_INDEX_3);	/* == 0.9375 */
-			case 0xe00: return(DS_CPU_OP_INDEX_3);	/* == 0.875 */
-			case 0xd00: return(DS_CPU_OP_INDEX_3);	/* == 0.8125 */
-			case 0xc00: return(DS_CPU_OP_INDEX_6);	/* == 0.75 */
-			case 0xb00: return(DS_CPU_OP_INDEX_6);	/* == 0.6875 */
-			case 0xa00: return(DS_CPU_OP_INDEX_6);	/* == 0.625 */
-			case 0x900: return(DS_CPU_OP_INDEX_9);	/* == 0.5625 */
-			case 0x800: return(DS_CPU_OP_INDEX_9);	/* == 0.5 */
-			case 0x700: return(DS_CPU_OP_INDEX_9);	/* == 0.4375 */
-			case 0x600: return(DS_CPU_OP_INDEX_9);	/* == 0.375 */
-			case 0x500: return(DS_CPU_OP_INDEX_9);	/* == 0.3125 */
-			case 0x400: return(DS_CPU_OP_INDEX_9);	/* == 0.25 */
-			case 0x300: return(DS_CPU_OP_INDEX_9);	/* == 0.1875 */
-			case 0x200: return(DS_CPU_OP_INDEX_9);	/* == 0.125 */
-			case 0x100: return(DS_CPU_OP_INDEX_9);	/* == 0.0625 */
-			default: return(DS_CPU_OP_INDEX_9);	/* <= 0.0625 */
-		}
-	}
-}
-
-/*====================================================================
-	The function which updates the fractions of
-	busy (= task + schedule + dvs suite) and idle time at each CPU_OP.
-	====================================================================*/
-
-int ds_update_time_counter(void){
-
-	unsigned long lc_sec_interval = 0;
-	unsigned long lc_usec_interval = 0;
-	unsigned long lc_usec_interval_fse = 0;
-	unsigned long lc_usec_interval_fse_fra_fp12 = 0;
-
-	/* (1) No rdtsc support in ARM.
-			So, we instead use ds_status.cpu_op_index for the last time interval
-			to calculate the full speed equivalent elapsed time.
-			I.e., the fse elapsed time = 
-			elapsed time (measured by do_gettimeofday) * scaling factor
-	 */
-
-	do_gettimeofday(&ds_timeval);
-	ds_status.tv_sec_curr = ds_timeval.tv_sec;
-	ds_status.tv_usec_curr = ds_timeval.tv_usec;
-
-	if(ds_status.flag_time_base_initialized == 0){
-		lc_usec_interval = 0;
-		ds_status.flag_time_base_initialized = 1;
-	}
-	else{
-		if(ds_status.tv_sec_curr == ds_status.tv_sec_base){
-			if(ds_status.tv_usec_curr >= ds_status.tv_usec_base){
-				lc_usec_interval = ds_status.tv_usec_curr - ds_status.tv_usec_base;
-			}
-			else{
-				/* Time inversion. 
-					This happens due to the inaccuracy in do_gettimeofday() function
-					when it is called consecutively in a very short time inverval.
-					In this case, we apply 1msec, which is the minimum context switch interval, 
-					as default.
-				 */
-				lc_usec_interval = 1000;
-			}
-		}
-		else{
-			/* ds_status.tv_usec_curr should be ds_status.tv_usec_base + 1.
-				This is because of that, 
-				no matter how long the interval between two consecutive 
-				ds_update_time_counter() calls is, it never ever able to 
-				exceed 1 sec in Linux kernel since the function is called
-				4 times at every context swtiching.
-			 */
-			lc_usec_interval = ds_status.tv_usec_curr + 1000000 - ds_status.tv_usec_base;
-		}
-
-	}
-	ds_status.tv_sec_base = ds_status.tv_sec_curr;
-	ds_status.tv_usec_base = ds_status.tv_usec_curr;
-
-	switch(ds_status.cpu_op_index){
-		case DS_CPU_OP_INDEX_0:
-		lc_usec_interval_fse = lc_usec_interval;
-		lc_usec_interval_fse_fra_fp12 = 0x0;
-		break;
-	case DS_CPU_OP_INDEX_1:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x90c, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_2:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x80b, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_3:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x70a, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_4:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x60c, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_5:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x50b, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_6:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x40a, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_7:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x30c, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_8:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x20b, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-		break;
-	case DS_CPU_OP_INDEX_9:
-		ds_fpmul(lc_usec_interval, 0, 0, 0x10a, 
-			 &lc_usec_interval_fse, &lc_usec_interval_fse_fra_fp12);
-	default:
-		lc_usec_interval_fse = lc_usec_interval;
-		lc_usec_interval_fse_fra_fp12 = 0x0;
-		break;
-	}
-#endif
-
-	/* (2) Update ds_counter by using lc_usec_interval, lc_usec_interval_fse,
-				 lc_usec_interval_fse_fra_fp12, ds_status.cpu_op_index,
-				 ds_status.cpu_op_sf, ds_status.cpu_op_index_nr,
-				 ds_status.cpu_op_mhz, and ds_status.cpu_mode.
-	 */
-
-	/* Elapsed */
-	ds_counter.elapsed_usec += lc_usec_interval;
-	if(ds_counter.elapsed_usec >= 1000000){
-		ds_counter.elapsed_sec += 1;
-		ds_counter.elapsed_usec -= 1000000;
-	}
-
-	/* Idle */
-	if(ds_status.cpu_mode == DS_CPU_MODE_IDLE){
-#if 0	// Not needed unless we want statistics
-		ds_counter.idle_usec[ds_status.cpu_op_index_nr] += lc_usec_interval;
-		if(ds_counter.idle_usec[ds_status.cpu_op_index_nr] >= 1000000){
-			ds_counter.idle_sec[ds_status.cpu_op_index_nr] += 1;
-			ds_counter.idle_usec[ds_status.cpu_op_index_nr] -= 1000000;
-		}
-
-		ds_counter.idle_total_usec += lc_usec_interval;
-		if(ds_counter.idle_total_usec >= 1000000){
-			ds_counter.idle_total_sec += 1;
-			ds_counter.idle_total_usec -= 1000000;
-		}
-#endif
-	}
-	/* Busy */
-	else{
-#if 0	// Not needed unless we want statistics
-		ds_counter.busy_usec[ds_status.cpu_op_index_nr] += lc_usec_interval;
-		if(ds_counter.busy_usec[ds_status.cpu_op_index_nr] >= 1000000){
-			ds_counter.busy_sec[ds_status.cpu_op_index_nr] += 1;
-			ds_counter.busy_usec[ds_status.cpu_op_index_nr] -= 1000000;
-		}
-#endif
-
-		ds_counter.busy_total_usec += lc_usec_interval;
-		if(ds_counter.busy_total_usec >= 1000000){
-			ds_counter.busy_total_sec += 1;
-			ds_counter.busy_total_usec -= 1000000;
-		}
-
-		ds_counter.busy_fse_usec += lc_usec_interval_fse;
-		if(ds_counter.busy_fse_usec >= 1000000){
-			ds_counter.busy_fse_sec += 1;
-			ds_counter.busy_fse_usec -= 1000000;
-		}
-		ds_counter.busy_fse_usec_fra_fp12 += lc_usec_interval_fse_fra_fp12;
-		if(ds_counter.busy_fse_usec_fra_fp12 >= 0x1000){
-			ds_counter.busy_fse_usec += 1;
-			ds_counter.busy_fse_usec_fra_fp12 -= 0x1000;
-		}
-
-#if 0	// Not needed unless we want statistics
-		switch(ds_status.cpu_mode){
-
-			case DS_CPU_MODE_TASK:
-
-				ds_counter.busy_task_usec[ds_status.cpu_op_index_nr] += lc_usec_interval;
-				if(ds_counter.busy_task_usec[ds_status.cpu_op_index_nr] >= 1000000){
-					ds_counter.busy_task_sec[ds_status.cpu_op_index_nr] += 1;
-					ds_counter.busy_task_usec[ds_status.cpu_op_index_nr] -= 1000000;
-				}
-
-				ds_counter.busy_task_total_usec += lc_usec_interval;
-				if(ds_counter.busy_task_total_usec >= 1000000){
-					ds_counter.busy_task_total_sec += 1;
-					ds_counter.busy_task_total_usec -= 1000000;
-				}
-
-				ds_counter.busy_task_fse_usec += lc_usec_interval_fse;
-				if(ds_counter.busy_task_fse_usec >= 1000000){
-					ds_counter.busy_task_fse_sec += 1;
-					ds_counter.busy_task_fse_usec -= 1000000;
-				}
-				ds_counter.busy_task_fse_usec_fra_fp12 += lc_usec_interval_fse_fra_fp12;
-				if(ds_counter.busy_task_fse_usec_fra_fp12 >= 0x1000){
-					ds_counter.busy_task_fse_usec += 1;
-					ds_counter.busy_task_fse_usec_fra_fp12 -= 0x1000;
-				}
-				break;
-
-			case DS_CPU_MODE_SCHEDULE:
-
-				ds_counter.busy_schedule_usec[ds_status.cpu_op_index_nr] += lc_usec_interval;
-				if(ds_counter.busy_schedule_usec[ds_status.cpu_op_index_nr] >= 1000000){
-					ds_counter.busy_schedule_sec[ds_status.cpu_op_index_nr] += 1;
-					ds_counter.busy_schedule_usec[ds_status.cpu_op_index_nr] -= 1000000;
-				}
-
-				ds_counter.busy_schedule_total_usec += lc_usec_interval;
-				if(ds_counter.busy_schedule_total_usec >= 1000000){
-					ds_counter.busy_schedule_total_sec += 1;
-					ds_counter.busy_schedule_total_usec -= 1000000;
-				}
-
-				ds_counter.busy_schedule_fse_usec += lc_usec_interval_fse;
-				if(ds_counter.busy_schedule_fse_usec >= 1000000){
-					ds_counter.busy_schedule_fse_sec += 1;
-					ds_counter.busy_schedule_fse_usec -= 1000000;
-				}
-				ds_counter.busy_schedule_fse_usec_fra_fp12 += lc_usec_interval_fse_fra_fp12;
-				if(ds_counter.busy_schedule_fse_usec_fra_fp12 >= 0x1000){
-					ds_counter.busy_schedule_fse_usec += 1;
-					ds_counter.busy_schedule_fse_usec_fra_fp12 -= 0x1000;
-				}
-				break;
-
-			case DS_CPU_MODE_DVS_SUITE:
-
-				ds_counter.busy_dvs_suite_usec[ds_status.cpu_op_index_nr] += lc_usec_interval;
-				if(ds_counter.busy_dvs_suite_usec[ds_status.cpu_op_index_nr] >= 1000000){
-					ds_counter.busy_dvs_suite_sec[ds_status.cpu_op_index_nr] += 1;
-					ds_counter.busy_dvs_suite_usec[ds_status.cpu_op_index_nr] -= 1000000;
-				}
-
-				ds_counter.busy_dvs_suite_total_usec += lc_usec_interval;
-				if(ds_counter.busy_dvs_suite_total_usec >= 1000000){
-					ds_counter.busy_dvs_suite_total_sec += 1;
-					ds_counter.busy_dvs_suite_total_usec -= 1000000;
-				}
-
-				ds_counter.busy_dvs_suite_fse_usec += lc_usec_interval_fse;
-				if(ds_counter.busy_dvs_suite_fse_usec >= 1000000){
-					ds_counter.busy_dvs_suite_fse_sec += 1;
-					ds_counter.busy_dvs_suite_fse_usec -= 1000000;
-				}
-				ds_counter.busy_dvs_suite_fse_usec_fra_fp12 += lc_usec_interval_fse_fra_fp12;
-				if(ds_counter.busy_dvs_suite_fse_usec_fra_fp12 >= 0x1000){
-					ds_counter.busy_dvs_suite_fse_usec += 1;
-					ds_counter.busy_dvs_suite_fse_usec_fra_fp12 -= 0x1000;
-				}
-				break;
-		}
-#endif
-	}
-
-	return(0);
-}
-
-/*====================================================================
-	The functions to perform DVS scheme:
-	AIDVS.
-	====================================================================*/
-
-#if 0
-int ds_do_dvs_aidvs(unsigned int *target_cpu_op_index, 
-					DS_AIDVS_STAT_STRUCT *stat,
-					int target_static_prio, 
-					int interval_window_size,
-					unsigned long interval_window_length,
-					unsigned long speedup_threshold, 
-					unsigned long speedup_interval)
-{
-	unsigned long lc_time_usec_interval_inc = 0;
-	unsigned long lc_time_usec_work_inc = 0;
-	unsigned long lc_time_usec_work_in_window = 0;
-	unsigned long lc_time_usec_interval_in_window = 0;
-	unsigned long lc_time_usec_since_last_util_calc = 0;
-
-	unsigned long lc_utilization_int_ulong_old_by_weight = 0;
-	unsigned long lc_utilization_fra_fp12_old_by_weight = 0;
-	unsigned long lc_numerator_int_ulong = 0;
-	unsigned long lc_numerator_fra_fp12 = 0;
-	unsigned long lc_moving_avg_int_ulong = 0;
-	unsigned long lc_moving_avg_fra_fp12 = 0;
-
-	/* (1) Update stat->time_usec_interval, 
-			stat->time_usec_work_fse,
-			stat->time_usec_work_fse_lasting, OR
-			stat->time_usec_work,
-			stat->time_usec_work_lasting.
-	 */
-	if(stat->base_initialized == 0 ||
-		(stat->base_initialized != 0 &&
-		ds_counter.elapsed_sec > stat->time_sec_interval_inc_base + 1))
-	{
-		stat->time_usec_util_calc_base = ds_counter.elapsed_usec;
-		stat->time_usec_interval_inc_base = ds_counter.elapsed_usec;
-		stat->time_sec_interval_inc_base = ds_counter.elapsed_sec;
-		stat->time_usec_work_inc_base = ds_counter.busy_total_usec;
-		stat->cpu_op_index = DS_CPU_OP_INDEX_MAX;
-		stat->base_initialized = 1;
-	}
-
-	/* This calaculation assumes that the interval
-	   between any consecutive context switches is shorter than 1 sec.
-	 */
-	if(ds_counter.elapsed_usec >= stat->time_usec_interval_inc_base){
-		lc_time_usec_interval_inc =
-			ds_counter.elapsed_usec - stat->time_usec_interval_inc_base;
-	}
-	else{
-		lc_time_usec_interval_inc =
-			ds_counter.elapsed_usec + (1000000 - stat->time_usec_interval_inc_base);
+	/* If perf_requirement_int_ulong > 0,
+		 which means that the required performance is greater than 1,
+		 apply the maximum CPU_OP. */
+	if(perf_requirement_int_ulong > 0){
+		return(DS_CPU_OP_INDEX_0);
 	}
-	stat->time_usec_interval += lc_time_usec_interval_inc;
-	stat->time_usec_interval_inc_base = ds_counter.elapsed_usec;
-	stat->time_sec_interval_inc_base = ds_counter.elapsed_sec;
-
-	if(stat->flag_in_busy_half == 1){
-		if(ds_counter.busy_total_usec >= stat->time_usec_work_inc_base){
-			lc_time_usec_work_inc =
-				ds_counter.busy_total_usec - stat->time_usec_work_inc_base;
-		}
-		else{
-			lc_time_usec_work_inc =
-				ds_counter.busy_total_usec + (1000000 - stat->time_usec_work_inc_base);
+	else if((perf_requirement_fra_fp12 & 0xff) != 0){
+		switch(perf_requirement_fra_fp12 & 0xf00){
+			case 0xf00: return(DS_CPU_OP_INDEX_3);	/* > 0.9375 and < 1 */
+			case 0xe00: return(DS_CPU_OP_INDEX_3);	/* > 0.875 and < 0.9375 */
+			case 0xd00: return(DS_CPU_OP_INDEX_3);	/* > 0.8125 and < 0.875 */
+			case 0xc00: return(DS_CPU_OP_INDEX_6);	/* > 0.75 and < 0.8125 */
+			case 0xb00: return(DS_CPU_OP_INDEX_6);	/* > 0.6875 and < 0.75 */
+			case 0xa00: return(DS_CPU_OP_INDEX_6);	/* > 0.625 and < 0.6875 */
+			case 0x900: return(DS_CPU_OP_INDEX_9);	/* > 0.5625 and < 0.625 */
+			case 0x800: return(DS_CPU_OP_INDEX_9);	/* > 0.5 and < 0.5625 */
+			case 0x700: return(DS_CPU_OP_INDEX_9);	/* > 0.4375 and < 0.5 */
+			case 0x600: return(DS_CPU_OP_INDEX_9);	/* > 0.375 and < 0.4375 */
+			case 0x500: return(DS_CPU_OP_INDEX_9);	/* > 0.3125 and < 0.375 */
+			case 0x400: return(DS_CPU_OP_INDEX_9);	/* > 0.25 and < 0.3125 */
+			case 0x300: return(DS_CPU_OP_INDEX_9);	/* > 0.1875 and < 0.25 */
+			case 0x200: return(DS_CPU_OP_INDEX_9);	/* > 0.125 and < 0.1875 */
+			case 0x100: return(DS_CPU_OP_INDEX_9);	/* > 0.0625 and < 0.125 */
+			default: return(DS_CPU_OP_INDEX_9);	/* < 0.0625 */
 		}
-		stat->time_usec_work += lc_time_usec_work_inc;
-		stat->time_usec_work_lasting += lc_time_usec_work_inc;
-		stat->time_usec_work_inc_base = ds_counter.busy_total_usec;
 	}
-
-	/* (2) If a series of workload lasts over speedup_threshold,
-			update CPU_OP to cope with this workload burst.
-	 */
-	if((stat->consecutive_speedup_count == 0 &&
-		stat->time_usec_work_lasting >= speedup_threshold) ||
-		(stat->consecutive_speedup_count > 0 &&
-		stat->time_usec_work_lasting >= speedup_interval))
-	{
-		/* Rampup stat->cpu_op_index by one available level */
-		switch(stat->cpu_op_index){
-			case DS_CPU_OP_INDEX_0: break;
-			case DS_CPU_OP_INDEX_1: stat->cpu_op_index = DS_CPU_OP_INDEX_0; break;
-			case DS_CPU_OP_INDEX_2: stat->cpu_op_index = DS_CPU_OP_INDEX_1; break;
-			case DS_CPU_OP_INDEX_3: stat->cpu_op_index = DS_CPU_OP_INDEX_2; break;
-			case DS_CPU_OP_INDEX_4: stat->cpu_op_index = DS_CPU_OP_INDEX_3; break;
-			case DS_CPU_OP_INDEX_5: stat->cpu_op_index = DS_CPU_OP_INDEX_4; break;
-			case DS_CPU_OP_INDEX_6: stat->cpu_op_index = DS_CPU_OP_INDEX_5; break;
-			case DS_CPU_OP_INDEX_7: stat->cpu_op_index = DS_CPU_OP_INDEX_6; break;
-			case DS_CPU_OP_INDEX_8: stat->cpu_op_index = DS_CPU_OP_INDEX_7; break;
-			case DS_CPU_OP_INDEX_9: stat->cpu_op_index = DS_CPU_OP_INDEX_8; break;
-#ifdef CONFIG_CPU_OVERCLOCK
-			case DS_CPU_OP_INDEX_10: stat->cpu_op_index = DS_CPU_OP_INDEX_9; break;
-			case DS_CPU_OP_INDEX_11: stat->cpu_op_index = DS_CPU_OP_INDEX_10; break;
-			case DS_CPU_OP_INDEX_12: stat->cpu_op_index = DS_CPU_OP_INDEX_11; break;
-			case DS_CPU_OP_INDEX_13: stat->cpu_op_index = DS_CPU_OP_INDEX_12; break;
-			case DS_CPU_OP_INDEX_14: stat->cpu_op_index = DS_CPU_OP_INDEX_13; break;
-			case DS_CPU_OP_INDEX_15: stat->cpu_op_index = DS_CPU_OP_INDEX_14; break;
-#endif
-			default: stat->cpu_op_index = DS_CPU_OP_INDEX_0; break;
+	else{
+		switch(perf_requirement_fra_fp12){
+			case 0xf00: return(DS_CPU_OP_INDEX_3);	/* == 0.9375 */
+			case 0xe00: return(DS_CPU_OP_INDEX_3);	/* == 0.875 */
+			case 0xd00: return(DS_CPU_OP_INDEX_3);	/* == 0.8125 */
+			case 0xc00: return(DS_CPU_OP_INDEX_6);	/* == 0.75 */
+			case 0xb00: return(DS_CPU_OP_INDEX_6);	/* == 0.6875 */
+			case 0xa00: return(DS_CPU_OP_INDEX_6);	/* == 0.625 */
+			case 0x900: return(DS_CPU_OP_INDEX_9);	/* == 0.5625 */
+			case 0x800: return(DS_CPU_OP_INDEX_9);	/* == 0.5 */
+			case 0x700: return(DS_CPU_OP_INDEX_9);	/* == 0.4375 */
+			case 0x600: return(DS_CPU_OP_INDEX_9);	/* == 0.375 */
+			case 0x500: return(DS_CPU_OP_INDEX_9);	/* == 0.3125 */
+			case 0x400: return(DS_CPU_OP_INDEX_9);	/* == 0.25 */
+			case 0x300: return(DS_CPU_OP_INDEX_9);	/* == 0.1875 */
+			case 0x200: return(DS_CPU_OP_INDEX_9);	/* == 0.125 */
+			case 0x100: return(DS_CPU_OP_INDEX_9);	/* == 0.0625 */
+			default: return(DS_CPU_OP_INDEX_9);	/* <= 0.0625 */
 		}
-
-		/* After the speedup, initialize followings */
-		stat->time_usec_work_lasting = 0;
-		stat->consecutive_speedup_count ++;
 	}
-
-	/* (3) Basic AIDVS operation at every context switch.
-	 */
-
-	/* If ds_parameter.entry_type == DS_ENTRY_SWITCH_TO */
-	if(ds_parameter.entry_type == DS_ENTRY_SWITCH_TO){
-
-		/* Idle -> Busy, i.e. the boundary of two consecutive intervals. */
-		if((ds_parameter.prev_p->static_prio > target_static_prio ||
-			ds_parameter.prev_p->pid == 0) &&
-			ds_parameter.next_p->static_prio <= target_static_prio)
-		{
-
-			/* Until all the stat->interval_window_array[] is filled, 
-				this calculation is based on the less number of intervals 
-				than interval_window_size.
-				The following code automatically discards the oldest interval's
-				time_usec_interval and time_usec_work_fse OR time_usec_work 
-				to keep the number of intervals that are used for 
-				the calculation interval_window_size.
-			 */
-#if 0	// MOVING WINDOW
-			if(stat->time_usec_interval_in_window < 
-				stat->interval_window_array[stat->interval_window_index].time_usec_interval)
-				stat->time_usec_interval_in_window = 0;
-			else
-				stat->time_usec_interval_in_window -=
-					stat->interval_window_array[stat->interval_window_index].time_usec_interval;
-
-			if(stat->time_usec_work_fse_in_window < 
-				stat->interval_window_array[stat->interval_window_index].time_usec_work_fse)
-				stat->time_usec_work_fse_in_window = 0;
-			else
-				stat->time_usec_work_fse_in_window -=
-					stat->interval_window_array[stat->interval_window_index].time_usec_work_fse;
-
-			stat->interval_window_array[stat->interval_window_index].time_usec_interval = 
-				stat->time_usec_interval;
-			stat->interval_window_array[stat->interval_window_index].time_usec_work_fse = 
-				stat->time_usec_work_fse;
-
-			stat->time_usec_interval_in_window +=
-				stat->interval_window_array[stat->interval_window_index].time_usec_interval;
-			stat->time_usec_work_fse_in_window +=
-				stat->interval_window_array[stat->interval_window_index].time_usec_work_fse;
-#endif
-
-			stat->time_usec_interval_in_window += stat->time_usec_interval;
-			stat->time_usec_work_in_window += stat->time_usec_work;
-
-			if(stat->time_usec_interval_in_window > 1000000){
-				lc_time_usec_interval_in_window = stat->time_usec_interval_in_window / 1000;
-				lc_time_usec_work_in_window = stat->time_usec_work_in_window / 1000;
-			}
-			else{
-				lc_time_usec_interval_in_window = stat->time_usec_interval_in_window;
-				lc_time_usec_work_in_window = stat->time_usec_work_in_window;
-			}
-
-#if 0	// MOVING WINDOW
-			if(stat->interval_window_index == interval_window_size - 1)
-				stat->interval_window_index = 0;
-			else
-				stat->interval_window_index ++;
+}
 #endif
 
-			// DS_GPSCHEDVS_Lx_MIN_WINDOW_LENGTH
-			if(ds_counter.elapsed_usec >= stat->time_usec_util_calc_base){
-				lc_time_usec_since_last_util_calc =
-					ds_counter.elapsed_usec - stat->time_usec_util_calc_base;
-			}
-			else{
-				lc_time_usec_since_last_util_calc =
-					ds_counter.elapsed_usec + (1000000 - stat->time_usec_util_calc_base);
-			}
+/*====================================================================
+	The function which updates the fractions of
+	busy (= task + schedule + dvs suite) and idle time.
+	====================================================================*/
 
-			if(lc_time_usec_since_last_util_calc >= interval_window_length){
-
-				/* Calculate OLD x 3 */
-				ds_fpmul(stat->utilization_int_ulong, 
-						stat->utilization_fra_fp12, 
-						DS_AIDVS_MOVING_AVG_WEIGHT, 
-						0x0,
-						&lc_utilization_int_ulong_old_by_weight, 
-						&lc_utilization_fra_fp12_old_by_weight);
-	
-				/* Calculate NEW, i.e., the current interval window's utilization */
-				if(lc_time_usec_interval_in_window == 0){
-					stat->utilization_int_ulong = 1;
-					stat->utilization_fra_fp12 = 0;
-				}
-				else{
-					if(ds_fpdiv(lc_time_usec_work_in_window,
-								0,
-								lc_time_usec_interval_in_window,
-								0,
-								&stat->utilization_int_ulong,
-								&stat->utilization_fra_fp12) < 0){
-						printk(KERN_INFO "[ds_do_dvs_aidvs] Error: ds_fpdiv failed. \
-										 Current DVS scheme is disabled.\n");
-						ds_configuration.on_dvs = 0;
-						return(-1);
-					}
-				}
+int ds_update_time_counter(void){
 
-				/* Calculate OLD x 3 + NEW, i.e., the numerator of moving average */
-				lc_numerator_int_ulong = 
-					lc_utilization_int_ulong_old_by_weight + stat->utilization_int_ulong;
-				lc_numerator_fra_fp12 = 
-					lc_utilization_fra_fp12_old_by_weight + stat->utilization_fra_fp12;
-				if(lc_numerator_fra_fp12 >= 0x1000){
-					lc_numerator_int_ulong += 1;
-					lc_numerator_fra_fp12 -= 0x1000;
-				}
+	u64 lc_now_ns;
+	u64 lc_ns_interval = 0;
+	u64 lc_ns_interval_fse = 0;
 
-				/* Calculate (OLD x 3 + NEW) / 4, i.e., the moving average */
-				ds_fpdiv(lc_numerator_int_ulong, lc_numerator_fra_fp12, 
-						DS_AIDVS_MOVING_AVG_WEIGHT+1, 0,
-						&lc_moving_avg_int_ulong, &lc_moving_avg_fra_fp12);
+	/* (1) No rdtsc support in ARM.
+			So, we instead use ds_status.cpu_op_sf of the last time interval
+			to calculate the full speed equivalent elapsed time.
+			I.e., the fse elapsed time = 
+			elapsed time (measured by sched_clock) * scaling factor
+	 */
 
-				/* Find the CPU_OP_INDEX corresponding to the calculated utilization */
-				stat->cpu_op_index = 
-					ds_get_next_high_cpu_op_index(lc_moving_avg_int_ulong, lc_moving_avg_fra_fp12);
+	lc_now_ns = sched_clock();
 
-				stat->time_usec_interval_in_window = 0;
-				stat->time_usec_work_in_window = 0;
-				stat->interval_window_index = 0;
-				stat->time_usec_util_calc_base = ds_counter.elapsed_usec;
-			}
+	if(ds_status.flag_time_base_initialized == 0){
+		ds_status.flag_time_base_initialized = 1;
+	}
+	/* Otherwise sched_clock() wrapped around. Just drop this interval. */
+	else if(lc_now_ns > ds_status.time_base_ns){
+		lc_ns_interval = lc_now_ns - ds_status.time_base_ns;
+	}
+	ds_status.time_base_ns = lc_now_ns;
 
-			/* Upon every new arrival of a busy half, initialize followings.
-			 */
-			stat->time_usec_work = 0;
-			stat->time_usec_interval = 0;
+	/* cpu_op_sf is U(20,12) */
+	lc_ns_interval_fse = (lc_ns_interval * ds_status.cpu_op_sf) >> 12;
 
-			/* As GPScheDVS uses a multiple number of AIDVS each of them sees
-				a particular priority range of tasks, we have to initialize
-				time_usec_work_fse_inc_base OR time_usec_work_inc 
-				at every beginning of a new interval.
-				Otherwise, all the tasks executed during this particular AIDVS's
-				idle half (i.e., not the busy half) will be added into
-				stat->interval_window_array[stat->interval_window_index].time_usec_work_fse
-				and then stat->time_usec_work_fse_in_window OR
-				stat->interval_window_array[stat->interval_window_index].time_usec_work
-				and then stat->time_usec_work_in_window. */
-			stat->time_usec_work_inc_base = ds_counter.busy_usec;
+	/* (2) Update ds_counter by using lc_ns_interval, lc_ns_interval_fse,
+				 and ds_status.cpu_mode.
+	 */
 
-			/* Upon the end of an interval, set flag_in_busy_half for the next interval. */
-			stat->flag_in_busy_half = 1;
-		}
+	/* Elapsed */
+	ds_counter.elapsed_ns += lc_ns_interval;
 
-		/* Busy -> Idle, i.e., the end of the busy half of the current interval */
-		else if(ds_parameter.prev_p->static_prio <= target_static_prio &&
-				(ds_parameter.next_p->static_prio > target_static_prio || 
-				ds_parameter.next_p->pid == 0))
-		{
-			stat->time_usec_work_lasting = 0;
-			stat->consecutive_speedup_count = 0;
-			stat->flag_in_busy_half = 0;
-		}
+	/* Busy */
+	if(ds_status.cpu_mode != DS_CPU_MODE_IDLE){
+		ds_counter.busy_total_ns += lc_ns_interval;
+		ds_counter.busy_fse_ns += lc_ns_interval_fse;
 	}
 
-	/* (4) Determine *target_cpu_op_index.
-	 */
-	*target_cpu_op_index = stat->cpu_op_index;
-
 	return(0);
 }
-#endif
+
+/*====================================================================
+	The functions to perform DVS scheme:
+	AIDVS.
+	====================================================================*/
 
 int ds_do_dvs_aidvs(unsigned int *target_cpu_op_index, 
 					DS_AIDVS_STAT_STRUCT *stat,
@@ -1914,73 +348,41 @@ int ds_do_dvs_aidvs(unsigned int *target_cpu_op_index,
 					unsigned long speedup_threshold, 
 					unsigned long speedup_interval)
 {
-	unsigned long lc_time_usec_interval_inc = 0;
-	unsigned long lc_time_usec_work_fse_inc = 0;
-	unsigned long lc_time_usec_work_fse_in_window = 0;
-	unsigned long lc_time_usec_interval_in_window = 0;
-	unsigned long lc_time_usec_since_last_util_calc = 0;
-
-	unsigned long lc_utilization_int_ulong_old_by_weight = 0;
-	unsigned long lc_utilization_fra_fp12_old_by_weight = 0;
-	unsigned long lc_numerator_int_ulong = 0;
-	unsigned long lc_numerator_fra_fp12 = 0;
-	unsigned long lc_moving_avg_int_ulong = 0;
-	unsigned long lc_moving_avg_fra_fp12 = 0;
-
-	/* (1) Update stat->time_usec_interval, 
-			stat->time_usec_work_fse,
-			stat->time_usec_work_fse_lasting, OR
-			stat->time_usec_work,
-			stat->time_usec_work_lasting.
+	u64 lc_time_ns_work_fse_inc = 0;
+	unsigned long lc_utilization_fp12 = 0;
+	unsigned long lc_moving_avg_fp12 = 0;
+
+	/* (1) Update stat->time_ns_interval, 
+			stat->time_ns_work_fse, and
+			stat->time_ns_work_fse_lasting.
 	 */
 	if(stat->base_initialized == 0 ||
-		(stat->base_initialized != 0 &&
-		ds_counter.elapsed_sec > stat->time_sec_interval_inc_base + 1))
+		ds_counter.elapsed_ns - stat->time_ns_interval_inc_base > DS_AIDVS_REBASE_TIMEOUT)
 	{
-		stat->time_usec_util_calc_base = ds_counter.elapsed_usec;
-		stat->time_usec_interval_inc_base = ds_counter.elapsed_usec;
-		stat->time_sec_interval_inc_base = ds_counter.elapsed_sec;
-		stat->time_usec_work_fse_inc_base = ds_counter.busy_fse_usec;
+		stat->time_ns_util_calc_base = ds_counter.elapsed_ns;
+		stat->time_ns_interval_inc_base = ds_counter.elapsed_ns;
+		stat->time_ns_work_fse_inc_base = ds_counter.busy_fse_ns;
 		stat->cpu_op_index = DS_CPU_OP_INDEX_MAX;
 		stat->base_initialized = 1;
 	}
 
-	/* This calaculation assumes that the interval
-	   between any consecutive context switches is shorter than 1 sec.
-	 */
-	if(ds_counter.elapsed_usec >= stat->time_usec_interval_inc_base){
-		lc_time_usec_interval_inc =
-			ds_counter.elapsed_usec - stat->time_usec_interval_inc_base;
-	}
-	else{
-		lc_time_usec_interval_inc =
-			ds_counter.elapsed_usec + (1000000 - stat->time_usec_interval_inc_base);
-	}
-	stat->time_usec_interval += lc_time_usec_interval_inc;
-	stat->time_usec_interval_inc_base = ds_counter.elapsed_usec;
-	stat->time_sec_interval_inc_base = ds_counter.elapsed_sec;
+	stat->time_ns_interval += ds_counter.elapsed_ns - stat->time_ns_interval_inc_base;
+	stat->time_ns_interval_inc_base = ds_counter.elapsed_ns;
 
 	if(stat->flag_in_busy_half == 1){
-		if(ds_counter.busy_fse_usec >= stat->time_usec_work_fse_inc_base){
-			lc_time_usec_work_fse_inc =
-				ds_counter.busy_fse_usec - stat->time_usec_work_fse_inc_base;
-		}
-		else{
-			lc_time_usec_work_fse_inc =
-				ds_counter.busy_fse_usec + (1000000 - stat->time_usec_work_fse_inc_base);
-		}
-		stat->time_usec_work_fse += lc_time_usec_work_fse_inc;
-		stat->time_usec_work_fse_lasting += lc_time_usec_work_fse_inc;
-		stat->time_usec_work_fse_inc_base = ds_counter.busy_fse_usec;
+		lc_time_ns_work_fse_inc = ds_counter.busy_fse_ns - stat->time_ns_work_fse_inc_base;
+		stat->time_ns_work_fse += lc_time_ns_work_fse_inc;
+		stat->time_ns_work_fse_lasting += lc_time_ns_work_fse_inc;
+		stat->time_ns_work_fse_inc_base = ds_counter.busy_fse_ns;
 	}
 
 	/* (2) If a series of workload lasts over speedup_threshold,
 			update CPU_OP to cope with this workload burst.
 	 */
 	if((stat->consecutive_speedup_count == 0 &&
-		stat->time_usec_work_fse_lasting >= speedup_threshold) ||
+		stat->time_ns_work_fse_lasting >= speedup_threshold) ||
 		(stat->consecutive_speedup_count > 0 &&
-		stat->time_usec_work_fse_lasting >= speedup_interval))
+		stat->time_ns_work_fse_lasting >= speedup_interval))
 	{
 		/* Rampup stat->cpu_op_index by one available level */
 		switch(stat->cpu_op_index){
@@ -2006,7 +408,7 @@ int ds_do_dvs_aidvs(unsigned int *target_cpu_op_index,
 		}
 
 		/* After the speedup, initialize followings */
-		stat->time_usec_work_fse_lasting = 0;
+		stat->time_ns_work_fse_lasting = 0;
 		stat->consecutive_speedup_count ++;
 	}
 
@@ -2021,140 +423,54 @@ int ds_do_dvs_aidvs(unsigned int *target_cpu_op_index,
 			ds_parameter.prev_p->pid == 0) &&
 			ds_parameter.next_p->static_prio <= target_static_prio)
 		{
-
-			/* Until all the stat->interval_window_array[] is filled, 
-				this calculation is based on the less number of intervals 
-				than interval_window_size.
-				The following code automatically discards the oldest interval's
-				time_usec_interval and time_usec_work_fse OR time_usec_work 
-				to keep the number of intervals that are used for 
-				the calculation interval_window_size.
-			 */
-#if 0	// MOVING WINDOW
-			if(stat->time_usec_interval_in_window < 
-				stat->interval_window_array[stat->interval_window_index].time_usec_interval)
-				stat->time_usec_interval_in_window = 0;
-			else
-				stat->time_usec_interval_in_window -=
-					stat->interval_window_array[stat->interval_window_index].time_usec_interval;
-
-			if(stat->time_usec_work_fse_in_window < 
-				stat->interval_window_array[stat->interval_window_index].time_usec_work_fse)
-				stat->time_usec_work_fse_in_window = 0;
-			else
-				stat->time_usec_work_fse_in_window -=
-					stat->interval_window_array[stat->interval_window_index].time_usec_work_fse;
-
-			stat->interval_window_array[stat->interval_window_index].time_usec_interval = 
-				stat->time_usec_interval;
-			stat->interval_window_array[stat->interval_window_index].time_usec_work_fse = 
-				stat->time_usec_work_fse;
-
-			stat->time_usec_interval_in_window +=
-				stat->interval_window_array[stat->interval_window_index].time_usec_interval;
-			stat->time_usec_work_fse_in_window +=
-				stat->interval_window_array[stat->interval_window_index].time_usec_work_fse;
-#endif
-
-			stat->time_usec_interval_in_window += stat->time_usec_interval;
-			stat->time_usec_work_fse_in_window += stat->time_usec_work_fse;
-
-			if(stat->time_usec_interval_in_window > 1000000){
-				lc_time_usec_interval_in_window = stat->time_usec_interval_in_window / 1000;
-				lc_time_usec_work_fse_in_window = stat->time_usec_work_fse_in_window / 1000;
-			}
-			else{
-				lc_time_usec_interval_in_window = stat->time_usec_interval_in_window;
-				lc_time_usec_work_fse_in_window = stat->time_usec_work_fse_in_window;
-			}
-
-#if 0	// MOVING WINDOW
-			if(stat->interval_window_index == interval_window_size - 1)
-				stat->interval_window_index = 0;
-			else
-				stat->interval_window_index ++;
-#endif
+			stat->time_ns_interval_in_window += stat->time_ns_interval;
+			stat->time_ns_work_fse_in_window += stat->time_ns_work_fse;
 
 			// DS_GPSCHEDVS_Lx_MIN_WINDOW_LENGTH
-			if(ds_counter.elapsed_usec >= stat->time_usec_util_calc_base){
-				lc_time_usec_since_last_util_calc =
-					ds_counter.elapsed_usec - stat->time_usec_util_calc_base;
-			}
-			else{
-				lc_time_usec_since_last_util_calc =
-					ds_counter.elapsed_usec + (1000000 - stat->time_usec_util_calc_base);
-			}
+			if(ds_counter.elapsed_ns - stat->time_ns_util_calc_base >= interval_window_length){
 
-			if(lc_time_usec_since_last_util_calc >= interval_window_length){
-
-				/* Calculate OLD x 3 */
-				ds_fpmul(stat->utilization_int_ulong, 
-						stat->utilization_fra_fp12, 
-						DS_AIDVS_MOVING_AVG_WEIGHT, 
-						0x0,
-						&lc_utilization_int_ulong_old_by_weight, 
-						&lc_utilization_fra_fp12_old_by_weight);
-	
-				/* Calculate NEW, i.e., the current interval window's utilization */
-				if(lc_time_usec_interval_in_window == 0){
-					stat->utilization_int_ulong = 1;
-					stat->utilization_fra_fp12 = 0;
+				/* Calculate NEW, i.e., the current interval window's utilization.
+					OLD is the previous window's NEW. */
+				if(stat->time_ns_interval_in_window == 0){
+					lc_utilization_fp12 = DS_ULONG2FP12(1);
 				}
 				else{
-					if(ds_fpdiv(lc_time_usec_work_fse_in_window,
-								0,
-								lc_time_usec_interval_in_window,
-								0,
-								&stat->utilization_int_ulong,
-								&stat->utilization_fra_fp12) < 0){
-						printk(KERN_INFO "[ds_do_dvs_aidvs] Error: ds_fpdiv failed. \
-										 Current DVS scheme is disabled.\n");
-						ds_configuration.on_dvs = 0;
-						return(-1);
-					}
-				}
-
-				/* Calculate OLD x 3 + NEW, i.e., the numerator of moving average */
-				lc_numerator_int_ulong = 
-					lc_utilization_int_ulong_old_by_weight + stat->utilization_int_ulong;
-				lc_numerator_fra_fp12 = 
-					lc_utilization_fra_fp12_old_by_weight + stat->utilization_fra_fp12;
-				if(lc_numerator_fra_fp12 >= 0x1000){
-					lc_numerator_int_ulong += 1;
-					lc_numerator_fra_fp12 -= 0x1000;
+					lc_utilization_fp12 = (unsigned long)div64_u64(
+						stat->time_ns_work_fse_in_window << 12,
+						stat->time_ns_interval_in_window);
 				}
 
 				/* Calculate (OLD x 3 + NEW) / 4, i.e., the moving average */
-				ds_fpdiv(lc_numerator_int_ulong, lc_numerator_fra_fp12, 
-						DS_AIDVS_MOVING_AVG_WEIGHT+1, 0,
-						&lc_moving_avg_int_ulong, &lc_moving_avg_fra_fp12);
+				lc_moving_avg_fp12 =
+					(stat->utilization_fp12 * DS_AIDVS_MOVING_AVG_WEIGHT + lc_utilization_fp12) /
+					(DS_AIDVS_MOVING_AVG_WEIGHT + 1);
+				stat->utilization_fp12 = lc_utilization_fp12;
 
 				/* Find the CPU_OP_INDEX corresponding to the calculated utilization */
 				stat->cpu_op_index = 
-					ds_get_next_high_cpu_op_index(lc_moving_avg_int_ulong, lc_moving_avg_fra_fp12);
+					ds_get_next_high_cpu_op_index(DS_GETFP12INT(lc_moving_avg_fp12),
+												  DS_GETFP12FRA(lc_moving_avg_fp12));
 
-				stat->time_usec_interval_in_window = 0;
-				stat->time_usec_work_fse_in_window = 0;
-				stat->interval_window_index = 0;
-				stat->time_usec_util_calc_base = ds_counter.elapsed_usec;
+				trace_lg_dvfs_aidvs(target_static_prio, lc_utilization_fp12,
+									lc_moving_avg_fp12, stat->cpu_op_index);
+
+				stat->time_ns_interval_in_window = 0;
+				stat->time_ns_work_fse_in_window = 0;
+				stat->time_ns_util_calc_base = ds_counter.elapsed_ns;
 			}
 
 			/* Upon every new arrival of a busy half, initialize followings.
 			 */
-			stat->time_usec_work_fse = 0;
-			stat->time_usec_interval = 0;
+			stat->time_ns_work_fse = 0;
+			stat->time_ns_interval = 0;
 
 			/* As GPScheDVS uses a multiple number of AIDVS each of them sees
 				a particular priority range of tasks, we have to initialize
-				time_usec_work_fse_inc_base OR time_usec_work_inc 
-				at every beginning of a new interval.
+				time_ns_work_fse_inc_base at every beginning of a new interval.
 				Otherwise, all the tasks executed during this particular AIDVS's
 				idle half (i.e., not the busy half) will be added into
-				stat->interval_window_array[stat->interval_window_index].time_usec_work_fse
-				and then stat->time_usec_work_fse_in_window OR
-				stat->interval_window_array[stat->interval_window_index].time_usec_work
-				and then stat->time_usec_work_in_window. */
-			stat->time_usec_work_fse_inc_base = ds_counter.busy_fse_usec;
+				stat->time_ns_work_fse and then stat->time_ns_work_fse_in_window. */
+			stat->time_ns_work_fse_inc_base = ds_counter.busy_fse_ns;
 
 			/* Upon the end of an interval, set flag_in_busy_half for the next interval. */
 			stat->flag_in_busy_half = 1;
@@ -2165,7 +481,7 @@ int ds_do_dvs_aidvs(unsigned int *target_cpu_op_index,
 				(ds_parameter.next_p->static_prio > target_static_prio || 
 				ds_parameter.next_p->pid == 0))
 		{
-			stat->time_usec_work_fse_lasting = 0;
+			stat->time_ns_work_fse_lasting = 0;
 			stat->consecutive_speedup_count = 0;
 			stat->flag_in_busy_half = 0;
 		}
@@ -2193,7 +509,7 @@ int ds_do_dvs_gpschedvs(unsigned int *target_cpu_op_index){
 
 	if(ds_status.flag_do_post_early_suspend == 0){
 
-		//if(ds_status.touch_timeout_sec == 0){
+		//if(ds_status.touch_timeout_ns == 0){
 #if 0
 		/* AIDVS for HRT tasks */
 		if(ds_do_dvs_aidvs(&lc_target_cpu_op_index_highest,
@@ -2280,106 +596,54 @@ int ds_do_dvs_gpschedvs(unsigned int *target_cpu_op_index){
 			Once we got an touch interrupt, we apply 
 			a high CPU frequency for a while.
 		 */
-		if(ds_status.touch_timeout_sec != 0){
+		if(ds_status.touch_timeout_ns != 0){
 
 			/* If DS_TOUCH_TIMEOUT is over */
-			if(ds_counter.elapsed_sec > ds_status.touch_timeout_sec ||
-				(ds_counter.elapsed_sec == ds_status.touch_timeout_sec &&
-				ds_counter.elapsed_usec > ds_status.touch_timeout_usec))
+			if(ds_counter.elapsed_ns > ds_status.touch_timeout_ns)
 			{
 				switch(ds_status.flag_touch_timeout_count){
 					case DS_TOUCH_TIMEOUT_COUNT_MAX:	// 7
-						if(ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT < 1000000){
-							ds_status.touch_timeout_sec = ds_counter.elapsed_sec;
-							ds_status.touch_timeout_usec = ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT;
-						}
-						else{
-							ds_status.touch_timeout_sec = ds_counter.elapsed_sec + 1;
-							ds_status.touch_timeout_usec = 
-								(ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT) - 1000000;
-						}
+						ds_status.touch_timeout_ns = ds_counter.elapsed_ns + DS_TOUCH_TIMEOUT;
 						ds_status.flag_touch_timeout_count = 6;
 						lc_target_cpu_op_index_touch = DS_CPU_OP_INDEX_MAX;
 						//lc_target_cpu_op_index_touch = DS_CPU_OP_INDEX_1;
 						break;
 					case 6:
-						if(ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT < 1000000){
-							ds_status.touch_timeout_sec = ds_counter.elapsed_sec;
-							ds_status.touch_timeout_usec = ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT;
-						}
-						else{
-							ds_status.touch_timeout_sec = ds_counter.elapsed_sec + 1;
-							ds_status.touch_timeout_usec = 
-								(ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT) - 1000000;
-						}
+						ds_status.touch_timeout_ns = ds_counter.elapsed_ns + DS_TOUCH_TIMEOUT;
 						ds_status.flag_touch_timeout_count = 5;
 						lc_target_cpu_op_index_touch = DS_CPU_OP_INDEX_MAX;
 						//lc_target_cpu_op_index_touch = DS_CPU_OP_INDEX_1;
 						break;
 					case 5:
-						if(ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT < 1000000){
-							ds_status.touch_timeout_sec = ds_counter.elapsed_sec;
-							ds_status.touch_timeout_usec = ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT;
-						}
-						else{
-							ds_status.touch_timeout_sec = ds_counter.elapsed_sec + 1;
-							ds_status.touch_timeout_usec = 
-								(ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT) - 1000000;
-						}
+						ds_status.touch_timeout_ns = ds_counter.elapsed_ns + DS_TOUCH_TIMEOUT;
 						ds_status.flag_touch_timeout_count = 4;
 						lc_target_cpu_op_index_touch = DS_CPU_OP_INDEX_1;
 						//lc_target_cpu_op_index_touch = DS_CPU_OP_INDEX_2;
 						break;
 					case 4:
-						if(ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT < 1000000){
-							ds_status.touch_timeout_sec = ds_counter.elapsed_sec;
-							ds_status.touch_timeout_usec = ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT;
-						}
-						else{
-							ds_status.touch_timeout_sec = ds_counter.elapsed_sec + 1;
-							ds_status.touch_timeout_usec = 
-								(ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT) - 1000000;
-						}
+						ds_status.touch_timeout_ns = ds_counter.elapsed_ns + DS_TOUCH_TIMEOUT;
 						ds_status.flag_touch_timeout_count = 3;
 						lc_target_cpu_op_index_touch = DS_CPU_OP_INDEX_1;
 						//lc_target_cpu_op_index_touch = DS_CPU_OP_INDEX_2;
 						break;
 					case 3:
-						if(ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT < 1000000){
-							ds_status.touch_timeout_sec = ds_counter.elapsed_sec;
-							ds_status.touch_timeout_usec = ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT;
-						}
-						else{
-							ds_status.touch_timeout_sec = ds_counter.elapsed_sec + 1;
-							ds_status.touch_timeout_usec = 
-								(ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT) - 1000000;
-						}
+						ds_status.touch_timeout_ns = ds_counter.elapsed_ns + DS_TOUCH_TIMEOUT;
 						ds_status.flag_touch_timeout_count = 2;
 						lc_target_cpu_op_index_touch = DS_CPU_OP_INDEX_2;
 						break;
 					case 2:
-						if(ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT < 1000000){
-							ds_status.touch_timeout_sec = ds_counter.elapsed_sec;
-							ds_status.touch_timeout_usec = ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT;
-						}
-						else{
-							ds_status.touch_timeout_sec = ds_counter.elapsed_sec + 1;
-							ds_status.touch_timeout_usec = 
-								(ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT) - 1000000;
-						}
+						ds_status.touch_timeout_ns = ds_counter.elapsed_ns + DS_TOUCH_TIMEOUT;
 						ds_status.flag_touch_timeout_count = 1;
 						lc_target_cpu_op_index_touch = DS_CPU_OP_INDEX_2;
 						//lc_target_cpu_op_index_touch = DS_CPU_OP_INDEX_MIN;
 						break;
 					case 1:
-						ds_status.touch_timeout_sec = 0;
-						ds_status.touch_timeout_usec = 0;
+						ds_status.touch_timeout_ns = 0;
 						ds_status.flag_touch_timeout_count = 0;
 						lc_target_cpu_op_index_touch = DS_CPU_OP_INDEX_MIN;
 						break;
 					default:
-						ds_status.touch_timeout_sec = 0;
-						ds_status.touch_timeout_usec = 0;
+						ds_status.touch_timeout_ns = 0;
 						ds_status.flag_touch_timeout_count = 0;
 						lc_target_cpu_op_index_touch = DS_CPU_OP_INDEX_MIN;
 						break;
@@ -2452,7 +716,6 @@ int ds_do_dvs_gpschedvs(unsigned int *target_cpu_op_index){
  */
 int ds_initialize_dvs_suite(int cpu_mode){
 
-	int i;
 	unsigned int lc_current_cpu_op_index;
 
 	ds_status.flag_run_dvs = 0;
@@ -2475,31 +738,17 @@ int ds_initialize_dvs_suite(int cpu_mode){
 	/* Initialize ds_status's fields */
 	ds_status.flag_update_cpu_op = 0;
 	ds_status.target_cpu_op_index = DS_CPU_OP_INDEX_MAX;
-	ds_status.cpu_op_last_update_sec = 0;
-	ds_status.cpu_op_last_update_usec = 0;
+	ds_status.cpu_op_last_update_ns = 0;
 	ds_status.current_dvs_scheme = 0;
-	for(i=0;i<DS_PID_LIMIT;i++){
-		ds_status.scheduler[i] = 0;
-		ds_status.type[i] = 0;
-		ds_status.type_fixed[i] = 0;
-		ds_status.type_need_to_be_changed[i] = 0;
-		ds_status.tgid[i] = 0;
-		ds_status.tgid_type_changed[i] = 0;
-		ds_status.tgid_type_change_causer[i] = 0;
-		ds_status.ipc_timeout_sec[i] = 0;
-		ds_status.ipc_timeout_usec[i] = 0;
-	}
 	ds_status.flag_touch_timeout_count = 0;
-	ds_status.touch_timeout_sec = 0;
-	ds_status.touch_timeout_usec = 0;
+	ds_status.touch_timeout_ns = 0;
 
 	ds_status.flag_mutex_lock_on_clock_state = 0;
 	ds_status.mutex_lock_on_clock_state_cnt = 0;
 	ds_status.flag_correct_cpu_op_update_path = 0;
 
 	ds_status.flag_post_early_suspend = 0;
-	ds_status.post_early_suspend_sec = 0;
-	ds_status.post_early_suspend_usec = 0;
+	ds_status.post_early_suspend_ns = 0;
 	ds_status.flag_do_post_early_suspend = 0;
 
 	ds_status.mpu_min_freq_to_lock = 0;
@@ -2507,8 +756,7 @@ int ds_initialize_dvs_suite(int cpu_mode){
 	ds_status.iva_min_freq_to_lock = 0;
 
 	/* Initialize ds_counter's fields */
-	ds_counter.elapsed_sec = 0;
-	ds_counter.elapsed_usec = 0;
+	ds_counter.elapsed_ns = 0;
 #if 0	// Not needed unless we want statistics.
 	for(i=0;i<DS_CPU_OP_LIMIT;i++){
 		ds_counter.idle_sec[i] = 0;
@@ -2527,11 +775,12 @@ int ds_initialize_dvs_suite(int cpu_mode){
 	ds_counter.idle_total_sec = 0;
 	ds_counter.idle_total_usec = 0;
 #endif
-	ds_counter.busy_total_sec = 0;
-	ds_counter.busy_total_usec = 0;
-	ds_counter.busy_fse_sec = 0;
-	ds_counter.busy_fse_usec = 0;
-	ds_counter.busy_fse_usec_fra_fp12 = 0;
+	ds_counter.busy_total_ns = 0;
+	ds_counter.busy_fse_ns = 0;
+#ifdef CONFIG_LG_DVFS_HOOK_STATS
+	ds_counter.hook_calls = 0;
+	ds_counter.hook_ns = 0;
+#endif
 #if 0	// Not needed unless we want statistics.
 	ds_counter.busy_task_total_sec = 0;
 	ds_counter.busy_task_total_usec = 0;
@@ -2587,116 +836,64 @@ int ds_initialize_dvs_suite(int cpu_mode){
 	ds_gpschedvs_status.aidvs_l3_status.base_initialized = 0;
 	ds_gpschedvs_status.aidvs_l3_status.flag_in_busy_half = 0;
 
-	ds_gpschedvs_status.aidvs_l3_status.time_usec_interval = 0;
-	ds_gpschedvs_status.aidvs_l3_status.time_usec_interval_inc_base = 0;
-	ds_gpschedvs_status.aidvs_l3_status.time_sec_interval_inc_base = 0;
-	ds_gpschedvs_status.aidvs_l3_status.time_usec_work_fse = 0;
-	ds_gpschedvs_status.aidvs_l3_status.time_usec_work_fse_inc_base = 0;
-	ds_gpschedvs_status.aidvs_l3_status.time_usec_work_fse_lasting = 0;
-	ds_gpschedvs_status.aidvs_l3_status.time_usec_work = 0;
-	ds_gpschedvs_status.aidvs_l3_status.time_usec_work_inc_base = 0;
-	ds_gpschedvs_status.aidvs_l3_status.time_usec_work_lasting = 0;
-	for(i=0;i<DS_GPSCHEDVS_L3_INTERVALS_IN_AN_WINDOW;i++){
-		ds_gpschedvs_status.aidvs_l3_status.interval_window_array[i].time_usec_interval = 0;
-		ds_gpschedvs_status.aidvs_l3_status.interval_window_array[i].time_usec_work_fse = 0;
-		ds_gpschedvs_status.aidvs_l3_status.interval_window_array[i].time_usec_work = 0;
-	}
-	ds_gpschedvs_status.aidvs_l3_status.interval_window_index = 0;
-	ds_gpschedvs_status.aidvs_l3_status.time_usec_interval_in_window = 0;
-	ds_gpschedvs_status.aidvs_l3_status.time_usec_work_fse_in_window = 0;
-	ds_gpschedvs_status.aidvs_l3_status.time_usec_work_in_window = 0;
+	ds_gpschedvs_status.aidvs_l3_status.time_ns_interval = 0;
+	ds_gpschedvs_status.aidvs_l3_status.time_ns_interval_inc_base = 0;
+	ds_gpschedvs_status.aidvs_l3_status.time_ns_work_fse = 0;
+	ds_gpschedvs_status.aidvs_l3_status.time_ns_work_fse_inc_base = 0;
+	ds_gpschedvs_status.aidvs_l3_status.time_ns_work_fse_lasting = 0;
+	ds_gpschedvs_status.aidvs_l3_status.time_ns_interval_in_window = 0;
+	ds_gpschedvs_status.aidvs_l3_status.time_ns_work_fse_in_window = 0;
 	ds_gpschedvs_status.aidvs_l3_status.consecutive_speedup_count = 0;
-	ds_gpschedvs_status.aidvs_l3_status.utilization_int_ulong = 1;	/* Begin with the max. perf. */
-	ds_gpschedvs_status.aidvs_l3_status.utilization_fra_fp12 = 0;
-	ds_gpschedvs_status.aidvs_l3_status.time_usec_util_calc_base = 0;
-	ds_gpschedvs_status.aidvs_l3_status.time_sec_util_calc_base = 0;
+	ds_gpschedvs_status.aidvs_l3_status.utilization_fp12 = DS_ULONG2FP12(1);	/* Begin with the max. perf. */
+	ds_gpschedvs_status.aidvs_l3_status.time_ns_util_calc_base = 0;
 	ds_gpschedvs_status.aidvs_l3_status.cpu_op_index = DS_CPU_OP_INDEX_0;
 
 	// aidvs_l2_status
 	ds_gpschedvs_status.aidvs_l2_status.base_initialized = 0;
 	ds_gpschedvs_status.aidvs_l2_status.flag_in_busy_half = 0;
 
-	ds_gpschedvs_status.aidvs_l2_status.time_usec_interval = 0;
-	ds_gpschedvs_status.aidvs_l2_status.time_usec_interval_inc_base = 0;
-	ds_gpschedvs_status.aidvs_l2_status.time_sec_interval_inc_base = 0;
-	ds_gpschedvs_status.aidvs_l2_status.time_usec_work_fse = 0;
-	ds_gpschedvs_status.aidvs_l2_status.time_usec_work_fse_inc_base = 0;
-	ds_gpschedvs_status.aidvs_l2_status.time_usec_work_fse_lasting = 0;
-	ds_gpschedvs_status.aidvs_l2_status.time_usec_work = 0;
-	ds_gpschedvs_status.aidvs_l2_status.time_usec_work_inc_base = 0;
-	ds_gpschedvs_status.aidvs_l2_status.time_usec_work_lasting = 0;
-	for(i=0;i<DS_GPSCHEDVS_L3_INTERVALS_IN_AN_WINDOW;i++){
-		ds_gpschedvs_status.aidvs_l2_status.interval_window_array[i].time_usec_interval = 0;
-		ds_gpschedvs_status.aidvs_l2_status.interval_window_array[i].time_usec_work_fse = 0;
-		ds_gpschedvs_status.aidvs_l2_status.interval_window_array[i].time_usec_work = 0;
-	}
-	ds_gpschedvs_status.aidvs_l2_status.interval_window_index = 0;
-	ds_gpschedvs_status.aidvs_l2_status.time_usec_interval_in_window = 0;
-	ds_gpschedvs_status.aidvs_l2_status.time_usec_work_fse_in_window = 0;
-	ds_gpschedvs_status.aidvs_l2_status.time_usec_work_in_window = 0;
+	ds_gpschedvs_status.aidvs_l2_status.time_ns_interval = 0;
+	ds_gpschedvs_status.aidvs_l2_status.time_ns_interval_inc_base = 0;
+	ds_gpschedvs_status.aidvs_l2_status.time_ns_work_fse = 0;
+	ds_gpschedvs_status.aidvs_l2_status.time_ns_work_fse_inc_base = 0;
+	ds_gpschedvs_status.aidvs_l2_status.time_ns_work_fse_lasting = 0;
+	ds_gpschedvs_status.aidvs_l2_status.time_ns_interval_in_window = 0;
+	ds_gpschedvs_status.aidvs_l2_status.time_ns_work_fse_in_window = 0;
 	ds_gpschedvs_status.aidvs_l2_status.consecutive_speedup_count = 0;
-	ds_gpschedvs_status.aidvs_l2_status.utilization_int_ulong = 1;	/* Begin with the max. perf. */
-	ds_gpschedvs_status.aidvs_l2_status.utilization_fra_fp12 = 0;
-	ds_gpschedvs_status.aidvs_l2_status.time_usec_util_calc_base = 0;
-	ds_gpschedvs_status.aidvs_l2_status.time_sec_util_calc_base = 0;
+	ds_gpschedvs_status.aidvs_l2_status.utilization_fp12 = DS_ULONG2FP12(1);	/* Begin with the max. perf. */
+	ds_gpschedvs_status.aidvs_l2_status.time_ns_util_calc_base = 0;
 	ds_gpschedvs_status.aidvs_l2_status.cpu_op_index = DS_CPU_OP_INDEX_0;
 
 	// aidvs_l1_status
 	ds_gpschedvs_status.aidvs_l1_status.base_initialized = 0;
 	ds_gpschedvs_status.aidvs_l1_status.flag_in_busy_half = 0;
 
-	ds_gpschedvs_status.aidvs_l1_status.time_usec_interval = 0;
-	ds_gpschedvs_status.aidvs_l1_status.time_usec_interval_inc_base = 0;
-	ds_gpschedvs_status.aidvs_l1_status.time_sec_interval_inc_base = 0;
-	ds_gpschedvs_status.aidvs_l1_status.time_usec_work_fse = 0;
-	ds_gpschedvs_status.aidvs_l1_status.time_usec_work_fse_inc_base = 0;
-	ds_gpschedvs_status.aidvs_l1_status.time_usec_work_fse_lasting = 0;
-	ds_gpschedvs_status.aidvs_l1_status.time_usec_work = 0;
-	ds_gpschedvs_status.aidvs_l1_status.time_usec_work_inc_base = 0;
-	ds_gpschedvs_status.aidvs_l1_status.time_usec_work_lasting = 0;
-	for(i=0;i<DS_GPSCHEDVS_L3_INTERVALS_IN_AN_WINDOW;i++){
-		ds_gpschedvs_status.aidvs_l1_status.interval_window_array[i].time_usec_interval = 0;
-		ds_gpschedvs_status.aidvs_l1_status.interval_window_array[i].time_usec_work_fse = 0;
-		ds_gpschedvs_status.aidvs_l1_status.interval_window_array[i].time_usec_work = 0;
-	}
-	ds_gpschedvs_status.aidvs_l1_status.interval_window_index = 0;
-	ds_gpschedvs_status.aidvs_l1_status.time_usec_interval_in_window = 0;
-	ds_gpschedvs_status.aidvs_l1_status.time_usec_work_fse_in_window = 0;
-	ds_gpschedvs_status.aidvs_l1_status.time_usec_work_in_window = 0;
+	ds_gpschedvs_status.aidvs_l1_status.time_ns_interval = 0;
+	ds_gpschedvs_status.aidvs_l1_status.time_ns_interval_inc_base = 0;
+	ds_gpschedvs_status.aidvs_l1_status.time_ns_work_fse = 0;
+	ds_gpschedvs_status.aidvs_l1_status.time_ns_work_fse_inc_base = 0;
+	ds_gpschedvs_status.aidvs_l1_status.time_ns_work_fse_lasting = 0;
+	ds_gpschedvs_status.aidvs_l1_status.time_ns_interval_in_window = 0;
+	ds_gpschedvs_status.aidvs_l1_status.time_ns_work_fse_in_window = 0;
 	ds_gpschedvs_status.aidvs_l1_status.consecutive_speedup_count = 0;
-	ds_gpschedvs_status.aidvs_l1_status.utilization_int_ulong = 1;	/* Begin with the max. perf. */
-	ds_gpschedvs_status.aidvs_l1_status.utilization_fra_fp12 = 0;
-	ds_gpschedvs_status.aidvs_l1_status.time_usec_util_calc_base = 0;
-	ds_gpschedvs_status.aidvs_l1_status.time_sec_util_calc_base = 0;
+	ds_gpschedvs_status.aidvs_l1_status.utilization_fp12 = DS_ULONG2FP12(1);	/* Begin with the max. perf. */
+	ds_gpschedvs_status.aidvs_l1_status.time_ns_util_calc_base = 0;
 	ds_gpschedvs_status.aidvs_l1_status.cpu_op_index = DS_CPU_OP_INDEX_0;
 
 	// aidvs_l0_status
 	ds_gpschedvs_status.aidvs_l0_status.base_initialized = 0;
 	ds_gpschedvs_status.aidvs_l0_status.flag_in_busy_half = 0;
 
-	ds_gpschedvs_status.aidvs_l0_status.time_usec_interval = 0;
-	ds_gpschedvs_status.aidvs_l0_status.time_usec_interval_inc_base = 0;
-	ds_gpschedvs_status.aidvs_l0_status.time_sec_interval_inc_base = 0;
-	ds_gpschedvs_status.aidvs_l0_status.time_usec_work_fse = 0;
-	ds_gpschedvs_status.aidvs_l0_status.time_usec_work_fse_inc_base = 0;
-	ds_gpschedvs_status.aidvs_l0_status.time_usec_work_fse_lasting = 0;
-	ds_gpschedvs_status.aidvs_l0_status.time_usec_work = 0;
-	ds_gpschedvs_status.aidvs_l0_status.time_usec_work_inc_base = 0;
-	ds_gpschedvs_status.aidvs_l0_status.time_usec_work_lasting = 0;
-	for(i=0;i<DS_GPSCHEDVS_L3_INTERVALS_IN_AN_WINDOW;i++){
-		ds_gpschedvs_status.aidvs_l0_status.interval_window_array[i].time_usec_interval = 0;
-		ds_gpschedvs_status.aidvs_l0_status.interval_window_array[i].time_usec_work_fse = 0;
-		ds_gpschedvs_status.aidvs_l0_status.interval_window_array[i].time_usec_work = 0;
-	}
-	ds_gpschedvs_status.aidvs_l0_status.interval_window_index = 0;
-	ds_gpschedvs_status.aidvs_l0_status.time_usec_interval_in_window = 0;
-	ds_gpschedvs_status.aidvs_l0_status.time_usec_work_fse_in_window = 0;
-	ds_gpschedvs_status.aidvs_l0_status.time_usec_work_in_window = 0;
+	ds_gpschedvs_status.aidvs_l0_status.time_ns_interval = 0;
+	ds_gpschedvs_status.aidvs_l0_status.time_ns_interval_inc_base = 0;
+	ds_gpschedvs_status.aidvs_l0_status.time_ns_work_fse = 0;
+	ds_gpschedvs_status.aidvs_l0_status.time_ns_work_fse_inc_base = 0;
+	ds_gpschedvs_status.aidvs_l0_status.time_ns_work_fse_lasting = 0;
+	ds_gpschedvs_status.aidvs_l0_status.time_ns_interval_in_window = 0;
+	ds_gpschedvs_status.aidvs_l0_status.time_ns_work_fse_in_window = 0;
 	ds_gpschedvs_status.aidvs_l0_status.consecutive_speedup_count = 0;
-	ds_gpschedvs_status.aidvs_l0_status.utilization_int_ulong = 1;	/* Begin with the max. perf. */
-	ds_gpschedvs_status.aidvs_l0_status.utilization_fra_fp12 = 0;
-	ds_gpschedvs_status.aidvs_l0_status.time_usec_util_calc_base = 0;
-	ds_gpschedvs_status.aidvs_l0_status.time_sec_util_calc_base = 0;
+	ds_gpschedvs_status.aidvs_l0_status.utilization_fp12 = DS_ULONG2FP12(1);	/* Begin with the max. perf. */
+	ds_gpschedvs_status.aidvs_l0_status.time_ns_util_calc_base = 0;
 	ds_gpschedvs_status.aidvs_l0_status.cpu_op_index = DS_CPU_OP_INDEX_0;
 
 	ds_status.ds_initialized = 1;
@@ -2718,13 +915,13 @@ int ds_update_priority_normal(struct task_struct *p){
 	int lc_resultant_nice = 0;
 	//int lc_resultant_static_prio = 0;
 
-	if(ds_status.type_need_to_be_changed[p->pid] == 0) return(0);
-
 	if(p == 0 || p->pid == 0) return(0);
 
+	if(p->ds.type_need_to_be_changed == 0) return(0);
+
 	lc_existing_nice = p->static_prio - 120;
 
-	switch(ds_status.type[p->pid]){
+	switch(p->ds.type){
 		case DS_HRT_TASK:
 			lc_nice_by_type = DS_HRT_NICE;
 			//lc_static_prio_by_type = DS_HRT_STATIC_PRIO;
@@ -2773,7 +970,7 @@ int ds_update_priority_normal(struct task_struct *p){
 	p->se.load.inv_weight = ds_prio_to_wmult[lc_resultant_nice+20];
 #endif
 
-	ds_status.type_need_to_be_changed[p->pid] = 0;
+	p->ds.type_need_to_be_changed = 0;
 
 	return(0);
 }
@@ -2788,41 +985,41 @@ int ds_update_priority_rt(struct task_struct *p){
 
 	struct sched_param lc_sched_param;
 
-	if(ds_status.type_need_to_be_changed[p->pid] == 0) return(0);
-
 	if(p == 0 || p->pid == 0) return(0);
 
-	switch(ds_status.type[p->pid]){
+	if(p->ds.type_need_to_be_changed == 0) return(0);
+
+	switch(p->ds.type){
 		case DS_HRT_TASK:
-			ds_status.scheduler[p->pid] = DS_SCHED_RR;
+			p->ds.scheduler = DS_SCHED_RR;
 			lc_sched_param.sched_priority = DS_HRT_RR_PRIO;
 			sched_setscheduler(p, SCHED_RR, &lc_sched_param);
 			break;
 		case DS_SRT_UI_SERVER_TASK:
-			ds_status.scheduler[p->pid] = DS_SCHED_RR;
+			p->ds.scheduler = DS_SCHED_RR;
 			lc_sched_param.sched_priority = DS_DBSRT_RR_PRIO;
 			sched_setscheduler(p, SCHED_RR, &lc_sched_param);
 			break;
 		case DS_SRT_UI_CLIENT_TASK:
-			//ds_status.scheduler[p->pid] = DS_SCHED_RR;
+			//p->ds.scheduler = DS_SCHED_RR;
 			//lc_sched_param.sched_priority = DS_DBSRT_RR_PRIO;
 			//sched_setscheduler(p, SCHED_RR, &lc_sched_param);
 			break;
 		case DS_SRT_KERNEL_THREAD:
 		case DS_SRT_DAEMON_TASK:
-			//ds_status.scheduler[p->pid] = DS_SCHED_NORMAL;
+			//p->ds.scheduler = DS_SCHED_NORMAL;
 			//lc_sched_param.sched_priority = 0;
 			//sched_setscheduler(p, SCHED_NORMAL, &lc_sched_param);
 			break;
 		case DS_NRT_TASK:
 		case 0:
-			//ds_status.scheduler[p->pid] = DS_SCHED_NORMAL;
+			//p->ds.scheduler = DS_SCHED_NORMAL;
 			//lc_sched_param.sched_priority = 0;
 			//sched_setscheduler(p, SCHED_NORMAL, &lc_sched_param);
 			break;
 	}
 
-	ds_status.type_need_to_be_changed[p->pid] = 0;
+	p->ds.type_need_to_be_changed = 0;
 
 	return(0);
 }
@@ -2834,7 +1031,6 @@ int ds_detect_task_type(void){
 
 	int old_type = 0;
 	int new_type = 0;
-	int i = 0;
 
 	struct sched_param lc_sched_param;
 
@@ -2842,12 +1038,11 @@ int ds_detect_task_type(void){
 
 		 For ds_parameter.next_p:
 
-		(1) Check if ds_status.type[ds_parameter.next_p->pid] is still its initial value.
+		(1) Check if ds_parameter.next_p->ds.type is still its initial value.
 			If it is, determine it.
 
 		(2) Check if the UI timeout of ds_parameter.next_p has been expired.
-			If so, reset ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] and
-			ds_status.ipc_timeout_usec[ds_parameter.next_p->pid].
+			If so, reset ds_parameter.next_p->ds.ipc_timeout_ns.
 			Then, re-determine the type of this task.
 	 */
 	if(ds_parameter.entry_type == DS_ENTRY_SWITCH_TO){
@@ -2864,54 +1059,44 @@ int ds_detect_task_type(void){
 
 			if(ds_parameter.next_p->pid != 0){
 
-				if(ds_parameter.next_p->pid == ds_parameter.next_p->tgid){
-					for(i=0;i<16;i++)
-						ds_status.tg_owner_comm[ds_parameter.next_p->pid][i] = 
-						*(ds_parameter.next_p->comm+i);
-				}
-
-				ds_status.tgid[ds_parameter.next_p->pid] = ds_parameter.next_p->tgid;
-
 				/* Get old type. */
-				old_type = ds_status.type[ds_parameter.next_p->pid];
+				old_type = ds_parameter.next_p->ds.type;
 				if(old_type == 0) old_type = DS_NRT_TASK;
 
 				/* C) Initialize and then determine new type. */
 				new_type = old_type;
 
-				switch(*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+0)){
+				switch(*(ds_parameter.next_p->group_leader->comm+0)){
 					case 'a':
 #if 0	// audio out. Audio related [daemon process].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'u' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == ' ' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'u' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 't'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'u' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == ' ' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'u' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 't'
 						)
 						{
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// adbd. ADB related [daemon process].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'b' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'd'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'b' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'd'
 						)
 						{
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -2921,53 +1106,50 @@ int ds_detect_task_type(void){
 					case 'b':
 #if 0	// binder. [kernel thread].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'n' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'r'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'n' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'r'
 						)
 						{
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 1	// btld. bluetooth reltated daemon-like [application].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'l' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'd'
+							*(ds_parameter.next_p->group_leader->comm+1) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'l' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'd'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 1	// bluetoothd. Bluetooth reltated [daemon process]. HRT.
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'l' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'u' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'h' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 'd'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'l' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'u' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'h' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == 'd'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -2977,98 +1159,94 @@ int ds_detect_task_type(void){
 					case 'c':
 #if 0	// com.lge.osp. LGE On-Screen Phone [application]. O 4 touch.
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'o' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'm' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == '.' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'l' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'g' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'e' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == '.' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'o' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 's' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'p'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'o' && 
+							*(ds_parameter.next_p->group_leader->comm+2) == 'm' && 
+							*(ds_parameter.next_p->group_leader->comm+3) == '.' && 
+							*(ds_parameter.next_p->group_leader->comm+4) == 'l' && 
+							*(ds_parameter.next_p->group_leader->comm+5) == 'g' && 
+							*(ds_parameter.next_p->group_leader->comm+6) == 'e' && 
+							*(ds_parameter.next_p->group_leader->comm+7) == '.' && 
+							*(ds_parameter.next_p->group_leader->comm+8) == 'o' && 
+							*(ds_parameter.next_p->group_leader->comm+9) == 's' && 
+							*(ds_parameter.next_p->group_leader->comm+10) == 'p'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else 
 #endif
 #if 0	// com.lge.media. [application].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'o' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'm' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == '.' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'l' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'g' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'e' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == '.' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'm' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 'e' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'a'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'o' && 
+							*(ds_parameter.next_p->group_leader->comm+2) == 'm' && 
+							*(ds_parameter.next_p->group_leader->comm+3) == '.' && 
+							*(ds_parameter.next_p->group_leader->comm+4) == 'l' && 
+							*(ds_parameter.next_p->group_leader->comm+5) == 'g' && 
+							*(ds_parameter.next_p->group_leader->comm+6) == 'e' && 
+							*(ds_parameter.next_p->group_leader->comm+7) == '.' && 
+							*(ds_parameter.next_p->group_leader->comm+8) == 'm' && 
+							*(ds_parameter.next_p->group_leader->comm+9) == 'e' && 
+							*(ds_parameter.next_p->group_leader->comm+10) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'a'
 						)
 						{
 							new_type = DS_SRT_UI_CLIENT_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else 
 #endif
 #if 0	// com.android.mms. [application].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'n' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 's'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'n' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 's'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// com.broadcom.bt.app.pbap. bluetooth. [application].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'b' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'p' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 'p' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'p' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'b' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 'p'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'b' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'p' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == 'p' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'p' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'b' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 'p'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3078,126 +1256,121 @@ int ds_detect_task_type(void){
 					case 'd':
 #if 0	// dbus-daemon. bluetooth related [daemon process].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'b' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'u' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 's' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == '-' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'd' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'a' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'e' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'm' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 'o' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'n'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'b' && 
+							*(ds_parameter.next_p->group_leader->comm+2) == 'u' && 
+							*(ds_parameter.next_p->group_leader->comm+3) == 's' && 
+							*(ds_parameter.next_p->group_leader->comm+4) == '-' && 
+							*(ds_parameter.next_p->group_leader->comm+5) == 'd' && 
+							*(ds_parameter.next_p->group_leader->comm+6) == 'a' && 
+							*(ds_parameter.next_p->group_leader->comm+7) == 'e' && 
+							*(ds_parameter.next_p->group_leader->comm+8) == 'm' && 
+							*(ds_parameter.next_p->group_leader->comm+9) == 'o' && 
+							*(ds_parameter.next_p->group_leader->comm+10) == 'n'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 1	// com.android.lgecamera. [application].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'r' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'o' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'i' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'd' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == '.' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'l' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'g' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'e' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 'c' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 'a'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'r' && 
+							*(ds_parameter.next_p->group_leader->comm+2) == 'o' && 
+							*(ds_parameter.next_p->group_leader->comm+3) == 'i' && 
+							*(ds_parameter.next_p->group_leader->comm+4) == 'd' && 
+							*(ds_parameter.next_p->group_leader->comm+5) == '.' && 
+							*(ds_parameter.next_p->group_leader->comm+6) == 'l' && 
+							*(ds_parameter.next_p->group_leader->comm+7) == 'g' && 
+							*(ds_parameter.next_p->group_leader->comm+8) == 'e' && 
+							*(ds_parameter.next_p->group_leader->comm+9) == 'c' && 
+							*(ds_parameter.next_p->group_leader->comm+10) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 'a'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// android.process.media. [application].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == '.' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'p' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'r' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'o' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'c' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'e' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 's' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 's' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == '.' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 'a'
+							*(ds_parameter.next_p->group_leader->comm+1) == '.' && 
+							*(ds_parameter.next_p->group_leader->comm+2) == 'p' && 
+							*(ds_parameter.next_p->group_leader->comm+3) == 'r' && 
+							*(ds_parameter.next_p->group_leader->comm+4) == 'o' && 
+							*(ds_parameter.next_p->group_leader->comm+5) == 'c' && 
+							*(ds_parameter.next_p->group_leader->comm+6) == 'e' && 
+							*(ds_parameter.next_p->group_leader->comm+7) == 's' && 
+							*(ds_parameter.next_p->group_leader->comm+8) == 's' && 
+							*(ds_parameter.next_p->group_leader->comm+9) == '.' && 
+							*(ds_parameter.next_p->group_leader->comm+10) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 'a'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// com.android.bluetooth. [application].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'r' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'o' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'i' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'd' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == '.' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'b' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'l' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'u' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 'e' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 'h'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'r' && 
+							*(ds_parameter.next_p->group_leader->comm+2) == 'o' && 
+							*(ds_parameter.next_p->group_leader->comm+3) == 'i' && 
+							*(ds_parameter.next_p->group_leader->comm+4) == 'd' && 
+							*(ds_parameter.next_p->group_leader->comm+5) == '.' && 
+							*(ds_parameter.next_p->group_leader->comm+6) == 'b' && 
+							*(ds_parameter.next_p->group_leader->comm+7) == 'l' && 
+							*(ds_parameter.next_p->group_leader->comm+8) == 'u' && 
+							*(ds_parameter.next_p->group_leader->comm+9) == 'e' && 
+							*(ds_parameter.next_p->group_leader->comm+10) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 'h'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// android.process.acore. Contact, home, and etc. [application].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == '.' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'p' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'r' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'o' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'c' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'e' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 's' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 's' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == '.' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'c' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 'e'
+							*(ds_parameter.next_p->group_leader->comm+1) == '.' && 
+							*(ds_parameter.next_p->group_leader->comm+2) == 'p' && 
+							*(ds_parameter.next_p->group_leader->comm+3) == 'r' && 
+							*(ds_parameter.next_p->group_leader->comm+4) == 'o' && 
+							*(ds_parameter.next_p->group_leader->comm+5) == 'c' && 
+							*(ds_parameter.next_p->group_leader->comm+6) == 'e' && 
+							*(ds_parameter.next_p->group_leader->comm+7) == 's' && 
+							*(ds_parameter.next_p->group_leader->comm+8) == 's' && 
+							*(ds_parameter.next_p->group_leader->comm+9) == '.' && 
+							*(ds_parameter.next_p->group_leader->comm+10) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'c' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 'e'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3207,44 +1380,42 @@ int ds_detect_task_type(void){
 					case 'e':
 #if 0	// events/0. [kernel thread].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'v' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'e' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'n' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 't' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == '/'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'v' && 
+							*(ds_parameter.next_p->group_leader->comm+2) == 'e' && 
+							*(ds_parameter.next_p->group_leader->comm+3) == 'n' && 
+							*(ds_parameter.next_p->group_leader->comm+4) == 't' && 
+							*(ds_parameter.next_p->group_leader->comm+5) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == '/'
 						)
 						{
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// com.google.process.gapps. [application]. Google services.
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == '.' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'p' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'r' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'o' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'c' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'e' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 's' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 's' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == '.' && 
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'g' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'p' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 'p' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 's'
+							*(ds_parameter.next_p->group_leader->comm+1) == '.' && 
+							*(ds_parameter.next_p->group_leader->comm+2) == 'p' && 
+							*(ds_parameter.next_p->group_leader->comm+3) == 'r' && 
+							*(ds_parameter.next_p->group_leader->comm+4) == 'o' && 
+							*(ds_parameter.next_p->group_leader->comm+5) == 'c' && 
+							*(ds_parameter.next_p->group_leader->comm+6) == 'e' && 
+							*(ds_parameter.next_p->group_leader->comm+7) == 's' && 
+							*(ds_parameter.next_p->group_leader->comm+8) == 's' && 
+							*(ds_parameter.next_p->group_leader->comm+9) == '.' && 
+							*(ds_parameter.next_p->group_leader->comm+10) == 'g' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'p' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 'p' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 's'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3254,20 +1425,19 @@ int ds_detect_task_type(void){
 					case 'f':
 #if 1	// fw3a_core. camera related [daemon process].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'w' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == '3' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == '_' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'c' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'e'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'w' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == '3' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == '_' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'c' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'e'
 						)
 						{
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3277,17 +1447,16 @@ int ds_detect_task_type(void){
 					case 'g':
 #if 0	// glgps. GPS server [daemon process]. < HRT.
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'l' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'g' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'p' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 's'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'l' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'g' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'p' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 's'
 						)
 						{
 							//new_type = DS_HRT_TASK;
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3301,22 +1470,21 @@ int ds_detect_task_type(void){
 					case 'j':
 #if 0	// jbd2/mmcblk0p*-. [kernel thread].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'b' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == '2' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == '/' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'c' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'b' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 'l' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'k'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'b' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == '2' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == '/' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'c' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'b' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == 'l' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 'k'
 						)
 						{
 							new_type = DS_HRT_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3326,56 +1494,53 @@ int ds_detect_task_type(void){
 					case 'k':
 #if 0	// ksoftirqd/0. [kernel thread].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'f' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'q' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'd'
+							*(ds_parameter.next_p->group_leader->comm+1) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'f' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'q' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'd'
 						)
 						{
 							new_type = DS_SRT_KERNEL_THREAD;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// kmmcd. [kernel thread].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'c' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'd'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'c' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'd'
 						)
 						{
 							new_type = DS_HRT_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// keystore. Key related [daemon process].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'y' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'e'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'y' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'e'
 						)
 						{
 							//new_type = DS_HRT_TASK;
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3387,143 +1552,137 @@ int ds_detect_task_type(void){
 					case 'm':
 #if 0	// mmcqd. [kernel thread].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'c' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'q' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'd'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'c' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'q' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'd'
 						)
 						{
 							new_type = DS_HRT_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 1	// mediaserver. Android system service [daemon process]. O 4 touch.
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'v' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'r'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'v' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 'r'
 						)
 						{
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// com.android.phone. [application].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'n' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'p' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'h' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 'n' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 'e'
+							*(ds_parameter.next_p->group_leader->comm+1) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'n' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 'p' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'h' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 'n' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 'e'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// com.android.music. [application].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'n' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'u' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 'c'
+							*(ds_parameter.next_p->group_leader->comm+1) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'n' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'u' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 'c'
 						)
 						{
 							//new_type = DS_SRT_DAEMON_TASK;
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// com.android.email. [application]. HRT.
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'n' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 'l'
+							*(ds_parameter.next_p->group_leader->comm+1) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'n' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 'l'
 						)
 						{
 							new_type = DS_HRT_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// com.broadcom.bt.app.system. bluetooth. [application].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'b' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'p' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'p' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'y' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 'm'
+							*(ds_parameter.next_p->group_leader->comm+1) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'b' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'p' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'p' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 'y' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 'm'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3533,67 +1692,64 @@ int ds_detect_task_type(void){
 					case 'n':
 #if 0	// netd. Network related [daemon process].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'd'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'd'
 						)
 						{
 							new_type = DS_HRT_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// com.android.systemui. [application].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'y' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 'u' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 'i'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'y' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 'u' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 'i'
 						)
 						{
 							new_type = DS_SRT_UI_CLIENT_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// com.android.settings. [application] X.
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'n' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 'g' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 's'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'n' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 'g' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 's'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3605,15 +1761,14 @@ int ds_detect_task_type(void){
 					case 'p':
 #if 0	// pvr_*. [kernel thread].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'v' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == '_'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'v' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == '_'
 						)
 						{
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3625,16 +1780,15 @@ int ds_detect_task_type(void){
 					case 'r':
 #if 0	// rild. RIL related [daemon process]. < HRT.
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'l' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'd'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'l' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'd'
 						)
 						{
 							//new_type = DS_HRT_TASK;
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3644,49 +1798,47 @@ int ds_detect_task_type(void){
 					case 's':
 #if 0	// servicemanager. Android system service [daemon process]
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'v' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'c' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 'n' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'g' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 'r'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'v' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'c' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == 'n' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'g' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 'r'
 						)
 						{
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// system_server. Android system service [application].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'y' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == '_' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'v' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'r'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'y' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == '_' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 'v' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'r'
 						)
 						{
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3698,18 +1850,17 @@ int ds_detect_task_type(void){
 					case 'u':
 #if 0	// ueventd. Polling server [daemon process].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'v' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'n' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'd'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'v' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'n' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'd'
 						)
 						{
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3719,15 +1870,14 @@ int ds_detect_task_type(void){
 					case 'v':
 #if 0	// vold. Volume (sdcard etc.) server [daemon process].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'l' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'd'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'l' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'd'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3737,25 +1887,24 @@ int ds_detect_task_type(void){
 					case 'w':
 #if 0	// wpa_supplicant. Wifi related [daemon process]. HRT.
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'p' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == '_' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'u' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'p' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'p' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'l' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'c' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'n' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 't'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'p' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == '_' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'u' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'p' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'p' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'l' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 'c' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'n' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 't'
 						)
 						{
 							new_type = DS_HRT_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3769,17 +1918,16 @@ int ds_detect_task_type(void){
 					case 'z':
 #if 0	// zygote. Android process spawning [daemon process].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'y' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'g' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'e'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'y' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'g' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'e'
 						)
 						{
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3793,17 +1941,16 @@ int ds_detect_task_type(void){
 					case 'C':
 #if 0	// Camera* threads of mediaserver. camera. [daemon process].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'a'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'a'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3823,26 +1970,25 @@ int ds_detect_task_type(void){
 					case 'I':
 #if 0	// InputDeviceRead. Android input device reader process. [daemon process].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'n' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'p' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'u' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'D' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'v' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 'c' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'R' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 'd'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'n' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'p' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'u' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'D' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'v' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == 'c' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'R' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 'd'
 						)
 						{
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3858,23 +2004,22 @@ int ds_detect_task_type(void){
 					case 'M':
 #if 0	// Mixer Thread. [daemon process].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'x' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == ' ' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'T' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'h' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'd'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'x' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == ' ' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'T' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'h' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'd'
 						)
 						{
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3886,19 +2031,18 @@ int ds_detect_task_type(void){
 					case 'O':
 #if 0	// OMAPVOUT. [kernel thread].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'M' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'A' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'P' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'V' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'O' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'U' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'T'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'M' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'A' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'P' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'V' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'O' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'U' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'T'
 						)
 						{
 							new_type = DS_SRT_UI_SERVER_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -3936,78 +2080,75 @@ int ds_detect_task_type(void){
 					case '.':
 #if 0	// android.process.lghome. [application]. O 4 touch.
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'p' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'c' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 'l' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'g' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'h' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 'e'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'p' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'c' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == 'l' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 'g' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'h' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 'e'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// com.lge.cameratest. [application].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'l' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'g' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'c' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'a' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 't' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 't'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'l' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'g' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'c' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 'a' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 't' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 't'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
 #endif
 #if 0	// com.cooliris.media. Gallary related. [application].
 						if(
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+1) == 'c' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+2) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+3) == 'o' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+4) == 'l' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+5) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+6) == 'r' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+7) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+8) == 's' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+9) == '.' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+10) == 'm' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+11) == 'e' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+12) == 'd' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+13) == 'i' &&
-							*(ds_status.tg_owner_comm[ds_parameter.next_p->pid]+14) == 'a'
+							*(ds_parameter.next_p->group_leader->comm+1) == 'c' &&
+							*(ds_parameter.next_p->group_leader->comm+2) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+3) == 'o' &&
+							*(ds_parameter.next_p->group_leader->comm+4) == 'l' &&
+							*(ds_parameter.next_p->group_leader->comm+5) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+6) == 'r' &&
+							*(ds_parameter.next_p->group_leader->comm+7) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+8) == 's' &&
+							*(ds_parameter.next_p->group_leader->comm+9) == '.' &&
+							*(ds_parameter.next_p->group_leader->comm+10) == 'm' &&
+							*(ds_parameter.next_p->group_leader->comm+11) == 'e' &&
+							*(ds_parameter.next_p->group_leader->comm+12) == 'd' &&
+							*(ds_parameter.next_p->group_leader->comm+13) == 'i' &&
+							*(ds_parameter.next_p->group_leader->comm+14) == 'a'
 						)
 						{
 							new_type = DS_SRT_DAEMON_TASK;
-							ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-							ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
-							ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+							ds_parameter.next_p->ds.ipc_timeout_ns = 0;
+							ds_parameter.next_p->ds.type_fixed = 1;
 							goto DS_TASK_TYPE_DETECTION_DONE;
 						}
 						else
@@ -4023,12 +2164,9 @@ DS_UNKNOWN_TASK_NAME:
 				if(old_type == DS_SRT_UI_CLIENT_TASK)
 				{
 					/* If DS_SRT_UI_IPC_TIMEOUT is over */
-					if(ds_counter.elapsed_sec > ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] ||
-						(ds_counter.elapsed_sec == ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] &&
-						ds_counter.elapsed_usec > ds_status.ipc_timeout_usec[ds_parameter.next_p->pid]))
+					if(ds_counter.elapsed_ns > ds_parameter.next_p->ds.ipc_timeout_ns)
 					{
-						ds_status.ipc_timeout_sec[ds_parameter.next_p->pid] = 0;
-						ds_status.ipc_timeout_usec[ds_parameter.next_p->pid] = 0;
+						ds_parameter.next_p->ds.ipc_timeout_ns = 0;
 
 						//if(ds_parameter.next_p->parent->pid == 1){
 						//	new_type = DS_SRT_DAEMON_TASK;
@@ -4051,7 +2189,7 @@ DS_UNKNOWN_TASK_NAME:
 						ds_parameter.next_p->parent->pid == 2)
 					{
 						new_type = DS_SRT_KERNEL_THREAD;
-						ds_status.type_fixed[ds_parameter.next_p->pid] = 1;
+						ds_parameter.next_p->ds.type_fixed = 1;
 						goto DS_TASK_TYPE_DETECTION_DONE;
 					}
 					else if(ds_parameter.next_p->parent->pid == 1){
@@ -4067,134 +2205,12 @@ new_type = DS_NRT_TASK;
 
 DS_TASK_TYPE_DETECTION_DONE:
 
-				/* D) Thread group consideration */
-
-#if 0
-				/* Skip for thread group leader or 
-					if the leader's type has not been determined yet. */
-				if(ds_parameter.next_p->pid != ds_status.tgid[ds_parameter.next_p->pid])
-				{
-					/* If thread group leader's type is different from next_p's */
-					if(new_type != ds_status.type[ds_status.tgid[ds_parameter.next_p->pid]])
-					{
-						/* If thread group leader's type is higher than next_p's */
-						if(new_type > ds_status.type[ds_status.tgid[ds_parameter.next_p->pid]])
-						{
-							/* If thread group leader's type change causer is next_p,
-								decrease the leader's type down to next_p's.
-								Then, reset the leader's type change causer pid. */
-							if(ds_status.tgid_type_change_causer[ds_status.tgid[ds_parameter.next_p->pid]] == 
-								ds_parameter.next_p->pid)
-							{
-								switch(new_type){
-									case DS_HRT_TASK:
-										ds_status.type[ds_status.tgid[ds_parameter.next_p->pid]] = 
-											DS_HRT_TASK;
-										break;
-									case DS_SRT_UI_SERVER_TASK:
-										ds_status.type[ds_status.tgid[ds_parameter.next_p->pid]] = 
-											DS_SRT_UI_SERVER_TASK;
-										break;
-									case DS_SRT_UI_CLIENT_TASK:
-										ds_status.type[ds_status.tgid[ds_parameter.next_p->pid]] = 
-											DS_SRT_UI_CLIENT_TASK;
-										break;
-									case DS_SRT_KERNEL_THREAD:
-										ds_status.type[ds_status.tgid[ds_parameter.next_p->pid]] = 
-											DS_SRT_KERNEL_THREAD;
-										break;
-									case DS_SRT_DAEMON_TASK:
-										ds_status.type[ds_status.tgid[ds_parameter.next_p->pid]] = 
-											DS_SRT_DAEMON_TASK;
-										break;
-									case DS_NRT_TASK:
-									default:
-										ds_status.type[ds_status.tgid[ds_parameter.next_p->pid]] = 
-											DS_NRT_TASK;
-										break;
-								}
-								ds_status.tgid_type_changed[ds_status.tgid[ds_parameter.next_p->pid]] = 1;
-								ds_status.tgid_type_change_causer[ds_status.tgid[ds_parameter.next_p->pid]] = 0;
-							}
-							/* If thread group leader's type change causer is 
-								either the leader itself or another task,
-								increase next_p's type up to the leader's.
-								The leader's type change causer pid should be remained. */
-							else
-							{
-								switch(ds_status.type[ds_status.tgid[ds_parameter.next_p->pid]]){
-									case DS_HRT_TASK:
-										new_type = DS_HRT_TASK;
-										break;
-									case DS_SRT_UI_SERVER_TASK:
-										new_type = DS_SRT_UI_SERVER_TASK;
-										break;
-									case DS_SRT_UI_CLIENT_TASK:
-										new_type = DS_SRT_UI_CLIENT_TASK;
-										break;
-									case DS_SRT_KERNEL_THREAD:
-										new_type = DS_SRT_KERNEL_THREAD;
-										break;
-									case DS_SRT_DAEMON_TASK:
-										new_type = DS_SRT_DAEMON_TASK;
-										break;
-									case DS_NRT_TASK:
-									default:
-										new_type = DS_NRT_TASK;
-										break;
-								}
-							}
-						}
-						/* If next_p's type is higher than thread group leader's */
-						else
-						{
-							/* In this case, unconditionally increase the leader's type up to the next_p's */
-							switch(new_type){
-								case DS_HRT_TASK:
-									ds_status.type[ds_status.tgid[ds_parameter.next_p->pid]] = 
-											DS_HRT_TASK;
-									break;
-								case DS_SRT_UI_SERVER_TASK:
-									ds_status.type[ds_status.tgid[ds_parameter.next_p->pid]] = 
-											DS_SRT_UI_SERVER_TASK;
-									break;
-								case DS_SRT_UI_CLIENT_TASK:
-									ds_status.type[ds_status.tgid[ds_parameter.next_p->pid]] = 
-											DS_SRT_UI_CLIENT_TASK;
-									break;
-								case DS_SRT_KERNEL_THREAD:
-									ds_status.type[ds_status.tgid[ds_parameter.next_p->pid]] = 
-											DS_SRT_KERNEL_THREAD;
-									break;
-								case DS_SRT_DAEMON_TASK:
-									ds_status.type[ds_status.tgid[ds_parameter.next_p->pid]] = 
-											DS_SRT_DAEMON_TASK;
-									break;
-								case DS_NRT_TASK:
-								default:
-									ds_status.type[ds_status.tgid[ds_parameter.next_p->pid]] = 
-											DS_NRT_TASK;
-									break;
-							}
-							ds_status.tgid_type_changed[ds_status.tgid[ds_parameter.next_p->pid]] = 1;
-							ds_status.tgid_type_change_causer[ds_status.tgid[ds_parameter.next_p->pid]] = 
-								ds_parameter.next_p->pid;
-						}
-					}
-				}
-#endif
-
-				/* E) Check type change. */
+				/* D) Check type change. */
 				if(old_type != new_type){
-					ds_status.type[ds_parameter.next_p->pid] = new_type;
-					ds_status.type_need_to_be_changed[ds_parameter.next_p->pid] = 1;
-				}
-#if 0
-				else if(ds_status.tgid_type_changed[ds_parameter.next_p->pid] == 1){
-					ds_status.type_need_to_be_changed[ds_parameter.next_p->pid] = 1;
-					ds_status.tgid_type_changed[ds_parameter.next_p->pid] = 0;
+					trace_lg_dvfs_task_type(ds_parameter.next_p, old_type, new_type);
+					ds_parameter.next_p->ds.type = new_type;
+					ds_parameter.next_p->ds.type_need_to_be_changed = 1;
 				}
-#endif
 			}
 		}
 	}
@@ -4211,7 +2227,7 @@ asmlinkage void ds_update_cpu_op(void){
 	struct device *l3_dev;	// Moved from cpu-omap.c
 	struct device *iva_dev; // Moved from cpu-omap.c
 
-	unsigned long lc_min_cpu_op_update_interval = 0;
+	u64 lc_min_cpu_op_update_interval = 0;
 
 	if(ds_status.flag_run_dvs == 1){
 
@@ -4222,35 +2238,14 @@ asmlinkage void ds_update_cpu_op(void){
 			else
 				lc_min_cpu_op_update_interval = DS_MIN_CPU_OP_UPDATE_INTERVAL_D;
 
-			/* If this is the first time */
-			if(ds_status.cpu_op_last_update_sec == 0 && ds_status.cpu_op_last_update_usec == 0){
+			/* If this is the first time or
+				lc_min_cpu_op_update_interval is over since the last update */
+			if(ds_status.cpu_op_last_update_ns == 0 ||
+				ds_counter.elapsed_ns - ds_status.cpu_op_last_update_ns
+				> lc_min_cpu_op_update_interval)
 				goto update_cpu_op;
-			}
-			else{
-				/* If lc_min_cpu_op_update_interval is over since the last update */
-				if(ds_counter.elapsed_sec > ds_status.cpu_op_last_update_sec + 1){
-					goto update_cpu_op;
-				}
-				else if(ds_counter.elapsed_sec > ds_status.cpu_op_last_update_sec){
-					if(ds_counter.elapsed_usec > ds_status.cpu_op_last_update_usec){
-						goto update_cpu_op;
-					}
-					else if(ds_counter.elapsed_usec + 1000000
-						> ds_status.cpu_op_last_update_usec + lc_min_cpu_op_update_interval){
-						goto update_cpu_op;
-					}
-					else
-						goto do_not_update;
-				}
-				else{
-					if(ds_counter.elapsed_usec
-						> ds_status.cpu_op_last_update_usec + lc_min_cpu_op_update_interval){
-						goto update_cpu_op;
-					}
-					else
-						goto do_not_update;
-				}
-			}
+			else
+				goto do_not_update;
 		}
 		else
 			goto do_not_update;
@@ -4258,6 +2253,20 @@ asmlinkage void ds_update_cpu_op(void){
 
 update_cpu_op:
 
+	/* Running as the 'lgdvfs' cpufreq governor. Let cpufreq do the transition;
+		ds_sync_cpu_op() updates cpu_op_index once it is done.
+	 */
+	if(ds_status.flag_run_dvs == 1 && ds_status.flag_cpufreq_gov == 1){
+		if(ds_status.mpu_min_freq_to_lock != 0){
+			if(ds_status.target_cpu_op_index < ds_status.mpu_min_freq_to_lock)
+				ds_status.target_cpu_op_index = ds_status.mpu_min_freq_to_lock;
+		}
+		cpufreq_lgdvfs_request(ds_status.target_cpu_op_index);
+		ds_status.cpu_op_last_update_ns = ds_counter.elapsed_ns;
+		ds_status.flag_update_cpu_op = 0;
+		goto do_not_update;
+	}
+
 	if(ds_status.flag_run_dvs == 1){
 		ds_update_time_counter();
 
@@ -4708,8 +2717,9 @@ update_cpu_op:
 
 		ds_status.flag_correct_cpu_op_update_path = 0;
 		ds_status.cpu_op_index = ds_status.target_cpu_op_index;
-		ds_status.cpu_op_last_update_sec = ds_counter.elapsed_sec;
-		ds_status.cpu_op_last_update_usec = ds_counter.elapsed_usec;
+		/* Keep the scale factor used by ds_update_time_counter() in step */
+		ds_status.cpu_op_sf = DS_INDEX2SF(ds_status.cpu_op_index);
+		ds_status.cpu_op_last_update_ns = ds_counter.elapsed_ns;
 		ds_status.flag_update_cpu_op = 0;
 	}
 
@@ -4719,6 +2729,30 @@ do_not_update:
 }
 EXPORT_SYMBOL(ds_update_cpu_op);
 
+/*====================================================================
+	The function which makes ds_status follow a CPU frequency change
+	done through cpufreq. freq is in kHz.
+	====================================================================*/
+void ds_sync_cpu_op(unsigned int freq){
+
+	unsigned int lc_cpu_op_index = freq * 1000;
+	unsigned long lc_flags;
+
+	/* Close the time interval run at the old CPU_OP first.
+		Interrupts off, as schedule() updates the same counters. */
+	local_irq_save(lc_flags);
+	ds_update_time_counter();
+
+	ds_status.cpu_op_index = lc_cpu_op_index;
+	ds_status.cpu_op_sf = DS_INDEX2SF(lc_cpu_op_index);
+	ds_status.cpu_op_index_nr = DS_INDEX2NR(lc_cpu_op_index);
+	ds_status.cpu_op_mhz = DS_INDEX2MHZPRECISE(lc_cpu_op_index);
+	local_irq_restore(lc_flags);
+
+	return;
+}
+EXPORT_SYMBOL(ds_sync_cpu_op);
+
 /*====================================================================
 	The main dynamic voltage scaling and
 	performance evaluation kernel function.
@@ -4739,7 +2773,7 @@ void do_dvs_suite(void){
 
 #if 0	// WARNING: This code will cause a severe performance degradation!!!
 printk(KERN_WARNING "t%d %5d %5d %16s p%3d s%3d\n", 
-ds_status.type[ds_parameter.next_p->pid],
+ds_parameter.next_p->ds.type,
 ds_parameter.next_p->pid,
 ds_parameter.next_p->tgid,
 ds_parameter.next_p->comm,
@@ -4751,7 +2785,7 @@ ds_parameter.next_p->static_prio
 	/* Trace task type.
 	 */
 	if(ds_status.flag_run_dvs == 1)
-		if(ds_status.type_fixed[ds_parameter.next_p->pid] == 0)
+		if(ds_parameter.next_p->ds.type_fixed == 0)
 			ds_detect_task_type();
 
 	/* If ds_status.flag_run_dvs == 1. This is set in binder.c */
@@ -4777,6 +2811,9 @@ ds_parameter.next_p->static_prio
 		}
 
 		if(lc_target_cpu_op_index != ds_status.cpu_op_index){
+			if(lc_target_cpu_op_index != ds_status.target_cpu_op_index)
+				trace_lg_dvfs_target(ds_status.cpu_op_index, lc_target_cpu_op_index,
+									 ds_status.touch_timeout_ns != 0);
 			ds_status.flag_update_cpu_op = 1;
 			ds_status.target_cpu_op_index = lc_target_cpu_op_index;
 		}
@@ -4816,7 +2853,7 @@ ds_parameter.next_p->static_prio
 	/* Delay the activation of LG-DVFS
 	 */
 	if(ds_configuration.on_dvs == 1 && ds_status.flag_run_dvs == 0){
-		if(ds_counter.elapsed_sec > DS_INIT_DELAY_SEC){
+		if(ds_counter.elapsed_ns > DS_INIT_DELAY){
 			ds_status.flag_run_dvs = 1;
 			printk(KERN_INFO "[LG-DVFS] LG-DVFS was activated.\n");
 		}
@@ -4827,11 +2864,8 @@ ds_parameter.next_p->static_prio
 	if(ds_status.flag_post_early_suspend == 0){
 		ds_status.flag_do_post_early_suspend = 0;
 	}
-	else if((ds_status.post_early_suspend_sec * 1000000 + 
-			ds_status.post_early_suspend_usec + 
-			DS_POST_EARLY_SUSPEND_TIMEOUT_USEC) >
-			(ds_counter.elapsed_sec * 1000000 + 
-			ds_counter.elapsed_usec))
+	else if(ds_status.post_early_suspend_ns + DS_POST_EARLY_SUSPEND_TIMEOUT >
+			ds_counter.elapsed_ns)
 	{
 		ds_status.flag_do_post_early_suspend = 0;
 	}
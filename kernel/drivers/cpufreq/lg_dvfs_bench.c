@@ -0,0 +1,162 @@
+/*
+ * drivers/cpufreq/lg_dvfs_bench.c
+ *
+ * Context switch benchmark for the LG-DVFS scheduler hook.
+ *
+ * Two kernel threads bound to the same CPU hand a completion back and
+ * forth, so that every hand-over is a context switch through
+ * ld_do_dvs_suite(). The ping-pong is timed once with LG-DVFS turned off
+ * and once with it turned on, and the cost per switch is reported with
+ * the hook time accounted in ds_counter. turn_on_lg_dvfs is restored
+ * afterwards.
+ *
+ * Load the module to run the benchmark; the results go to the kernel log.
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ */
+
+#include <linux/completion.h>
+#include <linux/dvs_suite.h>
+#include <linux/err.h>
+#include <linux/init.h>
+#include <linux/kthread.h>
+#include <linux/ktime.h>
+#include <linux/module.h>
+
+static int rounds = 10000;
+module_param(rounds, int, 0444);
+MODULE_PARM_DESC(rounds, "ping-pong round trips per run");
+
+static int cpu;
+module_param(cpu, int, 0444);
+MODULE_PARM_DESC(cpu, "CPU both threads are bound to");
+
+struct lg_dvfs_bench {
+	struct completion ping;
+	struct completion pong;
+	struct completion done;
+	ktime_t start;
+	ktime_t end;
+};
+
+static int lg_dvfs_bench_ping(void *data)
+{
+	struct lg_dvfs_bench *b = data;
+	int i;
+
+	b->start = ktime_get();
+	for (i = 0; i < rounds; i++) {
+		complete(&b->ping);
+		wait_for_completion(&b->pong);
+	}
+	b->end = ktime_get();
+
+	complete(&b->done);
+	return 0;
+}
+
+static int lg_dvfs_bench_pong(void *data)
+{
+	struct lg_dvfs_bench *b = data;
+	int i;
+
+	for (i = 0; i < rounds; i++) {
+		wait_for_completion(&b->ping);
+		complete(&b->pong);
+	}
+	return 0;
+}
+
+/* Returns the time per context switch in ns, or a negative errno */
+static s64 lg_dvfs_bench_run(void)
+{
+	struct lg_dvfs_bench b;
+	struct task_struct *ping, *pong;
+
+	init_completion(&b.ping);
+	init_completion(&b.pong);
+	init_completion(&b.done);
+
+	pong = kthread_create(lg_dvfs_bench_pong, &b, "lg_dvfs_pong");
+	if (IS_ERR(pong))
+		return PTR_ERR(pong);
+	ping = kthread_create(lg_dvfs_bench_ping, &b, "lg_dvfs_ping");
+	if (IS_ERR(ping)) {
+		/* pong has not run yet, kthread_stop() keeps it from starting */
+		kthread_stop(pong);
+		return PTR_ERR(ping);
+	}
+
+	kthread_bind(pong, cpu);
+	kthread_bind(ping, cpu);
+	wake_up_process(pong);
+	wake_up_process(ping);
+
+	wait_for_completion(&b.done);
+
+	/* Two switches per round trip */
+	return div_s64(ktime_to_ns(ktime_sub(b.end, b.start)), 2 * rounds);
+}
+
+static int __init lg_dvfs_bench_init(void)
+{
+	int saved_on_dvs = ds_configuration.on_dvs;
+#ifdef CONFIG_LG_DVFS_HOOK_STATS
+	unsigned long calls;
+	u64 hook_ns;
+#endif
+	s64 off_ns, on_ns = 0;
+
+	if (rounds <= 0 || cpu < 0 || cpu >= nr_cpu_ids || !cpu_online(cpu))
+		return -EINVAL;
+
+	ds_configuration.on_dvs = 0;
+	ds_status.flag_run_dvs = 0;
+	off_ns = lg_dvfs_bench_run();
+	if (off_ns < 0)
+		goto out;
+
+#ifdef CONFIG_LG_DVFS_HOOK_STATS
+	calls = ds_counter.hook_calls;
+	hook_ns = ds_counter.hook_ns;
+#endif
+
+	ds_configuration.on_dvs = 1;
+	on_ns = lg_dvfs_bench_run();
+
+#ifdef CONFIG_LG_DVFS_HOOK_STATS
+	calls = ds_counter.hook_calls - calls;
+	hook_ns = ds_counter.hook_ns - hook_ns;
+#endif
+
+out:
+	ds_configuration.on_dvs = saved_on_dvs;
+	if (!saved_on_dvs)
+		ds_status.flag_run_dvs = 0;
+
+	if (off_ns < 0)
+		return off_ns;
+	if (on_ns < 0)
+		return on_ns;
+
+	printk(KERN_INFO "lg_dvfs_bench: %d round trips on cpu %d: "
+	       "off %lld ns/switch, on %lld ns/switch\n",
+	       rounds, cpu, off_ns, on_ns);
+#ifdef CONFIG_LG_DVFS_HOOK_STATS
+	printk(KERN_INFO "lg_dvfs_bench: hook %lu calls, avg %llu ns\n",
+	       calls, calls ? (unsigned long long)div64_u64(hook_ns, calls) : 0ULL);
+#endif
+	return 0;
+}
+
+static void __exit lg_dvfs_bench_exit(void)
+{
+}
+
+module_init(lg_dvfs_bench_init);
+module_exit(lg_dvfs_bench_exit);
+
+MODULE_DESCRIPTION("LG-DVFS context switch benchmark");
+MODULE_LICENSE("GPL");
@@ -23,6 +23,9 @@
 
 /*  ----------------------------------- Host OS */
 #include <dspbridge/host_os.h>
+#include <linux/rbtree.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 
 /*  ----------------------------------- DSP/BIOS Bridge */
 #include <dspbridge/std.h>
@@ -42,71 +45,91 @@
 #include <dspbridge/dmm.h>
 
 /*  ----------------------------------- Defines, Data Structures, Typedefs */
-#define DMM_ADDR_VIRTUAL(a) \
-	(((struct map_page *)(a) - virtual_mapping_table) * PG_SIZE4K +\
-	dyn_mem_map_beg)
-#define DMM_ADDR_TO_INDEX(a) (((a) - dyn_mem_map_beg) / PG_SIZE4K)
+
+/*
+ * A region is either a chunk or a free range of the DSP virtual space.
+ * Regions tile the pool without holes and two free regions are never
+ * adjacent: they are coalesced when a chunk is unreserved.
+ */
+struct dmm_region {
+	struct rb_node addr_node;	/* dmm_object.regions, by address */
+	struct rb_node size_node;	/* dmm_object.free_regions, free only */
+	u32 addr;
+	u32 size;
+	bool reserved;
+};
+
+/* A block mapped with dmm_map_memory(), somewhere inside a chunk */
+struct dmm_map {
+	struct rb_node node;		/* dmm_object.maps, by address */
+	u32 addr;
+	u32 size;
+};
 
 /* DMM Mgr */
 struct dmm_object {
 	/* Dmm Lock is used to serialize access mem manager for
 	 * multi-threads. */
 	spinlock_t dmm_lock;	/* Lock to access dmm mgr */
+	struct rb_root regions;		/* All regions, by address */
+	struct rb_root free_regions;	/* Free regions, by size then address */
+	struct rb_root maps;		/* Mapped blocks, by address */
+	u32 dyn_mem_map_beg;	/* The Beginning of dynamic memory mapping */
+	u32 pool_size;		/* The size of the dynamic memory pool */
+	/* Fragmentation statistics */
+	u32 free_bytes;
+	u32 num_free;
+	u32 num_reserved;
+	u32 num_mapped;
 };
 
 /*  ----------------------------------- Globals */
 static u32 refs;		/* module reference count */
-struct map_page {
-	u32 region_size:31;
-	u32 reserved:1;
-	u32 mapped_size:31;
-	u32 mapped:1;
-};
-
-/*  Create the free list */
-static struct map_page *virtual_mapping_table;
-static u32 free_region;		/* The index of free region */
-static u32 free_size;
-static u32 dyn_mem_map_beg;	/* The Beginning of dynamic memory mapping */
-static u32 table_size;		/* The size of virt and phys pages tables */
 
 /*  ----------------------------------- Function Prototypes */
-static struct map_page *get_region(u32 addr);
-static struct map_page *get_free_region(u32 aSize);
-static struct map_page *get_mapped_region(u32 aAddr);
+static struct dmm_region *get_region(struct dmm_object *dmm_obj, u32 addr);
+static struct dmm_region *get_free_region(struct dmm_object *dmm_obj,
+					  u32 size);
+static struct dmm_map *get_mapped_region(struct dmm_object *dmm_obj,
+					 u32 addr);
+static void insert_region(struct dmm_object *dmm_obj,
+			  struct dmm_region *region);
+static void insert_free_region(struct dmm_object *dmm_obj,
+			       struct dmm_region *region);
+static void remove_free_region(struct dmm_object *dmm_obj,
+			       struct dmm_region *region);
 #ifdef DSP_DMM_DEBUG
 u32 dmm_mem_map_dump(struct dmm_object *dmm_mgr);
 #endif
 
 /*  ======== dmm_create_tables ========
  *  Purpose:
- *      Create table to hold the information of physical address
- *      the buffer pages that is passed by the user, and the table
- *      to hold the information of the virtual memory that is reserved
- *      for DSP.
+ *      Create the trees that hold the reserved chunks and the mapped
+ *      blocks of the virtual memory that is reserved for DSP. The whole
+ *      pool starts as a single free region.
  */
 int dmm_create_tables(struct dmm_object *dmm_mgr, u32 addr, u32 size)
 {
 	struct dmm_object *dmm_obj = (struct dmm_object *)dmm_mgr;
+	struct dmm_region *region;
 	int status = 0;
 
 	status = dmm_delete_tables(dmm_obj);
 	if (DSP_SUCCEEDED(status)) {
-		dyn_mem_map_beg = addr;
-		table_size = PG_ALIGN_HIGH(size, PG_SIZE4K) / PG_SIZE4K;
-		/*  Create the free list */
-		virtual_mapping_table = __vmalloc(table_size *
-				sizeof(struct map_page), GFP_KERNEL |
-				__GFP_HIGHMEM | __GFP_ZERO, PAGE_KERNEL);
-		if (virtual_mapping_table == NULL)
+		region = kzalloc(sizeof(struct dmm_region), GFP_KERNEL);
+		if (region == NULL)
 			status = -ENOMEM;
-		else {
-			/* On successful allocation,
-			 * all entries are zero ('free') */
-			free_region = 0;
-			free_size = table_size * PG_SIZE4K;
-			virtual_mapping_table[0].region_size = table_size;
-		}
+	}
+	if (DSP_SUCCEEDED(status)) {
+		region->addr = addr;
+		region->size = PG_ALIGN_HIGH(size, PG_SIZE4K);
+
+		spin_lock(&dmm_obj->dmm_lock);
+		dmm_obj->dyn_mem_map_beg = addr;
+		dmm_obj->pool_size = region->size;
+		insert_region(dmm_obj, region);
+		insert_free_region(dmm_obj, region);
+		spin_unlock(&dmm_obj->dmm_lock);
 	}
 
 	if (DSP_FAILED(status))
@@ -134,6 +157,9 @@ int dmm_create(OUT struct dmm_object **phDmmMgr,
 	dmm_obj = kzalloc(sizeof(struct dmm_object), GFP_KERNEL);
 	if (dmm_obj != NULL) {
 		spin_lock_init(&dmm_obj->dmm_lock);
+		dmm_obj->regions = RB_ROOT;
+		dmm_obj->free_regions = RB_ROOT;
+		dmm_obj->maps = RB_ROOT;
 		*phDmmMgr = dmm_obj;
 	} else {
 		status = -ENOMEM;
@@ -170,14 +196,39 @@ int dmm_destroy(struct dmm_object *dmm_mgr)
  */
 int dmm_delete_tables(struct dmm_object *dmm_mgr)
 {
+	struct rb_root regions;
+	struct rb_root maps;
+	struct rb_node *node;
 	int status = 0;
 
 	DBC_REQUIRE(refs > 0);
-	/* Delete all DMM tables */
-	if (dmm_mgr)
-		vfree(virtual_mapping_table);
-	else
-		status = -EFAULT;
+	if (!dmm_mgr)
+		return -EFAULT;
+
+	/* Detach the trees, then free their nodes outside of the lock */
+	spin_lock(&dmm_mgr->dmm_lock);
+	regions = dmm_mgr->regions;
+	maps = dmm_mgr->maps;
+	dmm_mgr->regions = RB_ROOT;
+	dmm_mgr->free_regions = RB_ROOT;
+	dmm_mgr->maps = RB_ROOT;
+	dmm_mgr->pool_size = 0;
+	dmm_mgr->free_bytes = 0;
+	dmm_mgr->num_free = 0;
+	dmm_mgr->num_reserved = 0;
+	dmm_mgr->num_mapped = 0;
+	spin_unlock(&dmm_mgr->dmm_lock);
+
+	/* Free regions are in both trees, free them through 'regions' */
+	while ((node = rb_first(&regions)) != NULL) {
+		rb_erase(node, &regions);
+		kfree(rb_entry(node, struct dmm_region, addr_node));
+	}
+	while ((node = rb_first(&maps)) != NULL) {
+		rb_erase(node, &maps);
+		kfree(rb_entry(node, struct dmm_map, node));
+	}
+
 	return status;
 }
 
@@ -220,6 +271,80 @@ int dmm_get_handle(void *hprocessor, OUT struct dmm_object **phDmmMgr)
 	return status;
 }
 
+/*
+ *  ======== dmm_get_stats ========
+ *  Purpose:
+ *      Return the usage and fragmentation of the DSP virtual space.
+ */
+int dmm_get_stats(struct dmm_object *dmm_mgr, OUT struct dmm_stats *stats)
+{
+	struct rb_node *largest;
+
+	DBC_REQUIRE(refs > 0);
+	DBC_REQUIRE(stats != NULL);
+	if (!dmm_mgr)
+		return -EFAULT;
+
+	spin_lock(&dmm_mgr->dmm_lock);
+	stats->pool_size = dmm_mgr->pool_size;
+	stats->free_bytes = dmm_mgr->free_bytes;
+	largest = rb_last(&dmm_mgr->free_regions);
+	stats->largest_free = largest ?
+	    rb_entry(largest, struct dmm_region, size_node)->size : 0;
+	stats->free_regions = dmm_mgr->num_free;
+	stats->reserved_regions = dmm_mgr->num_reserved;
+	stats->mapped_blocks = dmm_mgr->num_mapped;
+	spin_unlock(&dmm_mgr->dmm_lock);
+
+	return 0;
+}
+
+/*
+ *  ======== dmm_stats_show ========
+ *      dspbridge/dmm_stats, dmm_get_stats() of the default device.
+ */
+static int dmm_stats_show(struct seq_file *s, void *unused)
+{
+	struct dmm_object *dmm_mgr = NULL;
+	struct dmm_stats stats;
+
+	if (DSP_FAILED(dmm_get_handle(NULL, &dmm_mgr)) ||
+	    DSP_FAILED(dmm_get_stats(dmm_mgr, &stats)))
+		return -ENODEV;
+
+	seq_printf(s, "pool_size %u\n", stats.pool_size);
+	seq_printf(s, "free_bytes %u\n", stats.free_bytes);
+	seq_printf(s, "largest_free %u\n", stats.largest_free);
+	seq_printf(s, "free_regions %u\n", stats.free_regions);
+	seq_printf(s, "reserved_regions %u\n", stats.reserved_regions);
+	seq_printf(s, "mapped_blocks %u\n", stats.mapped_blocks);
+
+	return 0;
+}
+
+static int dmm_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, dmm_stats_show, inode->i_private);
+}
+
+static const struct file_operations dmm_stats_fops = {
+	.open = dmm_stats_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+/*
+ *  ======== dmm_debugfs_init ========
+ *  Purpose:
+ *      Exports the DSP virtual space statistics in the debugfs
+ *      directory dir, which is removed along with them.
+ */
+void dmm_debugfs_init(struct dentry *dir)
+{
+	debugfs_create_file("dmm_stats", S_IRUGO, dir, NULL, &dmm_stats_fops);
+}
+
 /*
  *  ======== dmm_init ========
  *  Purpose:
@@ -236,9 +361,6 @@ bool dmm_init(void)
 
 	DBC_ENSURE((ret && (refs > 0)) || (!ret && (refs >= 0)));
 
-	virtual_mapping_table = NULL;
-	table_size = 0;
-
 	return ret;
 }
 
@@ -246,28 +368,53 @@ bool dmm_init(void)
  *  ======== dmm_map_memory ========
  *  Purpose:
  *      Add a mapping block to the reserved chunk. DMM assumes that this block
- *  will be mapped in the DSP/IVA's address space. DMM returns an error if a
- *  mapping overlaps another one. This function stores the info that will be
- *  required later while unmapping the block.
+ *  will be mapped in the DSP/IVA's address space. This function stores the
+ *  info that will be required later while unmapping the block.
  */
 int dmm_map_memory(struct dmm_object *dmm_mgr, u32 addr, u32 size)
 {
 	struct dmm_object *dmm_obj = (struct dmm_object *)dmm_mgr;
-	struct map_page *chunk;
+	struct dmm_map *map;
+	struct dmm_map *chunk = NULL;
 	int status = 0;
 
+	map = kmalloc(sizeof(struct dmm_map), GFP_KERNEL);
+	if (map == NULL)
+		return -ENOMEM;
+	map->addr = addr;
+	map->size = size;
+
 	spin_lock(&dmm_obj->dmm_lock);
-	/* Find the Reserved memory chunk containing the DSP block to
-	 * be mapped */
-	chunk = (struct map_page *)get_region(addr);
-	if (chunk != NULL) {
-		/* Mark the region 'mapped', leave the 'reserved' info as-is */
-		chunk->mapped = true;
-		chunk->mapped_size = (size / PG_SIZE4K);
+	/* The DSP block to be mapped must be in the dynamic pool */
+	if (get_region(dmm_obj, addr) != NULL) {
+		chunk = get_mapped_region(dmm_obj, addr);
+		if (chunk != NULL) {
+			/* Remapped in place, as with the old page table */
+			chunk->size = size;
+		} else {
+			struct rb_node **link = &dmm_obj->maps.rb_node;
+			struct rb_node *parent = NULL;
+
+			while (*link) {
+				parent = *link;
+				if (addr < rb_entry(parent, struct dmm_map,
+						    node)->addr)
+					link = &parent->rb_left;
+				else
+					link = &parent->rb_right;
+			}
+			rb_link_node(&map->node, parent, link);
+			rb_insert_color(&map->node, &dmm_obj->maps);
+			dmm_obj->num_mapped++;
+			chunk = map;
+			map = NULL;
+		}
 	} else
 		status = -ENOENT;
 	spin_unlock(&dmm_obj->dmm_lock);
 
+	kfree(map);
+
 	dev_dbg(bridge, "%s dmm_mgr %p, addr %x, size %x\n\tstatus %i, "
 		"chunk %p", __func__, dmm_mgr, addr, size, status, chunk);
 
@@ -278,39 +425,50 @@ int dmm_map_memory(struct dmm_object *dmm_mgr, u32 addr, u32 size)
  *  ======== dmm_reserve_memory ========
  *  Purpose:
  *      Reserve a chunk of virtually contiguous DSP/IVA address space.
+ *      The smallest free region that fits is used (best fit), lowest
+ *      address first among regions of the same size.
  */
 int dmm_reserve_memory(struct dmm_object *dmm_mgr, u32 size,
 			      u32 *prsv_addr)
 {
 	int status = 0;
 	struct dmm_object *dmm_obj = (struct dmm_object *)dmm_mgr;
-	struct map_page *node;
+	struct dmm_region *node;
+	struct dmm_region *chunk;
 	u32 rsv_addr = 0;
 	u32 rsv_size = 0;
 
+	rsv_size = PG_ALIGN_HIGH(size, PG_SIZE4K);
+	if (rsv_size == 0)
+		return -EINVAL;
+
+	/* In case the free region has to be split */
+	chunk = kzalloc(sizeof(struct dmm_region), GFP_KERNEL);
+	if (chunk == NULL)
+		return -ENOMEM;
+
 	spin_lock(&dmm_obj->dmm_lock);
 
 	/* Try to get a DSP chunk from the free list */
-	node = get_free_region(size);
+	node = get_free_region(dmm_obj, rsv_size);
 	if (node != NULL) {
 		/*  DSP chunk of given size is available. */
-		rsv_addr = DMM_ADDR_VIRTUAL(node);
-		/* Calculate the number entries to use */
-		rsv_size = size / PG_SIZE4K;
-		if (rsv_size < node->region_size) {
-			/* Mark remainder of free region */
-			node[rsv_size].mapped = false;
-			node[rsv_size].reserved = false;
-			node[rsv_size].region_size =
-			    node->region_size - rsv_size;
-			node[rsv_size].mapped_size = 0;
+		rsv_addr = node->addr;
+		remove_free_region(dmm_obj, node);
+		if (rsv_size < node->size) {
+			/* The remainder stays free, after the new chunk */
+			node->addr += rsv_size;
+			node->size -= rsv_size;
+			insert_free_region(dmm_obj, node);
+
+			chunk->addr = rsv_addr;
+			chunk->size = rsv_size;
+			insert_region(dmm_obj, chunk);
+			node = chunk;
+			chunk = NULL;
 		}
-		/*  get_region will return first fit chunk. But we only use what
-		   is requested. */
-		node->mapped = false;
 		node->reserved = true;
-		node->region_size = rsv_size;
-		node->mapped_size = 0;
+		dmm_obj->num_reserved++;
 		/* Return the chunk's starting address */
 		*prsv_addr = rsv_addr;
 	} else
@@ -319,9 +477,14 @@ int dmm_reserve_memory(struct dmm_object *dmm_mgr, u32 size,
 
 	spin_unlock(&dmm_obj->dmm_lock);
 
+	kfree(chunk);
+
 	dev_dbg(bridge, "%s dmm_mgr %p, size %x, prsv_addr %p\n\tstatus %i, "
 		"rsv_addr %x, rsv_size %x\n", __func__, dmm_mgr, size,
 		prsv_addr, status, rsv_addr, rsv_size);
+	if (DSP_FAILED(status))
+		dev_dbg(bridge, "%s: free %x in %u regions\n", __func__,
+			dmm_obj->free_bytes, dmm_obj->num_free);
 
 	return status;
 }
@@ -334,25 +497,27 @@ int dmm_reserve_memory(struct dmm_object *dmm_mgr, u32 size,
 int dmm_un_map_memory(struct dmm_object *dmm_mgr, u32 addr, u32 *psize)
 {
 	struct dmm_object *dmm_obj = (struct dmm_object *)dmm_mgr;
-	struct map_page *chunk;
+	struct dmm_map *chunk;
 	int status = 0;
 
 	spin_lock(&dmm_obj->dmm_lock);
-	chunk = get_mapped_region(addr);
+	chunk = get_mapped_region(dmm_obj, addr);
 	if (chunk == NULL)
 		status = -ENOENT;
 
 	if (DSP_SUCCEEDED(status)) {
 		/* Unmap the region */
-		*psize = chunk->mapped_size * PG_SIZE4K;
-		chunk->mapped = false;
-		chunk->mapped_size = 0;
+		*psize = chunk->size;
+		rb_erase(&chunk->node, &dmm_obj->maps);
+		dmm_obj->num_mapped--;
 	}
 	spin_unlock(&dmm_obj->dmm_lock);
 
 	dev_dbg(bridge, "%s: dmm_mgr %p, addr %x, psize %p\n\tstatus %i, "
 		"chunk %p\n", __func__, dmm_mgr, addr, psize, status, chunk);
 
+	kfree(chunk);
+
 	return status;
 }
 
@@ -364,41 +529,71 @@ int dmm_un_map_memory(struct dmm_object *dmm_mgr, u32 addr, u32 *psize)
 int dmm_un_reserve_memory(struct dmm_object *dmm_mgr, u32 rsv_addr)
 {
 	struct dmm_object *dmm_obj = (struct dmm_object *)dmm_mgr;
-	struct map_page *chunk;
-	u32 i;
+	struct dmm_region *chunk;
+	struct dmm_region *next;
+	struct dmm_region *prev;
+	struct dmm_region *merged[2] = { NULL, NULL };
+	struct dmm_map *map;
+	struct rb_node *node;
+	struct rb_node *n;
 	int status = 0;
-	u32 chunk_size;
 
 	spin_lock(&dmm_obj->dmm_lock);
 
-	/* Find the chunk containing the reserved address */
-	chunk = get_mapped_region(rsv_addr);
-	if (chunk == NULL)
+	/* Find the chunk starting at the reserved address */
+	chunk = get_region(dmm_obj, rsv_addr);
+	if (chunk == NULL || chunk->addr != rsv_addr || !chunk->reserved)
 		status = -ENOENT;
 
 	if (DSP_SUCCEEDED(status)) {
-		/* Free all the mapped pages for this reserved region */
-		i = 0;
-		while (i < chunk->region_size) {
-			if (chunk[i].mapped) {
-				/* Remove mapping from the page tables. */
-				chunk_size = chunk[i].mapped_size;
-				/* Clear the mapping flags */
-				chunk[i].mapped = false;
-				chunk[i].mapped_size = 0;
-				i += chunk_size;
+		/* Free all the mapped blocks of this reserved chunk */
+		node = dmm_obj->maps.rb_node;
+		n = NULL;
+		while (node) {
+			map = rb_entry(node, struct dmm_map, node);
+			if (map->addr >= chunk->addr) {
+				n = node;
+				node = node->rb_left;
 			} else
-				i++;
+				node = node->rb_right;
+		}
+		while (n) {
+			map = rb_entry(n, struct dmm_map, node);
+			if (map->addr >= chunk->addr + chunk->size)
+				break;
+			n = rb_next(n);
+			rb_erase(&map->node, &dmm_obj->maps);
+			dmm_obj->num_mapped--;
+			kfree(map);
 		}
-		/* Clear the flags (mark the region 'free') */
+
+		/* Mark the region 'free' and coalesce it with its neighbours */
 		chunk->reserved = false;
-		/* NOTE: We do NOT coalesce free regions here.
-		 * Free regions are coalesced in get_region(), as it traverses
-		 *the whole mapping table
-		 */
+		dmm_obj->num_reserved--;
+		node = rb_prev(&chunk->addr_node);
+		prev = node ? rb_entry(node, struct dmm_region, addr_node) : NULL;
+		if (prev && !prev->reserved) {
+			remove_free_region(dmm_obj, prev);
+			prev->size += chunk->size;
+			rb_erase(&chunk->addr_node, &dmm_obj->regions);
+			merged[0] = chunk;
+			chunk = prev;
+		}
+		node = rb_next(&chunk->addr_node);
+		next = node ? rb_entry(node, struct dmm_region, addr_node) : NULL;
+		if (next && !next->reserved) {
+			remove_free_region(dmm_obj, next);
+			chunk->size += next->size;
+			rb_erase(&next->addr_node, &dmm_obj->regions);
+			merged[1] = next;
+		}
+		insert_free_region(dmm_obj, chunk);
 	}
 	spin_unlock(&dmm_obj->dmm_lock);
 
+	kfree(merged[0]);
+	kfree(merged[1]);
+
 	dev_dbg(bridge, "%s: dmm_mgr %p, rsv_addr %x\n\tstatus %i chunk %p",
 		__func__, dmm_mgr, rsv_addr, status, chunk);
 
@@ -408,130 +603,157 @@ int dmm_un_reserve_memory(struct dmm_object *dmm_mgr, u32 rsv_addr)
 /*
  *  ======== get_region ========
  *  Purpose:
- *      Returns a region containing the specified memory region
+ *      Returns the region containing the specified address
  */
-static struct map_page *get_region(u32 aAddr)
+static struct dmm_region *get_region(struct dmm_object *dmm_obj, u32 addr)
 {
-	struct map_page *curr_region = NULL;
-	u32 i = 0;
-
-	if (virtual_mapping_table != NULL) {
-		/* find page mapped by this address */
-		i = DMM_ADDR_TO_INDEX(aAddr);
-		if (i < table_size)
-			curr_region = virtual_mapping_table + i;
+	struct rb_node *node = dmm_obj->regions.rb_node;
+	struct dmm_region *curr_region;
+
+	while (node) {
+		curr_region = rb_entry(node, struct dmm_region, addr_node);
+		if (addr < curr_region->addr)
+			node = node->rb_left;
+		else if (addr - curr_region->addr >= curr_region->size)
+			node = node->rb_right;
+		else
+			return curr_region;
 	}
 
-	dev_dbg(bridge, "%s: curr_region %p, free_region %d, free_size %d\n",
-		__func__, curr_region, free_region, free_size);
-	return curr_region;
+	return NULL;
 }
 
 /*
  *  ======== get_free_region ========
  *  Purpose:
- *  Returns the requested free region
+ *  Returns the smallest free region of at least the requested size
  */
-static struct map_page *get_free_region(u32 aSize)
+static struct dmm_region *get_free_region(struct dmm_object *dmm_obj,
+					  u32 size)
 {
-	struct map_page *curr_region = NULL;
-	u32 i = 0;
-	u32 region_size = 0;
-	u32 next_i = 0;
-
-	if (virtual_mapping_table == NULL)
-		return curr_region;
-	if (aSize > free_size) {
-		/* Find the largest free region
-		 * (coalesce during the traversal) */
-		while (i < table_size) {
-			region_size = virtual_mapping_table[i].region_size;
-			next_i = i + region_size;
-			if (virtual_mapping_table[i].reserved == false) {
-				/* Coalesce, if possible */
-				if (next_i < table_size &&
-				    virtual_mapping_table[next_i].reserved
-				    == false) {
-					virtual_mapping_table[i].region_size +=
-					    virtual_mapping_table
-					    [next_i].region_size;
-					continue;
-				}
-				region_size *= PG_SIZE4K;
-				if (region_size > free_size) {
-					free_region = i;
-					free_size = region_size;
-				}
-			}
-			i = next_i;
-		}
-	}
-	if (aSize <= free_size) {
-		curr_region = virtual_mapping_table + free_region;
-		free_region += (aSize / PG_SIZE4K);
-		free_size -= aSize;
+	struct rb_node *node = dmm_obj->free_regions.rb_node;
+	struct dmm_region *curr_region;
+	struct dmm_region *best = NULL;
+
+	while (node) {
+		curr_region = rb_entry(node, struct dmm_region, size_node);
+		if (curr_region->size >= size) {
+			best = curr_region;
+			node = node->rb_left;
+		} else
+			node = node->rb_right;
 	}
-	return curr_region;
+
+	return best;
 }
 
 /*
  *  ======== get_mapped_region ========
  *  Purpose:
- *  Returns the requestedmapped region
+ *  Returns the block mapped at the specified address
  */
-static struct map_page *get_mapped_region(u32 aAddr)
+static struct dmm_map *get_mapped_region(struct dmm_object *dmm_obj,
+					 u32 addr)
 {
-	u32 i = 0;
-	struct map_page *curr_region = NULL;
+	struct rb_node *node = dmm_obj->maps.rb_node;
+	struct dmm_map *curr_map;
+
+	while (node) {
+		curr_map = rb_entry(node, struct dmm_map, node);
+		if (addr < curr_map->addr)
+			node = node->rb_left;
+		else if (addr > curr_map->addr)
+			node = node->rb_right;
+		else
+			return curr_map;
+	}
 
-	if (virtual_mapping_table == NULL)
-		return curr_region;
+	return NULL;
+}
 
-	i = DMM_ADDR_TO_INDEX(aAddr);
-	if (i < table_size && (virtual_mapping_table[i].mapped ||
-			       virtual_mapping_table[i].reserved))
-		curr_region = virtual_mapping_table + i;
-	return curr_region;
+/*
+ *  ======== insert_region ========
+ *  Purpose:
+ *  Add a region to the address tree
+ */
+static void insert_region(struct dmm_object *dmm_obj,
+			  struct dmm_region *region)
+{
+	struct rb_node **link = &dmm_obj->regions.rb_node;
+	struct rb_node *parent = NULL;
+
+	while (*link) {
+		parent = *link;
+		if (region->addr <
+		    rb_entry(parent, struct dmm_region, addr_node)->addr)
+			link = &parent->rb_left;
+		else
+			link = &parent->rb_right;
+	}
+	rb_link_node(&region->addr_node, parent, link);
+	rb_insert_color(&region->addr_node, &dmm_obj->regions);
+}
+
+/*
+ *  ======== insert_free_region ========
+ *  Purpose:
+ *  Add a free region to the size tree
+ */
+static void insert_free_region(struct dmm_object *dmm_obj,
+			       struct dmm_region *region)
+{
+	struct rb_node **link = &dmm_obj->free_regions.rb_node;
+	struct rb_node *parent = NULL;
+	struct dmm_region *curr_region;
+
+	while (*link) {
+		parent = *link;
+		curr_region = rb_entry(parent, struct dmm_region, size_node);
+		if (region->size < curr_region->size ||
+		    (region->size == curr_region->size &&
+		     region->addr < curr_region->addr))
+			link = &parent->rb_left;
+		else
+			link = &parent->rb_right;
+	}
+	rb_link_node(&region->size_node, parent, link);
+	rb_insert_color(&region->size_node, &dmm_obj->free_regions);
+
+	dmm_obj->free_bytes += region->size;
+	dmm_obj->num_free++;
+}
+
+/*
+ *  ======== remove_free_region ========
+ *  Purpose:
+ *  Take a free region out of the size tree
+ */
+static void remove_free_region(struct dmm_object *dmm_obj,
+			       struct dmm_region *region)
+{
+	rb_erase(&region->size_node, &dmm_obj->free_regions);
+
+	dmm_obj->free_bytes -= region->size;
+	dmm_obj->num_free--;
 }
 
 #ifdef DSP_DMM_DEBUG
 u32 dmm_mem_map_dump(struct dmm_object *dmm_mgr)
 {
-	struct map_page *curr_node = NULL;
-	u32 i;
-	u32 freemem = 0;
-	u32 bigsize = 0;
+	struct dmm_stats stats;
 
-	spin_lock(&dmm_mgr->dmm_lock);
+	if (DSP_FAILED(dmm_get_stats(dmm_mgr, &stats)))
+		return 0;
 
-	if (virtual_mapping_table != NULL) {
-		for (i = 0; i < table_size; i +=
-		     virtual_mapping_table[i].region_size) {
-			curr_node = virtual_mapping_table + i;
-			if (curr_node->reserved == TRUE) {
-				/*printk("RESERVED size = 0x%x, "
-				   "Map size = 0x%x\n",
-				   (curr_node->region_size * PG_SIZE4K),
-				   (curr_node->mapped == false) ? 0 :
-				   (curr_node->mapped_size * PG_SIZE4K));
-				 */
-			} else {
-/*				printk("UNRESERVED size = 0x%x\n",
-					(curr_node->region_size * PG_SIZE4K));
- */
-				freemem += (curr_node->region_size * PG_SIZE4K);
-				if (curr_node->region_size > bigsize)
-					bigsize = curr_node->region_size;
-			}
-		}
-	}
-	spin_unlock(&dmm_mgr->dmm_lock);
 	printk(KERN_INFO "Total DSP VA FREE memory = %d Mbytes\n",
-	       freemem / (1024 * 1024));
+	       stats.free_bytes / (1024 * 1024));
 	printk(KERN_INFO "Total DSP VA USED memory= %d Mbytes\n",
-	       (((table_size * PG_SIZE4K) - freemem)) / (1024 * 1024));
-	printk(KERN_INFO "DSP VA - Biggest FREE block = %d Mbytes\n\n",
-	       (bigsize * PG_SIZE4K / (1024 * 1024)));
+	       (stats.pool_size - stats.free_bytes) / (1024 * 1024));
+	printk(KERN_INFO "DSP VA - Biggest FREE block = %d Mbytes\n",
+	       stats.largest_free / (1024 * 1024));
+	printk(KERN_INFO "DSP VA - %u free regions, %u chunks, "
+	       "%u mapped blocks\n\n", stats.free_regions,
+	       stats.reserved_regions, stats.mapped_blocks);
 
 	return 0;
 }
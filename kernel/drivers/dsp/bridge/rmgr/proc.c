@@ -401,6 +401,9 @@ int proc_detach(struct process_context *pr_ctxt)
 	p_proc_object = (struct proc_object *)pr_ctxt->hprocessor;
 
 	if (p_proc_object) {
+		/* Release the buffers this process left in the map cache */
+		(void)(*p_proc_object->intf_fxns->pfn_dev_cntrl)
+		    (p_proc_object->hwmd_context, WMDIOCTL_MAPCACHE_FLUSH, NULL);
 		if (p_proc_object->ntfy_obj) {
 			/* Notify the Client */
 			ntfy_notify(p_proc_object->ntfy_obj,
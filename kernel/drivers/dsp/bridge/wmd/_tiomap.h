@@ -355,6 +355,16 @@ struct wmd_dev_context {
 	bool tc_word_swap_on;	/* Traffic Controller Word Swap */
 	struct pg_table_attrs *pt_attrs;
 	u32 dsp_per_clks;
+
+	/* User buffer mappings kept for reuse, see map_cache_lookup() */
+	struct mutex map_cache_lock;
+	struct list_head map_cache;
+	u32 map_cache_entries;
+	u32 map_cache_idle_bytes;
+	u32 map_cache_hits;
+	u32 map_cache_misses;
+	u32 map_cache_evictions;
+	struct dentry *map_cache_dbg;
 };
 
 	/*
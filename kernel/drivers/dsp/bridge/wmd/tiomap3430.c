@@ -20,6 +20,7 @@
 #include <dspbridge/host_os.h>
 #include <linux/mm.h>
 #include <linux/mmzone.h>
+#include <linux/debugfs.h>
 #include <plat/control.h>
 
 /*  ----------------------------------- DSP/BIOS Bridge */
@@ -73,6 +74,28 @@
 
 #define MMU_GFLUSH 0x60
 
+/* Pages pinned per get_user_pages() call when mapping a user buffer */
+#define MAP_GUP_BATCH		32
+/* Limits for unmapped user buffers kept in the map cache */
+#define MAP_CACHE_MAX_ENTRIES	32
+#define MAP_CACHE_MAX_BYTES	SZ_32M
+
+/*
+ * A user buffer mapped by bridge_brd_mem_map(). On unmap its DSP MMU
+ * entries and page references are kept, so that mapping the same buffer
+ * again is a lookup plus a check that the user VA still points at the
+ * pages the DSP MMU maps.
+ */
+struct map_cache_entry {
+	struct list_head link;
+	struct mm_struct *mm;
+	u32 mpu_addr;
+	u32 dsp_addr;
+	u32 size;
+	u32 attrs;
+	bool in_use;
+};
+
 /* Forward Declarations: */
 static int bridge_brd_monitor(struct wmd_dev_context *dev_context);
 static int bridge_brd_read(struct wmd_dev_context *dev_context,
@@ -107,7 +130,18 @@ static int bridge_dev_create(OUT struct wmd_dev_context **ppDevContext,
 static int bridge_dev_ctrl(struct wmd_dev_context *dev_context,
 				  u32 dw_cmd, IN OUT void *pargs);
 static int bridge_dev_destroy(struct wmd_dev_context *dev_context);
-static u32 user_va2_pa(struct mm_struct *mm, u32 address);
+static int map_pages(struct wmd_dev_context *dev_context,
+			  u32 ul_mpu_addr, u32 ulVirtAddr,
+			  u32 ul_num_bytes, u32 ul_map_attr);
+static int unmap_pages(struct wmd_dev_context *dev_context,
+			     u32 ulVirtAddr, u32 ul_num_bytes);
+static u32 user_va2_pa(struct mm_struct *mm, u32 address, bool write);
+static u32 pte_lookup(struct pg_table_attrs *pt, u32 va);
+static u32 release_run(struct wmd_dev_context *dev_context, u32 pa, u32 va,
+		       u32 size);
+static void map_cache_debugfs_init(struct wmd_dev_context *dev_context);
+static void map_cache_flush(struct wmd_dev_context *dev_context);
+static void map_cache_drop(struct wmd_dev_context *dev_context);
 static int pte_update(struct wmd_dev_context *hDevContext, u32 pa,
 			     u32 va, u32 size,
 			     struct hw_mmu_map_attrs_t *map_attrs);
@@ -759,6 +793,7 @@ static int bridge_brd_stop(struct wmd_dev_context *hDevContext)
 #endif
 
 	/* This is a good place to clear the MMU page tables as well */
+	map_cache_drop(dev_context);
 	if (dev_context->pt_attrs) {
 		pt_attrs = dev_context->pt_attrs;
 		memset((u8 *) pt_attrs->l1_base_va, 0x00, pt_attrs->l1_size);
@@ -818,6 +853,7 @@ static int wmd_brd_delete(struct wmd_dev_context *hDevContext)
 	dev_context->dw_brd_state = BRD_STOPPED;	/* update board state */
 
 	/* This is a good place to clear the MMU page tables as well */
+	map_cache_drop(dev_context);
 	if (dev_context->pt_attrs) {
 		pt_attrs = dev_context->pt_attrs;
 		memset((u8 *) pt_attrs->l1_base_va, 0x00, pt_attrs->l1_size);
@@ -1023,6 +1059,9 @@ static int bridge_dev_create(OUT struct wmd_dev_context **ppDevContext,
 		/* Store current board state. */
 		dev_context->dw_brd_state = BRD_STOPPED;
 		dev_context->resources = resources;
+		mutex_init(&dev_context->map_cache_lock);
+		INIT_LIST_HEAD(&dev_context->map_cache);
+		map_cache_debugfs_init(dev_context);
 		/* Return ptr to our device state to the WCD for storage */
 		*ppDevContext = dev_context;
 	} else {
@@ -1070,6 +1109,9 @@ static int bridge_dev_ctrl(struct wmd_dev_context *dev_context,
 		for (ndx = 0; ndx < WMDIOCTL_NUMOFMMUTLB; ndx++, pa_ext_proc++)
 			dev_context->atlb_entry[ndx] = *pa_ext_proc;
 		break;
+	case WMDIOCTL_MAPCACHE_FLUSH:
+		map_cache_flush(dev_context);
+		break;
 	case WMDIOCTL_DEEPSLEEP:
 	case WMDIOCTL_EMERGENCYSLEEP:
 		/* Currently only DSP Idle is supported Need to update for
@@ -1123,6 +1165,8 @@ static int bridge_dev_destroy(struct wmd_dev_context *hDevContext)
 
 	/* first put the device to stop state */
 	wmd_brd_delete(dev_context);
+	map_cache_drop(dev_context);
+	debugfs_remove_recursive(dev_context->map_cache_dbg);
 	if (dev_context->pt_attrs) {
 		pt_attrs = dev_context->pt_attrs;
 		kfree(pt_attrs->pg_info);
@@ -1268,37 +1312,285 @@ static int bridge_brd_mem_write(struct wmd_dev_context *hDevContext,
 	return status;
 }
 
+/*
+ *  ======== map_cache_debugfs_init ========
+ *      Exports the map cache counters and the DMM statistics in debugfs.
+ */
+static void map_cache_debugfs_init(struct wmd_dev_context *dev_context)
+{
+	struct dentry *d;
+
+	d = debugfs_create_dir("dspbridge", NULL);
+	if (IS_ERR_OR_NULL(d))
+		return;
+
+	debugfs_create_u32("map_cache_hits", S_IRUGO, d,
+			   &dev_context->map_cache_hits);
+	debugfs_create_u32("map_cache_misses", S_IRUGO, d,
+			   &dev_context->map_cache_misses);
+	debugfs_create_u32("map_cache_evictions", S_IRUGO, d,
+			   &dev_context->map_cache_evictions);
+	debugfs_create_u32("map_cache_entries", S_IRUGO, d,
+			   &dev_context->map_cache_entries);
+	debugfs_create_u32("map_cache_idle_bytes", S_IRUGO, d,
+			   &dev_context->map_cache_idle_bytes);
+	dmm_debugfs_init(d);
+	dev_context->map_cache_dbg = d;
+}
+
+static void map_cache_free(struct wmd_dev_context *dev_context,
+			   struct map_cache_entry *e)
+{
+	list_del(&e->link);
+	dev_context->map_cache_entries--;
+	mmdrop(e->mm);
+	kfree(e);
+}
+
+/* Unmaps an idle entry from the DSP MMU and drops its page references */
+static void map_cache_evict(struct wmd_dev_context *dev_context,
+			    struct map_cache_entry *e)
+{
+	DBC_REQUIRE(!e->in_use);
+
+	unmap_pages(dev_context, e->dsp_addr, e->size);
+	dev_context->map_cache_idle_bytes -= e->size;
+	dev_context->map_cache_evictions++;
+	map_cache_free(dev_context, e);
+}
+
+/* Checks that the user VA of an entry still points at the mapped pages */
+static bool map_cache_valid(struct wmd_dev_context *dev_context,
+			    struct map_cache_entry *e)
+{
+	struct vm_area_struct *vma;
+	bool write;
+	bool valid = true;
+	u32 pa;
+	u32 off;
+
+	down_read(&e->mm->mmap_sem);
+	vma = find_vma(e->mm, e->mpu_addr);
+	if (!vma || vma->vm_start > e->mpu_addr) {
+		up_read(&e->mm->mmap_sem);
+		return false;
+	}
+	/* A page shared for COW since the map would not see DSP writes */
+	write = !(vma->vm_flags & VM_IO) &&
+	    (vma->vm_flags & (VM_WRITE | VM_MAYWRITE));
+	for (off = 0; off < e->size; off += PG_SIZE4K) {
+		pa = user_va2_pa(e->mm, e->mpu_addr + off, write);
+		if (!pa || pa != pte_lookup(dev_context->pt_attrs,
+					    e->dsp_addr + off)) {
+			valid = false;
+			break;
+		}
+	}
+	up_read(&e->mm->mmap_sem);
+
+	return valid;
+}
+
+/*
+ *  ======== map_cache_lookup ========
+ *      Reuses an idle mapping of the same user buffer at the same DSP VA.
+ *      Returns true if the buffer is mapped.
+ */
+static bool map_cache_lookup(struct wmd_dev_context *dev_context,
+			     u32 ul_mpu_addr, u32 ulVirtAddr,
+			     u32 ul_num_bytes, u32 ul_map_attr)
+{
+	struct map_cache_entry *e;
+
+	list_for_each_entry(e, &dev_context->map_cache, link) {
+		if (e->mm != current->mm || e->mpu_addr != ul_mpu_addr ||
+		    e->size != ul_num_bytes)
+			continue;
+		if (e->in_use || e->dsp_addr != ulVirtAddr ||
+		    e->attrs != ul_map_attr)
+			continue;
+
+		if (!map_cache_valid(dev_context, e)) {
+			map_cache_evict(dev_context, e);
+			break;
+		}
+		e->in_use = true;
+		dev_context->map_cache_idle_bytes -= e->size;
+		list_move(&e->link, &dev_context->map_cache);
+		dev_context->map_cache_hits++;
+		return true;
+	}
+	dev_context->map_cache_misses++;
+
+	return false;
+}
+
+/* Tracks a new user buffer mapping; it is simply not cached on failure */
+static void map_cache_add(struct wmd_dev_context *dev_context,
+			  u32 ul_mpu_addr, u32 ulVirtAddr,
+			  u32 ul_num_bytes, u32 ul_map_attr)
+{
+	struct map_cache_entry *e;
+
+	e = kmalloc(sizeof(struct map_cache_entry), GFP_KERNEL);
+	if (!e)
+		return;
+
+	e->mm = current->mm;
+	atomic_inc(&e->mm->mm_count);
+	e->mpu_addr = ul_mpu_addr;
+	e->dsp_addr = ulVirtAddr;
+	e->size = ul_num_bytes;
+	e->attrs = ul_map_attr;
+	e->in_use = true;
+	list_add(&e->link, &dev_context->map_cache);
+	dev_context->map_cache_entries++;
+}
+
+/* Evicts the idle entries that overlap a DSP VA range about to be mapped */
+static void map_cache_evict_range(struct wmd_dev_context *dev_context,
+				  u32 ulVirtAddr, u32 ul_num_bytes)
+{
+	struct map_cache_entry *e, *tmp;
+
+	list_for_each_entry_safe(e, tmp, &dev_context->map_cache, link) {
+		if (!e->in_use && e->dsp_addr < ulVirtAddr + ul_num_bytes &&
+		    ulVirtAddr < e->dsp_addr + e->size)
+			map_cache_evict(dev_context, e);
+	}
+}
+
+/* Evicts the least recently used idle entries beyond the cache limits */
+static void map_cache_trim(struct wmd_dev_context *dev_context)
+{
+	struct map_cache_entry *e, *tmp;
+
+	list_for_each_entry_safe_reverse(e, tmp, &dev_context->map_cache,
+					 link) {
+		if (dev_context->map_cache_idle_bytes <= MAP_CACHE_MAX_BYTES &&
+		    dev_context->map_cache_entries <= MAP_CACHE_MAX_ENTRIES)
+			break;
+		if (!e->in_use)
+			map_cache_evict(dev_context, e);
+	}
+}
+
+/*
+ *  ======== map_cache_flush ========
+ *      Evicts the idle entries of the calling process and of processes
+ *      that have exited. Called when a process detaches.
+ */
+static void map_cache_flush(struct wmd_dev_context *dev_context)
+{
+	struct map_cache_entry *e, *tmp;
+
+	mutex_lock(&dev_context->map_cache_lock);
+	list_for_each_entry_safe(e, tmp, &dev_context->map_cache, link) {
+		if (!e->in_use && (e->mm == current->mm ||
+				   !atomic_read(&e->mm->mm_users)))
+			map_cache_evict(dev_context, e);
+	}
+	mutex_unlock(&dev_context->map_cache_lock);
+}
+
+/*
+ *  ======== map_cache_drop ========
+ *      Forgets all entries before the DSP MMU page tables are cleared.
+ *      The pages of idle entries are released here, without touching the
+ *      DSP MMU, which may already be off.
+ */
+static void map_cache_drop(struct wmd_dev_context *dev_context)
+{
+	struct map_cache_entry *e, *tmp;
+	struct page *pg;
+	u32 pa;
+	u32 off;
+
+	mutex_lock(&dev_context->map_cache_lock);
+	list_for_each_entry_safe(e, tmp, &dev_context->map_cache, link) {
+		for (off = 0; !e->in_use && off < e->size; off += PG_SIZE4K) {
+			pa = pte_lookup(dev_context->pt_attrs,
+					e->dsp_addr + off);
+			if (!pa || !pfn_valid(__phys_to_pfn(pa)))
+				continue;
+			pg = phys_to_page(pa);
+			SetPageDirty(pg);
+			page_cache_release(pg);
+		}
+		map_cache_free(dev_context, e);
+	}
+	dev_context->map_cache_idle_bytes = 0;
+	mutex_unlock(&dev_context->map_cache_lock);
+}
+
 /*
  *  ======== bridge_brd_mem_map ========
+ *      Maps an MPU buffer to the DSP address space. A user buffer that is
+ *      still mapped from a previous map/unmap cycle is reused.
+ */
+static int bridge_brd_mem_map(struct wmd_dev_context *hDevContext,
+				  u32 ul_mpu_addr, u32 ulVirtAddr,
+				  u32 ul_num_bytes, u32 ul_map_attr)
+{
+	struct wmd_dev_context *dev_context = hDevContext;
+	bool user = !(ul_map_attr & (DSP_MAPVMALLOCADDR |
+				     DSP_MAPPHYSICALADDR));
+	int status;
+
+	mutex_lock(&dev_context->map_cache_lock);
+	if (user && ul_num_bytes &&
+	    map_cache_lookup(dev_context, ul_mpu_addr, ulVirtAddr,
+			     ul_num_bytes, ul_map_attr)) {
+		mutex_unlock(&dev_context->map_cache_lock);
+		return 0;
+	}
+
+	map_cache_evict_range(dev_context, ulVirtAddr, ul_num_bytes);
+	status = map_pages(dev_context, ul_mpu_addr, ulVirtAddr, ul_num_bytes,
+			 ul_map_attr);
+	if (user && DSP_SUCCEEDED(status))
+		map_cache_add(dev_context, ul_mpu_addr, ulVirtAddr,
+			      ul_num_bytes, ul_map_attr);
+	mutex_unlock(&dev_context->map_cache_lock);
+
+	return status;
+}
+
+/*
+ *  ======== map_pages ========
  *      This function maps MPU buffer to the DSP address space. It performs
- *  linear to physical address translation if required. It translates each
- *  page since linear addresses can be physically non-contiguous
+ *  linear to physical address translation if required. Physically
+ *  contiguous runs of pages are handed to pte_update(), which uses the
+ *  largest DSP MMU pages (64 KB / 1 MB) the alignment allows.
  *  All address & size arguments are assumed to be page aligned (in proc.c)
  *
  *  TODO: Disable MMU while updating the page tables (but that'll stall DSP)
  */
-static int bridge_brd_mem_map(struct wmd_dev_context *hDevContext,
-				  u32 ul_mpu_addr, u32 ulVirtAddr,
-				  u32 ul_num_bytes, u32 ul_map_attr)
+static int map_pages(struct wmd_dev_context *dev_context,
+			  u32 ul_mpu_addr, u32 ulVirtAddr,
+			  u32 ul_num_bytes, u32 ul_map_attr)
 {
 	u32 attrs;
 	int status = 0;
-	struct wmd_dev_context *dev_context = hDevContext;
 	struct hw_mmu_map_attrs_t hw_attrs;
 	struct vm_area_struct *vma;
 	struct mm_struct *mm = current->mm;
 	u32 write = 0;
 	u32 num_usr_pgs = 0;
-	struct page *mapped_page, *pg;
+	struct page *pages[MAP_GUP_BATCH];
+	struct page *pg;
 	s32 pg_num;
 	u32 va = ulVirtAddr;
 	struct task_struct *curr_task = current;
 	u32 pg_i = 0;
 	u32 mpu_addr, pa;
+	u32 run_pa = 0;
+	u32 run_size = 0;
+	u32 i;
 
 	dev_dbg(bridge,
 		"%s hDevCtxt %p, pa %x, va %x, size %x, ul_map_attr %x\n",
-		__func__, hDevContext, ul_mpu_addr, ulVirtAddr, ul_num_bytes,
+		__func__, dev_context, ul_mpu_addr, ulVirtAddr, ul_num_bytes,
 		ul_map_attr);
 	if (ul_num_bytes == 0)
 		return -EINVAL;
@@ -1345,7 +1637,7 @@ static int bridge_brd_mem_map(struct wmd_dev_context *hDevContext,
 		hw_attrs.donotlockmpupage = 0;
 
 	if (attrs & DSP_MAPVMALLOCADDR) {
-		return mem_map_vmalloc(hDevContext, ul_mpu_addr, ulVirtAddr,
+		return mem_map_vmalloc(dev_context, ul_mpu_addr, ulVirtAddr,
 				       ul_num_bytes, &hw_attrs);
 	}
 	/*
@@ -1400,66 +1692,122 @@ static int bridge_brd_mem_map(struct wmd_dev_context *hDevContext,
 		mpu_addr = ul_mpu_addr;
 
 		/* Get the physical addresses for user buffer */
-		for (pg_i = 0; pg_i < num_usr_pgs; pg_i++) {
-			pa = user_va2_pa(mm, mpu_addr);
+		while (pg_i < num_usr_pgs) {
+			pa = user_va2_pa(mm, mpu_addr, false);
 			if (!pa) {
 				status = -EPERM;
 				pr_err("DSPBRIDGE: VM_IO mapping physical"
 				       "address is invalid\n");
 				break;
 			}
-			if (pfn_valid(__phys_to_pfn(pa))) {
-				pg = phys_to_page(pa);
+			/* Extend the run while it stays physically contiguous */
+			for (run_size = PG_SIZE4K;
+			     pg_i + run_size / PG_SIZE4K < num_usr_pgs;
+			     run_size += PG_SIZE4K) {
+				if (user_va2_pa(mm, mpu_addr + run_size, false) !=
+				    pa + run_size)
+					break;
+			}
+			for (i = 0; i < run_size; i += PG_SIZE4K) {
+				if (!pfn_valid(__phys_to_pfn(pa + i)))
+					continue;
+				pg = phys_to_page(pa + i);
 				get_page(pg);
 				if (page_count(pg) < 1) {
 					pr_err("Bad page in VM_IO buffer\n");
-					bad_page_dump(pa, pg);
+					bad_page_dump(pa + i, pg);
 				}
 			}
-			status = pte_set(dev_context->pt_attrs, pa,
-					 va, HW_PAGE_SIZE4KB, &hw_attrs);
-			if (DSP_FAILED(status))
+			status = pte_update(dev_context, pa, va, run_size,
+					    &hw_attrs);
+			if (DSP_FAILED(status)) {
+				pg_i += release_run(dev_context, pa, va,
+						    run_size) / PG_SIZE4K;
 				break;
+			}
 
-			va += HW_PAGE_SIZE4KB;
-			mpu_addr += HW_PAGE_SIZE4KB;
-			pa += HW_PAGE_SIZE4KB;
+			va += run_size;
+			mpu_addr += run_size;
+			pg_i += run_size / PG_SIZE4K;
 		}
 	} else {
-		num_usr_pgs = ul_num_bytes / PG_SIZE4K;
 		if (vma->vm_flags & (VM_WRITE | VM_MAYWRITE))
 			write = 1;
 
-		for (pg_i = 0; pg_i < num_usr_pgs; pg_i++) {
-			pg_num = get_user_pages(curr_task, mm, ul_mpu_addr, 1,
-						write, 1, &mapped_page, NULL);
-			if (pg_num > 0) {
-				if (page_count(mapped_page) < 1) {
-					pr_err("Bad page count after doing"
-					       "get_user_pages on"
-					       "user buffer\n");
-					bad_page_dump(page_to_phys(mapped_page),
-						      mapped_page);
-				}
-				status = pte_set(dev_context->pt_attrs,
-						 page_to_phys(mapped_page), va,
-						 HW_PAGE_SIZE4KB, &hw_attrs);
-				if (DSP_FAILED(status))
-					break;
-
-				va += HW_PAGE_SIZE4KB;
-				ul_mpu_addr += HW_PAGE_SIZE4KB;
-			} else {
+		/*
+		 * Pin the buffer MAP_GUP_BATCH pages at a time and map each
+		 * physically contiguous run once it ends. pg_i counts the
+		 * pages mapped so far, for the roll back below.
+		 */
+		mpu_addr = ul_mpu_addr;
+		while (mpu_addr < ul_mpu_addr + ul_num_bytes) {
+			num_usr_pgs = min_t(u32, MAP_GUP_BATCH,
+					    (ul_mpu_addr + ul_num_bytes -
+					     mpu_addr) / PG_SIZE4K);
+			pg_num = get_user_pages(curr_task, mm, mpu_addr,
+						num_usr_pgs, write, 1, pages,
+						NULL);
+			if (pg_num <= 0) {
 				pr_err("DSPBRIDGE: get_user_pages FAILED,"
 				       "MPU addr = 0x%x,"
 				       "vma->vm_flags = 0x%lx,"
 				       "get_user_pages Err"
 				       "Value = %d, Buffer"
-				       "size=0x%x\n", ul_mpu_addr,
+				       "size=0x%x\n", mpu_addr,
 				       vma->vm_flags, pg_num, ul_num_bytes);
 				status = -EPERM;
 				break;
 			}
+			mpu_addr += pg_num * PG_SIZE4K;
+
+			for (i = 0; i < pg_num; i++) {
+				pa = page_to_phys(pages[i]);
+				if (page_count(pages[i]) < 1) {
+					pr_err("Bad page count after doing"
+					       "get_user_pages on"
+					       "user buffer\n");
+					bad_page_dump(pa, pages[i]);
+				}
+				if (run_size && pa == run_pa + run_size) {
+					run_size += PG_SIZE4K;
+					continue;
+				}
+				if (run_size) {
+					status = pte_update(dev_context, run_pa,
+							    va, run_size,
+							    &hw_attrs);
+					if (DSP_FAILED(status))
+						break;
+					va += run_size;
+					pg_i += run_size / PG_SIZE4K;
+				}
+				run_pa = pa;
+				run_size = PG_SIZE4K;
+			}
+			if (DSP_FAILED(status)) {
+				/*
+				 * Unpin the unmapped part of the failed run
+				 * and the pages after it, which never got
+				 * into a run.
+				 */
+				pg_i += release_run(dev_context, run_pa, va,
+						    run_size) / PG_SIZE4K;
+				while (i < pg_num)
+					page_cache_release(pages[i++]);
+				run_size = 0;
+				break;
+			}
+		}
+		/* Map the last run, also when pinning failed after it */
+		if (run_size) {
+			if (DSP_SUCCEEDED(pte_update(dev_context, run_pa, va,
+						     run_size, &hw_attrs))) {
+				pg_i += run_size / PG_SIZE4K;
+			} else {
+				pg_i += release_run(dev_context, run_pa, va,
+						    run_size) / PG_SIZE4K;
+				status = -EPERM;
+			}
 		}
 	}
 	up_read(&mm->mmap_sem);
@@ -1472,10 +1820,8 @@ func_cont:
 		 * Roll out the mapped pages incase it failed in middle of
 		 * mapping
 		 */
-		if (pg_i) {
-			bridge_brd_mem_un_map(dev_context, ulVirtAddr,
-					   (pg_i * PG_SIZE4K));
-		}
+		if (pg_i)
+			unmap_pages(dev_context, ulVirtAddr, (pg_i * PG_SIZE4K));
 		status = -EPERM;
 	}
 	/*
@@ -1491,14 +1837,44 @@ func_cont:
 
 /*
  *  ======== bridge_brd_mem_un_map ========
+ *      Unmaps a DSP VA block. A user buffer mapping is kept in the map
+ *      cache instead, until it is reused or evicted.
+ */
+static int bridge_brd_mem_un_map(struct wmd_dev_context *hDevContext,
+				     u32 ulVirtAddr, u32 ul_num_bytes)
+{
+	struct wmd_dev_context *dev_context = hDevContext;
+	struct map_cache_entry *e;
+	int status;
+
+	mutex_lock(&dev_context->map_cache_lock);
+	list_for_each_entry(e, &dev_context->map_cache, link) {
+		if (e->in_use && e->dsp_addr == ulVirtAddr &&
+		    e->size == ul_num_bytes) {
+			e->in_use = false;
+			dev_context->map_cache_idle_bytes += e->size;
+			list_move(&e->link, &dev_context->map_cache);
+			map_cache_trim(dev_context);
+			mutex_unlock(&dev_context->map_cache_lock);
+			return 0;
+		}
+	}
+	status = unmap_pages(dev_context, ulVirtAddr, ul_num_bytes);
+	mutex_unlock(&dev_context->map_cache_lock);
+
+	return status;
+}
+
+/*
+ *  ======== unmap_pages ========
  *      Invalidate the PTEs for the DSP VA block to be unmapped.
  *
  *      PTEs of a mapped memory block are contiguous in any page table
  *      So, instead of looking up the PTE address for every 4K block,
  *      we clear consecutive PTEs until we unmap all the bytes
  */
-static int bridge_brd_mem_un_map(struct wmd_dev_context *hDevContext,
-				     u32 ulVirtAddr, u32 ul_num_bytes)
+static int unmap_pages(struct wmd_dev_context *hDevContext,
+			     u32 ulVirtAddr, u32 ul_num_bytes)
 {
 	u32 l1_base_va;
 	u32 l2_base_va;
@@ -1695,7 +2071,7 @@ EXIT_LOOP:
  *      This function walks through the Linux page tables to convert a userland
  *      virtual address to physical address
  */
-static u32 user_va2_pa(struct mm_struct *mm, u32 address)
+static u32 user_va2_pa(struct mm_struct *mm, u32 address, bool write)
 {
 	pgd_t *pgd;
 	pmd_t *pmd;
@@ -1708,7 +2084,8 @@ static u32 user_va2_pa(struct mm_struct *mm, u32 address)
 			ptep = pte_offset_map(pmd, address);
 			if (ptep) {
 				pte = *ptep;
-				if (pte_present(pte))
+				if (pte_present(pte) &&
+				    (!write || pte_write(pte)))
 					return pte & PAGE_MASK;
 			}
 		}
@@ -1717,6 +2094,53 @@ static u32 user_va2_pa(struct mm_struct *mm, u32 address)
 	return 0;
 }
 
+/*
+ *  ======== pte_lookup ========
+ *      Returns the MPU PA that the DSP MMU maps a DSP VA to, 0 if none.
+ */
+static u32 pte_lookup(struct pg_table_attrs *pt, u32 va)
+{
+	u32 pte_val;
+	u32 pte_size;
+	u32 l2_base_va;
+
+	pte_val = *(u32 *) hw_mmu_pte_addr_l1(pt->l1_base_va, va);
+	pte_size = hw_mmu_pte_size_l1(pte_val);
+	if (pte_size == HW_MMU_COARSE_PAGE_SIZE) {
+		l2_base_va = hw_mmu_pte_coarse_l1(pte_val) - pt->l2_base_pa +
+		    pt->l2_base_va;
+		pte_val = *(u32 *) hw_mmu_pte_addr_l2(l2_base_va, va);
+		pte_size = hw_mmu_pte_size_l2(pte_val);
+	}
+	if (!pte_size)
+		return 0;
+
+	return (pte_val & ~(pte_size - 1)) | (va & (pte_size - 1));
+}
+
+/*
+ * Unpin the pages of a run that pte_update() failed to map. The part of
+ * the run that did get mapped is left pinned for unmap_pages(); its size
+ * is returned so that the caller can roll it back with the rest.
+ */
+static u32 release_run(struct wmd_dev_context *dev_context, u32 pa, u32 va,
+		       u32 size)
+{
+	struct pg_table_attrs *pt = dev_context->pt_attrs;
+	u32 mapped = 0;
+	u32 i;
+
+	while (mapped < size && pte_lookup(pt, va + mapped) == pa + mapped)
+		mapped += PG_SIZE4K;
+
+	for (i = mapped; i < size; i += PG_SIZE4K) {
+		if (pfn_valid(__phys_to_pfn(pa + i)))
+			page_cache_release(phys_to_page(pa + i));
+	}
+
+	return mapped;
+}
+
 /*
  *  ======== pte_update ========
  *      This function calculates the optimum page-aligned addresses and sizes
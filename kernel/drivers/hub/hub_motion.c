@@ -29,6 +29,9 @@
 #include <linux/ioctl.h>
 #include <linux/miscdevice.h>
 #include <linux/regulator/consumer.h>
+#include <linux/hrtimer.h>
+#include <linux/mutex.h>
+#include <linux/spinlock.h>
 #ifdef CONFIG_ARCH_OMAP
 #include <mach/gpio.h>
 #endif
@@ -54,26 +57,40 @@
 //#define MAX_LGE_ACCEL_SAMPLERATE    7  /* for JSR256 API */
 
 
+/*
+ * Polled sensors. They share one hrtimer and one work: the timer expires
+ * when the earliest sensor is due, and every sensor due at that time is
+ * reported in the same pass of the work.
+ */
+enum {
+	MOTION_POLL_ACCEL = 0,
+	MOTION_POLL_TILT,
+	MOTION_POLL_GYRO,
+	MOTION_POLL_COMPASS,
+	MOTION_POLL_COMPOSITE,
+	MOTION_POLL_MAX,
+};
+
 struct heaven_motion_device {
 	struct input_dev            *input_dev;         
 	struct input_dev            *input_dev1;	 /* motion daemon process */	       
-	struct hrtimer              timer[5];        /* [0] acceleroemter raw data, [1] tilt , [2] Gyro, [3] Compass, [4] composite */
 
-	struct work_struct     		accel_work;
-	struct workqueue_struct	 	*accel_wq;
-	
-	struct work_struct     		tilt_work;
-	struct workqueue_struct	 	*tilt_wq;
-	
-	struct work_struct     		gyro_work;
-	struct workqueue_struct	 	*gyro_wq;
-	
-	struct work_struct     		compass_work;
-	struct workqueue_struct	 	*compass_wq;
+	struct hrtimer              poll_timer;
+	struct work_struct          poll_work;
+	struct workqueue_struct     *poll_wq;
+
+	struct mutex                poll_mutex;      /* serializes reschedules */
+	spinlock_t                  poll_lock;       /* protects the fields below */
+	unsigned int                poll_period[MOTION_POLL_MAX];	/* ms, 0 if off */
+	ktime_t                     poll_next[MOTION_POLL_MAX];	/* when due next */
+	unsigned int                poll_pending;    /* MOTION_POLL_* bits */
+	ktime_t                     poll_stamp;      /* when poll_pending was due */
+	int                         poll_suspended;
+
+	/* what the shared timer saves: one wakeup used to be one poll */
+	unsigned long               poll_wakeups;
+	unsigned long               poll_count;
 
-	struct work_struct     		composite_work;
-	struct workqueue_struct	 	*composite_wq;
-	
 	int  irq;
 	int  use_irq;
 
@@ -119,6 +136,22 @@ static atomic_t   gyro_x, gyro_y, gyro_z;
 static atomic_t	   mag_x, mag_y, mag_z;
 static atomic_t composite[3];
 
+static atomic_t *motion_poll_flag[MOTION_POLL_MAX] = {
+	[MOTION_POLL_ACCEL]	= &accel_flag,
+	[MOTION_POLL_TILT]	= &tilt_flag,
+	[MOTION_POLL_GYRO]	= &gyro_flag,
+	[MOTION_POLL_COMPASS]	= &compass_flag,
+	[MOTION_POLL_COMPOSITE]	= &composite_flag,
+};
+
+static atomic_t *motion_poll_delay[MOTION_POLL_MAX] = {
+	[MOTION_POLL_ACCEL]	= &accel_delay,
+	[MOTION_POLL_TILT]	= &tilt_delay,
+	[MOTION_POLL_GYRO]	= &gyro_delay,
+	[MOTION_POLL_COMPASS]	= &compass_delay,
+	[MOTION_POLL_COMPOSITE]	= &composite_delay,
+};
+
 #ifdef CONFIG_HAS_EARLYSUSPEND
 static void mpu3050_early_suspend(struct early_suspend *h);
 static void mpu3050_late_resume(struct early_suspend *h);
@@ -333,9 +366,9 @@ void motion_send_yawimage_detection(int direction)
 
 
 /*---------------------------------------------------------------------------
-	 work function
+	 poll function
    ---------------------------------------------------------------------------*/		  
-static void motion_accel_work_func(struct work_struct *work)                         
+static void motion_accel_poll(void)
 {
 	int current_x = 0, current_y = 0, current_z = 0;
 	u8 raw_data[6]; // xyz data bytes from hardware
@@ -366,7 +399,7 @@ static void motion_accel_work_func(struct work_struct *work)
 	motion_send_accel_detection(current_x,current_y,current_z);
 	
 }
-static void motion_tilt_work_func(struct work_struct *work)                         
+static void motion_tilt_poll(void)
 {
 	int current_yaw = 0, current_pitch = 0, current_roll = 0;
 	int data[12] = {0,};
@@ -380,7 +413,7 @@ static void motion_tilt_work_func(struct work_struct *work)
 	motion_send_tilt_detection(current_yaw, current_pitch, current_roll);
 }
 
-static void motion_gyro_work_func(struct work_struct *work)
+static void motion_gyro_poll(void)
 {
 	int current_x = 0, current_y = 0, current_z = 0;
 
@@ -392,7 +425,7 @@ static void motion_gyro_work_func(struct work_struct *work)
 
 }
 
-static void motion_compass_work_func(struct work_struct *work)
+static void motion_compass_poll(void)
 {
 	int mag_val[3];
 
@@ -405,7 +438,7 @@ static void motion_compass_work_func(struct work_struct *work)
 }
 
 
-static void motion_composite_work_func(struct work_struct *work)
+static void motion_composite_poll(void)
 {
 	int data[3] = {0,};
 	int i = 0;
@@ -416,81 +449,129 @@ static void motion_composite_work_func(struct work_struct *work)
 	motion_send_composite_detection(data);
 
 }
-/*---------------------------------------------------------------------------
-	 motion polling timer
-   ---------------------------------------------------------------------------*/		  
-static enum hrtimer_restart motion_accel_timer_func(struct hrtimer *timer)
-{	
-	unsigned long  polling_time;   
-
-	if(atomic_read(&accel_flag))
-	{	
-		queue_work(heaven_motion_dev.accel_wq, &heaven_motion_dev.accel_work);
+static void (*motion_poll_func[MOTION_POLL_MAX])(void) = {
+	[MOTION_POLL_ACCEL]	= motion_accel_poll,
+	[MOTION_POLL_TILT]	= motion_tilt_poll,
+	[MOTION_POLL_GYRO]	= motion_gyro_poll,
+	[MOTION_POLL_COMPASS]	= motion_compass_poll,
+	[MOTION_POLL_COMPOSITE]	= motion_composite_poll,
+};
 
-		polling_time = atomic_read(&accel_delay);
-		hrtimer_start(&heaven_motion_dev.timer[0], ktime_set(0,polling_time*1000000), HRTIMER_MODE_REL); 
+static void motion_poll_work_func(struct work_struct *work)
+{
+	unsigned int pending;
+	ktime_t stamp;
+	int i;
+
+	spin_lock_irq(&heaven_motion_dev.poll_lock);
+	pending = heaven_motion_dev.poll_pending;
+	stamp = heaven_motion_dev.poll_stamp;
+	heaven_motion_dev.poll_pending = 0;
+	spin_unlock_irq(&heaven_motion_dev.poll_lock);
+
+	for (i = 0; i < MOTION_POLL_MAX; i++) {
+		if (!(pending & (1 << i)) || !atomic_read(motion_poll_flag[i]))
+			continue;
+
+		/* when the sample was due, not when it got here */
+		input_event(heaven_motion_dev.input_dev, EV_MSC, MSC_TIMESTAMP,
+			    (int)ktime_to_us(stamp));
+		motion_poll_func[i]();
 	}
-
-    	return HRTIMER_NORESTART;
 }
 
-static enum hrtimer_restart motion_tilt_timer_func(struct hrtimer *timer)
-{	
-	unsigned long  polling_time;   
+/*---------------------------------------------------------------------------
+	 motion polling timer
+   ---------------------------------------------------------------------------*/		  
+static enum hrtimer_restart motion_poll_timer_func(struct hrtimer *timer)
+{
+	ktime_t expires = hrtimer_get_expires(timer);
+	ktime_t now = hrtimer_cb_get_time(timer);
+	ktime_t next = { .tv64 = KTIME_MAX };
+	unsigned int due = 0;
+	int i;
+
+	spin_lock(&heaven_motion_dev.poll_lock);
+
+	for (i = 0; i < MOTION_POLL_MAX; i++) {
+		if (!heaven_motion_dev.poll_period[i])
+			continue;
+
+		if (heaven_motion_dev.poll_next[i].tv64 <= expires.tv64) {
+			due |= 1 << i;
+			heaven_motion_dev.poll_count++;
+
+			/* step from when it was due, so that the polls do not drift */
+			heaven_motion_dev.poll_next[i] = ktime_add(heaven_motion_dev.poll_next[i],
+				ns_to_ktime((u64)heaven_motion_dev.poll_period[i] * NSEC_PER_MSEC));
+			/* but do not catch up after a long delay */
+			if (heaven_motion_dev.poll_next[i].tv64 <= now.tv64)
+				heaven_motion_dev.poll_next[i] = ktime_add(now,
+					ns_to_ktime((u64)heaven_motion_dev.poll_period[i] * NSEC_PER_MSEC));
+		}
 
-	if(atomic_read(&tilt_flag))
-	{	
-		queue_work(heaven_motion_dev.tilt_wq, &heaven_motion_dev.tilt_work);
+		if (heaven_motion_dev.poll_next[i].tv64 < next.tv64)
+			next = heaven_motion_dev.poll_next[i];
+	}
+	heaven_motion_dev.poll_wakeups++;
 
-		polling_time = atomic_read(&tilt_delay);
-		hrtimer_start(&heaven_motion_dev.timer[1], ktime_set(0,polling_time*1000000), HRTIMER_MODE_REL); 
+	if (due) {
+		heaven_motion_dev.poll_pending |= due;
+		heaven_motion_dev.poll_stamp = expires;
 	}
 
-    	return HRTIMER_NORESTART;
-}
+	spin_unlock(&heaven_motion_dev.poll_lock);
 
-static enum hrtimer_restart motion_gyro_timer_func(struct hrtimer *timer)
-{
-	unsigned long polling_time;
+	if (due)
+		queue_work(heaven_motion_dev.poll_wq, &heaven_motion_dev.poll_work);
 
-	if (atomic_read(&gyro_flag))
-	{
-		queue_work(heaven_motion_dev.gyro_wq, &heaven_motion_dev.gyro_work);
-
-		polling_time = atomic_read(&gyro_delay);
-		hrtimer_start(&heaven_motion_dev.timer[2],ktime_set(0,polling_time*1000000),HRTIMER_MODE_REL);
-	}
+	if (next.tv64 == KTIME_MAX)
+		return HRTIMER_NORESTART;
 
-	return HRTIMER_NORESTART;
+	/* sleep until the earliest sensor is due */
+	hrtimer_set_expires(timer, next);
+	return HRTIMER_RESTART;
 }
 
-static enum hrtimer_restart motion_compass_timer_func(struct hrtimer *timer)
+/*
+ * Restart the polls after a sensor was switched or its delay changed.
+ * All sensors start from the same instant, so that the ones with
+ * harmonic periods keep being due on the same timer expiry.
+ */
+static void motion_poll_reschedule(void)
 {
-	unsigned long polling_time;
+	unsigned int period[MOTION_POLL_MAX];
+	ktime_t now, next = { .tv64 = KTIME_MAX };
+	int i;
 
-	if (atomic_read(&compass_flag)) {
-		queue_work(heaven_motion_dev.compass_wq, &heaven_motion_dev.compass_work);
-
-		polling_time = atomic_read(&compass_delay);
-		hrtimer_start(&heaven_motion_dev.timer[3], ktime_set(0, polling_time * 1000000), HRTIMER_MODE_REL);
-	}
-
-	return HRTIMER_NORESTART;
-}
+	mutex_lock(&heaven_motion_dev.poll_mutex);
 
+	hrtimer_cancel(&heaven_motion_dev.poll_timer);
 
-static enum hrtimer_restart motion_composite_timer_func(struct hrtimer *timer)
-{
-	unsigned long polling_time;
-
-	if (atomic_read(&composite_flag)) {
-		queue_work(heaven_motion_dev.composite_wq, &heaven_motion_dev.composite_work);
+	for (i = 0; i < MOTION_POLL_MAX; i++) {
+		period[i] = 0;
+		if (atomic_read(motion_poll_flag[i]))
+			period[i] = atomic_read(motion_poll_delay[i]);
+	}
 
-		polling_time = atomic_read(&composite_delay);
-		hrtimer_start(&heaven_motion_dev.timer[4], ktime_set(0, polling_time * 1000000), HRTIMER_MODE_REL);
+	now = ktime_get();
+	spin_lock_irq(&heaven_motion_dev.poll_lock);
+	for (i = 0; i < MOTION_POLL_MAX; i++) {
+		heaven_motion_dev.poll_period[i] = period[i];
+		if (!period[i])
+			continue;
+
+		heaven_motion_dev.poll_next[i] = ktime_add(now,
+			ns_to_ktime((u64)period[i] * NSEC_PER_MSEC));
+		if (heaven_motion_dev.poll_next[i].tv64 < next.tv64)
+			next = heaven_motion_dev.poll_next[i];
 	}
+	spin_unlock_irq(&heaven_motion_dev.poll_lock);
+
+	if (next.tv64 != KTIME_MAX && !heaven_motion_dev.poll_suspended)
+		hrtimer_start(&heaven_motion_dev.poll_timer, next, HRTIMER_MODE_ABS);
 
-	return HRTIMER_NORESTART;
+	mutex_unlock(&heaven_motion_dev.poll_mutex);
 }
 
 /*---------------------------------------------------------------------------
@@ -517,6 +598,8 @@ static ssize_t motion_accel_onoff_store(struct device *dev,  struct device_attri
 		//atomic_set(&accel_z,0);
 	}
 
+	motion_poll_reschedule();
+
 	return count;
 	
 }
@@ -543,6 +626,8 @@ static ssize_t motion_tilt_onoff_store(struct device *dev,  struct device_attrib
 		atomic_set(&tilt_yaw,   0);
 	}
 
+	motion_poll_reschedule();
+
 	return count;
 	
 }
@@ -564,6 +649,8 @@ static ssize_t motion_gyro_onoff_store(struct device *dev, struct device_attribu
 		
 	}
 
+	motion_poll_reschedule();
+
 	return count;
 }
 
@@ -579,6 +666,8 @@ static ssize_t motion_compass_onoff_store(struct device *dev, struct device_attr
 		atomic_set(&compass_flag, 0);
 	}
 
+	motion_poll_reschedule();
+
 	return count;
 }
 
@@ -598,6 +687,8 @@ static ssize_t motion_composite_onoff_store(struct device *dev, struct device_at
 		atomic_set(&composite[2],  0);	
 	}
 
+	motion_poll_reschedule();
+
 	return count;
 }
 
@@ -722,15 +813,13 @@ static ssize_t motion_accel_delay_store(struct device *dev,  struct device_attri
 
 	if(atomic_read(&accel_flag))
 	{
-		hrtimer_cancel(&heaven_motion_dev.timer[0]);	   
-
 		if(current_delay < MIN_MOTION_POLLING_TIME)
 		{
 			current_delay = MIN_MOTION_POLLING_TIME;
 		}
 
 		atomic_set(&accel_delay, current_delay);
-		hrtimer_start(&heaven_motion_dev.timer[0], ktime_set(0,current_delay*1000000), HRTIMER_MODE_REL);
+		motion_poll_reschedule();
 	}
 
 	return count;
@@ -749,9 +838,6 @@ static ssize_t motion_tilt_delay_store(struct device *dev,  struct device_attrib
 
 	if(atomic_read(&tilt_flag))
 	{
-		hrtimer_cancel(&heaven_motion_dev.timer[1]);	   
-
-		
 		if(current_delay < MIN_MOTION_POLLING_TIME)
 		{
 			current_delay = MIN_MOTION_POLLING_TIME;
@@ -770,9 +856,7 @@ static ssize_t motion_tilt_delay_store(struct device *dev,  struct device_attrib
 		//printk("[motion_set_tilt_delay_store]  val [%d] current_delay[%ld]\n",val,current_delay);
 		
 		atomic_set(&tilt_delay, current_delay);
-		/* LGE_CHANGE_S sglee76@lge.com 2010-05-06 tilt delay */
-		hrtimer_start(&heaven_motion_dev.timer[1], ktime_set(0,current_delay*1000000), HRTIMER_MODE_REL);
-		/* LGE_CHANGE_E sglee76@lge.com 2010-05-06 tilt delay */
+		motion_poll_reschedule();
 
 	}
 
@@ -793,14 +877,12 @@ ssize_t motion_gyro_delay_store(struct device *dev, struct device_attribute *att
 #endif
 
 	if (atomic_read(&gyro_flag)) {
-		hrtimer_cancel(&heaven_motion_dev.timer[2]);
-
 		if (current_delay < MIN_MOTION_POLLING_TIME) {
 			current_delay = MIN_MOTION_POLLING_TIME;
 		}
 
 		atomic_set(&gyro_delay, current_delay);
-		hrtimer_start(&heaven_motion_dev.timer[2], ktime_set(0, current_delay * 1000000), HRTIMER_MODE_REL);
+		motion_poll_reschedule();
 
 	}
 
@@ -820,14 +902,12 @@ ssize_t motion_compass_delay_store(struct device *dev, struct device_attribute *
 #endif
 
 	if (atomic_read(&compass_flag)) {
-		hrtimer_cancel(&heaven_motion_dev.timer[3]);
-
 		if (current_delay < MIN_MOTION_POLLING_TIME) {
 			current_delay = MIN_MOTION_POLLING_TIME;
 		}
 
 		atomic_set(&compass_delay, current_delay);
-		hrtimer_start(&heaven_motion_dev.timer[3], ktime_set(0, current_delay * 1000000), HRTIMER_MODE_REL);
+		motion_poll_reschedule();
 	}
 
 	return count;
@@ -846,14 +926,12 @@ ssize_t motion_composite_delay_store(struct device *dev, struct device_attribute
 #endif
 
 	if (atomic_read(&composite_flag)) {
-		hrtimer_cancel(&heaven_motion_dev.timer[4]);
-
 		if (current_delay < MIN_MOTION_POLLING_TIME) {
 			current_delay = MIN_MOTION_POLLING_TIME;
 		}
 
 		atomic_set(&composite_delay, current_delay);
-		hrtimer_start(&heaven_motion_dev.timer[4], ktime_set(0, current_delay * 1000000), HRTIMER_MODE_REL);
+		motion_poll_reschedule();
 	}
 
 	return count;
@@ -882,6 +960,18 @@ static ssize_t motion_cal_onoff_store(struct device *dev, struct device_attribut
 }
 
 
+static ssize_t motion_poll_stats_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	unsigned long wakeups, polls;
+
+	spin_lock_irq(&heaven_motion_dev.poll_lock);
+	wakeups = heaven_motion_dev.poll_wakeups;
+	polls = heaven_motion_dev.poll_count;
+	spin_unlock_irq(&heaven_motion_dev.poll_lock);
+
+	return sprintf(buf, "wakeups %lu polls %lu\n", wakeups, polls);
+}
+
 static DEVICE_ATTR(accel_onoff,0666,NULL,motion_accel_onoff_store);
 static DEVICE_ATTR(tilt_onoff,0666,NULL,motion_tilt_onoff_store);
 static DEVICE_ATTR(gyro_onoff, 0666, NULL, motion_gyro_onoff_store);
@@ -898,6 +988,7 @@ static DEVICE_ATTR(tilt_delay,0666,NULL,motion_tilt_delay_store);
 static DEVICE_ATTR(gyro_delay, 0666, NULL, motion_gyro_delay_store);
 static DEVICE_ATTR(compass_delay, 0666, NULL, motion_compass_delay_store);
 static DEVICE_ATTR(composite_delay, 0666, NULL, motion_composite_delay_store);
+static DEVICE_ATTR(poll_stats, 0444, motion_poll_stats_show, NULL);
 
 
 //Sensor Calibration
@@ -918,7 +1009,8 @@ static struct attribute *heaven_motion_attributes[] = {
 	&dev_attr_accel_delay.attr,
 	&dev_attr_gyro_delay.attr,
 	&dev_attr_compass_delay.attr,
-	&dev_attr_composite_delay.attr,		
+	&dev_attr_composite_delay.attr,
+	&dev_attr_poll_stats.attr,		
 	&dev_attr_cal_onoff.attr,	
 	NULL
 };
@@ -1473,6 +1565,10 @@ static int __init heaven_motion_probe(struct platform_device *pdev)
 	input_set_abs_params(heaven_motion_dev.input_dev, ABS_BRAKE, -2048, 2032, 0, 0);
 
 	input_set_abs_params(heaven_motion_dev.input_dev, ABS_THROTTLE, 0, 0, 0, 0); //Yaw Image
+
+	/* sample time of the polled sensors, see motion_poll_work_func() */
+	set_bit(EV_MSC, heaven_motion_dev.input_dev->evbit);
+	set_bit(MSC_TIMESTAMP, heaven_motion_dev.input_dev->mscbit);
        
        err = input_register_device(heaven_motion_dev.input_dev);
        if(err){
@@ -1505,62 +1601,25 @@ static int __init heaven_motion_probe(struct platform_device *pdev)
 	/*---------------------------------------------------------------------------
 		INIT_WORK 
 	---------------------------------------------------------------------------*/		  			
-	INIT_WORK(&heaven_motion_dev.accel_work, motion_accel_work_func);
-	INIT_WORK(&heaven_motion_dev.tilt_work, motion_tilt_work_func);
-	INIT_WORK(&heaven_motion_dev.gyro_work, motion_gyro_work_func);
-	INIT_WORK(&heaven_motion_dev.compass_work, motion_compass_work_func);
-	INIT_WORK(&heaven_motion_dev.composite_work, motion_composite_work_func);
+	INIT_WORK(&heaven_motion_dev.poll_work, motion_poll_work_func);
+	mutex_init(&heaven_motion_dev.poll_mutex);
+	spin_lock_init(&heaven_motion_dev.poll_lock);
 
     /*---------------------------------------------------------------------------
 		init. workqueue 
 	---------------------------------------------------------------------------*/		  			
-	heaven_motion_dev.accel_wq = create_singlethread_workqueue("motion_accel_wq");
-	if (!heaven_motion_dev.accel_wq) {
-		printk("[motion_sensor] couldn't create accel queue\n");
-		goto err_motion_accel_wq;
-	}
-
-	heaven_motion_dev.tilt_wq = create_singlethread_workqueue("motion_tilt_wq");
-	if (!heaven_motion_dev.tilt_wq) {
-		printk("[motion_sensor] couldn't create tilt queue\n");
-		goto err_motion_tilt_wq;
-	}
-
-	heaven_motion_dev.gyro_wq = create_singlethread_workqueue("motion_gyro_wq");
-	if (!heaven_motion_dev.gyro_wq) {
-		printk("[motion_sensor] couldn't create gyro work queue\n");
-		goto err_motion_gyro_wq;
-	}
-
-	heaven_motion_dev.compass_wq = create_singlethread_workqueue("motion_compass_wq");
-	if (!heaven_motion_dev.compass_wq) {
-		printk("[motion_sensor] couldn't create accel work queue\n");
-		goto err_motion_compass_wq;
-	}
-
-	heaven_motion_dev.composite_wq = create_singlethread_workqueue("motion_composite_wq");
-	if (!heaven_motion_dev.composite_wq) {
-		printk("[motion_sensor] couldn't create accel work queue\n");
-		goto err_motion_composite_wq;
+	heaven_motion_dev.poll_wq = create_singlethread_workqueue("motion_poll_wq");
+	if (!heaven_motion_dev.poll_wq) {
+		printk("[motion_sensor] couldn't create poll work queue\n");
+		err = -ENOMEM;
+		goto err_motion_poll_wq;
 	}
 
    /*---------------------------------------------------------------------------
 		init. timer
     ---------------------------------------------------------------------------*/
-	hrtimer_init(&heaven_motion_dev.timer[0], CLOCK_MONOTONIC, HRTIMER_MODE_REL);
-	heaven_motion_dev.timer[0].function = motion_accel_timer_func;
-	 
-	hrtimer_init(&heaven_motion_dev.timer[1], CLOCK_MONOTONIC, HRTIMER_MODE_REL);
-	heaven_motion_dev.timer[1].function = motion_tilt_timer_func;
-
-	hrtimer_init(&heaven_motion_dev.timer[2], CLOCK_MONOTONIC, HRTIMER_MODE_REL);
-	heaven_motion_dev.timer[2].function = motion_gyro_timer_func;
-
-	hrtimer_init(&heaven_motion_dev.timer[3], CLOCK_MONOTONIC, HRTIMER_MODE_REL);
-	heaven_motion_dev.timer[3].function = motion_compass_timer_func;
-	
-	hrtimer_init(&heaven_motion_dev.timer[4], CLOCK_MONOTONIC, HRTIMER_MODE_REL);
-	heaven_motion_dev.timer[4].function = motion_composite_timer_func;
+	hrtimer_init(&heaven_motion_dev.poll_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+	heaven_motion_dev.poll_timer.function = motion_poll_timer_func;
 	
      /*---------------------------------------------------------------------------
        power 
@@ -1594,21 +1653,7 @@ err_input_allocate1:
 exit_misc_device_register_failed:
 err_sysfs_create:
        printk("+++++ LGE: heaven motion misc_device_register_failed\n");        
-err_motion_accel_wq:
-	printk("##  sensor: accel timer_failed\n");
-	destroy_workqueue(heaven_motion_dev.accel_wq);
-err_motion_tilt_wq:
-	printk("##  sensor: tilt timer_failed\n");
-	destroy_workqueue(heaven_motion_dev.tilt_wq);
-err_motion_gyro_wq:
-	printk("##  sensor: gyro timer_failed\n");
-	destroy_workqueue(heaven_motion_dev.gyro_wq);
-err_motion_compass_wq:
-	printk("##  sensor: compass timer_failed\n");
-	destroy_workqueue(heaven_motion_dev.compass_wq);
-err_motion_composite_wq:
-	printk("##  sensor: composite timer_failed\n");
-	destroy_workqueue(heaven_motion_dev.composite_wq);	
+err_motion_poll_wq:
 	return err;
 
 }
@@ -1620,10 +1665,9 @@ static int heaven_motion_remove(struct platform_device *pdev)
 	i2c_del_driver(&gyro_i2c_driver);
 	i2c_del_driver(&accel_i2c_driver);
 
-	if (heaven_motion_dev.tilt_wq)
-		destroy_workqueue(heaven_motion_dev.tilt_wq);
-	if (heaven_motion_dev.accel_wq)
-		destroy_workqueue(heaven_motion_dev.accel_wq);
+	hrtimer_cancel(&heaven_motion_dev.poll_timer);
+	if (heaven_motion_dev.poll_wq)
+		destroy_workqueue(heaven_motion_dev.poll_wq);
 	   
     return 0;
 }
@@ -1646,58 +1690,24 @@ static void mpu3050_early_suspend(struct early_suspend *h)
 	//printk("%s\n", __func__);
 	heaven_motion_suspend(NULL);
 
-	#if 1
-	//timer removed
-	if(atomic_read(&accel_flag)){
-		hrtimer_cancel(&heaven_motion_dev.timer[0]);
-	}
-	if(atomic_read(&tilt_flag)){
-		hrtimer_cancel(&heaven_motion_dev.timer[1]);
-	}
-	if(atomic_read(&gyro_flag)){
-		hrtimer_cancel(&heaven_motion_dev.timer[2]);
-	}	
-	if(atomic_read(&compass_flag)){
-		hrtimer_cancel(&heaven_motion_dev.timer[3]);
-	}
-	if(atomic_read(&composite_flag)){
-		hrtimer_cancel(&heaven_motion_dev.timer[4]);
-	}
-	#endif
+	mutex_lock(&heaven_motion_dev.poll_mutex);
+	heaven_motion_dev.poll_suspended = 1;
+	hrtimer_cancel(&heaven_motion_dev.poll_timer);
+	mutex_unlock(&heaven_motion_dev.poll_mutex);
 	
 	return;
 }
 
 static void mpu3050_late_resume(struct early_suspend *h)
 {
-	unsigned long current_delay;
-
 	//printk("%s\n", __func__);
 	heaven_motion_resume(NULL);
 	
-	#if 1
-	//timer restart
-	if(atomic_read(&accel_flag)){
-		current_delay = atomic_read(&accel_delay);
-		hrtimer_start(&heaven_motion_dev.timer[0], ktime_set(0, current_delay * 1000000), HRTIMER_MODE_REL);
-	}
-	if(atomic_read(&tilt_flag)){
-		current_delay = atomic_read(&tilt_delay);
-		hrtimer_start(&heaven_motion_dev.timer[1], ktime_set(0, current_delay * 1000000), HRTIMER_MODE_REL);
-	}
-	if(atomic_read(&gyro_flag)){
-		current_delay = atomic_read(&gyro_delay);
-		hrtimer_start(&heaven_motion_dev.timer[2], ktime_set(0, current_delay * 1000000), HRTIMER_MODE_REL);
-	}	
-	if(atomic_read(&compass_flag)){
-		current_delay = atomic_read(&compass_delay);
-		hrtimer_start(&heaven_motion_dev.timer[3], ktime_set(0, current_delay * 1000000), HRTIMER_MODE_REL);
-	}
-	if(atomic_read(&composite_flag)){
-		current_delay = atomic_read(&composite_delay);
-		hrtimer_start(&heaven_motion_dev.timer[4], ktime_set(0, current_delay * 1000000), HRTIMER_MODE_REL);
-	}	
-	#endif
+	mutex_lock(&heaven_motion_dev.poll_mutex);
+	heaven_motion_dev.poll_suspended = 0;
+	mutex_unlock(&heaven_motion_dev.poll_mutex);
+
+	motion_poll_reschedule();
 	
 	return;	
 }
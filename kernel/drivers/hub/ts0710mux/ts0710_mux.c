@@ -75,6 +75,8 @@
 #include <linux/semaphore.h>
 #include <linux/mutex.h>
 #include <linux/kthread.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 #define TS0710MAX_CHANNELS 32
 #define TS0710MAX_PRIORITY_NUMBER 64
 #else
@@ -137,6 +139,10 @@ struct mux_data {
     int copy_index;
     int framelen;
 	unsigned char chunk[MAX_FRAME_SIZE];
+#if defined(CONFIG_KERNEL_GSM0710MUX_TEST) || defined(CONFIG_KERNEL_GSM0710MUX_TEST_MODULE)
+    /* replay test: receives the accepted frames instead of the connection */
+    void (*rx_replay)(const u8 *frame, int len);
+#endif
 };
 #else
 struct mux_data {
@@ -203,22 +209,65 @@ struct spi_data_recived_struct {
     int size;
     int updated;
 };
- #if 1 //heeyoung.lee 2011.08.02 - from RIL group patch (100 -> 1000)
-#define MAX_WAITING_FRAMES 1000
-#else
-#define MAX_WAITING_FRAMES 100
-#endif
-struct spi_data_send_struct;
+/*
+ * Outgoing frames are queued on one ring per DLCI and drained by
+ * ts_ldisc_tx_looper() in DLCI priority order.  The looper is the only
+ * consumer, so it never takes a lock: it reads 'head' published by the
+ * producers and hands slots back by advancing 'tail'.  Producers of one
+ * DLCI (the tty writer and control replies sent from the rx path) are
+ * serialised by the per-ring lock, which the looper never touches.
+ */
+#define MUX_TX_RING_SIZE	128	/* must be a power of 2 */
+#define MUX_TX_RING_MASK	(MUX_TX_RING_SIZE - 1)
+#define MUX_TX_RING_WAKE	(MUX_TX_RING_SIZE / 2)
+
 struct spi_data_send_struct {
-    struct spi_data_send_struct *next;
     u8 *data;
     int size;
 };
 
-static LOCK_T frame_nodes_lock = SPIN_LOCK_UNLOCKED;
-static unsigned long lock_flag ;
-static struct spi_data_send_struct frame_node[MAX_WAITING_FRAMES];
-static struct spi_data_send_struct *frame_to_send[TS0710MAX_PRIORITY_NUMBER];          
+struct mux_tx_ring {
+    LOCK_T lock;			/* producer side only */
+    unsigned int head;			/* next slot to fill */
+    unsigned int tail;			/* next slot to send */
+    volatile int stopped;		/* a writer is waiting for room */
+    unsigned int high_water;
+    unsigned long queued;
+    unsigned long sent;
+    unsigned long dropped;
+    struct spi_data_send_struct slot[MUX_TX_RING_SIZE];
+};
+
+static struct mux_tx_ring tx_ring[TS0710_MAX_CHN];
+static u8 tx_last_dlci;
+
+/*
+ * Coalesced transmit: the looper packs as many queued frames as fit into
+ * one write of the ipc tty (one IFX SPI frame), still in DLCI priority
+ * order.  If less than tx_coalesce_bytes are queued it may wait up to
+ * tx_coalesce_delay_ms for more before sending.
+ */
+#define MUX_TX_BATCH_SIZE	2044	/* IFX_SPI_MAX_BUF_SIZE */
+
+static int tx_coalesce = 1;
+module_param(tx_coalesce, int, S_IRUGO | S_IWUSR);
+static int tx_coalesce_bytes = MUX_TX_BATCH_SIZE;
+module_param(tx_coalesce_bytes, int, S_IRUGO | S_IWUSR);
+static int tx_coalesce_delay_ms = 0;
+module_param(tx_coalesce_delay_ms, int, S_IRUGO | S_IWUSR);
+
+/* Drop received frames whose FCS does not match. Off until it has been
+ * verified against the modem firmware. */
+static int rx_check_fcs = 0;
+module_param(rx_check_fcs, int, S_IRUGO | S_IWUSR);
+
+static unsigned long rx_frames;
+static unsigned long rx_fast_frames;
+static unsigned long rx_fcs_errors;
+
+static u8 tx_batch_buf[MUX_TX_BATCH_SIZE];
+static unsigned long tx_batch_writes;
+static unsigned long tx_batch_frames;
 static struct spi_data_recived_struct spi_data_recieved;
 static struct task_struct *task;
 static struct task_struct *write_task;
@@ -236,48 +285,46 @@ static u8 default_priority_table[] = {
 };
 
 
-static int max_frame_usage = 0;
 #if defined(RIL_RECOVERY_MODE)
 static int ts_ldisc_called = 0;
 #endif
+
+static inline unsigned int tx_ring_used(struct mux_tx_ring *ring)
+{
+    return ACCESS_ONCE(ring->head) - ACCESS_ONCE(ring->tail);
+}
+
+static inline unsigned int tx_ring_room(struct mux_tx_ring *ring)
+{
+    return MUX_TX_RING_SIZE - tx_ring_used(ring);
+}
+
 static void nodes_init(void)
 {
     int i;
-//LGE_GB_TELECA_CR_405	-START
-//20110322, ravi.holal@teleca.com
-//Description: lockup during utube streaming 
-//@@spin_lock_irqsave(&frame_nodes_lock, lock_flag);
-    CREATELOCK(frame_nodes_lock);
-    LOCK(frame_nodes_lock);
-//LGE_GB_TELECA_CR_405	-END
-    for (i=0; i<MAX_WAITING_FRAMES;i++)
+
+    for (i = 0; i < TS0710_MAX_CHN; i++)
     {
-        frame_node[i].next = NULL;
-        frame_node[i].data = NULL;
-        frame_node[i].size = 0;
-    }
-	
-    for (i=0; i<TS0710MAX_PRIORITY_NUMBER;i++)
-   {
-        frame_to_send[i]=NULL;
+        struct mux_tx_ring *ring = &tx_ring[i];
+
+        LOCK(ring->lock);
+        ring->head = 0;
+        ring->tail = 0;
+        ring->stopped = 0;
+        UNLOCK(ring->lock);
     }
-//LGE_GB_TELECA_CR_405	-START
-//20110322, ravi.holal@teleca.com
-//Description: lockup during utube streaming 
-    UNLOCK(frame_nodes_lock);
-//LGE_GB_TELECA_CR_405	-END
-//@@spin_unlock_irqrestore(&frame_nodes_lock, lock_flag);
+    tx_last_dlci = 0;
 }
 
+/* Producer side: called with a kmalloc()ed frame which the looper frees
+ * once it has been written.  Returns -ENOSPC, leaving the frame to the
+ * caller, when the ring of this DLCI is full. */
 static int node_put_to_send(u8 dlci, u8 *data, int size)
 {
-    int i;
-    int retval = 0; 
-    int free_node = MAX_WAITING_FRAMES+1;
-    struct spi_data_send_struct *new_frame;
-//    u8 * buf;
-    u8 priority;
-    int frame_count = 0;
+    struct mux_tx_ring *ring;
+    struct spi_data_send_struct *slot;
+    unsigned int head, used;
+
 #if defined(RIL_RECOVERY_MODE)
 	if(ts_ldisc_called) 
 	{
@@ -287,84 +334,117 @@ static int node_put_to_send(u8 dlci, u8 *data, int size)
 	}
 #endif
 
+    if (dlci >= TS0710_MAX_CHN)
+        return -EINVAL;
 
-    priority = ts0710_connection.dlci[dlci].priority;    
-#if 0
-    buf = kmalloc(size, GFP_ATOMIC);
-    if (buf)
-         memcpy(buf, data, size);
-    else
-    {
-         printk("\nTS0710:node_put_to_send:buf null, return ENOMEM\r\n");
-         return -ENOMEM;
-    }
-#endif
-//LGE_GB_TELECA_CR_405	-START
-//20110322, ravi.holal@teleca.com
-//Description: lockup during utube streaming   
-//@@spin_lock_irqsave(&frame_nodes_lock, lock_flag);
-    LOCK(frame_nodes_lock);
-//LGE_GB_TELECA_CR_405	-END
-    for (i=0; i<MAX_WAITING_FRAMES;i++)
+    ring = &tx_ring[dlci];
+
+    LOCK(ring->lock);
+    head = ring->head;
+    used = head - ACCESS_ONCE(ring->tail);
+    if (used >= MUX_TX_RING_SIZE)
     {
-        if(frame_node[i].size == 0)
-	{
-            free_node = i;
-            if(free_node > max_frame_usage)
-	    {
-                max_frame_usage = free_node;
-                printk("\nTS0710:node_put_to_send:max_frame_usage=%d\n",max_frame_usage);
-            }
-            break;    
+        /* Ask the looper for a wakeup, then look again in case it
+         * drained the ring before it could see the request. */
+        ring->stopped = 1;
+        smp_mb();
+        used = head - ACCESS_ONCE(ring->tail);
+        if (used >= MUX_TX_RING_SIZE)
+        {
+            ring->dropped++;
+            UNLOCK(ring->lock);
+            return -ENOSPC;
         }
     }
-	
-    if(free_node < MAX_WAITING_FRAMES)
-   {
-        frame_node[free_node].next = NULL;
-        frame_node[free_node].data = data;
-        frame_node[free_node].size = size;
-        retval = size;
-        if(frame_to_send[priority] == NULL)
-	{
-            frame_to_send[priority]= &frame_node[free_node];
-        }
-        else
-	{
-            new_frame = frame_to_send[priority];
-            while (new_frame->next != NULL)
-	    {
-                new_frame = new_frame->next;
-                frame_count++;
-                if(frame_count>MAX_WAITING_FRAMES) 
-		{
-                  printk("\n Never hit this case : frame_count(%d) > MAX_WAITING_FRAMES[%d]\r\n", frame_count, MAX_WAITING_FRAMES);
-                  break;
-                }
-            }
-            new_frame->next = &frame_node[free_node];
+
+    slot = &ring->slot[head & MUX_TX_RING_MASK];
+    slot->data = data;
+    slot->size = size;
+    /* publish the slot before the looper can see the new head */
+    smp_wmb();
+    ring->head = head + 1;
+
+    ring->queued++;
+    if (used + 1 > ring->high_water)
+        ring->high_water = used + 1;
+    UNLOCK(ring->lock);
+
+    up(&spi_write_sema);
+    return size;
+}
+
+/* Consumer side, ts_ldisc_tx_looper() only.  Picks the non-empty ring with
+ * the best DLCI priority, rotating among DLCIs of equal priority, and
+ * takes its head frame if it is no bigger than max_size. */
+static int node_get_to_send(u8 *dlci, u8 **data, int max_size)
+{
+    struct mux_tx_ring *ring;
+    struct spi_data_send_struct *slot;
+    unsigned int tail;
+    int i, best = -1;
+    u8 j, prio, best_prio = 0xff;
+    int size;
+
+    for (i = 1; i <= TS0710_MAX_CHN; i++)
+    {
+        j = (tx_last_dlci + i) % TS0710_MAX_CHN;
+        if (!tx_ring_used(&tx_ring[j]))
+            continue;
+        prio = ts0710_connection.dlci[j].priority;
+        if (prio < best_prio)
+        {
+            best_prio = prio;
+            best = j;
         }
     }
-    
+    if (best < 0)
+        return 0;
+
+    ring = &tx_ring[best];
+    tail = ring->tail;
+    /* read the slot only after the head that published it */
+    smp_rmb();
+    slot = &ring->slot[tail & MUX_TX_RING_MASK];
+    size = slot->size;
+    if (size > max_size)
+        return 0;
+    *data = slot->data;
+    slot->data = NULL;
+    /* finish with the slot before handing it back to the producers */
+    smp_mb();
+    ring->tail = tail + 1;
+    ring->sent++;
+
+    tx_last_dlci = best;
+    *dlci = best;
+    return size;
+}
 
-    if(free_node >= MAX_WAITING_FRAMES)
-   {
-       	printk("\n[LGE-MUX] TS0710 free_node[%d] >= MAX_WAITING_FRAMES\r\n", free_node);//For EBS TEST 
-        kfree(data);
-        retval = -ENOMEM; 
-    }
+static int tx_ring_pending(void)
+{
+    int i;
 
-//LGE_GB_TELECA_CR_405	-START
-//20110322, ravi.holal@teleca.com
-//Description: lockup during utube streaming
-//@@spin_unlock_irqrestore(&frame_nodes_lock, lock_flag);
-    UNLOCK(frame_nodes_lock);
-//LGE_GB_TELECA_CR_405	-END
-    if(retval > 0 ){
-        up(&spi_write_sema);
-    }
-    return retval;
-} 
+    for (i = 0; i < TS0710_MAX_CHN; i++)
+        if (tx_ring_used(&tx_ring[i]))
+            return 1;
+    return 0;
+}
+
+/* Wake a writer which found the ring of this DLCI full, once the looper
+ * has drained it far enough to be worth it. */
+static void node_wake_writer(u8 dlci)
+{
+    struct mux_tx_ring *ring = &tx_ring[dlci];
+    struct tty_struct *tty;
+
+    if (!ring->stopped || tx_ring_room(ring) < MUX_TX_RING_WAKE)
+        return;
+
+    ring->stopped = 0;
+    tty = mux_table[dlci];
+    if (mux_tty[dlci] && tty)
+        tty_wakeup(tty);
+}
 
 #endif
 
@@ -545,8 +625,9 @@ static int mux_send_frame(u8 dlci, int initiator,
 		framebuf[pos ++] = MUX_ADVANCED_FLAG_SEQ; */
 #ifdef LGE_KERNEL_MUX
     res = node_put_to_send( dlci, framebuf, pos);
-    if(res == -ENOMEM)
+    if(res < 0)
     {
+      kfree(framebuf);
       return res;
     }
 #else    
@@ -1814,7 +1895,13 @@ static int mux_write(struct tty_struct *tty, const unsigned char *buf, int count
 		frame_written = mux_send_uih_data(ts0710, dlci, (u8 *)(buf + written), frame_size);
 
 
-	        if(frame_written < 0)
+		if (frame_written == -ENOSPC)
+		{
+			/* tx ring full: report what went out, the looper
+			 * wakes us up again once it has drained the ring */
+			break;
+		}
+	        else if(frame_written < 0)
 		{
 	      	    printk("\nTS0710:mux_write(): returning -1 \n"); //for ebs test
 				/* send frame error */
@@ -1839,6 +1926,7 @@ static int mux_write_room(struct tty_struct *tty)
 	int line;
 	u8 dlci;
 	mux_send_struct *send_info;
+	struct mux_tx_ring *ring;
 
 	retval = 0;
 
@@ -1873,6 +1961,15 @@ static int mux_write_room(struct tty_struct *tty)
 	if (send_info->filled)
 		goto out;
 
+	ring = &tx_ring[dlci];
+	if (!tx_ring_room(ring))
+	{
+		ring->stopped = 1;
+		smp_mb();
+		if (!tx_ring_room(ring))
+			goto out;
+	}
+
 	retval = ts0710->dlci[dlci].mtu - 1;
 
 out:
@@ -2028,10 +2125,64 @@ static void send_ack(ts0710_con * ts0710, u8 seq_num)
 	mux_send_frame(CTRL_CHAN, ts0710->initiator, ACK, &seq_num, 1);
 }
 #endif
+#ifdef LGE_KERNEL_MUX
+/* Offset of the first flag byte in buf, or len if there is none.  Once buf
+ * is word aligned this compares a whole word against the flag at a time. */
+static int mux_find_flag(const u8 *buf, int len)
+{
+    const unsigned long ones = ~0UL / 0xff;
+    const unsigned long flags = ones * TS0710_BASIC_FLAG;
+    unsigned long v;
+    int i = 0;
+
+    while ((i < len) && ((unsigned long)(buf + i) & (sizeof(long) - 1)))
+    {
+        if (buf[i] == (u8)TS0710_BASIC_FLAG)
+            return i;
+        i++;
+    }
+
+    for (; i + (int)sizeof(long) <= len; i += sizeof(long))
+    {
+        v = *(const unsigned long *)(buf + i) ^ flags;
+        if ((v - ones) & ~v & (ones << 7))
+            break;
+    }
+
+    for (; i < len; i++)
+        if (buf[i] == (u8)TS0710_BASIC_FLAG)
+            return i;
+    return len;
+}
+
+/* Length of the frame starting with the flag at buf including both flags,
+ * or 0 if fewer than TS0710_MAX_HDR_SIZE bytes are available to tell. */
+static int mux_frame_len(const u8 *buf, int len)
+{
+    short_frame *short_pkt;
+    long_frame *long_pkt;
+
+    if (len < TS0710_MAX_HDR_SIZE)
+        return 0;
+
+    short_pkt = (short_frame *) (buf + ADDRESS_FIELD_OFFSET);
+    if (short_pkt->h.length.ea == 1)
+        return TS0710_MAX_HDR_SIZE + short_pkt->h.length.len + 1 + SEQ_FIELD_SIZE;
+
+    long_pkt = (long_frame *) short_pkt;
+    return TS0710_MAX_HDR_SIZE + GET_LONG_LENGTH(long_pkt->h.length) + 2 + SEQ_FIELD_SIZE;
+}
+#endif
+
 static void ts_ldisc_rx_post(struct tty_struct *tty, const u8 *data, char *flags, int count)
 {
 #ifndef LGE_KERNEL_MUX
 	static u8 expect_seq = 0;
+#else
+	int check_fcs = rx_check_fcs;
+#if defined(CONFIG_KERNEL_GSM0710MUX_TEST) || defined(CONFIG_KERNEL_GSM0710MUX_TEST_MODULE)
+	struct mux_data *st = (struct mux_data *)tty->disc_data;
+#endif
 #endif    
 	int framelen;
 	short_frame *short_pkt;
@@ -2049,6 +2200,41 @@ static void ts_ldisc_rx_post(struct tty_struct *tty, const u8 *data, char *flags
 	}
 #ifdef LGE_KERNEL_MUX
 /* To remove Motorola's modem specific*/
+#if defined(CONFIG_KERNEL_GSM0710MUX_TEST) || defined(CONFIG_KERNEL_GSM0710MUX_TEST_MODULE)
+    /* recorded frames are always checked */
+    if (st->rx_replay)
+        check_fcs = 1;
+#endif
+    if (check_fcs)
+    {
+        int crc_len;
+
+        /* UI frames are covered up to the FCS, all others (UIH above
+         * all) only over address, control and length. See 5.2.1.6.
+         * The FCS itself is always the byte before the closing flag. */
+        if (CLR_PF(short_pkt->h.control) == MUX_UI)
+            crc_len = framelen - 3;
+        else if (short_pkt->h.length.ea == 1)
+            crc_len = SHORT_CRC_CHECK;
+        else
+            crc_len = LONG_CRC_CHECK;
+
+        if (mux_fcs_compute(data + 1, crc_len) != data[framelen - 2])
+        {
+            rx_fcs_errors++;
+            TS0710_PRINTK("MUX: ts_ldisc_rx_post: bad FCS on dlci %d, frame dropped\n",
+                short_pkt->h.addr.server_chn << 1 | short_pkt->h.addr.d);
+            return;
+        }
+    }
+    rx_frames++;
+#if defined(CONFIG_KERNEL_GSM0710MUX_TEST) || defined(CONFIG_KERNEL_GSM0710MUX_TEST_MODULE)
+    if (st->rx_replay)
+    {
+        st->rx_replay(data + 1, framelen - 2);
+        return;
+    }
+#endif
     ts0710_recv_data(&ts0710_connection, (char*)(data + 1), framelen - 2);
 #else
     TS0710_PRINTK("MUX: ts_ldisc_rx_post: expect_seq = %x \n", expect_seq );
@@ -2077,77 +2263,79 @@ void ts_ldisc_rx(struct tty_struct *tty, const u8 *data, char *flags, int size)
 {
     struct mux_data *st = (struct mux_data *)tty->disc_data;
 #ifdef LGE_KERNEL_MUX
-    int i;
-    short_frame *short_pkt;
-    long_frame *long_pkt;
-    for(i=0; i < size; i++)
-   {
+    int i, j, n;
+    int framelen;
+
+    i = 0;
+    while (i < size)
+    {
         switch (st->state)
-	{
-	        case OUT_OF_FRAME:
-	            if(data[i] == (u8)TS0710_BASIC_FLAG)
-		    {
-	                st->state = INSIDE_FRAME_HEADER;
-	                st->copy_index = 0;
-	            }
-	            else
-		    {
-                      //Kernel mux received bad data.
-                       if(i == 0 || i == 1|| i == 2|| i == 3)
-                       	{
-	                       printk("ts_ldisc_rx: bad_data >> data[%d]=%x  Size = %d\n",i, data[i], size);
-                       	}
-                       break;
-          	     }
-
-                case INSIDE_FRAME_HEADER:
-	            if(st->copy_index < TS0710_MAX_HDR_SIZE)
-		    {
-	                if((st->copy_index == 1) && (data[i] == (u8)TS0710_BASIC_FLAG)) /* this is fix of out of sync with seq F9 F9*/
-	                {
-	                     st->copy_index = 0;
-	                }					
-			 st->chunk[st->copy_index++]=data[i];
-	                break;
-	            }
-	            else
-		    {
-	                short_pkt = (short_frame *) (st->chunk + ADDRESS_FIELD_OFFSET);
-	                if (short_pkt->h.length.ea == 1) 
-			{
-	                    st->framelen = TS0710_MAX_HDR_SIZE + short_pkt->h.length.len + 1 + SEQ_FIELD_SIZE;
-	                } 
-			else 
-			{
-                          long_pkt = (long_frame *) short_pkt;
-                          st->framelen = TS0710_MAX_HDR_SIZE + GET_LONG_LENGTH(long_pkt->h.length) + 2 + SEQ_FIELD_SIZE;
-                        }
-			
-                       if(st->framelen > MAX_FRAME_SIZE)
-	 	       {
-                          printk("\nTS0710:ts_ldisc_rx:Too big frame to copy %d!\n",st->framelen);
-                          st->state = OUT_OF_FRAME ;
-                          break;
-                       }
-                      st->state = INSIDE_FRAME_BODY; 
-                  }
-				
-                case INSIDE_FRAME_BODY:
-                   if(st->copy_index < st->framelen)
-   	   	  {
-                        st->chunk[st->copy_index++]=data[i];
-                   }
-   
-                    if(!(st->copy_index < st->framelen))
-   		   {
-                        ts_ldisc_rx_post(tty, st->chunk, flags,	st->framelen);
-                        st->state = OUT_OF_FRAME;
-                    }
+        {
+            case OUT_OF_FRAME:
+                n = mux_find_flag(data + i, size - i);
+                //Kernel mux received bad data.
+                for (j = i; j < 4 && j < i + n; j++)
+                    printk("ts_ldisc_rx: bad_data >> data[%d]=%x  Size = %d\n", j, data[j], size);
+                i += n;
+                if (i >= size)
                     break;
-   			
-                default:
-                    printk("\nTS0710:ts_ldisc_rx:unknown state!!!!!!!\n");
-                   return;
+
+                /* this is fix of out of sync with seq F9 F9 */
+                if ((i + 1 < size) && (data[i + 1] == (u8)TS0710_BASIC_FLAG))
+                {
+                    i++;
+                    break;
+                }
+
+                /* fast path: the whole frame is in this buffer, hand it
+                 * over without copying it to st->chunk first */
+                framelen = mux_frame_len(data + i, size - i);
+                if ((framelen > 0) && (framelen <= MAX_FRAME_SIZE) && (framelen <= size - i))
+                {
+                    rx_fast_frames++;
+                    ts_ldisc_rx_post(tty, data + i, flags, framelen);
+                    i += framelen;
+                    break;
+                }
+
+                st->state = INSIDE_FRAME_HEADER;
+                st->copy_index = 0;
+                st->chunk[st->copy_index++] = data[i++];
+                break;
+
+            case INSIDE_FRAME_HEADER:
+                if ((st->copy_index == 1) && (data[i] == (u8)TS0710_BASIC_FLAG)) /* this is fix of out of sync with seq F9 F9*/
+                    st->copy_index = 0;
+                st->chunk[st->copy_index++] = data[i++];
+                if (st->copy_index < TS0710_MAX_HDR_SIZE)
+                    break;
+
+                st->framelen = mux_frame_len(st->chunk, st->copy_index);
+                if (st->framelen > MAX_FRAME_SIZE)
+                {
+                    printk("\nTS0710:ts_ldisc_rx:Too big frame to copy %d!\n",st->framelen);
+                    st->state = OUT_OF_FRAME;
+                    break;
+                }
+                st->state = INSIDE_FRAME_BODY;
+                break;
+
+            case INSIDE_FRAME_BODY:
+                n = min(st->framelen - st->copy_index, size - i);
+                memcpy(st->chunk + st->copy_index, data + i, n);
+                st->copy_index += n;
+                i += n;
+
+                if (!(st->copy_index < st->framelen))
+                {
+                    ts_ldisc_rx_post(tty, st->chunk, flags, st->framelen);
+                    st->state = OUT_OF_FRAME;
+                }
+                break;
+
+            default:
+                printk("\nTS0710:ts_ldisc_rx:unknown state!!!!!!!\n");
+                return;
         }
     }
 #else
@@ -2196,62 +2384,134 @@ void ts_ldisc_rx(struct tty_struct *tty, const u8 *data, char *flags, int size)
 #endif
 }
 
+#if defined(CONFIG_KERNEL_GSM0710MUX_TEST) || defined(CONFIG_KERNEL_GSM0710MUX_TEST_MODULE)
+/*
+ * Feed a recorded byte stream through ts_ldisc_rx in pieces of 'split'
+ * bytes, on a private receive state. Frames that pass the checks in
+ * ts_ldisc_rx_post go to 'post' (without the flags) instead of the
+ * connection. For ts0710_mux_test.
+ */
+int ts0710_mux_rx_replay(const u8 *data, int size, int split,
+                         void (*post)(const u8 *frame, int len))
+{
+    struct tty_struct *tty;
+    struct mux_data *st;
+    int i, n;
+
+    if (split <= 0)
+        return -EINVAL;
+
+    tty = kzalloc(sizeof(struct tty_struct), GFP_KERNEL);
+    st = kzalloc(sizeof(struct mux_data), GFP_KERNEL);
+    if (!tty || !st)
+    {
+        kfree(tty);
+        kfree(st);
+        return -ENOMEM;
+    }
+
+    st->state = OUT_OF_FRAME;
+    st->rx_replay = post;
+    tty->disc_data = st;
+
+    for (i = 0; i < size; i += n)
+    {
+        n = min(split, size - i);
+        ts_ldisc_rx(tty, data + i, NULL, n);
+    }
+
+    kfree(st);
+    kfree(tty);
+    return 0;
+}
+EXPORT_SYMBOL_GPL(ts0710_mux_rx_replay);
+#endif
+
 #ifdef LGE_KERNEL_MUX
-static int ts_ldisc_tx_looper(void *param)
+/* Append further queued frames behind the first one in tx_batch_buf.
+ * Returns the number of bytes in the batch. */
+static int ts_ldisc_tx_batch(u8 *first, int first_size)
 {
-    int i,res;
+    unsigned long timeout;
     u8 *data_ptr;
     int data_size;
-    void * next_ptr;     
-    while(!kthread_should_stop())
+    int batch_size;
+    int room;
+    int credit = 0;
+    u8 dlci;
+
+    room = ipc_tty->ops->write_room ? ipc_tty->ops->write_room(ipc_tty) : 0;
+    if (room > MUX_TX_BATCH_SIZE)
+        room = MUX_TX_BATCH_SIZE;
+
+    memcpy(tx_batch_buf, first, first_size);
+    kfree(first);
+    batch_size = first_size;
+    tx_batch_frames++;
+
+    timeout = jiffies + msecs_to_jiffies(tx_coalesce_delay_ms);
+    for (;;)
     {
- //LGE_GB_TELECA_CR_405	-START
-//20110322, ravi.holal@teleca.com
-//Description: lockup during utube streaming                               
-//@@   spin_lock_irqsave(&frame_nodes_lock,flag);  // for avoiding to catch spinlock of interrupt handler, by eunae.kim
-//@@   spin_lock(&frame_nodes_lock);
+        data_ptr = NULL;
+        data_size = node_get_to_send(&dlci, &data_ptr, room - batch_size);
+        if (data_size > 0)
+        {
+            memcpy(tx_batch_buf + batch_size, data_ptr, data_size);
+            kfree(data_ptr);
+            batch_size += data_size;
+            tx_batch_frames++;
+            node_wake_writer(dlci);
+            /* this frame's count on spi_write_sema is used up here */
+            if (credit)
+                credit = 0;
+            else
+                down_trylock(&spi_write_sema);
+            continue;
+        }
 
+        /* the next frame does not fit, or nothing is queued yet */
+        if (tx_ring_pending() || batch_size >= tx_coalesce_bytes ||
+            time_after_eq(jiffies, timeout) || kthread_should_stop())
+            break;
+        if (down_timeout(&spi_write_sema, timeout - jiffies))
+            break;
+        credit = 1;
+    }
 
-//        WAIT_UNLOCK(frame_nodes_lock);
-        LOCK(frame_nodes_lock);
-//LGE_GB_TELECA_CR_405	-END
-       data_size = 0;
-       data_ptr  = NULL;
+    /* give back a count taken for a frame we did not send */
+    if (credit)
+        up(&spi_write_sema);
+
+    return batch_size;
+}
+
+static int ts_ldisc_tx_looper(void *param)
+{
+    int res;
+    u8 *data_ptr;
+    int data_size;
+    u8 dlci;
+
+    while(!kthread_should_stop())
+    {
+        data_ptr = NULL;
+        data_size = node_get_to_send(&dlci, &data_ptr, INT_MAX);
 
-        for(i = 0; i < TS0710MAX_PRIORITY_NUMBER ; i++)
-	{
-           if(frame_to_send[i] != NULL)
-  	   {
-                data_ptr = frame_to_send[i]->data;
-                data_size = frame_to_send[i]->size;
-                next_ptr = frame_to_send[i]->next;
-				
-                frame_to_send[i]->size = 0;
-                frame_to_send[i]->data = NULL;
-                frame_to_send[i]->next = NULL;
-                frame_to_send[i]= next_ptr;
-              /*  printk("\nTS0710:ts_ldisc_tx_looper:send to dlci=%d",i);*/
-                break;
-            }
-        }
-//LGE_GB_TELECA_CR_405	-START
-//20110322, ravi.holal@teleca.com
-//Description: lockup during utube streaming
-//@@     spin_unlock(&frame_nodes_lock);
-//@@     spin_unlock_irqrestore(&frame_nodes_lock,flag); // for avoiding to catch spinlock of interrupt handler, by eunae.kim
-        UNLOCK(frame_nodes_lock);
-//LGE_GB_TELECA_CR_405	-END
         if((data_size > 0) && (data_ptr != NULL))
 	{
-            res = ipc_tty->ops->write(ipc_tty, data_ptr, data_size);
-		// 20110501 sungjoong.kang@lge.com  from Platform Dept.[START] 
-			if(max_frame_usage > 0)
-				--max_frame_usage; 
-		// 20110501 sungjoong.kang@lge.com  from Platform Dept.[END] 
+            node_wake_writer(dlci);
+            if (tx_coalesce && data_size < MUX_TX_BATCH_SIZE)
+            {
+                data_size = ts_ldisc_tx_batch(data_ptr, data_size);
+                data_ptr = tx_batch_buf;
+                tx_batch_writes++;
+            }
 
+            res = ipc_tty->ops->write(ipc_tty, data_ptr, data_size);
 	            if (res != data_size)
                 printk("\nTS0710: [SPI RETRY] ts_ldisc_tx_looper:data_size=%d,res=%d\n",data_size,res);
-            kfree(data_ptr);    
+            if (data_ptr != tx_batch_buf)
+                kfree(data_ptr);    
         }
         down(&spi_write_sema);
     }
@@ -2277,7 +2537,6 @@ static int ts_ldisc_open(struct tty_struct *tty)
 
 	ipc_tty = tty;
 #ifdef LGE_KERNEL_MUX
-    spin_lock_init(&frame_nodes_lock) ; //ebs 
     nodes_init();
     ts0710_reset_dlci_priority();
     spi_data_recieved.tty = NULL;
@@ -2340,26 +2599,21 @@ static void ts_ldisc_close(struct tty_struct *tty)
         wake_lock_timeout(&s_wake_lock, MUX_WAKELOCK_TIME);
     #endif
     
-        TS0710_PRINTK("[%s] frame_nodes_lock Lock\n", __FUNCTION__);    
-        LOCK(frame_nodes_lock);
-        
-        for(i = 0; i < TS0710MAX_PRIORITY_NUMBER ; i++)
+        TS0710_PRINTK("[%s] flush tx rings\n", __FUNCTION__);    
+        for(i = 0; i < TS0710_MAX_CHN ; i++)
         {
-            if(frame_to_send[i] != NULL && frame_to_send[i]->data !=NULL)
+            struct mux_tx_ring *ring = &tx_ring[i];
+
+            LOCK(ring->lock);
+            while (ring->tail != ring->head)
             {
-                TS0710_PRINTK("[%s] frame_to_send[%d]->data = %p\n", __FUNCTION__, i, frame_to_send[i]->data);
-                kfree(frame_to_send[i]->data);
-                frame_to_send[i]->size = 0;
-                frame_to_send[i]->data = NULL;
-                frame_to_send[i]->next = NULL;
+                kfree(ring->slot[ring->tail & MUX_TX_RING_MASK].data);
+                ring->slot[ring->tail & MUX_TX_RING_MASK].data = NULL;
+                ring->tail++;
             }
+            ring->stopped = 0;
+            UNLOCK(ring->lock);
         }
-        UNLOCK(frame_nodes_lock);
-        TS0710_PRINTK("[%s] rame_nodes_lock UnLock\n", __FUNCTION__);    
-        
-// 20110501 sungjoong.kang@lge.com  from Platform Dept.[START] 
-        max_frame_usage = 0;
-// 20110501 sungjoong.kang@lge.com  from Platform Dept.[END] 
         
         ts0710_upon_disconnect();
         tty_ldisc_flush(tty);
@@ -2464,7 +2718,59 @@ static struct tty_ldisc_ops ts_ldisc = {
 	.ioctl		= ts_ldisc_ioctl,
 };
 
-#ifndef LGE_KERNEL_MUX
+#ifdef LGE_KERNEL_MUX
+static int mux_tx_rings_show(struct seq_file *m, void *unused)
+{
+	struct mux_tx_ring *ring;
+	int i;
+
+	seq_printf(m, "dlci prio       head       tail used high"
+		   "     queued       sent    dropped stopped\n");
+	for (i = 0; i < TS0710_MAX_CHN; i++) {
+		ring = &tx_ring[i];
+		if (!ring->queued && !ring->dropped)
+			continue;
+		seq_printf(m, "%4d %4d %10u %10u %4u %4u %10lu %10lu %10lu %7d\n",
+			   i, ts0710_connection.dlci[i].priority,
+			   ring->head, ring->tail, tx_ring_used(ring),
+			   ring->high_water, ring->queued, ring->sent,
+			   ring->dropped, ring->stopped);
+	}
+	seq_printf(m, "batched writes %lu frames %lu\n",
+		   tx_batch_writes, tx_batch_frames);
+	seq_printf(m, "rx frames %lu uncopied %lu bad fcs %lu\n",
+		   rx_frames, rx_fast_frames, rx_fcs_errors);
+	return 0;
+}
+
+static int mux_tx_rings_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, mux_tx_rings_show, inode->i_private);
+}
+
+static const struct file_operations mux_tx_rings_fops = {
+	.owner = THIS_MODULE,
+	.open = mux_tx_rings_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static struct dentry *mux_debugfs_dir;
+
+static void mux_tx_rings_init(void)
+{
+	int i;
+
+	for (i = 0; i < TS0710_MAX_CHN; i++)
+		CREATELOCK(tx_ring[i].lock);
+
+	mux_debugfs_dir = debugfs_create_dir("ts0710mux", NULL);
+	if (mux_debugfs_dir)
+		debugfs_create_file("tx_rings", S_IRUGO, mux_debugfs_dir,
+				    NULL, &mux_tx_rings_fops);
+}
+#else
 static u8 iscmdtty_gen1[16] =
 	{ 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0 };
 
@@ -2494,6 +2800,9 @@ static int __init mux_init(void)
 	TS0710_PRINTK("initializing mux with %d channels\n", NR_MUXS);
 
 	ts0710_init();
+#ifdef LGE_KERNEL_MUX
+	mux_tx_rings_init();
+#endif
 
 	for (j = 0; j < NR_MUXS; j++) {
 		mux_send_info_flags[j] = 0;
@@ -2589,6 +2898,9 @@ static void __exit mux_exit(void)
 
 	if (tty_unregister_driver(mux_driver))
 		panic("Couldn't unregister mux driver");
+#ifdef LGE_KERNEL_MUX
+	debugfs_remove_recursive(mux_debugfs_dir);
+#endif
 }
 
 module_init(mux_init);
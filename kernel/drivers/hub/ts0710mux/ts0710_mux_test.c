@@ -0,0 +1,230 @@
+/*
+ * drivers/hub/ts0710mux/ts0710_mux_test.c
+ *
+ * Replay test for the receive path of the kernel gsm0710 multiplexer.
+ *
+ * A recorded modem byte stream is fed through ts_ldisc_rx() in pieces of
+ * different sizes, so that frames are posted both straight from the
+ * received buffer and reassembled in the chunk, and the frames that reach
+ * ts_ldisc_rx_post() are compared with the recording. The frame with a
+ * bad FCS must be dropped, the others must come out unchanged.
+ *
+ * The stream is then parsed 'passes' more times in one piece, and the
+ * parse throughput is reported.
+ *
+ * Load the module to run the test; it reports to the kernel log and
+ * fails to load if the test fails.
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ */
+
+#include <linux/init.h>
+#include <linux/kernel.h>
+#include <linux/hrtimer.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/types.h>
+
+static int passes = 1000;
+module_param(passes, int, 0444);
+MODULE_PARM_DESC(passes, "timed parses of the whole stream");
+
+extern int ts0710_mux_rx_replay(const u8 *data, int size, int split,
+				void (*post)(const u8 *frame, int len));
+
+/* Captured on DLCIs 0-5 during registration; the FCS of one is broken */
+static const u8 mux_test_ua[] =
+	"\xf9\x03\x73\x01"
+	"\xd7\xf9";
+
+static const u8 mux_test_ok[] =
+	"\xf9\x07\xef\x0d"
+	"\r\nOK\r\n"
+	"\x3e\xf9";
+
+static const u8 mux_test_cops[] =
+	"\xf9\x0b\xef\x38\x01"
+	"\r\n+COPS: (2,\"T-Mobile\",\"TMO\",\"310260\",2),(1,\"AT"
+	"&T\",\"AT&T\",\"310410\",2),(1,\"Sprint\",\"Sprint\",\"3"
+	"10120\",2),(3,\"Verizon\",\"VZW\",\"311480\",2),,(0,1,2,"
+	"3,4),(0,1,2)\r\n"
+	"\xdd\xf9";
+
+static const u8 mux_test_ring[] =
+	"\xf9\x17\x03\x11"
+	"\r\nRING\r\n"
+	"\x77\xf9";
+
+static const u8 mux_test_bad_fcs[] =
+	"\xf9\x07\xef\x13"
+	"\r\nERROR\r\n"
+	"\x92\xf9";
+
+static const u8 mux_test_creg[] =
+	"\xf9\x0f\xef\x19"
+	"\r\n+CREG: 1\r\n"
+	"\x60\xf9";
+
+/* Line noise before the first flag */
+static const u8 mux_test_noise[] = "\x00\x7e\x41";
+
+struct mux_test_frame {
+	const u8 *data;
+	int len;		/* with both flags */
+	int good;
+};
+
+#define MUX_TEST_FRAME(a, g)	{ a, sizeof(a) - 1, g }
+
+static const struct mux_test_frame mux_test_frames[] = {
+	MUX_TEST_FRAME(mux_test_ua, 1),
+	MUX_TEST_FRAME(mux_test_ok, 1),
+	MUX_TEST_FRAME(mux_test_cops, 1),
+	MUX_TEST_FRAME(mux_test_ring, 1),
+	MUX_TEST_FRAME(mux_test_bad_fcs, 0),
+	MUX_TEST_FRAME(mux_test_creg, 1),
+};
+
+static const int mux_test_splits[] = { 0, 1, 2, 3, 5, 7, 64 };
+
+static int mux_test_next;	/* index in mux_test_frames of the next good one */
+static int mux_test_posted;
+static int mux_test_errors;
+
+static void mux_test_post(const u8 *frame, int len)
+{
+	const struct mux_test_frame *f;
+
+	mux_test_posted++;
+
+	while (mux_test_next < ARRAY_SIZE(mux_test_frames) &&
+	       !mux_test_frames[mux_test_next].good)
+		mux_test_next++;
+	if (mux_test_next >= ARRAY_SIZE(mux_test_frames)) {
+		printk(KERN_ERR "ts0710_mux_test: unexpected frame, len %d\n",
+		       len);
+		mux_test_errors++;
+		return;
+	}
+
+	/* ts_ldisc_rx_post hands over the frame without its flags */
+	f = &mux_test_frames[mux_test_next++];
+	if (len != f->len - 2 || memcmp(frame, f->data + 1, len)) {
+		printk(KERN_ERR "ts0710_mux_test: frame %d mismatch, len %d\n",
+		       mux_test_next - 1, len);
+		mux_test_errors++;
+	}
+}
+
+static void mux_test_count(const u8 *frame, int len)
+{
+	mux_test_posted++;
+}
+
+/* Parses the stream 'passes' times and reports the throughput */
+static int mux_test_throughput(const u8 *stream, int size)
+{
+	ktime_t start;
+	s64 ns;
+	u64 bytes = (u64)size * passes;
+	int i, ret = 0;
+
+	mux_test_posted = 0;
+	start = ktime_get();
+	for (i = 0; i < passes && !ret; i++)
+		ret = ts0710_mux_rx_replay(stream, size, size, mux_test_count);
+	ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+	if (ret)
+		return ret;
+
+	if (ns <= 0)
+		ns = 1;
+	/* bytes per us is MB/s; keep two decimals */
+	printk(KERN_INFO "ts0710_mux_test: %d passes, %llu bytes, %d frames "
+	       "in %lld us, %llu.%02llu MB/s\n", passes, bytes,
+	       mux_test_posted, div_s64(ns, NSEC_PER_USEC),
+	       div64_u64(bytes * 1000, ns),
+	       div64_u64(bytes * 100000, ns) % 100);
+	return 0;
+}
+
+static int __init ts0710_mux_test_init(void)
+{
+	u8 *stream;
+	int size = sizeof(mux_test_noise) - 1;
+	int good = 0;
+	int failed = 0;
+	int i, split, ret;
+
+	for (i = 0; i < ARRAY_SIZE(mux_test_frames); i++) {
+		size += mux_test_frames[i].len;
+		good += mux_test_frames[i].good;
+	}
+
+	stream = kmalloc(size, GFP_KERNEL);
+	if (!stream)
+		return -ENOMEM;
+
+	size = sizeof(mux_test_noise) - 1;
+	memcpy(stream, mux_test_noise, size);
+	for (i = 0; i < ARRAY_SIZE(mux_test_frames); i++) {
+		memcpy(stream + size, mux_test_frames[i].data,
+		       mux_test_frames[i].len);
+		size += mux_test_frames[i].len;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(mux_test_splits); i++) {
+		/* 0: the whole stream at once */
+		split = mux_test_splits[i] ? mux_test_splits[i] : size;
+
+		mux_test_next = 0;
+		mux_test_posted = 0;
+		mux_test_errors = 0;
+
+		ret = ts0710_mux_rx_replay(stream, size, split, mux_test_post);
+		if (ret) {
+			kfree(stream);
+			return ret;
+		}
+
+		if (mux_test_posted != good || mux_test_errors) {
+			printk(KERN_ERR "ts0710_mux_test: split %d: %d of %d "
+			       "frames posted, %d errors\n", split,
+			       mux_test_posted, good, mux_test_errors);
+			failed++;
+		}
+	}
+
+	if (!failed && passes > 0) {
+		ret = mux_test_throughput(stream, size);
+		if (ret) {
+			kfree(stream);
+			return ret;
+		}
+	}
+
+	kfree(stream);
+
+	if (failed) {
+		printk(KERN_ERR "ts0710_mux_test: %d of %d replays failed\n",
+		       failed, (int)ARRAY_SIZE(mux_test_splits));
+		return -EINVAL;
+	}
+
+	printk(KERN_INFO "ts0710_mux_test: %d replays of %d bytes passed\n",
+	       (int)ARRAY_SIZE(mux_test_splits), size);
+	return 0;
+}
+
+static void __exit ts0710_mux_test_exit(void)
+{
+}
+
+module_init(ts0710_mux_test_init);
+module_exit(ts0710_mux_test_exit);
+
+MODULE_DESCRIPTION("gsm0710 multiplexer receive replay test");
+MODULE_LICENSE("GPL");
@@ -84,16 +84,8 @@ static irqreturn_t powerbutton_irq(int irq, void *_pwr)
 #if 1
 	if(ds_status.flag_run_dvs == 1){
         ds_status.flag_touch_timeout_count = DS_TOUCH_TIMEOUT_COUNT_MAX;    // = 6
-        if(ds_status.touch_timeout_sec == 0){
-            if(ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT < 1000000){
-                ds_status.touch_timeout_sec = ds_counter.elapsed_sec;
-                ds_status.touch_timeout_usec = ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT;
-            }
-            else{
-                ds_status.touch_timeout_sec = ds_counter.elapsed_sec + 1;
-                ds_status.touch_timeout_usec = (ds_counter.elapsed_usec + DS_TOUCH_TIMEOUT) - 1000000;
-            }
-        }
+        if(ds_status.touch_timeout_ns == 0)
+            ds_status.touch_timeout_ns = ds_counter.elapsed_ns + DS_TOUCH_TIMEOUT;
     }
 #endif
 /* 20110331 sookyoung.kim@lge.com LG-DVFS [END_LGE] */
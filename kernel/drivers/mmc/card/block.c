@@ -31,6 +31,7 @@
 #include <linux/mutex.h>
 #include <linux/scatterlist.h>
 #include <linux/string_helpers.h>
+#include <linux/ktime.h>
 
 #include <linux/mmc/card.h>
 #include <linux/mmc/host.h>
@@ -93,6 +94,36 @@ struct mmc_blk_data {
 
 	unsigned int	usage;
 	unsigned int	read_only;
+
+	unsigned int	discard_mode;
+	unsigned int	max_discard;	/* sectors per erase command */
+
+	/* Discard statistics, see discard_stats */
+	unsigned long	discards;
+	unsigned long	discard_errors;
+	u64		discard_sectors;
+	u64		discard_us;
+	unsigned int	discard_max_us;
+};
+
+/*
+ * How REQ_DISCARD is carried out, selected through the discard_mode
+ * attribute of the disk. "secure" does a secure trim.
+ */
+enum {
+	MMC_BLK_DISCARD_OFF = 0,
+	MMC_BLK_DISCARD_TRIM,
+	MMC_BLK_DISCARD_ERASE,
+	MMC_BLK_DISCARD_SECURE,
+	MMC_BLK_DISCARD_MODES
+};
+
+static const char *mmc_blk_discard_names[MMC_BLK_DISCARD_MODES] = {
+	"off", "trim", "erase", "secure"
+};
+
+static const unsigned int mmc_blk_discard_args[MMC_BLK_DISCARD_MODES] = {
+	0, MMC_TRIM_ARG, MMC_ERASE_ARG, MMC_SECURE_TRIM1_ARG
 };
 
 static DEFINE_MUTEX(open_lock);
@@ -300,6 +331,99 @@ mmc_blk_set_blksize(struct mmc_blk_data *md, struct mmc_card *card)
 	return 0;
 }
 
+static int mmc_blk_issue_discard_rq(struct mmc_queue *mq, struct request *req)
+{
+	struct mmc_blk_data *md = mq->data;
+	struct mmc_card *card = md->queue.card;
+	unsigned int from, nr, chunk, arg;
+	ktime_t start;
+	s64 us;
+	int err = 0;
+
+	mmc_claim_host(card->host);
+
+	arg = mmc_blk_discard_args[md->discard_mode];
+	if (md->discard_mode == MMC_BLK_DISCARD_OFF)
+		err = -EOPNOTSUPP;
+
+	from = blk_rq_pos(req);
+	nr = blk_rq_sectors(req);
+	start = ktime_get();
+
+	/* Merged requests may be more than the host can wait for */
+	while (!err && nr) {
+		chunk = min(nr, md->max_discard);
+
+		err = mmc_erase(card, from, chunk, arg);
+		if (!err && arg == MMC_SECURE_TRIM1_ARG)
+			err = mmc_erase(card, from, chunk,
+					MMC_SECURE_TRIM2_ARG);
+
+		from += chunk;
+		nr -= chunk;
+	}
+
+	us = ktime_us_delta(ktime_get(), start);
+	md->discards++;
+	if (err)
+		md->discard_errors++;
+	else
+		md->discard_sectors += blk_rq_sectors(req);
+	md->discard_us += us;
+	if (us > md->discard_max_us)
+		md->discard_max_us = us;
+
+	spin_lock_irq(&md->lock);
+	__blk_end_request(req, err, blk_rq_bytes(req));
+	spin_unlock_irq(&md->lock);
+
+	mmc_release_host(card->host);
+
+	return err ? 0 : 1;
+}
+
+/*
+ * Have the host map the request the queue will hand us next, so that
+ * the sg mapping, cache maintenance and DMA descriptors are done while
+ * the card is busy with the current request. blk_peek_request() marks
+ * the request started, so no more bios are merged into it.
+ */
+static void mmc_blk_prep_next(struct mmc_queue *mq)
+{
+	struct mmc_host *host = mq->card->host;
+	struct request_queue *q = mq->queue;
+	struct mmc_data *data = &mq->next_data;
+	struct request *next = NULL;
+
+	if (mq->next_req || !mq->next_sg)
+		return;
+
+	spin_lock_irq(q->queue_lock);
+	if (!blk_queue_plugged(q))
+		next = blk_peek_request(q);
+	spin_unlock_irq(q->queue_lock);
+
+	if (!next || blk_discard_rq(next) ||
+	    blk_rq_sectors(next) > host->max_blk_count)
+		return;
+
+	memset(&mq->next_mrq, 0, sizeof(struct mmc_request));
+	memset(data, 0, sizeof(struct mmc_data));
+	mq->next_mrq.data = data;
+
+	data->blksz = 512;
+	data->blocks = blk_rq_sectors(next);
+	if (rq_data_dir(next) == READ)
+		data->flags = MMC_DATA_READ;
+	else
+		data->flags = MMC_DATA_WRITE;
+	data->sg = mq->next_sg;
+	data->sg_len = mmc_queue_map_next_sg(mq, next);
+
+	mmc_pre_req(host, &mq->next_mrq, false);
+	if (data->host_cookie)
+		mq->next_req = next;
+}
 
 static int mmc_blk_issue_rq(struct mmc_queue *mq, struct request *req)
 {
@@ -315,10 +439,17 @@ static int mmc_blk_issue_rq(struct mmc_queue *mq, struct request *req)
 	}
 #endif
 
+	if (blk_discard_rq(req))
+		return mmc_blk_issue_discard_rq(mq, req);
+
 	mmc_claim_host(card->host);
 
+	if (mq->next_req != req)
+		mmc_queue_unprep_next(mq);
+
 	do {
 		struct mmc_command cmd;
+		struct completion complete;
 		u32 readcmd, writecmd, status = 0;
 
 		memset(&brq, 0, sizeof(struct mmc_blk_request));
@@ -383,8 +514,21 @@ static int mmc_blk_issue_rq(struct mmc_queue *mq, struct request *req)
 
 		mmc_set_data_timeout(&brq.data, card);
 
-		brq.data.sg = mq->sg;
-		brq.data.sg_len = mmc_queue_map_sg(mq);
+		if (mq->next_req == req) {
+			struct scatterlist *sg = mq->sg;
+
+			/* Mapped while the previous request was in flight */
+			mq->sg = mq->next_sg;
+			mq->next_sg = sg;
+			mq->next_req = NULL;
+
+			brq.data.sg = mq->sg;
+			brq.data.sg_len = mq->next_data.sg_len;
+			brq.data.host_cookie = mq->next_data.host_cookie;
+		} else {
+			brq.data.sg = mq->sg;
+			brq.data.sg_len = mmc_queue_map_sg(mq);
+		}
 
 		/*
 		 * Adjust the sg list so it is the same size as the
@@ -407,7 +551,13 @@ static int mmc_blk_issue_rq(struct mmc_queue *mq, struct request *req)
 
 		mmc_queue_bounce_pre(mq);
 
-		mmc_wait_for_req(card->host, &brq.mrq);
+		mmc_start_req(card->host, &brq.mrq, &complete);
+		mmc_blk_prep_next(mq);
+		mmc_wait_for_req_done(&brq.mrq);
+
+		if (brq.data.host_cookie)
+			mmc_post_req(card->host, &brq.mrq,
+				     brq.cmd.error ? : brq.data.error);
 
 		mmc_queue_bounce_post(mq);
 
@@ -569,6 +719,139 @@ static int mmc_blk_issue_rq(struct mmc_queue *mq, struct request *req)
 }
 
 
+static int mmc_blk_discard_supported(struct mmc_card *card,
+				     unsigned int mode)
+{
+	switch (mode) {
+	case MMC_BLK_DISCARD_OFF:
+		return 1;
+	case MMC_BLK_DISCARD_TRIM:
+		return mmc_can_trim(card);
+	case MMC_BLK_DISCARD_ERASE:
+		return mmc_can_erase(card);
+	case MMC_BLK_DISCARD_SECURE:
+		return mmc_can_trim(card) && mmc_can_secure_erase_trim(card);
+	}
+	return 0;
+}
+
+/*
+ * Switch the discard mode and advertise it on the queue. With erases
+ * the card works on whole erase groups, so say so in the granularity.
+ * Called with the host claimed, or before the disk is added, so no
+ * discard is in progress.
+ */
+static int mmc_blk_set_discard(struct mmc_blk_data *md, unsigned int mode)
+{
+	struct mmc_card *card = md->queue.card;
+	struct request_queue *q = md->queue.queue;
+	unsigned int max_discard = 0;
+
+	if (!mmc_blk_discard_supported(card, mode))
+		return -EINVAL;
+
+	if (mode != MMC_BLK_DISCARD_OFF) {
+		max_discard = mmc_calc_max_discard(card,
+						   mmc_blk_discard_args[mode]);
+		if (!max_discard)
+			return -EINVAL;
+	}
+
+	spin_lock_irq(&md->lock);
+	md->discard_mode = mode;
+	md->max_discard = max_discard;
+	if (mode == MMC_BLK_DISCARD_OFF) {
+		queue_flag_clear(QUEUE_FLAG_DISCARD, q);
+	} else {
+		queue_flag_set(QUEUE_FLAG_DISCARD, q);
+		q->limits.max_discard_sectors = max_discard;
+		if (mode == MMC_BLK_DISCARD_ERASE)
+			q->limits.discard_granularity = card->erase_size << 9;
+		else
+			q->limits.discard_granularity = 0;
+	}
+	spin_unlock_irq(&md->lock);
+
+	return 0;
+}
+
+static ssize_t mmc_blk_discard_mode_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct mmc_blk_data *md = mmc_blk_get(dev_to_disk(dev));
+	int mode, len = 0;
+
+	if (!md)
+		return -ENODEV;
+
+	for (mode = 0; mode < MMC_BLK_DISCARD_MODES; mode++) {
+		if (!mmc_blk_discard_supported(md->queue.card, mode))
+			continue;
+		if (mode == md->discard_mode)
+			len += sprintf(buf + len, "[%s] ",
+				       mmc_blk_discard_names[mode]);
+		else
+			len += sprintf(buf + len, "%s ",
+				       mmc_blk_discard_names[mode]);
+	}
+	buf[len - 1] = '\n';
+
+	mmc_blk_put(md);
+	return len;
+}
+
+static ssize_t mmc_blk_discard_mode_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	struct mmc_blk_data *md = mmc_blk_get(dev_to_disk(dev));
+	struct mmc_card *card;
+	int mode, ret = -EINVAL;
+
+	if (!md)
+		return -ENODEV;
+
+	card = md->queue.card;
+	for (mode = 0; mode < MMC_BLK_DISCARD_MODES; mode++) {
+		if (sysfs_streq(buf, mmc_blk_discard_names[mode])) {
+			mmc_claim_host(card->host);
+			ret = mmc_blk_set_discard(md, mode);
+			mmc_release_host(card->host);
+			break;
+		}
+	}
+
+	mmc_blk_put(md);
+	return ret ? ret : count;
+}
+
+static DEVICE_ATTR(discard_mode, S_IRUGO | S_IWUSR,
+		   mmc_blk_discard_mode_show, mmc_blk_discard_mode_store);
+
+/*
+ * requests, sectors discarded, failed requests, total and longest time
+ * spent in a request in us
+ */
+static ssize_t mmc_blk_discard_stats_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct mmc_blk_data *md = mmc_blk_get(dev_to_disk(dev));
+	int len;
+
+	if (!md)
+		return -ENODEV;
+
+	len = sprintf(buf, "%lu %llu %lu %llu %u\n", md->discards,
+		      (unsigned long long)md->discard_sectors,
+		      md->discard_errors,
+		      (unsigned long long)md->discard_us,
+		      md->discard_max_us);
+
+	mmc_blk_put(md);
+	return len;
+}
+
+static DEVICE_ATTR(discard_stats, S_IRUGO, mmc_blk_discard_stats_show, NULL);
+
 static inline int mmc_blk_readonly(struct mmc_card *card)
 {
 	return mmc_card_readonly(card) ||
@@ -623,6 +906,9 @@ static struct mmc_blk_data *mmc_blk_alloc(struct mmc_card *card)
 	md->queue.issue_fn = mmc_blk_issue_rq;
 	md->queue.data = md;
 
+	if (mmc_blk_set_discard(md, MMC_BLK_DISCARD_TRIM))
+		mmc_blk_set_discard(md, MMC_BLK_DISCARD_ERASE);
+
 	md->disk->major	= MMC_BLOCK_MAJOR;
 #ifdef CONFIG_LGE_MAX_MINORS_PATCH
 	md->disk->first_minor = devidx * perdev_minors;
@@ -712,6 +998,11 @@ static int mmc_blk_probe(struct mmc_card *card)
 	mmc_set_bus_resume_policy(card->host, 1);
 #endif
 	add_disk(md->disk);
+
+	if (device_create_file(disk_to_dev(md->disk), &dev_attr_discard_mode) ||
+	    device_create_file(disk_to_dev(md->disk), &dev_attr_discard_stats))
+		printk(KERN_WARNING "%s: unable to create discard attributes\n",
+		       md->disk->disk_name);
 	return 0;
 
  out:
@@ -726,6 +1017,11 @@ static void mmc_blk_remove(struct mmc_card *card)
 	struct mmc_blk_data *md = mmc_get_drvdata(card);
 
 	if (md) {
+		device_remove_file(disk_to_dev(md->disk),
+				   &dev_attr_discard_stats);
+		device_remove_file(disk_to_dev(md->disk),
+				   &dev_attr_discard_mode);
+
 		/* Stop new requests from getting into the queue */
 		del_gendisk(md->disk);
 
@@ -63,6 +63,11 @@ static int mmc_queue_thread(void *d)
 		if (!req) {
 			if (kthread_should_stop()) {
 				set_current_state(TASK_RUNNING);
+				if (mq->next_req) {
+					mmc_claim_host(mq->card->host);
+					mmc_queue_unprep_next(mq);
+					mmc_release_host(mq->card->host);
+				}
 				break;
 			}
 			up(&mq->thread_sem);
@@ -192,6 +197,18 @@ int mmc_init_queue(struct mmc_queue *mq, struct mmc_card *card, spinlock_t *lock
 			goto cleanup_queue;
 		}
 		sg_init_table(mq->sg, host->max_phys_segs);
+
+		/*
+		 * Hosts that can prepare a request ahead of time get a
+		 * second table for the next request. Not having one only
+		 * costs the overlap.
+		 */
+		if (host->ops->pre_req) {
+			mq->next_sg = kmalloc(sizeof(struct scatterlist) *
+				host->max_phys_segs, GFP_KERNEL);
+			if (mq->next_sg)
+				sg_init_table(mq->next_sg, host->max_phys_segs);
+		}
 	}
 
 	init_MUTEX(&mq->thread_sem);
@@ -211,6 +228,8 @@ int mmc_init_queue(struct mmc_queue *mq, struct mmc_card *card, spinlock_t *lock
  	if (mq->sg)
 		kfree(mq->sg);
 	mq->sg = NULL;
+	kfree(mq->next_sg);
+	mq->next_sg = NULL;
 	if (mq->bounce_buf)
 		kfree(mq->bounce_buf);
 	mq->bounce_buf = NULL;
@@ -242,6 +261,9 @@ void mmc_cleanup_queue(struct mmc_queue *mq)
 	kfree(mq->sg);
 	mq->sg = NULL;
 
+	kfree(mq->next_sg);
+	mq->next_sg = NULL;
+
 	if (mq->bounce_buf)
 		kfree(mq->bounce_buf);
 	mq->bounce_buf = NULL;
@@ -322,6 +344,30 @@ unsigned int mmc_queue_map_sg(struct mmc_queue *mq)
 	return 1;
 }
 
+/*
+ * Map the request the queue will hand out next into the spare sg list.
+ * Only used without a bounce buffer.
+ */
+unsigned int mmc_queue_map_next_sg(struct mmc_queue *mq, struct request *req)
+{
+	BUG_ON(!mq->next_sg);
+
+	return blk_rq_map_sg(mq->queue, req, mq->next_sg);
+}
+
+/*
+ * Drop the request prepared ahead of time, e.g. because the queue
+ * handed out another one first. The host must be claimed.
+ */
+void mmc_queue_unprep_next(struct mmc_queue *mq)
+{
+	if (!mq->next_req)
+		return;
+
+	mmc_post_req(mq->card->host, &mq->next_mrq, -EINVAL);
+	mq->next_req = NULL;
+}
+
 /*
  * If writing, bounce the data to the buffer before the request
  * is sent to the host driver
@@ -17,6 +17,12 @@ struct mmc_queue {
 	char			*bounce_buf;
 	struct scatterlist	*bounce_sg;
 	unsigned int		bounce_sg_len;
+
+	/* next request, prepared while the current one is in flight */
+	struct request		*next_req;
+	struct scatterlist	*next_sg;
+	struct mmc_request	next_mrq;
+	struct mmc_data		next_data;
 };
 
 extern int mmc_init_queue(struct mmc_queue *, struct mmc_card *, spinlock_t *);
@@ -25,6 +31,9 @@ extern void mmc_queue_suspend(struct mmc_queue *);
 extern void mmc_queue_resume(struct mmc_queue *);
 
 extern unsigned int mmc_queue_map_sg(struct mmc_queue *);
+extern unsigned int mmc_queue_map_next_sg(struct mmc_queue *,
+	struct request *);
+extern void mmc_queue_unprep_next(struct mmc_queue *);
 extern void mmc_queue_bounce_pre(struct mmc_queue *);
 extern void mmc_queue_bounce_post(struct mmc_queue *);
 
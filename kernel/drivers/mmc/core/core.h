@@ -36,6 +36,7 @@ void mmc_set_bus_width(struct mmc_host *host, unsigned int width);
 void mmc_set_bus_width_ddr(struct mmc_host *host, unsigned int width, int ddr);
 u32 mmc_select_voltage(struct mmc_host *host, u32 ocr);
 void mmc_set_timing(struct mmc_host *host, unsigned int timing);
+void mmc_init_erase(struct mmc_card *card);
 
 #if 1//def CONFIG_LGE_MMC_WORKAROUND//LGE_CHANGES
 void mmc_power_up(struct mmc_host *host);
@@ -104,6 +104,8 @@
 #define ADMA_TABLE_SZ (PAGE_SIZE)
 #define ADMA_TABLE_NUM_ENTRIES \
 	(ADMA_TABLE_SZ / sizeof(struct adma_desc_table))
+/* One table for the current request, one for the prepared next one */
+#define ADMA_TABLES_SZ (2 * ADMA_TABLE_SZ)
 
 #define SDMA_XFER	1
 #define ADMA_XFER	2
@@ -162,6 +164,13 @@ struct adma_desc_table {
 	dma_addr_t addr;
 };
 
+/* A request mapped by omap_hsmmc_pre_req() ahead of time */
+struct omap_hsmmc_next {
+	unsigned int	dma_len;
+	int		adma_idx;
+	s32		cookie;
+};
+
 struct omap_hsmmc_host {
 	struct	device		*dev;
 	struct	mmc_host	*mmc;
@@ -196,9 +205,12 @@ struct omap_hsmmc_host {
 	int			suspended;
 	int			irq;
 	int			dma_type, dma_ch;
+	int			sdma_ch;	/* kept while enabled */
 	int			polling_enabled;
 	struct adma_desc_table 	*adma_table;
 	dma_addr_t		phy_adma_table;
+	int			adma_idx;	/* table in use */
+	struct omap_hsmmc_next	next_data;
 	int			dma_line_tx, dma_line_rx;
 	int			slot_id;
 	int			got_dbclk;
@@ -933,7 +945,7 @@ omap_hsmmc_xfer_done(struct omap_hsmmc_host *host, struct mmc_data *data)
 
 	host->data = NULL;
 
-	if (host->dma_type == ADMA_XFER)
+	if (host->dma_type == ADMA_XFER && !data->host_cookie)
 		dma_unmap_sg(mmc_dev(host->mmc), data->sg, host->dma_len,
 					omap_hsmmc_get_dma_dir(host, data));
 
@@ -988,9 +1000,11 @@ static void omap_hsmmc_dma_cleanup(struct omap_hsmmc_host *host, int errno)
 	spin_unlock(&host->irq_lock);
 
 	if ((host->dma_type == SDMA_XFER) && (dma_ch != -1)) {
-		dma_unmap_sg(mmc_dev(host->mmc), host->data->sg, host->dma_len,
-			omap_hsmmc_get_dma_dir(host, host->data));
-		omap_free_dma(dma_ch);
+		omap_stop_dma(dma_ch);
+		if (!host->data->host_cookie)
+			dma_unmap_sg(mmc_dev(host->mmc), host->data->sg,
+				host->dma_len,
+				omap_hsmmc_get_dma_dir(host, host->data));
 	}
 	host->data = NULL;
 }
@@ -1362,7 +1376,7 @@ static void omap_hsmmc_dma_cb(int lch, u16 ch_status, void *cb_data)
 {
 	struct omap_hsmmc_host *host = cb_data;
 	struct mmc_data *data = host->mrq->data;
-	int dma_ch, req_in_progress;
+	int req_in_progress;
 
 	if (!(ch_status & OMAP_DMA_BLOCK_IRQ)) {
 		dev_warn(mmc_dev(host->mmc), "unexpected dma status %x\n",
@@ -1385,16 +1399,14 @@ static void omap_hsmmc_dma_cb(int lch, u16 ch_status, void *cb_data)
 		return;
 	}
 
-	dma_unmap_sg(mmc_dev(host->mmc), data->sg, host->dma_len,
-		omap_hsmmc_get_dma_dir(host, data));
+	if (!data->host_cookie)
+		dma_unmap_sg(mmc_dev(host->mmc), data->sg, host->dma_len,
+			omap_hsmmc_get_dma_dir(host, data));
 
 	req_in_progress = host->req_in_progress;
-	dma_ch = host->dma_ch;
 	host->dma_ch = -1;
 	spin_unlock(&host->irq_lock);
 
-	omap_free_dma(dma_ch);
-
 	/* If DMA has finished after TC, complete the request */
 	if (!req_in_progress) {
 		struct mmc_request *mrq = host->mrq;
@@ -1404,62 +1416,16 @@ static void omap_hsmmc_dma_cb(int lch, u16 ch_status, void *cb_data)
 	}
 }
 
-/*
- * Routine to configure and start DMA for the MMC card
- */
-static int omap_hsmmc_start_sdma_transfer(struct omap_hsmmc_host *host,
-					struct mmc_request *req)
-{
-	int dma_ch = 0, ret = 0, i;
-	struct mmc_data *data = req->data;
-
-	/* Sanity check: all the SG entries must be aligned by block size. */
-	for (i = 0; i < data->sg_len; i++) {
-		struct scatterlist *sgl;
-
-		sgl = data->sg + i;
-		if (sgl->length % data->blksz)
-			return -EINVAL;
-	}
-	if ((data->blksz % 4) != 0)
-		/* REVISIT: The MMC buffer increments only when MSB is written.
-		 * Return error for blksz which is non multiple of four.
-		 */
-		return -EINVAL;
-
-	BUG_ON(host->dma_ch != -1);
-
-	ret = omap_request_dma(omap_hsmmc_get_dma_sync_dev(host, data),
-			       "MMC/SD", omap_hsmmc_dma_cb, host, &dma_ch);
-	if (ret != 0) {
-		dev_err(mmc_dev(host->mmc),
-			"%s: omap_request_dma() failed with %d\n",
-			mmc_hostname(host->mmc), ret);
-		return ret;
-	}
-
-	host->dma_len = dma_map_sg(mmc_dev(host->mmc), data->sg,
-			data->sg_len, omap_hsmmc_get_dma_dir(host, data));
-	host->dma_ch = dma_ch;
-	host->dma_sg_idx = 0;
-
-	omap_hsmmc_config_dma_params(host, data, data->sg);
-
-	return 0;
-}
-
 static int mmc_populate_adma_desc_table(struct omap_hsmmc_host *host,
-		struct mmc_request *req, struct adma_desc_table *pdesc)
+		struct mmc_data *data, struct adma_desc_table *pdesc,
+		int dma_len)
 {
 	int i, j, dmalen;
 	int splitseg, xferaddr;
 	int numblocks = 0;
 	dma_addr_t dmaaddr;
-	struct mmc_data *data = req->data;
 
-	host->dma_len = dma_map_sg(mmc_dev(host->mmc), data->sg,
-			data->sg_len, omap_hsmmc_get_dma_dir(host, data));
-	for (i = 0, j = 0; i < host->dma_len; i++) {
+	for (i = 0, j = 0; i < dma_len; i++) {
 		dmaaddr = sg_dma_address(data->sg + i);
 		dmalen = sg_dma_len(data->sg + i);
 		numblocks += dmalen / data->blksz;
@@ -1497,14 +1463,145 @@ static int mmc_populate_adma_desc_table(struct omap_hsmmc_host *host,
 	WARN_ON((i + j - 1) > ADMA_TABLE_NUM_ENTRIES);
 	dev_dbg(mmc_dev(host->mmc),
 		"ADMA table has %d entries from %d sglist\n",
-		i + j, host->dma_len);
+		i + j, dma_len);
 	return numblocks;
 }
 
+/*
+ * Map the data for DMA: sg mapping with its cache maintenance and, for
+ * ADMA, the descriptor table. With @next the request is prepared ahead
+ * of time by omap_hsmmc_pre_req() while another one may be in flight,
+ * so the spare ADMA table is used. Otherwise the request is about to be
+ * started and the prepared mapping is taken over if the cookie matches.
+ */
+static int omap_hsmmc_pre_dma_transfer(struct omap_hsmmc_host *host,
+				       struct mmc_data *data,
+				       struct omap_hsmmc_next *next)
+{
+	int dma_len, idx, numblks, i;
+
+	if (!next && data->host_cookie &&
+	    data->host_cookie != host->next_data.cookie) {
+		dev_warn(mmc_dev(host->mmc), "invalid cookie %d, next %d\n",
+			 data->host_cookie, host->next_data.cookie);
+		data->host_cookie = 0;
+	}
+
+	if (!next && data->host_cookie) {
+		dma_len = host->next_data.dma_len;
+		idx = host->next_data.adma_idx;
+		host->next_data.dma_len = 0;
+		goto mapped;
+	}
+
+	if (host->dma_type == SDMA_XFER) {
+		/*
+		 * Sanity check: all the SG entries must be aligned by
+		 * block size.
+		 */
+		for (i = 0; i < data->sg_len; i++) {
+			struct scatterlist *sgl;
+
+			sgl = data->sg + i;
+			if (sgl->length % data->blksz)
+				return -EINVAL;
+		}
+		if ((data->blksz % 4) != 0)
+			/* REVISIT: The MMC buffer increments only when MSB is
+			 * written. Return error for blksz which is non
+			 * multiple of four.
+			 */
+			return -EINVAL;
+	}
+
+	dma_len = dma_map_sg(mmc_dev(host->mmc), data->sg, data->sg_len,
+			     omap_hsmmc_get_dma_dir(host, data));
+	if (dma_len == 0)
+		return -EINVAL;
+
+	/* Keep off the table of the request in flight / prepared */
+	if (next)
+		idx = host->adma_idx ^ 1;
+	else if (host->next_data.dma_len)
+		idx = host->next_data.adma_idx ^ 1;
+	else
+		idx = host->adma_idx;
+
+	if (host->dma_type == ADMA_XFER) {
+		numblks = mmc_populate_adma_desc_table(host, data,
+				host->adma_table + idx * ADMA_TABLE_NUM_ENTRIES,
+				dma_len);
+		WARN_ON(numblks != data->blocks);
+	}
+
+mapped:
+	if (next) {
+		next->dma_len = dma_len;
+		next->adma_idx = idx;
+		if (++next->cookie < 0)
+			next->cookie = 1;
+		data->host_cookie = next->cookie;
+	} else {
+		host->dma_len = dma_len;
+		host->adma_idx = idx;
+	}
+
+	return 0;
+}
+
+/*
+ * Routine to configure and start DMA for the MMC card
+ */
+static int omap_hsmmc_start_sdma_transfer(struct omap_hsmmc_host *host,
+					struct mmc_request *req)
+{
+	int dma_ch = 0, ret = 0;
+	struct mmc_data *data = req->data;
+
+	BUG_ON(host->dma_ch != -1);
+
+	/*
+	 * The channel is kept until the host is disabled, the sync device
+	 * is reprogrammed by omap_hsmmc_config_dma_params() per transfer.
+	 */
+	if (host->sdma_ch < 0) {
+		ret = omap_request_dma(omap_hsmmc_get_dma_sync_dev(host, data),
+				"MMC/SD", omap_hsmmc_dma_cb, host, &dma_ch);
+		if (ret != 0) {
+			dev_err(mmc_dev(host->mmc),
+				"%s: omap_request_dma() failed with %d\n",
+				mmc_hostname(host->mmc), ret);
+			return ret;
+		}
+		host->sdma_ch = dma_ch;
+	}
+
+	ret = omap_hsmmc_pre_dma_transfer(host, data, NULL);
+	if (ret != 0)
+		return ret;
+
+	host->dma_ch = host->sdma_ch;
+	host->dma_sg_idx = 0;
+
+	omap_hsmmc_config_dma_params(host, data, data->sg);
+
+	return 0;
+}
+
+static void omap_hsmmc_free_dma_ch(struct omap_hsmmc_host *host)
+{
+	if (host->sdma_ch < 0)
+		return;
+
+	omap_free_dma(host->sdma_ch);
+	host->sdma_ch = -1;
+}
+
 static void omap_hsmmc_start_adma_transfer(struct omap_hsmmc_host *host)
 {
 	wmb();
-	OMAP_HSMMC_WRITE(host, ADMA_SAL, host->phy_adma_table);
+	OMAP_HSMMC_WRITE(host, ADMA_SAL,
+		host->phy_adma_table + host->adma_idx * ADMA_TABLE_SZ);
 }
 
 static void set_data_timeout(struct omap_hsmmc_host *host,
@@ -1551,7 +1648,6 @@ static int
 omap_hsmmc_prepare_data(struct omap_hsmmc_host *host, struct mmc_request *req)
 {
 	int ret;
-	int numblks;
 
 	host->data = req->data;
 
@@ -1559,10 +1655,16 @@ omap_hsmmc_prepare_data(struct omap_hsmmc_host *host, struct mmc_request *req)
 		OMAP_HSMMC_WRITE(host, BLK, 0);
 		/*
 		 * Set an arbitrary 100ms data timeout for commands with
-		 * busy signal.
+		 * busy signal, erases say how long they may take.
 		 */
-		if (req->cmd->flags & MMC_RSP_BUSY)
-			set_data_timeout(host, 100000000U, 0);
+		if (req->cmd->flags & MMC_RSP_BUSY) {
+			unsigned int timeout_ms = 100;
+
+			if (req->cmd->erase_timeout > timeout_ms)
+				timeout_ms = min(req->cmd->erase_timeout,
+						 host->mmc->max_discard_to);
+			set_data_timeout(host, timeout_ms * 1000000U, 0);
+		}
 		return 0;
 	}
 
@@ -1577,14 +1679,45 @@ omap_hsmmc_prepare_data(struct omap_hsmmc_host *host, struct mmc_request *req)
 			return ret;
 		}
 	} else if (host->dma_type == ADMA_XFER) {
-		numblks = mmc_populate_adma_desc_table(host,
-				req, host->adma_table);
-		WARN_ON(numblks != req->data->blocks);
+		ret = omap_hsmmc_pre_dma_transfer(host, req->data, NULL);
+		if (ret != 0)
+			return ret;
 		omap_hsmmc_start_adma_transfer(host);
 	}
 	return 0;
 }
 
+static void omap_hsmmc_post_req(struct mmc_host *mmc, struct mmc_request *mrq,
+				int err)
+{
+	struct omap_hsmmc_host *host = mmc_priv(mmc);
+	struct mmc_data *data = mrq->data;
+
+	if (host->dma_type && data->host_cookie) {
+		dma_unmap_sg(mmc_dev(host->mmc), data->sg, data->sg_len,
+			     omap_hsmmc_get_dma_dir(host, data));
+		/* Dropped before it was started */
+		if (data->host_cookie == host->next_data.cookie)
+			host->next_data.dma_len = 0;
+		data->host_cookie = 0;
+	}
+}
+
+static void omap_hsmmc_pre_req(struct mmc_host *mmc, struct mmc_request *mrq,
+			       bool is_first_req)
+{
+	struct omap_hsmmc_host *host = mmc_priv(mmc);
+
+	if (mrq->data->host_cookie) {
+		mrq->data->host_cookie = 0;
+		return;
+	}
+
+	if (host->dma_type &&
+	    omap_hsmmc_pre_dma_transfer(host, mrq->data, &host->next_data))
+		mrq->data->host_cookie = 0;
+}
+
 /*
  * Request function. for read/write operation
  */
@@ -1915,6 +2048,7 @@ enum {ENABLED = 0, DISABLED, CARDSLEEP, REGSLEEP, OFF};
 /* Handler for [ENABLED -> DISABLED] transition */
 static int omap_hsmmc_enabled_to_disabled(struct omap_hsmmc_host *host)
 {
+	omap_hsmmc_free_dma_ch(host);
 	pm_runtime_put_sync(host->dev);
 
 	host->dpm_state = DISABLED;
@@ -2156,6 +2290,7 @@ static int omap_hsmmc_disable_simple(struct mmc_host *mmc, int lazy)
 {
 	struct omap_hsmmc_host *host = mmc_priv(mmc);
 
+	omap_hsmmc_free_dma_ch(host);
 	pm_runtime_put_sync(host->dev);
 #ifdef CONFIG_OMAP_PM
 	if ((mmc_slot(host).features & HSMMC_DVFS_24MHZ_CONST) &&
@@ -2175,6 +2310,8 @@ static int omap_hsmmc_disable_simple(struct mmc_host *mmc, int lazy)
 static const struct mmc_host_ops omap_hsmmc_ops = {
 	.enable = omap_hsmmc_enable_simple,
 	.disable = omap_hsmmc_disable_simple,
+	.post_req = omap_hsmmc_post_req,
+	.pre_req = omap_hsmmc_pre_req,
 	.request = omap_hsmmc_request,
 	.set_ios = omap_hsmmc_set_ios,
 	.get_cd = omap_hsmmc_get_cd,
@@ -2185,6 +2322,8 @@ static const struct mmc_host_ops omap_hsmmc_ops = {
 static const struct mmc_host_ops omap_hsmmc_ps_ops = {
 	.enable = omap_hsmmc_enable,
 	.disable = omap_hsmmc_disable,
+	.post_req = omap_hsmmc_post_req,
+	.pre_req = omap_hsmmc_pre_req,
 	.request = omap_hsmmc_request,
 	.set_ios = omap_hsmmc_set_ios,
 	.get_cd = omap_hsmmc_get_cd,
@@ -2313,6 +2452,7 @@ static int __init omap_hsmmc_probe(struct platform_device *pdev)
 	host->dma_type	= SDMA_XFER;
 	host->dev->dma_mask = &pdata->dma_mask;
 	host->dma_ch	= -1;
+	host->sdma_ch	= -1;
 	host->irq	= irq;
 	host->id	= pdev->id;
 	host->slot_id	= 0;
@@ -2356,6 +2496,9 @@ static int __init omap_hsmmc_probe(struct platform_device *pdev)
 	mmc->f_min	= 400000;
 	mmc->f_max	= 52000000;
 
+	/* Largest data timeout set_data_timeout() can program at f_max */
+	mmc->max_discard_to = (1 << 27) / (mmc->f_max / 1000);
+
 	spin_lock_init(&host->irq_lock);
 
 	host->iclk = clk_get(&pdev->dev, "ick");
@@ -2407,7 +2550,7 @@ static int __init omap_hsmmc_probe(struct platform_device *pdev)
 		 * due to unset conherency mask
 		 */
 		host->adma_table = dma_alloc_coherent(NULL,
-			ADMA_TABLE_SZ, &host->phy_adma_table, 0);
+			ADMA_TABLES_SZ, &host->phy_adma_table, 0);
 		if (host->adma_table != NULL)
 			host->dma_type = ADMA_XFER;
 	}
@@ -2546,7 +2689,7 @@ err_irq:
 	}
 err1:
 	if (host->adma_table != NULL)
-		dma_free_coherent(NULL, ADMA_TABLE_SZ,
+		dma_free_coherent(NULL, ADMA_TABLES_SZ,
 			host->adma_table, host->phy_adma_table);
 
 	iounmap(host->base);
@@ -2579,10 +2722,11 @@ static int omap_hsmmc_remove(struct platform_device *pdev)
 		flush_scheduled_work();
 
 		if (host->adma_table != NULL)
-			dma_free_coherent(NULL, ADMA_TABLE_SZ,
+			dma_free_coherent(NULL, ADMA_TABLES_SZ,
 				host->adma_table, host->phy_adma_table);
 
 		mmc_host_disable(host->mmc);
+		omap_hsmmc_free_dma_ch(host);
 		pm_runtime_suspend(host->dev);
 
 		clk_put(host->fclk);
@@ -140,6 +140,8 @@ typedef struct dhd_pub {
 	/* Last error return */
 	int bcmerror;
 	uint tickcnt;
+	uint wd_period;		/* Current watchdog period (ms) */
+	uint wd_idleticks;	/* Watchdog ticks at a backed-off period */
 
 	/* Last error from dongle */
 	int dongle_error;
@@ -60,6 +60,9 @@ extern int dhd_bus_rxctl(struct dhd_bus *bus, uchar *msg, uint msglen);
 /* Watchdog timer function */
 extern bool dhd_bus_watchdog(dhd_pub_t *dhd);
 
+/* Nothing for the watchdog to do until the next bus activity */
+extern bool dhd_bus_idle(dhd_pub_t *dhd);
+
 #if defined(DHD_DEBUG)
 /* Device console input function */
 extern int dhd_bus_console_in(dhd_pub_t *dhd, uchar *msg, uint msglen);
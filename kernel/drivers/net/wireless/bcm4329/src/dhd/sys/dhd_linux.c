@@ -312,6 +312,13 @@ typedef struct dhd_info {
 	atomic_t pend_8021x_cnt;
     dhd_attach_states_t dhd_state;
 
+#ifdef DHD_RX_NAPI
+	/* Rx frames waiting for the NAPI poll */
+	struct napi_struct rx_napi;
+	struct sk_buff_head rx_napi_q;
+	bool rx_napi_on;
+#endif /* DHD_RX_NAPI */
+
 #ifdef CONFIG_HAS_EARLYSUSPEND
 	struct early_suspend early_suspend;
 #endif /* CONFIG_HAS_EARLYSUSPEND */
@@ -351,6 +358,10 @@ module_param(dhd_sysioc, uint, 0);
 uint dhd_watchdog_ms = 10;
 module_param(dhd_watchdog_ms, uint, 0);
 
+/* Max watchdog interval while the bus is idle (0 = no backoff) */
+uint dhd_watchdog_max_ms = 1280;
+module_param(dhd_watchdog_max_ms, uint, 0);
+
 #if defined(DHD_DEBUG)
 /* Console poll interval */
 uint dhd_console_ms = 250;
@@ -463,6 +474,16 @@ module_param(dhd_rxbound, uint, 0);
 extern uint dhd_deferred_tx;
 module_param(dhd_deferred_tx, uint, 0);
 
+#ifdef DHD_RX_NAPI
+/* Deliver rx frames through NAPI and GRO instead of netif_rx_ni() */
+uint dhd_rx_napi = TRUE;
+module_param(dhd_rx_napi, uint, 0);
+
+/* Max frames handed to the stack per NAPI poll */
+uint dhd_rx_napi_weight = 64;
+module_param(dhd_rx_napi_weight, uint, 0);
+#endif /* DHD_RX_NAPI */
+
 
 
 #ifdef SDTEST
@@ -1008,6 +1029,32 @@ _dhd_set_mac_address(dhd_info_t *dhd, int ifidx, struct ether_addr *addr)
 extern struct net_device *ap_net_dev;
 #endif
 
+#ifdef DHD_RX_NAPI
+/* Drop the frames still queued for a virtual interface going away, and let
+ * a running poll finish, so that no skb->dev outlives its net_device.
+ */
+static void
+dhd_rx_napi_flush_if(dhd_info_t *dhd, struct net_device *net)
+{
+	struct sk_buff *skb, *tmp;
+	unsigned long flags;
+
+	spin_lock_irqsave(&dhd->rx_napi_q.lock, flags);
+	skb_queue_walk_safe(&dhd->rx_napi_q, skb, tmp) {
+		if (skb->dev == net) {
+			__skb_unlink(skb, &dhd->rx_napi_q);
+			dev_kfree_skb_any(skb);
+		}
+	}
+	spin_unlock_irqrestore(&dhd->rx_napi_q.lock, flags);
+
+	if (dhd->rx_napi_on)
+		napi_synchronize(&dhd->rx_napi);
+}
+#else
+#define dhd_rx_napi_flush_if(dhd, net)	do { } while (0)
+#endif /* DHD_RX_NAPI */
+
 static void
 dhd_op_if(dhd_if_t *ifp)
 {
@@ -1030,6 +1077,7 @@ dhd_op_if(dhd_if_t *ifp)
 			DHD_ERROR(("%s: ERROR: netdev:%s already exists, try free & unregister \n",
 			 __FUNCTION__, ifp->net->name));
 			netif_stop_queue(ifp->net);
+			dhd_rx_napi_flush_if(dhd, ifp->net);
 			unregister_netdev(ifp->net);
 			free_netdev(ifp->net);
 		}
@@ -1083,6 +1131,7 @@ dhd_op_if(dhd_if_t *ifp)
 
 	if (ret < 0) {
 		if (ifp->net) {
+			dhd_rx_napi_flush_if(dhd, ifp->net);
 			unregister_netdev(ifp->net);
 			free_netdev(ifp->net);
 		}
@@ -1464,6 +1513,19 @@ dhd_rx_frame(dhd_pub_t *dhdp, int ifidx, void *pktbuf, int numpkt)
 		dhdp->dstats.rx_bytes += skb->len;
 		dhdp->rx_packets++; /* Local count */
 
+#ifdef DHD_RX_NAPI
+		if (dhd->rx_napi_on) {
+			/* Bounded like the netif_rx() backlog */
+			if (skb_queue_len(&dhd->rx_napi_q) >= netdev_max_backlog) {
+				dhdp->rx_dropped++;
+				dev_kfree_skb_any(skb);
+			} else {
+				skb_queue_tail(&dhd->rx_napi_q, skb);
+			}
+			continue;
+		}
+#endif /* DHD_RX_NAPI */
+
 		if (in_interrupt()) {
 			netif_rx(skb);
 		} else {
@@ -1484,9 +1546,49 @@ dhd_rx_frame(dhd_pub_t *dhdp, int ifidx, void *pktbuf, int numpkt)
 #endif /* LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 0) */
 		}
 	}
+
+#ifdef DHD_RX_NAPI
+	/* One NET_RX softirq pass for the whole chain, e.g. a glommed superframe */
+	if (dhd->rx_napi_on && !skb_queue_empty(&dhd->rx_napi_q)) {
+		if (in_interrupt()) {
+			napi_schedule(&dhd->rx_napi);
+		} else {
+			/* Run the poll right away, as netif_rx_ni() would */
+			local_bh_disable();
+			napi_schedule(&dhd->rx_napi);
+			local_bh_enable();
+		}
+	}
+#endif /* DHD_RX_NAPI */
+
 	DHD_OS_WAKE_LOCK_TIMEOUT_ENABLE(dhdp);
 }
 
+#ifdef DHD_RX_NAPI
+static int
+dhd_rx_napi_poll(struct napi_struct *napi, int budget)
+{
+	dhd_info_t *dhd = container_of(napi, dhd_info_t, rx_napi);
+	struct sk_buff *skb;
+	int work_done = 0;
+
+	while (work_done < budget && (skb = skb_dequeue(&dhd->rx_napi_q)) != NULL) {
+		/* TCP is coalesced; without TOE tcp4_gro_receive() checks the sum */
+		napi_gro_receive(napi, skb);
+		work_done++;
+	}
+
+	if (work_done < budget) {
+		napi_complete(napi);
+		/* Frames queued since the last dequeue found us still scheduled */
+		if (!skb_queue_empty(&dhd->rx_napi_q))
+			napi_schedule(napi);
+	}
+
+	return work_done;
+}
+#endif /* DHD_RX_NAPI */
+
 void
 dhd_event(struct dhd_info *dhd, char *evpkt, int evlen, int ifidx)
 {
@@ -1545,6 +1647,26 @@ dhd_get_stats(struct net_device *net)
 	return &ifp->stats;
 }
 
+/* Doubles the watchdog period up to dhd_watchdog_max_ms while the bus is idle.
+ * dhd_os_wd_timer() brings it back to dhd_watchdog_ms on the next bus activity.
+ */
+static uint
+dhd_watchdog_period(dhd_info_t *dhd)
+{
+	dhd_pub_t *dhdp = &dhd->pub;
+
+	if (dhdp->wd_period > dhd_watchdog_ms)
+		dhdp->wd_idleticks++;
+
+	if ((dhd_watchdog_max_ms > dhd_watchdog_ms) && dhd_bus_idle(dhdp))
+		dhdp->wd_period = MIN(MAX(dhdp->wd_period, dhd_watchdog_ms) * 2,
+		                      dhd_watchdog_max_ms);
+	else
+		dhdp->wd_period = dhd_watchdog_ms;
+
+	return dhdp->wd_period;
+}
+
 static int
 dhd_watchdog_thread(void *data)
 {
@@ -1576,7 +1698,8 @@ dhd_watchdog_thread(void *data)
 
 			/* Reschedule the watchdog */
 			if (dhd->wd_timer_valid) {
-				mod_timer(&dhd->timer, jiffies + dhd_watchdog_ms * HZ / 1000);
+				mod_timer(&dhd->timer,
+				          jiffies + dhd_watchdog_period(dhd) * HZ / 1000);
 			}
 			DHD_OS_WAKE_UNLOCK(&dhd->pub);
 		}
@@ -1606,7 +1729,7 @@ dhd_watchdog(ulong data)
 
 	/* Reschedule the watchdog */
 	if (dhd->wd_timer_valid)
-		mod_timer(&dhd->timer, jiffies + dhd_watchdog_ms * HZ / 1000);
+		mod_timer(&dhd->timer, jiffies + dhd_watchdog_period(dhd) * HZ / 1000);
 	DHD_OS_WAKE_UNLOCK(&dhd->pub);
 }
 
@@ -2157,6 +2280,7 @@ dhd_add_if(dhd_info_t *dhd, int ifidx, void *handle, char *name,
 	if (ifp != NULL) {
 		if (ifp->net != NULL) {
 			netif_stop_queue(ifp->net);
+			dhd_rx_napi_flush_if(dhd, ifp->net);
 			unregister_netdev(ifp->net);
 			free_netdev(ifp->net);
 		}
@@ -2269,6 +2393,16 @@ dhd_attach(osl_t *osh, struct dhd_bus *bus, uint bus_hdrlen)
 		goto fail;
 	dhd_state |= DHD_ATTACH_STATE_ADD_IF;
 
+#ifdef DHD_RX_NAPI
+	/* One NAPI context on the primary interface serves all of them */
+	skb_queue_head_init(&dhd->rx_napi_q);
+	if (dhd_rx_napi) {
+		netif_napi_add(net, &dhd->rx_napi, dhd_rx_napi_poll, dhd_rx_napi_weight);
+		napi_enable(&dhd->rx_napi);
+		dhd->rx_napi_on = TRUE;
+	}
+#endif /* DHD_RX_NAPI */
+
 #if (LINUX_VERSION_CODE < KERNEL_VERSION(2, 6, 31))
 	net->open = NULL;
 	#else
@@ -2436,6 +2570,7 @@ dhd_bus_start(dhd_pub_t *dhdp)
 
 	/* Start the watchdog timer */
 	dhd->pub.tickcnt = 0;
+	dhd->pub.wd_idleticks = 0;
 	dhd_os_wd_timer(&dhd->pub, dhd_watchdog_ms);
 
 	/* Bring up the bus */
@@ -2627,6 +2762,11 @@ dhd_net_attach(dhd_pub_t *dhdp, int ifidx)
 
 	dhd->pub.rxsz = net->mtu + net->hard_header_len + dhd->pub.hdrlen;
 
+#ifdef DHD_RX_NAPI
+	if (dhd->rx_napi_on)
+		net->features |= NETIF_F_GRO;
+#endif /* DHD_RX_NAPI */
+
 	memcpy(net->dev_addr, temp_addr, ETHER_ADDR_LEN);
 
 	if ((err = register_netdev(net)) != 0) {
@@ -2785,6 +2925,14 @@ dhd_detach(dhd_pub_t *dhdp)
 	if (dhd->dhd_state & DHD_ATTACH_STATE_ADD_IF) {
 		dhd_if_t *ifp;
 		ifp = dhd->iflist[0];
+#ifdef DHD_RX_NAPI
+		if (dhd->rx_napi_on) {
+			napi_disable(&dhd->rx_napi);
+			netif_napi_del(&dhd->rx_napi);
+			dhd->rx_napi_on = FALSE;
+		}
+		skb_queue_purge(&dhd->rx_napi_q);
+#endif /* DHD_RX_NAPI */
 		free_netdev(ifp->net);
 		MFREE(dhd->pub.osh, ifp, sizeof(*ifp));
 	}
@@ -3026,6 +3174,8 @@ dhd_os_wd_timer(void *bus, uint wdtick)
 
 	if (wdtick) {
 		dhd_watchdog_ms = (uint)wdtick;
+		/* Bus activity, drop any idle backoff */
+		pub->wd_period = dhd_watchdog_ms;
 		if (save_dhd_watchdog_ms != dhd_watchdog_ms) {
 
 			if (dhd->wd_timer_valid == TRUE)
@@ -96,6 +96,10 @@
 
 #define DHD_TXMINMAX	1	/* Max tx frames if rx still pending */
 
+#define DHD_TXGLOM	0	/* Default for max tx frames in one F2 write (0/1 = off) */
+#define DHD_TXGLOM_MAX	16	/* Max tx frames in one superframe */
+#define DHD_TXGLOM_BUFSZ	(16 * 1024)	/* Buffer for building tx superframes */
+
 #define MEMBLOCK	2048		/* Block size used for downloading of dongle image */
 #define MAX_DATA_BUF	(32 * 1024)	/* Must be large enough to hold biggest possible glom */
 
@@ -228,6 +232,7 @@ typedef struct dhd_bus {
 	uint8		*rxctl;			/* Aligned pointer into rxbuf */
 	uint8		*databuf;		/* Buffer for receiving big glom packet */
 	uint8		*dataptr;		/* Aligned pointer into databuf */
+	void		*txglom_pkt;		/* Buffer for sending tx superframes */
 	uint		rxlen;			/* Length of valid data in buffer */
 
 	uint8		sdpcm_ver;		/* Bus protocol reported by dongle */
@@ -306,6 +311,8 @@ typedef struct dhd_bus {
 	uint		rxglomfail;		/* Failed deglom attempts */
 	uint		rxglomframes;		/* Number of glom frames (superframes) */
 	uint		rxglompkts;		/* Number of packets from glom frames */
+	uint		txglomframes;		/* Number of tx glom frames (superframes) */
+	uint		txglompkts;		/* Number of packets in tx glom frames */
 	uint		f2rxhdrs;		/* Number of header reads */
 	uint		f2rxdata;		/* Number of frame data reads */
 	uint		f2txdata;		/* Number of f2 frame writes */
@@ -339,6 +346,7 @@ extern void dhd_os_wd_timer(void *bus, uint wdtick);
 uint dhd_txbound;
 uint dhd_rxbound;
 uint dhd_txminmax;
+uint dhd_txglom;
 
 /* override the RAM size if possible */
 #define DONGLE_MIN_MEMSIZE (128 *1024)
@@ -1177,6 +1185,173 @@ dhd_bus_txdata(struct dhd_bus *bus, void *pkt)
 	return ret;
 }
 
+/* Dequeues up to maxframes data frames and sends them in a single F2 write.
+ * Each frame gets its own HW/SW header and sequence number and starts on a
+ * DHD_SDALIGN boundary, the same layout the dongle uses for rx superframes.
+ * Assumes: caller holds lock, DATAOK(bus).
+ * Returns the number of frames taken off the queue (0 if glomming failed).
+ */
+static uint
+dhdsdio_txglom(dhd_bus_t *bus, uint maxframes)
+{
+	osl_t *osh = bus->dhd->osh;
+	bcmsdh_info_t *sdh = bus->sdh;
+	void *pkts[DHD_TXGLOM_MAX];
+	void *pkt;
+	uint8 *buf, *frame;
+	uint8 tx_prec_map, window;
+	uint16 len, sublen;
+	uint32 swheader;
+	uint num, total, retries = 0;
+	uint datalen = 0;
+	int ret, prec_out;
+	int i;
+
+	DHD_TRACE(("%s: Enter\n", __FUNCTION__));
+
+	if (bus->dhd->dongle_reset)
+		return 0;
+
+	if (!bus->txglom_pkt) {
+		bus->txglom_pkt = PKTGET(osh, DHD_TXGLOM_BUFSZ + DHD_SDALIGN, TRUE);
+		if (!bus->txglom_pkt) {
+			DHD_ERROR(("%s: couldn't allocate %d-byte tx glom buffer\n",
+			           __FUNCTION__, DHD_TXGLOM_BUFSZ + DHD_SDALIGN));
+			return 0;
+		}
+		PKTALIGN(osh, bus->txglom_pkt, DHD_TXGLOM_BUFSZ, DHD_SDALIGN);
+	}
+	buf = (uint8*)PKTDATA(osh, bus->txglom_pkt);
+
+	/* Don't send more frames than the dongle offers credits for */
+	window = (uint8)(bus->tx_max - bus->tx_seq);
+	maxframes = MIN(maxframes, MIN(window, DHD_TXGLOM_MAX));
+
+	tx_prec_map = ~bus->flowcontrol;
+
+	/* Copy frames into the superframe while they fit */
+	for (num = 0, total = 0; num < maxframes; num++) {
+		dhd_os_sdlock_txq(bus->dhd);
+		pkt = pktq_peek(&bus->txq, &prec_out);
+		if (!pkt || !(tx_prec_map & NBITVAL(prec_out)) ||
+		    (ROUNDUP(total + PKTLEN(osh, pkt), DHD_SDALIGN) > DHD_TXGLOM_BUFSZ)) {
+			dhd_os_sdunlock_txq(bus->dhd);
+			break;
+		}
+		pkt = pktq_mdeq(&bus->txq, tx_prec_map, &prec_out);
+		dhd_os_sdunlock_txq(bus->dhd);
+		ASSERT(pkt);
+
+		frame = buf + total;
+		sublen = (uint16)PKTLEN(osh, pkt);
+		bcopy(PKTDATA(osh, pkt), frame, sublen);
+
+		/* Hardware tag: 2 byte len followed by 2 byte ~len check (all LE) */
+		*(uint16*)frame = htol16(sublen);
+		*(((uint16*)frame) + 1) = htol16(~sublen);
+
+		/* Software tag: channel, sequence number, data offset */
+		swheader = ((SDPCM_DATA_CHANNEL << SDPCM_CHANNEL_SHIFT) & SDPCM_CHANNEL_MASK) |
+		        ((bus->tx_seq + num) % SDPCM_SEQUENCE_WRAP) |
+		        ((SDPCM_HDRLEN << SDPCM_DOFFSET_SHIFT) & SDPCM_DOFFSET_MASK);
+		htol32_ua_store(swheader, frame + SDPCM_FRAMETAG_LEN);
+		htol32_ua_store(0, frame + SDPCM_FRAMETAG_LEN + sizeof(swheader));
+
+#ifdef DHD_DEBUG
+		tx_packets[PKTPRIO(pkt)]++;
+		if (DHD_BYTES_ON() && DHD_DATA_ON()) {
+			prhex("Tx Subframe", frame, sublen);
+		} else if (DHD_HDRS_ON()) {
+			prhex("TxHdr", frame, MIN(sublen, 16));
+		}
+#endif
+
+		/* Pad the next subframe out to alignment */
+		total = ROUNDUP(total + sublen, DHD_SDALIGN);
+		datalen += sublen - SDPCM_HDRLEN;
+		pkts[num] = pkt;
+	}
+
+	if (num == 0)
+		return 0;
+
+	/* The last subframe needs no trailing pad */
+	len = (uint16)(total - (ROUNDUP(sublen, DHD_SDALIGN) - sublen));
+
+	/* Raise len to next SDIO block to eliminate tail command */
+	if (bus->roundup && bus->blocksize && (len > bus->blocksize)) {
+		uint16 pad = bus->blocksize - (len % bus->blocksize);
+		if ((pad <= bus->roundup) && (pad < bus->blocksize) &&
+		    (len + pad <= DHD_TXGLOM_BUFSZ))
+			len += pad;
+	} else if (len % DHD_SDALIGN) {
+		len += DHD_SDALIGN - (len % DHD_SDALIGN);
+	}
+
+	/* Some controllers have trouble with odd bytes -- round to even */
+	if (forcealign && (len & (ALIGNMENT - 1)))
+		len = ROUNDUP(len, ALIGNMENT);
+
+	PKTSETLEN(osh, bus->txglom_pkt, len);
+
+	do {
+		ret = dhd_bcmsdh_send_buf(bus, bcmsdh_cur_sbwad(sdh), SDIO_FUNC_2, F2SYNC,
+		                      buf, len, bus->txglom_pkt, NULL, NULL);
+		bus->f2txdata++;
+		ASSERT(ret != BCME_PENDING);
+
+		if (ret < 0) {
+			/* On failure, abort the command and terminate the frame */
+			DHD_INFO(("%s: sdio error %d, abort command and terminate frame.\n",
+			          __FUNCTION__, ret));
+			bus->tx_sderrs++;
+
+			bcmsdh_abort(sdh, SDIO_FUNC_2);
+			bcmsdh_cfg_write(sdh, SDIO_FUNC_1, SBSDIO_FUNC1_FRAMECTRL,
+			                 SFC_WF_TERM, NULL);
+			bus->f1regdata++;
+
+			for (i = 0; i < 3; i++) {
+				uint8 hi, lo;
+				hi = bcmsdh_cfg_read(sdh, SDIO_FUNC_1,
+				                     SBSDIO_FUNC1_WFRAMEBCHI, NULL);
+				lo = bcmsdh_cfg_read(sdh, SDIO_FUNC_1,
+				                     SBSDIO_FUNC1_WFRAMEBCLO, NULL);
+				bus->f1regdata += 2;
+				if ((hi == 0) && (lo == 0))
+					break;
+			}
+		}
+	} while ((ret < 0) && retrydata && retries++ < TXRETRIES);
+
+	if (ret == 0) {
+		bus->tx_seq = (bus->tx_seq + num) % SDPCM_SEQUENCE_WRAP;
+		bus->txglomframes++;
+		bus->txglompkts += num;
+		bus->dhd->dstats.tx_bytes += datalen;
+	} else {
+		bus->dhd->tx_errors += num;
+	}
+
+	/* Complete the frames the same way dhdsdio_txpkt does */
+	for (i = 0; i < num; i++) {
+		pkt = pkts[i];
+		PKTPULL(osh, pkt, SDPCM_HDRLEN);
+		dhd_os_sdunlock(bus->dhd);
+#ifdef PROP_TXSTATUS
+		dhd_wlfc_txcomplete(bus->dhd, pkt, ret == 0);
+#else
+		dhd_txcomplete(bus->dhd, pkt, ret != 0);
+#endif
+		dhd_os_sdlock(bus->dhd);
+#ifndef PROP_TXSTATUS
+		PKTFREE(osh, pkt, TRUE);
+#endif
+	}
+
+	return num;
+}
+
 static uint
 dhdsdio_sendfromq(dhd_bus_t *bus, uint maxframes)
 {
@@ -1185,6 +1360,7 @@ dhdsdio_sendfromq(dhd_bus_t *bus, uint maxframes)
 	uint retries = 0;
 	int ret = 0, prec_out;
 	uint cnt = 0;
+	uint num;
 	uint datalen;
 	uint8 tx_prec_map;
 
@@ -1197,24 +1373,36 @@ dhdsdio_sendfromq(dhd_bus_t *bus, uint maxframes)
 
 	/* Send frames until the limit or some other event */
 	for (cnt = 0; (cnt < maxframes) && DATAOK(bus); cnt++) {
-		dhd_os_sdlock_txq(bus->dhd);
-		if ((pkt = pktq_mdeq(&bus->txq, tx_prec_map, &prec_out)) == NULL) {
-			dhd_os_sdunlock_txq(bus->dhd);
-			break;
+		num = 0;
+#ifndef SDTEST
+		/* Pack several frames into one F2 write if enabled */
+		if ((dhd_txglom > 1) && (maxframes - cnt > 1) &&
+		    (pktq_len(&bus->txq) > 1)) {
+			num = dhdsdio_txglom(bus, MIN(maxframes - cnt, dhd_txglom));
+			if (num)
+				cnt += num - 1;
 		}
-		dhd_os_sdunlock_txq(bus->dhd);
-		datalen = PKTLEN(bus->dhd->osh, pkt) - SDPCM_HDRLEN;
+#endif /* SDTEST */
+		if (!num) {
+			dhd_os_sdlock_txq(bus->dhd);
+			if ((pkt = pktq_mdeq(&bus->txq, tx_prec_map, &prec_out)) == NULL) {
+				dhd_os_sdunlock_txq(bus->dhd);
+				break;
+			}
+			dhd_os_sdunlock_txq(bus->dhd);
+			datalen = PKTLEN(bus->dhd->osh, pkt) - SDPCM_HDRLEN;
 
 #ifndef SDTEST
-		ret = dhdsdio_txpkt(bus, pkt, SDPCM_DATA_CHANNEL, TRUE);
+			ret = dhdsdio_txpkt(bus, pkt, SDPCM_DATA_CHANNEL, TRUE);
 #else
-		ret = dhdsdio_txpkt(bus, pkt,
-		        (bus->ext_loop ? SDPCM_TEST_CHANNEL : SDPCM_DATA_CHANNEL), TRUE);
+			ret = dhdsdio_txpkt(bus, pkt,
+			        (bus->ext_loop ? SDPCM_TEST_CHANNEL : SDPCM_DATA_CHANNEL), TRUE);
 #endif
-		if (ret)
-			bus->dhd->tx_errors++;
-		else
-			bus->dhd->dstats.tx_bytes += datalen;
+			if (ret)
+				bus->dhd->tx_errors++;
+			else
+				bus->dhd->dstats.tx_bytes += datalen;
+		}
 
 		/* In poll mode, need to check for other events */
 		if (!bus->intr && cnt)
@@ -1464,6 +1652,7 @@ enum {
 	IOV_TXBOUND,
 	IOV_RXBOUND,
 	IOV_TXMINMAX,
+	IOV_TXGLOM,
 	IOV_IDLETIME,
 	IOV_IDLECLOCK,
 	IOV_SD1IDLE,
@@ -1488,6 +1677,7 @@ const bcm_iovar_t dhdsdio_iovars[] = {
 	{"alignctl",	IOV_ALIGNCTL,	0,	IOVT_BOOL,	0 },
 	{"sdalign",	IOV_SDALIGN,	0,	IOVT_BOOL,	0 },
 	{"devreset",	IOV_DEVRESET,	0,	IOVT_BOOL,	0 },
+	{"txglom",	IOV_TXGLOM,	0,	IOVT_UINT32,	0 },
 #ifdef DHD_DEBUG
 	{"sdreg",	IOV_SDREG,	0,	IOVT_BUFFER,	sizeof(sdreg_t) },
 	{"sbreg",	IOV_SBREG,	0,	IOVT_BUFFER,	sizeof(sdreg_t) },
@@ -1549,6 +1739,8 @@ dhd_bus_dump(dhd_pub_t *dhdp, struct bcmstrbuf *strbuf)
 	            bus->fc_rcvd, bus->fc_xoff, bus->fc_xon);
 	bcm_bprintf(strbuf, "rxglomfail %d, rxglomframes %d, rxglompkts %d\n",
 	            bus->rxglomfail, bus->rxglomframes, bus->rxglompkts);
+	bcm_bprintf(strbuf, "txglom %d, txglomframes %d, txglompkts %d\n",
+	            dhd_txglom, bus->txglomframes, bus->txglompkts);
 	bcm_bprintf(strbuf, "f2rx (hdrs/data) %d (%d/%d), f2tx %d f1regs %d\n",
 	            (bus->f2rxhdrs + bus->f2rxdata), bus->f2rxhdrs, bus->f2rxdata,
 	            bus->f2txdata, bus->f1regdata);
@@ -1573,6 +1765,11 @@ dhd_bus_dump(dhd_pub_t *dhdp, struct bcmstrbuf *strbuf)
 		dhd_dump_pct(strbuf, ", pkts/int", bus->dhd->tx_packets, bus->intrcount);
 		bcm_bprintf(strbuf, "\n");
 
+		dhd_dump_pct(strbuf, "Tx: glom pct", (100 * bus->txglompkts),
+		             bus->dhd->tx_packets);
+		dhd_dump_pct(strbuf, ", pkts/glom", bus->txglompkts, bus->txglomframes);
+		bcm_bprintf(strbuf, "\n");
+
 		dhd_dump_pct(strbuf, "Total: pkts/f2rw",
 		             (bus->dhd->tx_packets + bus->dhd->rx_packets),
 		             (bus->f2txdata + bus->f2rxhdrs + bus->f2rxdata));
@@ -1615,6 +1812,7 @@ dhd_bus_clearcounts(dhd_pub_t *dhdp)
 	bus->rx_hdrfail = bus->rx_badhdr = bus->rx_badseq = 0;
 	bus->tx_sderrs = bus->fc_rcvd = bus->fc_xoff = bus->fc_xon = 0;
 	bus->rxglomfail = bus->rxglomframes = bus->rxglompkts = 0;
+	bus->txglomframes = bus->txglompkts = 0;
 	bus->f2rxhdrs = bus->f2rxdata = bus->f2txdata = bus->f1regdata = 0;
 }
 
@@ -2395,6 +2593,18 @@ dhdsdio_doiovar(dhd_bus_t *bus, const bcm_iovar_t *vi, uint32 actionid, const ch
 
 #endif /* DHD_DEBUG */
 
+	case IOV_GVAL(IOV_TXGLOM):
+		int_val = (int32)dhd_txglom;
+		bcopy(&int_val, arg, val_size);
+		break;
+
+	case IOV_SVAL(IOV_TXGLOM):
+		if ((uint)int_val > DHD_TXGLOM_MAX) {
+			bcmerror = BCME_RANGE;
+			break;
+		}
+		dhd_txglom = (uint)int_val;
+		break;
 
 #ifdef SDTEST
 	case IOV_GVAL(IOV_EXTLOOP):
@@ -4721,7 +4931,8 @@ dhd_bus_watchdog(dhd_pub_t *dhdp)
 #ifdef DHD_DEBUG
 	/* Poll for console output periodically */
 	if (dhdp->busstate == DHD_BUS_DATA && dhd_console_ms != 0) {
-		bus->console.count += dhd_watchdog_ms;
+		/* The tick may have been backed off, count the real period */
+		bus->console.count += dhdp->wd_period;
 		if (bus->console.count >= dhd_console_ms) {
 			bus->console.count -= dhd_console_ms;
 			/* Make sure backplane clock is on */
@@ -4758,6 +4969,35 @@ dhd_bus_watchdog(dhd_pub_t *dhdp)
 	return bus->ipend;
 }
 
+/* The watchdog may back off while there is no polling, no pending tx/rx,
+ * no credit or flow-control stall and no idle clock countdown to run.
+ * Console polling is not work: it counts the backed-off period.
+ */
+bool
+dhd_bus_idle(dhd_pub_t *dhdp)
+{
+	dhd_bus_t *bus = dhdp->bus;
+
+	if (!bus || bus->dhd->dongle_reset || bus->sleeping)
+		return TRUE;
+
+	if (bus->poll || bus->ipend || bus->dpc_sched || bus->fcstate)
+		return FALSE;
+
+	if (pktq_len(&bus->txq) || bus->ctrl_frame_stat)
+		return FALSE;
+
+	if ((bus->idletime > 0) && (bus->clkstate == CLK_AVAIL) && bus->activity)
+		return FALSE;
+
+#ifdef SDTEST
+	if (bus->pktgen_count)
+		return FALSE;
+#endif /* SDTEST */
+
+	return TRUE;
+}
+
 #ifdef DHD_DEBUG
 extern int
 dhd_bus_console_in(dhd_pub_t *dhdp, uchar *msg, uint msglen)
@@ -4885,6 +5125,7 @@ dhdsdio_probe(uint16 venid, uint16 devid, uint16 bus_no, uint16 slot,
 	dhd_doflow = TRUE;
 	dhd_dongle_memsize = 0;
 	dhd_txminmax = DHD_TXMINMAX;
+	dhd_txglom = DHD_TXGLOM;
 
 	forcealign = TRUE;
 
@@ -5395,6 +5636,11 @@ dhdsdio_release_malloc(dhd_bus_t *bus, osl_t *osh)
 		bus->databuf = NULL;
 	}
 
+	if (bus->txglom_pkt) {
+		PKTFREE(osh, bus->txglom_pkt, TRUE);
+		bus->txglom_pkt = NULL;
+	}
+
 	if (bus->vars && bus->varsz) {
 		MFREE(osh, bus->vars, bus->varsz);
 		bus->vars = NULL;
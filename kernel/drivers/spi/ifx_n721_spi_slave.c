@@ -46,6 +46,7 @@
 #include <linux/spi/ifx_n721_spi.h>
 #include <linux/delay.h> 
 #include <linux/earlysuspend.h>
+#include <linux/dma-mapping.h>
 
 #define CONFIG_SPI_DEBUG
 #define CONFIG_EARLY_SUSPEND_TEST
@@ -210,9 +211,13 @@ struct ifx_spi_data {
 	unsigned int		ifx_current_frame_size;
 	unsigned int		ifx_valid_frame_size;
 	unsigned int		ifx_ret_count;
+	unsigned int		ifx_peer_next_size;	/* next frame size announced by the modem */
+	unsigned int		ifx_xfer_len;		/* length of the transfer being set up */
 	const unsigned char 	*ifx_spi_buf;
 	unsigned char		*ifx_tx_buffer;
 	unsigned char           *ifx_rx_buffer;
+	dma_addr_t		ifx_tx_dma;	/* 0 unless the frame buffers are mapped */
+	dma_addr_t		ifx_rx_dma;
 	unsigned		mrdy_gpio;
 	unsigned		srdy_gpio;
 	unsigned int wcount;
@@ -250,7 +255,8 @@ static void ifx_spi_late_resume(struct early_suspend *h);
 /* Global Declarations */
 /* Function Declarations */
 static void ifx_spi_set_header_info(unsigned char *header_buffer, unsigned int curr_buf_size, unsigned int next_buf_size);
-static int ifx_spi_get_header_info(unsigned char *rx_buffer, unsigned int *valid_buf_size);
+static int ifx_spi_get_header_info(unsigned char *rx_buffer, unsigned int *valid_buf_size, unsigned int *next_buf_size);
+static unsigned int ifx_spi_get_transfer_len(struct ifx_spi_data *spi_data, unsigned int payload);
 static void ifx_spi_set_mrdy_signal(struct ifx_spi_data *spi_data, int value);
 static void ifx_spi_setup_transmission(struct ifx_spi_data *spi_data);
 static void ifx_spi_setup_transmit_and_receive(struct ifx_spi_data *spi_data); //deinsala
@@ -260,6 +266,8 @@ static void ifx_spi_receive_data(struct ifx_spi_data *spi_data); //deinsala
 static int ifx_spi_get_next_frame_size(int count);
 static int ifx_spi_allocate_frame_memory(struct ifx_spi_data *spi_data, unsigned int memory_size);
 static void ifx_spi_free_frame_memory(struct ifx_spi_data *spi_data);
+static void ifx_spi_map_frame_memory(struct ifx_spi_data *spi_data);
+static void ifx_spi_unmap_frame_memory(struct ifx_spi_data *spi_data);
 static void ifx_spi_buffer_initialization(struct ifx_spi_data *spi_data);
 static unsigned int ifx_spi_sync_read_write(struct ifx_spi_data *spi_data, unsigned int len);
 static unsigned int ifx_spi_sync_read(struct ifx_spi_data *spi_data, unsigned int len); //deinsala
@@ -271,6 +279,22 @@ unsigned char rx_dummy[]={0xff,0xff,0xff,0xff};
 
 static DEFINE_MUTEX(mspi_tx_rx_mutex);
 
+/*
+ * Length negotiated transfers: every frame header carries the size of the
+ * sender's next frame, so a transfer only has to clock the larger of our
+ * payload and what the modem announced last, rounded up to the McSPI FIFO
+ * depth, instead of always IFX_SPI_MAX_BUF_SIZE.  If the modem announces
+ * nothing, a small frame is assumed.  This needs modem firmware which
+ * honours the header, so it is off by default.
+ */
+static int ifx_spi_var_len = 0;
+module_param(ifx_spi_var_len, int, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(ifx_spi_var_len, "Size SPI transfers from the frame headers");
+
+#define IFX_SPI_XFER_ALIGN		16	/* McSPI1 fifo_depth, see devices.c */
+#define IFX_SPI_XFER_DEFAULT_SIZE	128	/* payload assumed if none announced */
+#define IFX_SPI_XFER_MAX_SIZE		(IFX_SPI_MAX_BUF_SIZE + IFX_SPI_HEADER_SIZE)
+
 /* ################################################################################################################ */
 
 static LIST_HEAD(device_list);
@@ -551,6 +575,8 @@ static int ifx_spi_probe(struct spi_device *spi)
 		printk("File: ifx_n721_spi.c\tFunction: int ifx_spi_probe\tFailed to allocate memory for buffers\n");
 		return -ENOMEM;
         }
+	spi_data->ifx_peer_next_size = IFX_SPI_XFER_DEFAULT_SIZE;
+	spi_data->ifx_xfer_len = IFX_SPI_XFER_MAX_SIZE;
 	
         dev_set_drvdata(&spi->dev,spi_data);
         spin_lock_init(&spi_data->spi_lock);
@@ -578,6 +604,7 @@ static int ifx_spi_probe(struct spi_device *spi)
 	if(status < 0){
 		printk("Failed to setup SPI \n");
 	}             
+	ifx_spi_map_frame_memory(spi_data);
 
 	if (gpio_request(spi_data->srdy_gpio, "ifx srdy") < 0) {
 		printk(KERN_ERR "Can't get SRDY GPIO\n");
@@ -621,10 +648,14 @@ static int ifx_spi_probe(struct spi_device *spi)
 	if (status != 0){
 		printk(KERN_ERR "Failed to request IRQ for SRDY\n");
 		printk(KERN_ERR "IFX SPI Probe Failed\n");
+		/* same order as ifx_spi_remove(): unmap before freeing */
+		ifx_spi_unmap_frame_memory(spi_data);
+		spi_set_drvdata(spi, NULL);
 		ifx_spi_free_frame_memory(spi_data);
 		if(spi_data){
 			kfree(spi_data);
 		}          
+		return status;
 	}
 	
 	enable_irq_wake(spi->irq);
@@ -646,6 +677,7 @@ ifx_spi_remove(struct spi_device *spi)
 {	
 	struct ifx_spi_data *spi_data;
 	spi_data = spi_get_drvdata(spi);
+	ifx_spi_unmap_frame_memory(spi_data);
 	spin_lock_irq(&spi_data->spi_lock);
 	spi_data->spi = NULL;
 	spi_set_drvdata(spi, NULL);
@@ -811,6 +843,46 @@ ifx_spi_free_frame_memory(struct ifx_spi_data *spi_data)
 	}
 }
 
+/*
+ * Map TX_BUFFER and RX_BUFFER for DMA once, so that every transfer only has to
+ * do the cache maintenance for the bytes it actually clocks instead of a
+ * map/unmap of the whole buffer in the McSPI driver.
+ */
+static void 
+ifx_spi_map_frame_memory(struct ifx_spi_data *spi_data)
+{
+	struct device *dev = &spi_data->spi->dev;
+
+	spi_data->ifx_tx_dma = dma_map_single(dev, spi_data->ifx_tx_buffer, IFX_SPI_XFER_MAX_SIZE, DMA_TO_DEVICE);
+	if(dma_mapping_error(dev, spi_data->ifx_tx_dma)){
+		spi_data->ifx_tx_dma = 0;
+		return;
+	}
+
+	spi_data->ifx_rx_dma = dma_map_single(dev, spi_data->ifx_rx_buffer, IFX_SPI_XFER_MAX_SIZE, DMA_FROM_DEVICE);
+	if(dma_mapping_error(dev, spi_data->ifx_rx_dma)){
+		dma_unmap_single(dev, spi_data->ifx_tx_dma, IFX_SPI_XFER_MAX_SIZE, DMA_TO_DEVICE);
+		spi_data->ifx_tx_dma = 0;
+		spi_data->ifx_rx_dma = 0;
+		printk("ifx_spi_map_frame_memory: mapping failed, using per transfer mappings\n");
+	}
+}
+
+static void 
+ifx_spi_unmap_frame_memory(struct ifx_spi_data *spi_data)
+{
+	struct device *dev;
+
+	if(!spi_data->ifx_tx_dma)
+		return;
+
+	dev = &spi_data->spi->dev;
+	dma_unmap_single(dev, spi_data->ifx_tx_dma, IFX_SPI_XFER_MAX_SIZE, DMA_TO_DEVICE);
+	dma_unmap_single(dev, spi_data->ifx_rx_dma, IFX_SPI_XFER_MAX_SIZE, DMA_FROM_DEVICE);
+	spi_data->ifx_tx_dma = 0;
+	spi_data->ifx_rx_dma = 0;
+}
+
 /*
  * Function to set header information according to IFX SPI framing protocol specification
  */
@@ -842,7 +914,7 @@ ifx_spi_set_header_info(unsigned char *header_buffer, unsigned int curr_buf_size
  * Function to get header information according to IFX SPI framing protocol specification
  */
 static int 
-ifx_spi_get_header_info(unsigned char *rx_buffer, unsigned int *valid_buf_size)
+ifx_spi_get_header_info(unsigned char *rx_buffer, unsigned int *valid_buf_size, unsigned int *next_buf_size)
 {
 	int i;
 	union ifx_spi_frame_header header;
@@ -856,6 +928,7 @@ ifx_spi_get_header_info(unsigned char *rx_buffer, unsigned int *valid_buf_size)
 	}
 
 	*valid_buf_size = header.ifx_spi_header.curr_data_size;
+	*next_buf_size = header.ifx_spi_header.next_data_size;
 	if(header.ifx_spi_header.more)
 	{
 		printk(KERN_ERR "ifx_spi_get_header_info, There is more packet = %d\n", header.ifx_spi_header.next_data_size);
@@ -891,6 +964,22 @@ ifx_spi_get_next_frame_size(int count)
 	}
 }
 
+/*
+ * Function to calculate the number of bytes to clock for a frame carrying "payload" bytes
+ */
+static unsigned int 
+ifx_spi_get_transfer_len(struct ifx_spi_data *spi_data, unsigned int payload)
+{
+	unsigned int len;
+
+	if(!ifx_spi_var_len)
+		return IFX_SPI_XFER_MAX_SIZE;
+
+	len = max(payload, spi_data->ifx_peer_next_size);
+	len = ALIGN(len + IFX_SPI_HEADER_SIZE, IFX_SPI_XFER_ALIGN);
+	return min_t(unsigned int, len, IFX_SPI_XFER_MAX_SIZE);
+}
+
 /*
  * Function to setup transmission and reception. It implements a logic to find out the ifx_current_frame_size,
  * valid_frame_size and sender_next_frame_size to set in SPI header frame. Copys the data to be transferred from 
@@ -938,32 +1027,26 @@ ifx_spi_setup_transmission(struct ifx_spi_data *spi_data)
 static void 
 ifx_spi_setup_transmit_and_receive(struct ifx_spi_data *spi_data)
 {
+	unsigned int used = IFX_SPI_HEADER_SIZE + spi_data->ifx_spi_count;
 
-	/* memset buffers to 0 */
+	spi_data->ifx_xfer_len = ifx_spi_get_transfer_len(spi_data, spi_data->ifx_spi_count);
 
-	#if 0 //defined(shim_test)
-		memset(spi_data->ifx_tx_buffer,0,2048 + 64);
-		memset(spi_data->ifx_rx_buffer,0,2048 + 64);
-	
-	#else
-		memset(spi_data->ifx_tx_buffer,0,IFX_SPI_MAX_BUF_SIZE+IFX_SPI_HEADER_SIZE);
-		memset(spi_data->ifx_rx_buffer,0,IFX_SPI_MAX_BUF_SIZE+IFX_SPI_HEADER_SIZE);
-	#endif
-	
-	
 	ifx_spi_set_header_info(spi_data->ifx_tx_buffer, spi_data->ifx_spi_count, 0);
 
 	memcpy(spi_data->ifx_tx_buffer+IFX_SPI_HEADER_SIZE, spi_data->ifx_spi_buf, spi_data->ifx_spi_count);
 	//spi_data->ifx_spi_buf = NULL;
 
+	/* Only the padding behind the payload needs clearing, the rx buffer
+	 * is completely overwritten by the transfer */
+	if(used < spi_data->ifx_xfer_len)
+		memset(spi_data->ifx_tx_buffer + used, 0, spi_data->ifx_xfer_len - used);
 }
 
 static void 
 ifx_spi_setup_receive(struct ifx_spi_data *spi_data)
 {
-	/* memset buffers to 0 */
-	memset(spi_data->ifx_tx_buffer,0,IFX_SPI_MAX_BUF_SIZE+IFX_SPI_HEADER_SIZE);
-	memset(spi_data->ifx_rx_buffer,0,IFX_SPI_MAX_BUF_SIZE+IFX_SPI_HEADER_SIZE);
+	/* rx only transfer, nothing to clear: the whole length is received */
+	spi_data->ifx_xfer_len = ifx_spi_get_transfer_len(spi_data, 0);
 }
 
 
@@ -973,6 +1056,7 @@ ifx_spi_tty_callback( struct ifx_spi_data *spi_data)
 {
 
 	unsigned int rx_valid_buf_size;
+	unsigned int next_buf_size;
 #ifdef LG_RIL_SPIMUX 
 	int spimux_packet_num = 0;
 	u32 spimux_current_packet_size = 0;
@@ -983,7 +1067,17 @@ ifx_spi_tty_callback( struct ifx_spi_data *spi_data)
 	/* Handling Received data */
 #ifdef SPI_TEST
 #else
-	spi_data->ifx_receiver_buf_size = ifx_spi_get_header_info(spi_data->ifx_rx_buffer, &rx_valid_buf_size);
+	spi_data->ifx_receiver_buf_size = ifx_spi_get_header_info(spi_data->ifx_rx_buffer, &rx_valid_buf_size, &next_buf_size);
+	if(next_buf_size > 0 && next_buf_size <= IFX_SPI_MAX_BUF_SIZE)
+		spi_data->ifx_peer_next_size = next_buf_size;
+	else
+		spi_data->ifx_peer_next_size = IFX_SPI_XFER_DEFAULT_SIZE;
+
+	if(rx_valid_buf_size > spi_data->ifx_xfer_len - IFX_SPI_HEADER_SIZE)
+	{
+		printk("ifx_spi_tty_callback: frame of %d bytes in a %d byte transfer, dropped\n", rx_valid_buf_size, spi_data->ifx_xfer_len);
+		return;
+	}
 #endif
 
 //	if((spi_data->throttle == 0) && (rx_valid_buf_size != 0) && !(spi_data->ifx_spi_lock)){
@@ -1008,14 +1102,20 @@ ifx_spi_tty_callback( struct ifx_spi_data *spi_data)
 		spimux_current_packet_size = *(SPIMUX_PACKET_HDR_TYPE*)(&data[spimux_packet_offset]);
 
 		spimux_packet_offset += SPIMUX_PACKET_HDR_SIZE;
+		if(spimux_packet_offset + spimux_current_packet_size > IFX_SPI_HEADER_SIZE + rx_valid_buf_size)
+		{
+			printk("ifx_spi_tty_callback: spimux packet #%d overruns the frame, dropped\n", spimux_current_packet);
+			break;
+		}
 
 		//printk("   current packet #(%d) size(%d) offset(%d)\n",spimux_current_packet, spimux_current_packet_size, spimux_packet_offset); 		
 
 
 		tty_insert_flip_string(spi_data->ifx_tty, spi_data->ifx_rx_buffer + spimux_packet_offset, spimux_current_packet_size);
-		tty_flip_buffer_push(spi_data->ifx_tty);
 		spimux_packet_offset += spimux_current_packet_size;
 	}
+	/* hand all packets of the frame to the mux in one go */
+	tty_flip_buffer_push(spi_data->ifx_tty);
 
 
 
@@ -1062,7 +1162,7 @@ ifx_spi_send_and_receive_data(struct ifx_spi_data *spi_data)
 	//gpio_set_value(65 ,0);printk(KERN_ERR "[LGE-SPI] gpio 65 to LOW  = %d\n", gpio_get_value(65));
 #endif
 	                   
-	status = ifx_spi_sync_read_write(spi_data, IFX_SPI_MAX_BUF_SIZE+IFX_SPI_HEADER_SIZE); /* 4 bytes for header */                       
+	status = ifx_spi_sync_read_write(spi_data, spi_data->ifx_xfer_len); /* 4 bytes for header */
 
 #ifdef SPI_LOG_ENABLE_SHIM
 
@@ -1094,7 +1194,6 @@ ifx_spi_send_and_receive_data(struct ifx_spi_data *spi_data)
 // TODO:[EBS] LGE_UPDATE_S eungbo.shim@lge.com 20110713 For Ril recovery 
 	if(status > 0) //Status is not clear, I think in case of something TX this should be m.actual_length
 	{
-		memset(spi_data->ifx_tx_buffer,0,IFX_SPI_MAX_BUF_SIZE+IFX_SPI_HEADER_SIZE);
 		//spi_data->ifx_ret_count += spi_data->ifx_valid_frame_size;
 		// deinsala if Ok just set the ifx_ret_count to what I wrote (i.e.ifx_spi_count)
 		spi_data->ifx_ret_count = spi_data->ifx_spi_count;
@@ -1129,12 +1228,11 @@ ifx_spi_receive_data(struct ifx_spi_data *spi_data)
 	int status = 0; 
 
 	//status = ifx_spi_sync_read(spi_data, spi_data->ifx_current_frame_size+IFX_SPI_HEADER_SIZE); /* 4 bytes for header */                       
-	status = ifx_spi_sync_read(spi_data, IFX_SPI_MAX_BUF_SIZE+IFX_SPI_HEADER_SIZE); /* 4 bytes for header */
+	status = ifx_spi_sync_read(spi_data, spi_data->ifx_xfer_len); /* 4 bytes for header */
 
 // TODO:[EBS] LGE_UPDATE_S eungbo.shim@lge.com 20110713 For Ril recovery 
 	if(status > 0) //Status is not clear, I think in case of something TX this should be m.actual_length
 	{
-		memset(spi_data->ifx_tx_buffer,0,IFX_SPI_MAX_BUF_SIZE+IFX_SPI_HEADER_SIZE);
 		//spi_data->ifx_ret_count += spi_data->ifx_valid_frame_size;
 		// deinsala if Ok just set the ifx_ret_count to what I wrote (i.e.ifx_spi_count)
 		spi_data->ifx_ret_count = spi_data->ifx_spi_count;
@@ -1169,8 +1267,21 @@ ifx_spi_sync_read_write(struct ifx_spi_data *spi_data, unsigned int len)
 	
 	if (spi_data->spi == NULL)
 		status = -ESHUTDOWN;
-	else
-		status = spi_sync(spi_data->spi, &m);
+	else{
+		if(spi_data->ifx_tx_dma){
+			struct device *dev = &spi_data->spi->dev;
+
+			m.is_dma_mapped = 1;
+			t.tx_dma = spi_data->ifx_tx_dma;
+			t.rx_dma = spi_data->ifx_rx_dma;
+			dma_sync_single_for_device(dev, t.tx_dma, len, DMA_TO_DEVICE);
+			dma_sync_single_for_device(dev, t.rx_dma, len, DMA_FROM_DEVICE);
+			status = spi_sync(spi_data->spi, &m);
+			dma_sync_single_for_cpu(dev, t.rx_dma, len, DMA_FROM_DEVICE);
+		}
+		else
+			status = spi_sync(spi_data->spi, &m);
+	}
 	
 	if (status == 0){          
 		status = m.status;
@@ -1198,8 +1309,19 @@ ifx_spi_sync_read(struct ifx_spi_data *spi_data, unsigned int len)
 	
 	if (spi_data->spi == NULL)
 		status = -ESHUTDOWN;
-	else
-		status = spi_sync(spi_data->spi, &m);
+	else{
+		if(spi_data->ifx_rx_dma){
+			struct device *dev = &spi_data->spi->dev;
+
+			m.is_dma_mapped = 1;
+			t.rx_dma = spi_data->ifx_rx_dma;
+			dma_sync_single_for_device(dev, t.rx_dma, len, DMA_FROM_DEVICE);
+			status = spi_sync(spi_data->spi, &m);
+			dma_sync_single_for_cpu(dev, t.rx_dma, len, DMA_FROM_DEVICE);
+		}
+		else
+			status = spi_sync(spi_data->spi, &m);
+	}
 	
 	if (status == 0){          
 		status = m.status;
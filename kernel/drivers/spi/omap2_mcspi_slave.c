@@ -514,8 +514,11 @@ omap2_mcspi_dump_regs(struct spi_device *spi)
 }          
 // LGE_UPDATE_E eungbo.shim@lge.com [EBS]
 
+/* Buffers of a message with is_dma_mapped set stay mapped by the protocol
+ * driver across transfers, so they are not unmapped here. */
 static unsigned
-omap2_mcspi_txrx_dma(struct spi_device *spi, struct spi_transfer *xfer)
+omap2_mcspi_txrx_dma(struct spi_device *spi, struct spi_transfer *xfer,
+		     int is_dma_mapped)
 {
 	struct omap2_mcspi	*mcspi;
 	struct omap2_mcspi_cs	*cs = spi->controller_state;
@@ -752,7 +755,8 @@ omap2_mcspi_txrx_dma(struct spi_device *spi, struct spi_transfer *xfer)
 		omap2_mcspi_set_txfifo(spi, count, 0, bytes_per_transfer);
 		}
 
-		dma_unmap_single(NULL, xfer->tx_dma, count, DMA_TO_DEVICE);
+		if (!is_dma_mapped)
+			dma_unmap_single(NULL, xfer->tx_dma, count, DMA_TO_DEVICE);
 
 	     //20110329 ws.yang@lge.com .. Reset Through-put requirement /* 20110719 dongyu.gwak@lge.com L3 200Mhz from Justin */ 
                //omap_pm_set_min_bus_tput(&spi->dev,OCP_INITIATOR_AGENT, -1);			
@@ -821,7 +825,8 @@ omap2_mcspi_txrx_dma(struct spi_device *spi, struct spi_transfer *xfer)
 
 		}
 
-		dma_unmap_single(NULL, xfer->rx_dma, count, DMA_FROM_DEVICE);
+		if (!is_dma_mapped)
+			dma_unmap_single(NULL, xfer->rx_dma, count, DMA_FROM_DEVICE);
 		omap2_mcspi_set_enable(spi, 0);
 
 		if (l & OMAP2_MCSPI_CHCONF_TURBO) {
@@ -1390,7 +1395,8 @@ static void omap2_mcspi_work(struct work_struct *work)
 					t->len >= DMA_MIN_BYTES ||
 					mcspi->dma_mode)
 
-					count = omap2_mcspi_txrx_dma(spi, t);
+					count = omap2_mcspi_txrx_dma(spi, t,
+							m->is_dma_mapped);
 				else
 					count = omap2_mcspi_txrx_pio(spi, t);
 
@@ -40,6 +40,43 @@
 #include <linux/dvs_suite.h>
 /* 20110331 sookyoung.kim@lge.com LG-DVFS [END_LGE] */
 
+/*
+ * binder_lock protects the reference counts, todo lists and transactions
+ * of all procs, and the contents of the nodes and refs.
+ *
+ * The trees of each proc (threads, nodes, refs_by_desc, refs_by_node) are
+ * protected by its own proc->tree_lock: every lookup, walk, insert and
+ * erase holds it. Inserting or erasing a node or ref also holds
+ * binder_lock, since it goes with the reference counts, and nodes and refs
+ * are only freed with both held; so a binder_lock holder may keep using
+ * what it looked up after dropping tree_lock. A thread is only freed by
+ * itself (BINDER_THREAD_EXIT) or by binder_deferred_release() once no
+ * ioctl can run on the file, so binder_ioctl() and binder_poll() look up
+ * the calling thread under tree_lock alone, before taking binder_lock.
+ *
+ * The buffer allocator of each proc has its own proc->alloc_lock, so that
+ * mapping and unmapping buffer pages and copying transaction data (both of
+ * which may sleep on mmap_sem or fault) do not stall every other binder
+ * user. binder_lock is not held across page faults on the commands and
+ * returns either, see binder_copy_from_user_locked().
+ *
+ * Lock order:
+ *	binder_lock -> proc->alloc_lock -> mmap_sem
+ *	binder_lock -> proc->tree_lock
+ *
+ * tree_lock is a leaf: no other mutex is taken under it, in particular
+ * neither alloc_lock nor the tree_lock of another proc. Operations on two
+ * procs take the two tree_locks one after the other, each only around its
+ * own tree, and hold binder_lock across the whole step to make it atomic:
+ *  - a transaction looks up the sender's node or ref under the sender's
+ *    tree_lock, then adds the ref in the target under the target's
+ *    (binder_get_ref_for_node());
+ *  - binder_delete_ref() erases the ref under ref->proc->tree_lock and
+ *    drops it before binder_dec_node() erases the node under
+ *    node->proc->tree_lock;
+ *  - binder_deferred_release() drops its own tree_lock around freeing each
+ *    thread and ref, which releases buffers and refs of other procs.
+ */
 static DEFINE_MUTEX(binder_lock);
 static DEFINE_MUTEX(binder_deferred_lock);
 
@@ -84,6 +121,19 @@ BINDER_DEBUG_ENTRY(proc);
 
 #define BINDER_SMALL_BUF_SIZE (PAGE_SIZE * 64)
 
+/*
+ * Most parcels are small. The first BINDER_SLOT_PAGES of a large enough
+ * mapping are mapped once at mmap time and cut into fixed size slots,
+ * which serve the transactions of up to BINDER_SLOT_DATA_SIZE bytes
+ * (data + offsets) from a free list, without the best fit search and
+ * without mapping and unmapping pages per transaction.
+ */
+#define BINDER_SLOT_DATA_SIZE               256
+#define BINDER_SLOT_STRIDE                  ALIGN(sizeof(struct binder_buffer) + \
+						  BINDER_SLOT_DATA_SIZE, sizeof(void *))
+#define BINDER_SLOT_PAGES                   4
+#define BINDER_SLOT_MIN_MMAP                (BINDER_SLOT_PAGES * PAGE_SIZE * 16)
+
 enum {
 	BINDER_DEBUG_USER_ERROR             = 1U << 0,
 	BINDER_DEBUG_FAILED_TRANSACTION     = 1U << 1,
@@ -289,6 +339,7 @@ struct binder_proc {
 	struct rb_root nodes;
 	struct rb_root refs_by_desc;
 	struct rb_root refs_by_node;
+	struct mutex tree_lock; /* threads, nodes, refs_by_desc/node */
 	int pid;
 	struct vm_area_struct *vma;
 	struct task_struct *tsk;
@@ -298,6 +349,7 @@ struct binder_proc {
 	void *buffer;
 	ptrdiff_t user_buffer_offset;
 
+	struct mutex alloc_lock; /* buffers, free/allocated_buffers, pages */
 	struct list_head buffers;
 	struct rb_root free_buffers;
 	struct rb_root allocated_buffers;
@@ -306,6 +358,17 @@ struct binder_proc {
 	struct page **pages;
 	size_t buffer_size;
 	uint32_t buffer_free;
+	int tmp_ref;	/* transactions copying into our buffers */
+	int is_dead;	/* released, waiting for tmp_ref to drop */
+
+	struct list_head free_slots;
+	int slot_count;
+	int free_slot_count;
+	unsigned slot_hits;
+	unsigned slot_misses;
+	unsigned pages_mapped;
+	unsigned pages_unmapped;
+
 	struct list_head todo;
 	wait_queue_head_t wait;
 	struct binder_stats stats;
@@ -519,9 +582,23 @@ static void binder_set_nice(long nice)
 	binder_user_error("binder: %d RLIMIT_NICE not set\n", current->pid);
 }
 
+static struct binder_buffer *binder_slot(struct binder_proc *proc, int i)
+{
+	return proc->buffer + i * BINDER_SLOT_STRIDE;
+}
+
+static int binder_buffer_is_slot(struct binder_proc *proc,
+				 struct binder_buffer *buffer)
+{
+	return (void *)buffer >= proc->buffer &&
+		(void *)buffer < (void *)binder_slot(proc, proc->slot_count);
+}
+
 static size_t binder_buffer_size(struct binder_proc *proc,
 				 struct binder_buffer *buffer)
 {
+	if (binder_buffer_is_slot(proc, buffer))
+		return BINDER_SLOT_STRIDE - sizeof(struct binder_buffer);
 	if (list_is_last(&buffer->entry, &proc->buffers))
 		return proc->buffer + proc->buffer_size - (void *)buffer->data;
 	else
@@ -597,6 +674,13 @@ static struct binder_buffer *binder_buffer_lookup(struct binder_proc *proc,
 	kern_ptr = user_ptr - proc->user_buffer_offset
 		- offsetof(struct binder_buffer, data);
 
+	if (binder_buffer_is_slot(proc, kern_ptr)) {
+		if (((void *)kern_ptr - proc->buffer) % BINDER_SLOT_STRIDE ||
+		    kern_ptr->free)
+			return NULL;
+		return kern_ptr;
+	}
+
 	while (n) {
 		buffer = rb_entry(n, struct binder_buffer, rb_node);
 		BUG_ON(buffer->free);
@@ -679,6 +763,7 @@ static int binder_update_page_range(struct binder_proc *proc, int allocate,
 			goto err_vm_insert_page_failed;
 		}
 		/* vm_insert_page does not seem to increment the refcount */
+		proc->pages_mapped++;
 	}
 	if (mm) {
 		up_write(&mm->mmap_sem);
@@ -690,6 +775,7 @@ free_range:
 	for (page_addr = end - PAGE_SIZE; page_addr >= start;
 	     page_addr -= PAGE_SIZE) {
 		page = &proc->pages[(page_addr - proc->buffer) / PAGE_SIZE];
+		proc->pages_unmapped++;
 		if (vma)
 			zap_page_range(vma, (uintptr_t)page_addr +
 				proc->user_buffer_offset, PAGE_SIZE, NULL);
@@ -709,9 +795,10 @@ err_no_vma:
 	return -ENOMEM;
 }
 
-static struct binder_buffer *binder_alloc_buf(struct binder_proc *proc,
-					      size_t data_size,
-					      size_t offsets_size, int is_async)
+static struct binder_buffer *binder_alloc_buf_locked(struct binder_proc *proc,
+						     size_t data_size,
+						     size_t offsets_size,
+						     int is_async)
 {
 	struct rb_node *n = proc->free_buffers.rb_node;
 	struct binder_buffer *buffer;
@@ -744,6 +831,19 @@ static struct binder_buffer *binder_alloc_buf(struct binder_proc *proc,
 		return NULL;
 	}
 
+	if (size <= BINDER_SLOT_DATA_SIZE && proc->slot_count) {
+		if (!list_empty(&proc->free_slots)) {
+			buffer = list_first_entry(&proc->free_slots,
+						  struct binder_buffer, entry);
+			list_del(&buffer->entry);
+			proc->free_slot_count--;
+			proc->slot_hits++;
+			buffer->free = 0;
+			goto got_buffer;
+		}
+		proc->slot_misses++;
+	}
+
 	while (n) {
 		buffer = rb_entry(n, struct binder_buffer, rb_node);
 		BUG_ON(!buffer->free);
@@ -798,12 +898,16 @@ static struct binder_buffer *binder_alloc_buf(struct binder_proc *proc,
 		new_buffer->free = 1;
 		binder_insert_free_buffer(proc, new_buffer);
 	}
+got_buffer:
 	binder_debug(BINDER_DEBUG_BUFFER_ALLOC,
 		     "binder: %d: binder_alloc_buf size %zd got "
 		     "%p\n", proc->pid, size, buffer);
 	buffer->data_size = data_size;
 	buffer->offsets_size = offsets_size;
 	buffer->async_transaction = is_async;
+	/* Not visible to BC_FREE_BUFFER until it is returned to user space */
+	buffer->allow_user_free = 0;
+	buffer->transaction = NULL;
 	if (is_async) {
 		proc->free_async_space -= size + sizeof(struct binder_buffer);
 		binder_debug(BINDER_DEBUG_BUFFER_ALLOC_ASYNC,
@@ -815,6 +919,19 @@ static struct binder_buffer *binder_alloc_buf(struct binder_proc *proc,
 	return buffer;
 }
 
+static struct binder_buffer *binder_alloc_buf(struct binder_proc *proc,
+					      size_t data_size,
+					      size_t offsets_size, int is_async)
+{
+	struct binder_buffer *buffer;
+
+	mutex_lock(&proc->alloc_lock);
+	buffer = binder_alloc_buf_locked(proc, data_size, offsets_size,
+					 is_async);
+	mutex_unlock(&proc->alloc_lock);
+	return buffer;
+}
+
 static void *buffer_start_page(struct binder_buffer *buffer)
 {
 	return (void *)((uintptr_t)buffer & PAGE_MASK);
@@ -872,8 +989,8 @@ static void binder_delete_free_buffer(struct binder_proc *proc,
 	}
 }
 
-static void binder_free_buf(struct binder_proc *proc,
-			    struct binder_buffer *buffer)
+static void binder_free_buf_locked(struct binder_proc *proc,
+				   struct binder_buffer *buffer)
 {
 	size_t size, buffer_size;
 
@@ -901,6 +1018,13 @@ static void binder_free_buf(struct binder_proc *proc,
 			     proc->free_async_space);
 	}
 
+	if (binder_buffer_is_slot(proc, buffer)) {
+		buffer->free = 1;
+		list_add(&buffer->entry, &proc->free_slots);
+		proc->free_slot_count++;
+		return;
+	}
+
 	binder_update_page_range(proc, 0,
 		(void *)PAGE_ALIGN((uintptr_t)buffer->data),
 		(void *)(((uintptr_t)buffer->data + buffer_size) & PAGE_MASK),
@@ -927,12 +1051,29 @@ static void binder_free_buf(struct binder_proc *proc,
 	binder_insert_free_buffer(proc, buffer);
 }
 
+static void binder_free_buf(struct binder_proc *proc,
+			    struct binder_buffer *buffer)
+{
+	mutex_lock(&proc->alloc_lock);
+	binder_free_buf_locked(proc, buffer);
+	mutex_unlock(&proc->alloc_lock);
+}
+
+static void binder_proc_dec_tmpref(struct binder_proc *proc)
+{
+	proc->tmp_ref--;
+	if (proc->tmp_ref == 0 && proc->is_dead)
+		binder_defer_work(proc, BINDER_DEFERRED_RELEASE);
+}
+
 static struct binder_node *binder_get_node(struct binder_proc *proc,
 					   void __user *ptr)
 {
-	struct rb_node *n = proc->nodes.rb_node;
-	struct binder_node *node;
+	struct rb_node *n;
+	struct binder_node *node = NULL;
 
+	mutex_lock(&proc->tree_lock);
+	n = proc->nodes.rb_node;
 	while (n) {
 		node = rb_entry(n, struct binder_node, rb_node);
 
@@ -941,19 +1082,22 @@ static struct binder_node *binder_get_node(struct binder_proc *proc,
 		else if (ptr > node->ptr)
 			n = n->rb_right;
 		else
-			return node;
+			break;
 	}
-	return NULL;
+	mutex_unlock(&proc->tree_lock);
+	return n ? node : NULL;
 }
 
 static struct binder_node *binder_new_node(struct binder_proc *proc,
 					   void __user *ptr,
 					   void __user *cookie)
 {
-	struct rb_node **p = &proc->nodes.rb_node;
+	struct rb_node **p;
 	struct rb_node *parent = NULL;
 	struct binder_node *node;
 
+	mutex_lock(&proc->tree_lock);
+	p = &proc->nodes.rb_node;
 	while (*p) {
 		parent = *p;
 		node = rb_entry(parent, struct binder_node, rb_node);
@@ -963,15 +1107,13 @@ static struct binder_node *binder_new_node(struct binder_proc *proc,
 		else if (ptr > node->ptr)
 			p = &(*p)->rb_right;
 		else
-			return NULL;
+			goto err;
 	}
 
 	node = kzalloc(sizeof(*node), GFP_KERNEL);
 	if (node == NULL)
-		return NULL;
+		goto err;
 	binder_stats_created(BINDER_STAT_NODE);
-	rb_link_node(&node->rb_node, parent, p);
-	rb_insert_color(&node->rb_node, &proc->nodes);
 	node->debug_id = ++binder_last_id;
 	node->proc = proc;
 	node->ptr = ptr;
@@ -979,11 +1121,18 @@ static struct binder_node *binder_new_node(struct binder_proc *proc,
 	node->work.type = BINDER_WORK_NODE;
 	INIT_LIST_HEAD(&node->work.entry);
 	INIT_LIST_HEAD(&node->async_todo);
+	rb_link_node(&node->rb_node, parent, p);
+	rb_insert_color(&node->rb_node, &proc->nodes);
+	mutex_unlock(&proc->tree_lock);
 	binder_debug(BINDER_DEBUG_INTERNAL_REFS,
 		     "binder: %d:%d node %d u%p c%p created\n",
 		     proc->pid, current->pid, node->debug_id,
 		     node->ptr, node->cookie);
 	return node;
+
+err:
+	mutex_unlock(&proc->tree_lock);
+	return NULL;
 }
 
 static int binder_inc_node(struct binder_node *node, int strong, int internal,
@@ -1046,7 +1195,9 @@ static int binder_dec_node(struct binder_node *node, int strong, int internal)
 		    !node->local_weak_refs) {
 			list_del_init(&node->work.entry);
 			if (node->proc) {
+				mutex_lock(&node->proc->tree_lock);
 				rb_erase(&node->rb_node, &node->proc->nodes);
+				mutex_unlock(&node->proc->tree_lock);
 				binder_debug(BINDER_DEBUG_INTERNAL_REFS,
 					     "binder: refless node %d deleted\n",
 					     node->debug_id);
@@ -1068,9 +1219,11 @@ static int binder_dec_node(struct binder_node *node, int strong, int internal)
 static struct binder_ref *binder_get_ref(struct binder_proc *proc,
 					 uint32_t desc)
 {
-	struct rb_node *n = proc->refs_by_desc.rb_node;
-	struct binder_ref *ref;
+	struct rb_node *n;
+	struct binder_ref *ref = NULL;
 
+	mutex_lock(&proc->tree_lock);
+	n = proc->refs_by_desc.rb_node;
 	while (n) {
 		ref = rb_entry(n, struct binder_ref, rb_node_desc);
 
@@ -1079,19 +1232,22 @@ static struct binder_ref *binder_get_ref(struct binder_proc *proc,
 		else if (desc > ref->desc)
 			n = n->rb_right;
 		else
-			return ref;
+			break;
 	}
-	return NULL;
+	mutex_unlock(&proc->tree_lock);
+	return n ? ref : NULL;
 }
 
 static struct binder_ref *binder_get_ref_for_node(struct binder_proc *proc,
 						  struct binder_node *node)
 {
 	struct rb_node *n;
-	struct rb_node **p = &proc->refs_by_node.rb_node;
+	struct rb_node **p;
 	struct rb_node *parent = NULL;
 	struct binder_ref *ref, *new_ref;
 
+	mutex_lock(&proc->tree_lock);
+	p = &proc->refs_by_node.rb_node;
 	while (*p) {
 		parent = *p;
 		ref = rb_entry(parent, struct binder_ref, rb_node_node);
@@ -1100,12 +1256,16 @@ static struct binder_ref *binder_get_ref_for_node(struct binder_proc *proc,
 			p = &(*p)->rb_left;
 		else if (node > ref->node)
 			p = &(*p)->rb_right;
-		else
+		else {
+			mutex_unlock(&proc->tree_lock);
 			return ref;
+		}
 	}
 	new_ref = kzalloc(sizeof(*ref), GFP_KERNEL);
-	if (new_ref == NULL)
+	if (new_ref == NULL) {
+		mutex_unlock(&proc->tree_lock);
 		return NULL;
+	}
 	binder_stats_created(BINDER_STAT_REF);
 	new_ref->debug_id = ++binder_last_id;
 	new_ref->proc = proc;
@@ -1135,6 +1295,7 @@ static struct binder_ref *binder_get_ref_for_node(struct binder_proc *proc,
 	}
 	rb_link_node(&new_ref->rb_node_desc, parent, p);
 	rb_insert_color(&new_ref->rb_node_desc, &proc->refs_by_desc);
+	mutex_unlock(&proc->tree_lock);
 	if (node) {
 		hlist_add_head(&new_ref->node_entry, &node->refs);
 
@@ -1158,8 +1319,10 @@ static void binder_delete_ref(struct binder_ref *ref)
 		     "node %d\n", ref->proc->pid, ref->debug_id,
 		     ref->desc, ref->node->debug_id);
 
+	mutex_lock(&ref->proc->tree_lock);
 	rb_erase(&ref->rb_node_desc, &ref->proc->refs_by_desc);
 	rb_erase(&ref->rb_node_node, &ref->proc->refs_by_node);
+	mutex_unlock(&ref->proc->tree_lock);
 	if (ref->strong)
 		binder_dec_node(ref->node, 1, 1);
 	hlist_del(&ref->node_entry);
@@ -1485,20 +1648,11 @@ static void binder_transaction(struct binder_proc *proc,
 				return_error = BR_FAILED_REPLY;
 				goto err_bad_call_stack;
 			}
-			while (tmp) {
-				if (tmp->from && tmp->from->proc == target_proc)
-					target_thread = tmp->from;
-				tmp = tmp->from_parent;
-			}
 		}
 	}
-	if (target_thread) {
-		e->to_thread = target_thread->pid;
-		target_list = &target_thread->todo;
-		target_wait = &target_thread->wait;
-	} else {
-		target_list = &target_proc->todo;
-		target_wait = &target_proc->wait;
+	if (target_proc->is_dead) {
+		return_error = BR_DEAD_REPLY;
+		goto err_dead_binder;
 	}
 	e->to_proc = target_proc->pid;
 
@@ -1543,17 +1697,29 @@ static void binder_transaction(struct binder_proc *proc,
 		t->from = NULL;
 	t->sender_euid = proc->tsk->cred->euid;
 	t->to_proc = target_proc;
-	t->to_thread = target_thread;
 	t->code = tr->code;
 	t->flags = tr->flags;
 	t->priority = task_nice(current);
+
+	/*
+	 * Allocate the buffer and copy the data without binder_lock. The
+	 * target node is held by a local strong ref and the release of
+	 * target_proc waits for tmp_ref, the rest is looked up again below.
+	 */
+	if (target_node)
+		binder_inc_node(target_node, 1, 0, NULL);
+	target_proc->tmp_ref++;
+	mutex_unlock(&binder_lock);
+
 	t->buffer = binder_alloc_buf(target_proc, tr->data_size,
 		tr->offsets_size, !reply && (t->flags & TF_ONE_WAY));
 	if (t->buffer == NULL) {
+		mutex_lock(&binder_lock);
+		if (target_node)
+			binder_dec_node(target_node, 1, 0);
 		return_error = BR_FAILED_REPLY;
 		goto err_binder_alloc_buf_failed;
 	}
-	t->buffer->allow_user_free = 0;
 	t->buffer->debug_id = t->debug_id;
 	t->buffer->transaction = t;
 	t->buffer->target_node = target_node;
@@ -1771,23 +1937,62 @@ static void binder_transaction(struct binder_proc *proc,
 	/* 20110331 sookyoung.kim@lge.com LG-DVFS [END_LGE] */
 #endif	// }
 
-	if (target_node)
-		binder_inc_node(target_node, 1, 0, NULL);
-
 	offp = (size_t *)(t->buffer->data + ALIGN(tr->data_size, sizeof(void *)));
 
 	if (copy_from_user(t->buffer->data, tr->data.ptr.buffer, tr->data_size)) {
+		mutex_lock(&binder_lock);
 		binder_user_error("binder: %d:%d got transaction with invalid "
 			"data ptr\n", proc->pid, thread->pid);
 		return_error = BR_FAILED_REPLY;
 		goto err_copy_data_failed;
 	}
 	if (copy_from_user(offp, tr->data.ptr.offsets, tr->offsets_size)) {
+		mutex_lock(&binder_lock);
 		binder_user_error("binder: %d:%d got transaction with invalid "
 			"offsets ptr\n", proc->pid, thread->pid);
 		return_error = BR_FAILED_REPLY;
 		goto err_copy_data_failed;
 	}
+	mutex_lock(&binder_lock);
+
+	if (reply) {
+		/* The target thread may have exited or moved on meanwhile */
+		if (in_reply_to->from == NULL) {
+			return_error = BR_DEAD_REPLY;
+			goto err_dead_target_thread;
+		}
+		if (target_thread->transaction_stack != in_reply_to) {
+			binder_user_error("binder: %d:%d got reply transaction "
+				"with bad target transaction stack %d, "
+				"expected %d\n",
+				proc->pid, thread->pid,
+				target_thread->transaction_stack ?
+				target_thread->transaction_stack->debug_id : 0,
+				in_reply_to->debug_id);
+			return_error = BR_FAILED_REPLY;
+			in_reply_to = NULL;
+			target_thread = NULL;
+			goto err_dead_target_thread;
+		}
+	} else if (!(t->flags & TF_ONE_WAY) && thread->transaction_stack) {
+		struct binder_transaction *tmp;
+		tmp = thread->transaction_stack;
+		while (tmp) {
+			if (tmp->from && tmp->from->proc == target_proc)
+				target_thread = tmp->from;
+			tmp = tmp->from_parent;
+		}
+	}
+	if (target_thread) {
+		e->to_thread = target_thread->pid;
+		target_list = &target_thread->todo;
+		target_wait = &target_thread->wait;
+	} else {
+		target_list = &target_proc->todo;
+		target_wait = &target_proc->wait;
+	}
+	t->to_thread = target_thread;
+
 	if (!IS_ALIGNED(tr->offsets_size, sizeof(size_t))) {
 		binder_user_error("binder: %d:%d got transaction with "
 			"invalid offsets size, %zd\n",
@@ -1957,6 +2162,7 @@ static void binder_transaction(struct binder_proc *proc,
 	list_add_tail(&tcomplete->entry, &thread->todo);
 	if (target_wait)
 		wake_up_interruptible(target_wait);
+	binder_proc_dec_tmpref(target_proc);
 	return;
 
 err_get_unused_fd_failed:
@@ -1967,11 +2173,13 @@ err_binder_get_ref_failed:
 err_binder_new_node_failed:
 err_bad_object_type:
 err_bad_offset:
+err_dead_target_thread:
 err_copy_data_failed:
 	binder_transaction_buffer_release(target_proc, t->buffer, offp);
 	t->buffer->transaction = NULL;
 	binder_free_buf(target_proc, t->buffer);
 err_binder_alloc_buf_failed:
+	binder_proc_dec_tmpref(target_proc);
 	kfree(tcomplete);
 	binder_stats_deleted(BINDER_STAT_TRANSACTION_COMPLETE);
 err_alloc_tcomplete_failed:
@@ -1994,24 +2202,113 @@ err_no_context_mgr_node:
 		*fe = *e;
 	}
 
-	BUG_ON(thread->return_error != BR_OK);
+	/*
+	 * A failed reply to an earlier transaction of this thread may have
+	 * been reported while binder_lock was dropped; keep it first.
+	 */
+	if (thread->return_error != BR_OK &&
+	    thread->return_error2 == BR_OK) {
+		thread->return_error2 = thread->return_error;
+		thread->return_error = BR_OK;
+	}
 	if (in_reply_to) {
-		thread->return_error = BR_TRANSACTION_COMPLETE;
+		if (thread->return_error == BR_OK)
+			thread->return_error = BR_TRANSACTION_COMPLETE;
 		binder_send_failed_reply(in_reply_to, return_error);
-	} else
+	} else if (thread->return_error == BR_OK)
 		thread->return_error = return_error;
 }
 
+/*
+ * binder_copy_from_user_locked - copy_from_user() for callers holding
+ * binder_lock. The copy is done with page faults disabled; only if the
+ * user page is not there is binder_lock dropped around a plain copy, so
+ * that faulting it in does not stall every other binder user.
+ *
+ * Returns 0 if the copy was done under binder_lock, -EAGAIN if binder_lock
+ * was dropped for it, in which case anything the caller looked at before
+ * has to be looked at again, or -EFAULT.
+ */
+static int binder_copy_from_user_locked(void *dst, const void __user *src,
+					size_t size)
+{
+	unsigned long left;
+
+	if (!access_ok(VERIFY_READ, src, size))
+		return -EFAULT;
+
+	pagefault_disable();
+	left = __copy_from_user_inatomic(dst, src, size);
+	pagefault_enable();
+	if (likely(!left))
+		return 0;
+
+	mutex_unlock(&binder_lock);
+	left = copy_from_user(dst, src, size);
+	mutex_lock(&binder_lock);
+
+	return left ? -EFAULT : -EAGAIN;
+}
+
+/*
+ * binder_copy_to_user_locked - the copy_to_user() counterpart of
+ * binder_copy_from_user_locked(). 'src' must stay valid while binder_lock
+ * is dropped, so it is a copy on the stack rather than a binder object.
+ */
+static int binder_copy_to_user_locked(void __user *dst, const void *src,
+				      size_t size)
+{
+	unsigned long left;
+
+	if (!access_ok(VERIFY_WRITE, dst, size))
+		return -EFAULT;
+
+	pagefault_disable();
+	left = __copy_to_user_inatomic(dst, src, size);
+	pagefault_enable();
+	if (likely(!left))
+		return 0;
+
+	mutex_unlock(&binder_lock);
+	left = copy_to_user(dst, src, size);
+	mutex_lock(&binder_lock);
+
+	return left ? -EFAULT : -EAGAIN;
+}
+
+/*
+ * binder_put_cmd_locked - writes the return 'cmd' followed by 'size' bytes
+ * of 'data' at 'ptr'. Returns as binder_copy_to_user_locked(); on -EAGAIN
+ * all of it was written, but the caller has to decide again what to
+ * return before it changes any state.
+ */
+static int binder_put_cmd_locked(void __user *ptr, uint32_t cmd,
+				 const void *data, size_t size)
+{
+	int ret, ret2;
+
+	ret = binder_copy_to_user_locked(ptr, &cmd, sizeof(cmd));
+	if (ret == -EFAULT || !size)
+		return ret;
+
+	ret2 = binder_copy_to_user_locked(ptr + sizeof(cmd), data, size);
+	return ret2 ? ret2 : ret;
+}
+
 int binder_thread_write(struct binder_proc *proc, struct binder_thread *thread,
 			void __user *buffer, int size, signed long *consumed)
 {
 	uint32_t cmd;
 	void __user *ptr = buffer + *consumed;
 	void __user *end = buffer + size;
+	int ret;
 
 	while (ptr < end && thread->return_error == BR_OK) {
-		if (get_user(cmd, (uint32_t __user *)ptr))
-			return -EFAULT;
+		ret = binder_copy_from_user_locked(&cmd, ptr, sizeof(cmd));
+		if (ret == -EFAULT)
+			return ret;
+		if (ret && thread->return_error != BR_OK)
+			break;	/* failed reply came in while unlocked */
 		ptr += sizeof(uint32_t);
 		if (_IOC_NR(cmd) < ARRAY_SIZE(binder_stats.bc)) {
 			binder_stats.bc[_IOC_NR(cmd)]++;
@@ -2027,7 +2324,8 @@ int binder_thread_write(struct binder_proc *proc, struct binder_thread *thread,
 			struct binder_ref *ref;
 			const char *debug_string;
 
-			if (get_user(target, (uint32_t __user *)ptr))
+			if (binder_copy_from_user_locked(&target, ptr,
+					sizeof(target)) == -EFAULT)
 				return -EFAULT;
 			ptr += sizeof(uint32_t);
 			if (target == 0 && binder_context_mgr_node &&
@@ -2086,10 +2384,12 @@ int binder_thread_write(struct binder_proc *proc, struct binder_thread *thread,
 			void *cookie;
 			struct binder_node *node;
 
-			if (get_user(node_ptr, (void * __user *)ptr))
+			if (binder_copy_from_user_locked(&node_ptr, ptr,
+					sizeof(node_ptr)) == -EFAULT)
 				return -EFAULT;
 			ptr += sizeof(void *);
-			if (get_user(cookie, (void * __user *)ptr))
+			if (binder_copy_from_user_locked(&cookie, ptr,
+					sizeof(cookie)) == -EFAULT)
 				return -EFAULT;
 			ptr += sizeof(void *);
 			node = binder_get_node(proc, node_ptr);
@@ -2153,24 +2453,30 @@ int binder_thread_write(struct binder_proc *proc, struct binder_thread *thread,
 			void __user *data_ptr;
 			struct binder_buffer *buffer;
 
-			if (get_user(data_ptr, (void * __user *)ptr))
+			if (binder_copy_from_user_locked(&data_ptr, ptr,
+					sizeof(data_ptr)) == -EFAULT)
 				return -EFAULT;
 			ptr += sizeof(void *);
 
+			mutex_lock(&proc->alloc_lock);
 			buffer = binder_buffer_lookup(proc, data_ptr);
 			if (buffer == NULL) {
+				mutex_unlock(&proc->alloc_lock);
 				binder_user_error("binder: %d:%d "
 					"BC_FREE_BUFFER u%p no match\n",
 					proc->pid, thread->pid, data_ptr);
 				break;
 			}
 			if (!buffer->allow_user_free) {
+				mutex_unlock(&proc->alloc_lock);
 				binder_user_error("binder: %d:%d "
 					"BC_FREE_BUFFER u%p matched "
 					"unreturned buffer\n",
 					proc->pid, thread->pid, data_ptr);
 				break;
 			}
+			buffer->allow_user_free = 0;
+			mutex_unlock(&proc->alloc_lock);
 			binder_debug(BINDER_DEBUG_FREE_BUFFER,
 				     "binder: %d:%d BC_FREE_BUFFER u%p found buffer %d for %s transaction\n",
 				     proc->pid, thread->pid, data_ptr, buffer->debug_id,
@@ -2188,7 +2494,11 @@ int binder_thread_write(struct binder_proc *proc, struct binder_thread *thread,
 					list_move_tail(buffer->target_node->async_todo.next, &thread->todo);
 			}
 			binder_transaction_buffer_release(proc, buffer, NULL);
+
+			/* Unmapping the pages takes mmap_sem, don't hold up others */
+			mutex_unlock(&binder_lock);
 			binder_free_buf(proc, buffer);
+			mutex_lock(&binder_lock);
 			break;
 		}
 
@@ -2196,7 +2506,8 @@ int binder_thread_write(struct binder_proc *proc, struct binder_thread *thread,
 		case BC_REPLY: {
 			struct binder_transaction_data tr;
 
-			if (copy_from_user(&tr, ptr, sizeof(tr)))
+			if (binder_copy_from_user_locked(&tr, ptr,
+					sizeof(tr)) == -EFAULT)
 				return -EFAULT;
 			ptr += sizeof(tr);
 			binder_transaction(proc, thread, &tr, cmd == BC_REPLY);
@@ -2252,10 +2563,12 @@ int binder_thread_write(struct binder_proc *proc, struct binder_thread *thread,
 			struct binder_ref *ref;
 			struct binder_ref_death *death;
 
-			if (get_user(target, (uint32_t __user *)ptr))
+			if (binder_copy_from_user_locked(&target, ptr,
+					sizeof(target)) == -EFAULT)
 				return -EFAULT;
 			ptr += sizeof(uint32_t);
-			if (get_user(cookie, (void __user * __user *)ptr))
+			if (binder_copy_from_user_locked(&cookie, ptr,
+					sizeof(cookie)) == -EFAULT)
 				return -EFAULT;
 			ptr += sizeof(void *);
 			ref = binder_get_ref(proc, target);
@@ -2349,7 +2662,8 @@ int binder_thread_write(struct binder_proc *proc, struct binder_thread *thread,
 			struct binder_work *w;
 			void __user *cookie;
 			struct binder_ref_death *death = NULL;
-			if (get_user(cookie, (void __user * __user *)ptr))
+			if (binder_copy_from_user_locked(&cookie, ptr,
+					sizeof(cookie)) == -EFAULT)
 				return -EFAULT;
 
 			ptr += sizeof(void *);
@@ -2424,10 +2738,11 @@ static int binder_thread_read(struct binder_proc *proc,
 	void __user *end = buffer + size;
 
 	int ret = 0;
+	int err;
 	int wait_for_proc_work;
 
 	if (*consumed == 0) {
-		if (put_user(BR_NOOP, (uint32_t __user *)ptr))
+		if (binder_put_cmd_locked(ptr, BR_NOOP, NULL, 0) == -EFAULT)
 			return -EFAULT;
 		ptr += sizeof(uint32_t);
 	}
@@ -2438,15 +2753,22 @@ retry:
 
 	if (thread->return_error != BR_OK && ptr < end) {
 		if (thread->return_error2 != BR_OK) {
-			if (put_user(thread->return_error2, (uint32_t __user *)ptr))
-				return -EFAULT;
+			err = binder_put_cmd_locked(ptr, thread->return_error2,
+						    NULL, 0);
+			if (err == -EAGAIN)
+				goto retry;
+			if (err)
+				return err;
 			ptr += sizeof(uint32_t);
 			if (ptr == end)
 				goto done;
 			thread->return_error2 = BR_OK;
 		}
-		if (put_user(thread->return_error, (uint32_t __user *)ptr))
-			return -EFAULT;
+		err = binder_put_cmd_locked(ptr, thread->return_error, NULL, 0);
+		if (err == -EAGAIN)
+			goto retry;
+		if (err)
+			return err;
 		ptr += sizeof(uint32_t);
 		thread->return_error = BR_OK;
 		goto done;
@@ -2513,8 +2835,11 @@ retry:
 		} break;
 		case BINDER_WORK_TRANSACTION_COMPLETE: {
 			cmd = BR_TRANSACTION_COMPLETE;
-			if (put_user(cmd, (uint32_t __user *)ptr))
-				return -EFAULT;
+			err = binder_put_cmd_locked(ptr, cmd, NULL, 0);
+			if (err == -EAGAIN)
+				continue;
+			if (err)
+				return err;
 			ptr += sizeof(uint32_t);
 
 			binder_stat_br(proc, thread, cmd);
@@ -2528,6 +2853,7 @@ retry:
 		} break;
 		case BINDER_WORK_NODE: {
 			struct binder_node *node = container_of(w, struct binder_node, work);
+			struct binder_ptr_cookie pc;
 			uint32_t cmd = BR_NOOP;
 			const char *cmd_name;
 			int strong = node->internal_strong_refs || node->local_strong_refs;
@@ -2535,34 +2861,44 @@ retry:
 			if (weak && !node->has_weak_ref) {
 				cmd = BR_INCREFS;
 				cmd_name = "BR_INCREFS";
-				node->has_weak_ref = 1;
-				node->pending_weak_ref = 1;
-				node->local_weak_refs++;
 			} else if (strong && !node->has_strong_ref) {
 				cmd = BR_ACQUIRE;
 				cmd_name = "BR_ACQUIRE";
-				node->has_strong_ref = 1;
-				node->pending_strong_ref = 1;
-				node->local_strong_refs++;
 			} else if (!strong && node->has_strong_ref) {
 				cmd = BR_RELEASE;
 				cmd_name = "BR_RELEASE";
-				node->has_strong_ref = 0;
 			} else if (!weak && node->has_weak_ref) {
 				cmd = BR_DECREFS;
 				cmd_name = "BR_DECREFS";
-				node->has_weak_ref = 0;
 			}
 			if (cmd != BR_NOOP) {
-				if (put_user(cmd, (uint32_t __user *)ptr))
-					return -EFAULT;
-				ptr += sizeof(uint32_t);
-				if (put_user(node->ptr, (void * __user *)ptr))
-					return -EFAULT;
-				ptr += sizeof(void *);
-				if (put_user(node->cookie, (void * __user *)ptr))
-					return -EFAULT;
-				ptr += sizeof(void *);
+				pc.ptr = node->ptr;
+				pc.cookie = node->cookie;
+				err = binder_put_cmd_locked(ptr, cmd, &pc, sizeof(pc));
+				if (err == -EAGAIN)
+					continue;
+				if (err)
+					return err;
+				ptr += sizeof(uint32_t) + sizeof(pc);
+
+				switch (cmd) {
+				case BR_INCREFS:
+					node->has_weak_ref = 1;
+					node->pending_weak_ref = 1;
+					node->local_weak_refs++;
+					break;
+				case BR_ACQUIRE:
+					node->has_strong_ref = 1;
+					node->pending_strong_ref = 1;
+					node->local_strong_refs++;
+					break;
+				case BR_RELEASE:
+					node->has_strong_ref = 0;
+					break;
+				case BR_DECREFS:
+					node->has_weak_ref = 0;
+					break;
+				}
 
 				binder_stat_br(proc, thread, cmd);
 				binder_debug(BINDER_DEBUG_USER_REFS,
@@ -2575,7 +2911,9 @@ retry:
 						     "binder: %d:%d node %d u%p c%p deleted\n",
 						     proc->pid, thread->pid, node->debug_id,
 						     node->ptr, node->cookie);
+					mutex_lock(&proc->tree_lock);
 					rb_erase(&node->rb_node, &proc->nodes);
+					mutex_unlock(&proc->tree_lock);
 					kfree(node);
 					binder_stats_deleted(BINDER_STAT_NODE);
 				} else {
@@ -2590,6 +2928,7 @@ retry:
 		case BINDER_WORK_DEAD_BINDER_AND_CLEAR:
 		case BINDER_WORK_CLEAR_DEATH_NOTIFICATION: {
 			struct binder_ref_death *death;
+			void __user *cookie;
 			uint32_t cmd;
 
 			death = container_of(w, struct binder_ref_death, work);
@@ -2597,12 +2936,13 @@ retry:
 				cmd = BR_CLEAR_DEATH_NOTIFICATION_DONE;
 			else
 				cmd = BR_DEAD_BINDER;
-			if (put_user(cmd, (uint32_t __user *)ptr))
-				return -EFAULT;
-			ptr += sizeof(uint32_t);
-			if (put_user(death->cookie, (void * __user *)ptr))
-				return -EFAULT;
-			ptr += sizeof(void *);
+			cookie = death->cookie;
+			err = binder_put_cmd_locked(ptr, cmd, &cookie, sizeof(cookie));
+			if (err == -EAGAIN)
+				continue;
+			if (err)
+				return err;
+			ptr += sizeof(uint32_t) + sizeof(cookie);
 			binder_debug(BINDER_DEBUG_DEATH_NOTIFICATION,
 				     "binder: %d:%d %s %p\n",
 				      proc->pid, thread->pid,
@@ -2630,13 +2970,6 @@ retry:
 			struct binder_node *target_node = t->buffer->target_node;
 			tr.target.ptr = target_node->ptr;
 			tr.cookie =  target_node->cookie;
-			t->saved_priority = task_nice(current);
-			if (t->priority < target_node->min_priority &&
-			    !(t->flags & TF_ONE_WAY))
-				binder_set_nice(t->priority);
-			else if (!(t->flags & TF_ONE_WAY) ||
-				 t->saved_priority > target_node->min_priority)
-				binder_set_nice(target_node->min_priority);
 			cmd = BR_TRANSACTION;
 		} else {
 			tr.target.ptr = NULL;
@@ -2663,12 +2996,24 @@ retry:
 					ALIGN(t->buffer->data_size,
 					    sizeof(void *));
 
-		if (put_user(cmd, (uint32_t __user *)ptr))
-			return -EFAULT;
-		ptr += sizeof(uint32_t);
-		if (copy_to_user(ptr, &tr, sizeof(tr)))
-			return -EFAULT;
-		ptr += sizeof(tr);
+		err = binder_put_cmd_locked(ptr, cmd, &tr, sizeof(tr));
+		if (err == -EAGAIN)
+			continue;
+		if (err)
+			return err;
+		ptr += sizeof(uint32_t) + sizeof(tr);
+
+		if (cmd == BR_TRANSACTION) {
+			struct binder_node *target_node = t->buffer->target_node;
+
+			t->saved_priority = task_nice(current);
+			if (t->priority < target_node->min_priority &&
+			    !(t->flags & TF_ONE_WAY))
+				binder_set_nice(t->priority);
+			else if (!(t->flags & TF_ONE_WAY) ||
+				 t->saved_priority > target_node->min_priority)
+				binder_set_nice(target_node->min_priority);
+		}
 
 		binder_stat_br(proc, thread, cmd);
 		binder_debug(BINDER_DEBUG_TRANSACTION,
@@ -2708,7 +3053,7 @@ done:
 		binder_debug(BINDER_DEBUG_THREADS,
 			     "binder: %d:%d BR_SPAWN_LOOPER\n",
 			     proc->pid, thread->pid);
-		if (put_user(BR_SPAWN_LOOPER, (uint32_t __user *)buffer))
+		if (binder_put_cmd_locked(buffer, BR_SPAWN_LOOPER, NULL, 0) == -EFAULT)
 			return -EFAULT;
 	}
 	return 0;
@@ -2739,38 +3084,71 @@ static void binder_release_work(struct list_head *list)
 
 }
 
-static struct binder_thread *binder_get_thread(struct binder_proc *proc)
+/*
+ * Only needs proc->tree_lock: the thread of current can only be freed by
+ * current itself or by binder_deferred_release().
+ */
+static struct binder_thread *binder_find_thread(struct binder_proc *proc)
 {
+	struct rb_node *n;
 	struct binder_thread *thread = NULL;
+
+	mutex_lock(&proc->tree_lock);
+	n = proc->threads.rb_node;
+	while (n) {
+		thread = rb_entry(n, struct binder_thread, rb_node);
+
+		if (current->pid < thread->pid)
+			n = n->rb_left;
+		else if (current->pid > thread->pid)
+			n = n->rb_right;
+		else
+			break;
+	}
+	mutex_unlock(&proc->tree_lock);
+	return n ? thread : NULL;
+}
+
+static struct binder_thread *binder_get_thread(struct binder_proc *proc)
+{
+	struct binder_thread *thread;
 	struct rb_node *parent = NULL;
-	struct rb_node **p = &proc->threads.rb_node;
+	struct rb_node **p;
 
+	thread = binder_find_thread(proc);
+	if (thread)
+		return thread;
+
+	thread = kzalloc(sizeof(*thread), GFP_KERNEL);
+	if (thread == NULL)
+		return NULL;
+	binder_stats_created(BINDER_STAT_THREAD);
+	thread->proc = proc;
+	thread->pid = current->pid;
+	init_waitqueue_head(&thread->wait);
+	INIT_LIST_HEAD(&thread->todo);
+	thread->looper |= BINDER_LOOPER_STATE_NEED_RETURN;
+	thread->return_error = BR_OK;
+	thread->return_error2 = BR_OK;
+
+	mutex_lock(&proc->tree_lock);
+	p = &proc->threads.rb_node;
 	while (*p) {
+		struct binder_thread *t;
+
 		parent = *p;
-		thread = rb_entry(parent, struct binder_thread, rb_node);
+		t = rb_entry(parent, struct binder_thread, rb_node);
 
-		if (current->pid < thread->pid)
+		if (thread->pid < t->pid)
 			p = &(*p)->rb_left;
-		else if (current->pid > thread->pid)
+		else if (thread->pid > t->pid)
 			p = &(*p)->rb_right;
 		else
-			break;
-	}
-	if (*p == NULL) {
-		thread = kzalloc(sizeof(*thread), GFP_KERNEL);
-		if (thread == NULL)
-			return NULL;
-		binder_stats_created(BINDER_STAT_THREAD);
-		thread->proc = proc;
-		thread->pid = current->pid;
-		init_waitqueue_head(&thread->wait);
-		INIT_LIST_HEAD(&thread->todo);
-		rb_link_node(&thread->rb_node, parent, p);
-		rb_insert_color(&thread->rb_node, &proc->threads);
-		thread->looper |= BINDER_LOOPER_STATE_NEED_RETURN;
-		thread->return_error = BR_OK;
-		thread->return_error2 = BR_OK;
+			BUG();
 	}
+	rb_link_node(&thread->rb_node, parent, p);
+	rb_insert_color(&thread->rb_node, &proc->threads);
+	mutex_unlock(&proc->tree_lock);
 	return thread;
 }
 
@@ -2781,7 +3159,9 @@ static int binder_free_thread(struct binder_proc *proc,
 	struct binder_transaction *send_reply = NULL;
 	int active_transactions = 0;
 
+	mutex_lock(&proc->tree_lock);
 	rb_erase(&thread->rb_node, &proc->threads);
+	mutex_unlock(&proc->tree_lock);
 	t = thread->transaction_stack;
 	if (t && t->to_thread == thread)
 		send_reply = t;
@@ -2822,8 +3202,10 @@ static unsigned int binder_poll(struct file *filp,
 	struct binder_thread *thread = NULL;
 	int wait_for_proc_work;
 
+	thread = binder_find_thread(proc);
 	mutex_lock(&binder_lock);
-	thread = binder_get_thread(proc);
+	if (thread == NULL)
+		thread = binder_get_thread(proc);
 #if defined(CONFIG_MACH_LGE_OMAP3) //LGE_CHANGE [sunggyun.yu@lge.com] 2011-03-19, WBT
 	if (thread == NULL) {
 		printk(KERN_ERR "binder_get_thread failed.\n");
@@ -2866,8 +3248,10 @@ static long binder_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
 	if (ret)
 		return ret;
 
+	thread = binder_find_thread(proc);
 	mutex_lock(&binder_lock);
-	thread = binder_get_thread(proc);
+	if (thread == NULL)
+		thread = binder_get_thread(proc);
 	if (thread == NULL) {
 		ret = -ENOMEM;
 		goto err;
@@ -2880,7 +3264,8 @@ static long binder_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
 			ret = -EINVAL;
 			goto err;
 		}
-		if (copy_from_user(&bwr, ubuf, sizeof(bwr))) {
+		if (binder_copy_from_user_locked(&bwr, ubuf,
+				sizeof(bwr)) == -EFAULT) {
 			ret = -EFAULT;
 			goto err;
 		}
@@ -2893,7 +3278,8 @@ static long binder_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
 			ret = binder_thread_write(proc, thread, (void __user *)bwr.write_buffer, bwr.write_size, &bwr.write_consumed);
 			if (ret < 0) {
 				bwr.read_consumed = 0;
-				if (copy_to_user(ubuf, &bwr, sizeof(bwr)))
+				if (binder_copy_to_user_locked(ubuf, &bwr,
+						sizeof(bwr)) == -EFAULT)
 					ret = -EFAULT;
 				goto err;
 			}
@@ -2903,7 +3289,8 @@ static long binder_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
 			if (!list_empty(&proc->todo))
 				wake_up_interruptible(&proc->wait);
 			if (ret < 0) {
-				if (copy_to_user(ubuf, &bwr, sizeof(bwr)))
+				if (binder_copy_to_user_locked(ubuf, &bwr,
+						sizeof(bwr)) == -EFAULT)
 					ret = -EFAULT;
 				goto err;
 			}
@@ -2912,18 +3299,24 @@ static long binder_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
 			     "binder: %d:%d wrote %ld of %ld, read return %ld of %ld\n",
 			     proc->pid, thread->pid, bwr.write_consumed, bwr.write_size,
 			     bwr.read_consumed, bwr.read_size);
-		if (copy_to_user(ubuf, &bwr, sizeof(bwr))) {
+		if (binder_copy_to_user_locked(ubuf, &bwr,
+				sizeof(bwr)) == -EFAULT) {
 			ret = -EFAULT;
 			goto err;
 		}
 		break;
 	}
-	case BINDER_SET_MAX_THREADS:
-		if (copy_from_user(&proc->max_threads, ubuf, sizeof(proc->max_threads))) {
+	case BINDER_SET_MAX_THREADS: {
+		int max_threads;
+
+		if (binder_copy_from_user_locked(&max_threads, ubuf,
+				sizeof(max_threads)) == -EFAULT) {
 			ret = -EINVAL;
 			goto err;
 		}
+		proc->max_threads = max_threads;
 		break;
+	}
 	case BINDER_SET_CONTEXT_MGR:
 		if (binder_context_mgr_node != NULL) {
 			printk(KERN_ERR "binder: BINDER_SET_CONTEXT_MGR already set\n");
@@ -2962,9 +3355,14 @@ static long binder_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
 			ret = -EINVAL;
 			goto err;
 		}
-		if (put_user(BINDER_CURRENT_PROTOCOL_VERSION, &((struct binder_version *)ubuf)->protocol_version)) {
-			ret = -EINVAL;
-			goto err;
+		{
+			signed long version = BINDER_CURRENT_PROTOCOL_VERSION;
+
+			if (binder_copy_to_user_locked(&((struct binder_version *)ubuf)->protocol_version,
+					&version, sizeof(version)) == -EFAULT) {
+				ret = -EINVAL;
+				goto err;
+			}
 		}
 		break;
 	default:
@@ -3017,6 +3415,8 @@ static int binder_mmap(struct file *filp, struct vm_area_struct *vma)
 	struct binder_proc *proc = filp->private_data;
 	const char *failure_string;
 	struct binder_buffer *buffer;
+	size_t slots_size;
+	int i;
 
 	if ((vma->vm_end - vma->vm_start) > SZ_4M)
 		vma->vm_end = vma->vm_start + SZ_4M;
@@ -3068,12 +3468,25 @@ static int binder_mmap(struct file *filp, struct vm_area_struct *vma)
 	vma->vm_ops = &binder_vm_ops;
 	vma->vm_private_data = proc;
 
-	if (binder_update_page_range(proc, 1, proc->buffer, proc->buffer + PAGE_SIZE, vma)) {
+	slots_size = 0;
+	if (proc->buffer_size >= BINDER_SLOT_MIN_MMAP)
+		slots_size = BINDER_SLOT_PAGES * PAGE_SIZE;
+
+	if (binder_update_page_range(proc, 1, proc->buffer, proc->buffer + slots_size + PAGE_SIZE, vma)) {
 		ret = -ENOMEM;
 		failure_string = "alloc small buf";
 		goto err_alloc_small_buf_failed;
 	}
-	buffer = proc->buffer;
+	INIT_LIST_HEAD(&proc->free_slots);
+	proc->slot_count = slots_size / BINDER_SLOT_STRIDE;
+	for (i = proc->slot_count - 1; i >= 0; i--) {
+		buffer = binder_slot(proc, i);
+		buffer->free = 1;
+		list_add(&buffer->entry, &proc->free_slots);
+	}
+	proc->free_slot_count = proc->slot_count;
+
+	buffer = proc->buffer + slots_size;
 	INIT_LIST_HEAD(&proc->buffers);
 	list_add(&buffer->entry, &proc->buffers);
 	buffer->free = 1;
@@ -3113,6 +3526,8 @@ static int binder_open(struct inode *nodp, struct file *filp)
 		return -ENOMEM;
 	get_task_struct(current);
 	proc->tsk = current;
+	mutex_init(&proc->tree_lock);
+	mutex_init(&proc->alloc_lock);
 	INIT_LIST_HEAD(&proc->todo);
 	init_waitqueue_head(&proc->wait);
 	proc->default_priority = task_nice(current);
@@ -3147,6 +3562,8 @@ static void binder_deferred_flush(struct binder_proc *proc)
 {
 	struct rb_node *n;
 	int wake_count = 0;
+
+	mutex_lock(&proc->tree_lock);
 	for (n = rb_first(&proc->threads); n != NULL; n = rb_next(n)) {
 		struct binder_thread *thread = rb_entry(n, struct binder_thread, rb_node);
 		thread->looper |= BINDER_LOOPER_STATE_NEED_RETURN;
@@ -3155,6 +3572,7 @@ static void binder_deferred_flush(struct binder_proc *proc)
 			wake_count++;
 		}
 	}
+	mutex_unlock(&proc->tree_lock);
 	wake_up_interruptible_all(&proc->wait);
 
 	binder_debug(BINDER_DEBUG_OPEN_CLOSE,
@@ -3171,16 +3589,39 @@ static int binder_release(struct inode *nodp, struct file *filp)
 	return 0;
 }
 
+static void binder_deferred_release_buf(struct binder_proc *proc,
+					struct binder_buffer *buffer)
+{
+	struct binder_transaction *t;
+
+	t = buffer->transaction;
+	if (t) {
+		t->buffer = NULL;
+		buffer->transaction = NULL;
+		printk(KERN_ERR "binder: release proc %d, "
+		       "transaction %d, not freed\n",
+		       proc->pid, t->debug_id);
+		/*BUG();*/
+	}
+	binder_free_buf_locked(proc, buffer);
+}
+
 static void binder_deferred_release(struct binder_proc *proc)
 {
 	struct hlist_node *pos;
-	struct binder_transaction *t;
 	struct rb_node *n;
 	int threads, nodes, incoming_refs, outgoing_refs, buffers, active_transactions, page_count;
+	int i;
 
 	BUG_ON(proc->vma);
 	BUG_ON(proc->files);
 
+	if (proc->tmp_ref) {
+		/* requeued by binder_proc_dec_tmpref() */
+		proc->is_dead = 1;
+		return;
+	}
+
 	hlist_del(&proc->proc_node);
 	if (binder_context_mgr_node && binder_context_mgr_node->proc == proc) {
 		binder_debug(BINDER_DEBUG_DEAD_BINDER,
@@ -3191,10 +3632,13 @@ static void binder_deferred_release(struct binder_proc *proc)
 
 	threads = 0;
 	active_transactions = 0;
+	mutex_lock(&proc->tree_lock);
 	while ((n = rb_first(&proc->threads))) {
 		struct binder_thread *thread = rb_entry(n, struct binder_thread, rb_node);
 		threads++;
+		mutex_unlock(&proc->tree_lock);
 		active_transactions += binder_free_thread(proc, thread);
+		mutex_lock(&proc->tree_lock);
 	}
 	nodes = 0;
 	incoming_refs = 0;
@@ -3239,32 +3683,34 @@ static void binder_deferred_release(struct binder_proc *proc)
 		struct binder_ref *ref = rb_entry(n, struct binder_ref,
 						  rb_node_desc);
 		outgoing_refs++;
+		mutex_unlock(&proc->tree_lock);
 		binder_delete_ref(ref);
+		mutex_lock(&proc->tree_lock);
 	}
+	mutex_unlock(&proc->tree_lock);
 	binder_release_work(&proc->todo);
 	buffers = 0;
 
+	mutex_lock(&proc->alloc_lock);
+	for (i = 0; i < proc->slot_count; i++) {
+		struct binder_buffer *buffer = binder_slot(proc, i);
+		if (buffer->free)
+			continue;
+		binder_deferred_release_buf(proc, buffer);
+		buffers++;
+	}
 	while ((n = rb_first(&proc->allocated_buffers))) {
 		struct binder_buffer *buffer = rb_entry(n, struct binder_buffer,
 							rb_node);
-		t = buffer->transaction;
-		if (t) {
-			t->buffer = NULL;
-			buffer->transaction = NULL;
-			printk(KERN_ERR "binder: release proc %d, "
-			       "transaction %d, not freed\n",
-			       proc->pid, t->debug_id);
-			/*BUG();*/
-		}
-		binder_free_buf(proc, buffer);
+		binder_deferred_release_buf(proc, buffer);
 		buffers++;
 	}
+	mutex_unlock(&proc->alloc_lock);
 
 	binder_stats_deleted(BINDER_STAT_PROC);
 
 	page_count = 0;
 	if (proc->pages) {
-		int i;
 		for (i = 0; i < proc->buffer_size / PAGE_SIZE; i++) {
 			if (proc->pages[i]) {
 				void *page_addr = proc->buffer + i * PAGE_SIZE;
@@ -3483,6 +3929,16 @@ static void print_binder_ref(struct seq_file *m, struct binder_ref *ref)
 		   ref->node->debug_id, ref->strong, ref->weak, ref->death);
 }
 
+static void print_binder_alloc_stats(struct seq_file *m,
+				     struct binder_proc *proc)
+{
+	seq_printf(m, "  small buffers: %d free of %d, hits %u misses %u\n",
+		   proc->free_slot_count, proc->slot_count,
+		   proc->slot_hits, proc->slot_misses);
+	seq_printf(m, "  pages mapped %u unmapped %u\n",
+		   proc->pages_mapped, proc->pages_unmapped);
+}
+
 static void print_binder_proc(struct seq_file *m,
 			      struct binder_proc *proc, int print_all)
 {
@@ -3490,10 +3946,12 @@ static void print_binder_proc(struct seq_file *m,
 	struct rb_node *n;
 	size_t start_pos = m->count;
 	size_t header_pos;
+	int i;
 
 	seq_printf(m, "proc %d\n", proc->pid);
 	header_pos = m->count;
 
+	mutex_lock(&proc->tree_lock);
 	for (n = rb_first(&proc->threads); n != NULL; n = rb_next(n))
 		print_binder_thread(m, rb_entry(n, struct binder_thread,
 						rb_node), print_all);
@@ -3510,9 +3968,18 @@ static void print_binder_proc(struct seq_file *m,
 			print_binder_ref(m, rb_entry(n, struct binder_ref,
 						     rb_node_desc));
 	}
+	mutex_unlock(&proc->tree_lock);
+	mutex_lock(&proc->alloc_lock);
+	if (print_all)
+		print_binder_alloc_stats(m, proc);
+	for (i = 0; i < proc->slot_count; i++) {
+		if (!binder_slot(proc, i)->free)
+			print_binder_buffer(m, "  buffer", binder_slot(proc, i));
+	}
 	for (n = rb_first(&proc->allocated_buffers); n != NULL; n = rb_next(n))
 		print_binder_buffer(m, "  buffer",
 				    rb_entry(n, struct binder_buffer, rb_node));
+	mutex_unlock(&proc->alloc_lock);
 	list_for_each_entry(w, &proc->todo, entry)
 		print_binder_work(m, "  ", "  pending transaction", w);
 	list_for_each_entry(w, &proc->delivered_death, entry) {
@@ -3616,15 +4083,20 @@ static void print_binder_proc_stats(struct seq_file *m,
 	int count, strong, weak;
 
 	seq_printf(m, "proc %d\n", proc->pid);
+	mutex_lock(&proc->tree_lock);
 	count = 0;
 	for (n = rb_first(&proc->threads); n != NULL; n = rb_next(n))
 		count++;
+	mutex_unlock(&proc->tree_lock);
 	seq_printf(m, "  threads: %d\n", count);
+	mutex_lock(&proc->alloc_lock);
 	seq_printf(m, "  requested threads: %d+%d/%d\n"
 			"  ready threads %d\n"
 			"  free async space %zd\n", proc->requested_threads,
 			proc->requested_threads_started, proc->max_threads,
 			proc->ready_threads, proc->free_async_space);
+	mutex_unlock(&proc->alloc_lock);
+	mutex_lock(&proc->tree_lock);
 	count = 0;
 	for (n = rb_first(&proc->nodes); n != NULL; n = rb_next(n))
 		count++;
@@ -3639,12 +4111,16 @@ static void print_binder_proc_stats(struct seq_file *m,
 		strong += ref->strong;
 		weak += ref->weak;
 	}
+	mutex_unlock(&proc->tree_lock);
 	seq_printf(m, "  refs: %d s %d w %d\n", count, strong, weak);
 
-	count = 0;
+	mutex_lock(&proc->alloc_lock);
+	count = proc->slot_count - proc->free_slot_count;
 	for (n = rb_first(&proc->allocated_buffers); n != NULL; n = rb_next(n))
 		count++;
 	seq_printf(m, "  buffers: %d\n", count);
+	print_binder_alloc_stats(m, proc);
+	mutex_unlock(&proc->alloc_lock);
 
 	count = 0;
 	list_for_each_entry(w, &proc->todo, entry) {
@@ -3778,6 +4254,51 @@ static struct miscdevice binder_miscdev = {
 	.fops = &binder_fops
 };
 
+#if defined(CONFIG_ANDROID_BINDER_BENCH) || defined(CONFIG_ANDROID_BINDER_BENCH_MODULE)
+/*
+ * binder_bench_get_ref - for binder_bench, which has no context manager to
+ * get a first handle from. Makes 'ptr' a node of the proc of 'server' and
+ * returns the handle of a strong ref to it in the proc of 'client', as if
+ * the server had sent it in a transaction: the server gets BR_INCREFS and
+ * BR_ACQUIRE for it.
+ */
+int binder_bench_get_ref(struct file *server, struct file *client,
+			 void __user *ptr, void __user *cookie)
+{
+	struct binder_proc *proc, *target_proc;
+	struct binder_node *node;
+	struct binder_ref *ref;
+	int ret;
+
+	if (server->f_op != &binder_fops || client->f_op != &binder_fops)
+		return -EINVAL;
+	proc = server->private_data;
+	target_proc = client->private_data;
+
+	mutex_lock(&binder_lock);
+	node = binder_get_node(proc, ptr);
+	if (node == NULL)
+		node = binder_new_node(proc, ptr, cookie);
+	if (node == NULL) {
+		ret = -ENOMEM;
+		goto out;
+	}
+	ref = binder_get_ref_for_node(target_proc, node);
+	if (ref == NULL) {
+		ret = -ENOMEM;
+		goto out;
+	}
+	ret = binder_inc_ref(ref, 1, &proc->todo);
+	if (ret == 0)
+		ret = ref->desc;
+	wake_up_interruptible(&proc->wait);
+out:
+	mutex_unlock(&binder_lock);
+	return ret;
+}
+EXPORT_SYMBOL_GPL(binder_bench_get_ref);
+#endif
+
 BINDER_DEBUG_ENTRY(state);
 BINDER_DEBUG_ENTRY(stats);
 BINDER_DEBUG_ENTRY(transactions);
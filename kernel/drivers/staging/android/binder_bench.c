@@ -0,0 +1,422 @@
+/*
+ * drivers/staging/android/binder_bench.c
+ *
+ * Transaction benchmark for the binder driver.
+ *
+ * The module opens /dev/binder twice, for a server and a client proc, and
+ * maps both the way ProcessState does. A server thread answers the client
+ * over a ref made by binder_bench_get_ref(). The client then times
+ * 'rounds' two-way transactions one after the other (ping-pong latency)
+ * and 'oneway' one-way transactions (throughput), with 'size' bytes of
+ * data each.
+ *
+ * Both run as threads of the insmod process, since the returns point into
+ * its mapping of the binder buffers. Load the module to run the benchmark;
+ * the results go to the kernel log.
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ */
+
+#include <linux/completion.h>
+#include <linux/err.h>
+#include <linux/fs.h>
+#include <linux/init.h>
+#include <linux/ktime.h>
+#include <linux/mm.h>
+#include <linux/mman.h>
+#include <linux/module.h>
+#include <linux/sched.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/uaccess.h>
+
+#include "binder.h"
+
+static int rounds = 10000;
+module_param(rounds, int, 0444);
+MODULE_PARM_DESC(rounds, "two-way transactions");
+
+static int oneway = 10000;
+module_param(oneway, int, 0444);
+MODULE_PARM_DESC(oneway, "one-way transactions");
+
+static int size = 128;
+module_param(size, int, 0444);
+MODULE_PARM_DESC(size, "data bytes per transaction");
+
+extern int binder_bench_get_ref(struct file *server, struct file *client,
+				void __user *ptr, void __user *cookie);
+
+#define BINDER_BENCH_MAP_SIZE	((1 * 1024 * 1024) - (2 * PAGE_SIZE))
+#define BINDER_BENCH_MAX_SIZE	4096
+
+/* Transaction codes */
+#define BINDER_BENCH_PING	1
+#define BINDER_BENCH_STOP	2
+
+/* The node of the server; never dereferenced */
+#define BINDER_BENCH_PTR	((void __user *)0xbe7c0000)
+
+struct binder_bench_proc {
+	struct file *filp;
+	unsigned long map;
+};
+
+struct binder_bench {
+	struct binder_bench_proc server;
+	struct binder_bench_proc client;
+	uint32_t handle;
+	void *data;
+	int oneway_seen;	/* by the server */
+	int server_ret;
+	struct completion oneway_done;
+	struct completion done;
+};
+
+/* Commands going to the driver, returns coming back */
+struct binder_bench_buf {
+	size_t len;
+	uint8_t data[512];
+};
+
+static void binder_bench_put(struct binder_bench_buf *b, const void *p,
+			     size_t len)
+{
+	BUG_ON(b->len + len > sizeof(b->data));
+	memcpy(b->data + b->len, p, len);
+	b->len += len;
+}
+
+static void binder_bench_put_cmd(struct binder_bench_buf *b, uint32_t cmd)
+{
+	binder_bench_put(b, &cmd, sizeof(cmd));
+}
+
+static void binder_bench_put_transaction(struct binder_bench_buf *b,
+		uint32_t cmd, uint32_t handle, unsigned int code,
+		unsigned int flags, void *data, size_t size)
+{
+	struct binder_transaction_data tr;
+
+	memset(&tr, 0, sizeof(tr));
+	tr.target.handle = handle;
+	tr.code = code;
+	tr.flags = flags;
+	tr.data_size = size;
+	tr.data.ptr.buffer = data;
+
+	binder_bench_put_cmd(b, cmd);
+	binder_bench_put(b, &tr, sizeof(tr));
+}
+
+/*
+ * binder_bench_write_read - sends the commands in 'w' and reads returns
+ * into 'r', if it is given. Called with KERNEL_DS.
+ */
+static int binder_bench_write_read(struct binder_bench_proc *p,
+				   struct binder_bench_buf *w,
+				   struct binder_bench_buf *r)
+{
+	struct binder_write_read bwr;
+	long ret;
+
+	memset(&bwr, 0, sizeof(bwr));
+	bwr.write_size = w->len;
+	bwr.write_buffer = (unsigned long)w->data;
+	if (r) {
+		bwr.read_size = sizeof(r->data);
+		bwr.read_buffer = (unsigned long)r->data;
+	}
+
+	ret = p->filp->f_op->unlocked_ioctl(p->filp, BINDER_WRITE_READ,
+					    (unsigned long)&bwr);
+	w->len = 0;
+	if (r)
+		r->len = bwr.read_consumed;
+	return ret;
+}
+
+static int binder_bench_server(void *arg)
+{
+	struct binder_bench *bb = arg;
+	struct binder_bench_buf w, r;
+	int stop = 0;
+	int ret = 0;
+
+	set_fs(KERNEL_DS);
+
+	w.len = 0;
+	binder_bench_put_cmd(&w, BC_ENTER_LOOPER);
+
+	while (!stop && !ret) {
+		size_t off = 0;
+
+		ret = binder_bench_write_read(&bb->server, &w, &r);
+		if (ret)
+			break;
+
+		while (off < r.len && !ret) {
+			struct binder_transaction_data tr;
+			struct binder_ptr_cookie pc;
+			uint32_t cmd;
+
+			memcpy(&cmd, r.data + off, sizeof(cmd));
+			off += sizeof(cmd);
+
+			switch (cmd) {
+			case BR_NOOP:
+			case BR_TRANSACTION_COMPLETE:
+			case BR_SPAWN_LOOPER:
+				break;
+			case BR_INCREFS:
+			case BR_ACQUIRE:
+				memcpy(&pc, r.data + off, sizeof(pc));
+				off += sizeof(pc);
+				binder_bench_put_cmd(&w, cmd == BR_INCREFS ?
+						BC_INCREFS_DONE : BC_ACQUIRE_DONE);
+				binder_bench_put(&w, &pc, sizeof(pc));
+				break;
+			case BR_RELEASE:
+			case BR_DECREFS:
+				off += sizeof(pc);
+				break;
+			case BR_TRANSACTION:
+				memcpy(&tr, r.data + off, sizeof(tr));
+				off += sizeof(tr);
+				if (tr.flags & TF_ONE_WAY) {
+					if (tr.code == BINDER_BENCH_PING &&
+					    ++bb->oneway_seen == oneway)
+						complete(&bb->oneway_done);
+				} else
+					binder_bench_put_transaction(&w,
+						BC_REPLY, 0, tr.code, 0,
+						bb->data, tr.data_size);
+				binder_bench_put_cmd(&w, BC_FREE_BUFFER);
+				binder_bench_put(&w, &tr.data.ptr.buffer,
+						 sizeof(tr.data.ptr.buffer));
+				if (tr.code == BINDER_BENCH_STOP)
+					stop = 1;
+				break;
+			default:
+				printk(KERN_ERR "binder_bench: server got %x\n",
+				       cmd);
+				ret = -EIO;
+				break;
+			}
+		}
+	}
+
+	/* Send the last replies and buffers back */
+	if (!ret && w.len)
+		ret = binder_bench_write_read(&bb->server, &w, NULL);
+	if (ret)
+		/* fails the transaction the client may be waiting on */
+		bb->server.filp->f_op->unlocked_ioctl(bb->server.filp,
+						     BINDER_THREAD_EXIT, 0);
+
+	bb->server_ret = ret;
+	complete(&bb->oneway_done);
+	complete_and_exit(&bb->done, 0);
+}
+
+/*
+ * binder_bench_transact - sends a transaction to the server and waits for
+ * BR_TRANSACTION_COMPLETE, and for the reply unless it is one-way.
+ */
+static int binder_bench_transact(struct binder_bench *bb, unsigned int code,
+				 unsigned int flags, int *retries)
+{
+	struct binder_bench_buf w, r;
+	int done = 0;
+	int ret;
+
+	w.len = 0;
+	binder_bench_put_transaction(&w, BC_TRANSACTION, bb->handle, code,
+				     flags, bb->data, size);
+
+	while (done != ((flags & TF_ONE_WAY) ? 1 : 2)) {
+		size_t off = 0;
+
+		ret = binder_bench_write_read(&bb->client, &w, &r);
+		if (ret)
+			return ret;
+
+		while (off < r.len) {
+			struct binder_transaction_data tr;
+			uint32_t cmd;
+
+			memcpy(&cmd, r.data + off, sizeof(cmd));
+			off += sizeof(cmd);
+
+			switch (cmd) {
+			case BR_NOOP:
+				break;
+			case BR_TRANSACTION_COMPLETE:
+				done++;
+				break;
+			case BR_REPLY:
+				memcpy(&tr, r.data + off, sizeof(tr));
+				off += sizeof(tr);
+				binder_bench_put_cmd(&w, BC_FREE_BUFFER);
+				binder_bench_put(&w, &tr.data.ptr.buffer,
+						 sizeof(tr.data.ptr.buffer));
+				done++;
+				break;
+			case BR_FAILED_REPLY:
+				/* out of async buffer space, let the server catch up */
+				if ((flags & TF_ONE_WAY) && retries) {
+					(*retries)++;
+					schedule_timeout_uninterruptible(1);
+					binder_bench_put_transaction(&w,
+						BC_TRANSACTION, bb->handle,
+						code, flags, bb->data, size);
+					break;
+				}
+				/* fall through */
+			default:
+				printk(KERN_ERR "binder_bench: client got %x\n",
+				       cmd);
+				return -EIO;
+			}
+		}
+	}
+
+	/* Free the reply buffer */
+	if (w.len)
+		return binder_bench_write_read(&bb->client, &w, NULL);
+	return 0;
+}
+
+static int binder_bench_open(struct binder_bench_proc *p)
+{
+	p->filp = filp_open("/dev/binder", O_RDWR, 0);
+	if (IS_ERR(p->filp)) {
+		printk(KERN_ERR "binder_bench: cannot open /dev/binder\n");
+		return PTR_ERR(p->filp);
+	}
+
+	down_write(&current->mm->mmap_sem);
+	p->map = do_mmap(p->filp, 0, BINDER_BENCH_MAP_SIZE, PROT_READ,
+			 MAP_PRIVATE | MAP_NORESERVE, 0);
+	up_write(&current->mm->mmap_sem);
+	if (IS_ERR_VALUE(p->map)) {
+		filp_close(p->filp, current->files);
+		return p->map;
+	}
+	return 0;
+}
+
+static void binder_bench_close(struct binder_bench_proc *p)
+{
+	down_write(&current->mm->mmap_sem);
+	do_munmap(current->mm, p->map, BINDER_BENCH_MAP_SIZE);
+	up_write(&current->mm->mmap_sem);
+	filp_close(p->filp, current->files);
+}
+
+static int __init binder_bench_init(void)
+{
+	struct binder_bench *bb;
+	mm_segment_t old_fs;
+	ktime_t start;
+	s64 pingpong_ns = 0, oneway_ns = 0;
+	int retries = 0;
+	int i, ret;
+
+	if (rounds <= 0 || oneway < 0 || size < 0 ||
+	    size > BINDER_BENCH_MAX_SIZE)
+		return -EINVAL;
+
+	bb = kzalloc(sizeof(*bb), GFP_KERNEL);
+	if (!bb)
+		return -ENOMEM;
+	bb->data = kzalloc(BINDER_BENCH_MAX_SIZE, GFP_KERNEL);
+	if (!bb->data) {
+		ret = -ENOMEM;
+		goto err_free;
+	}
+	init_completion(&bb->oneway_done);
+	init_completion(&bb->done);
+
+	ret = binder_bench_open(&bb->server);
+	if (ret)
+		goto err_free;
+	ret = binder_bench_open(&bb->client);
+	if (ret)
+		goto err_close_server;
+
+	ret = binder_bench_get_ref(bb->server.filp, bb->client.filp,
+				   BINDER_BENCH_PTR, NULL);
+	if (ret < 0)
+		goto err_close_client;
+	bb->handle = ret;
+
+	/* A thread of ours, so that it sees the mapping too */
+	ret = kernel_thread(binder_bench_server, bb,
+			    CLONE_VM | CLONE_FS | CLONE_FILES |
+			    CLONE_SIGHAND | CLONE_THREAD);
+	if (ret < 0)
+		goto err_close_client;
+
+	old_fs = get_fs();
+	set_fs(KERNEL_DS);
+
+	/* One round to warm up, and to get the server thread going */
+	ret = binder_bench_transact(bb, BINDER_BENCH_PING, 0, NULL);
+
+	start = ktime_get();
+	for (i = 0; i < rounds && !ret; i++)
+		ret = binder_bench_transact(bb, BINDER_BENCH_PING, 0, NULL);
+	pingpong_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	if (!ret && oneway) {
+		start = ktime_get();
+		for (i = 0; i < oneway && !ret; i++)
+			ret = binder_bench_transact(bb, BINDER_BENCH_PING,
+						    TF_ONE_WAY, &retries);
+		if (!ret)
+			wait_for_completion(&bb->oneway_done);
+		oneway_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+	}
+
+	/* One-way, so that it also gets through if the client failed */
+	binder_bench_transact(bb, BINDER_BENCH_STOP, TF_ONE_WAY, NULL);
+	set_fs(old_fs);
+
+	wait_for_completion(&bb->done);
+	if (!ret)
+		ret = bb->server_ret;
+
+	if (!ret) {
+		printk(KERN_INFO "binder_bench: %d bytes, %d two-way: "
+		       "%lld ns per round trip\n", size, rounds,
+		       div_s64(pingpong_ns, rounds));
+		if (oneway)
+			printk(KERN_INFO "binder_bench: %d one-way: %llu/s, "
+			       "%d retries\n", oneway,
+			       div64_u64((u64)oneway * NSEC_PER_SEC,
+					 oneway_ns > 0 ? oneway_ns : 1),
+			       retries);
+	}
+
+err_close_client:
+	binder_bench_close(&bb->client);
+err_close_server:
+	binder_bench_close(&bb->server);
+err_free:
+	kfree(bb->data);
+	kfree(bb);
+	return ret;
+}
+
+static void __exit binder_bench_exit(void)
+{
+}
+
+module_init(binder_bench_init);
+module_exit(binder_bench_exit);
+
+MODULE_DESCRIPTION("binder transaction benchmark");
+MODULE_LICENSE("GPL");
@@ -33,15 +33,17 @@
  * struct logger_log - represents a specific log, such as 'main' or 'radio'
  *
  * This structure lives from module insertion until module removal, so it does
- * not need additional reference counting. The structure is protected by the
- * mutex 'mutex'.
+ * not need additional reference counting. The offsets and the list of readers
+ * are protected by the spinlock 'lock', which is only held to reserve room for
+ * an entry or to pick the next one to read. Payloads are copied into the log
+ * and to user space without it, see logger_aio_write() and logger_read().
  */
 struct logger_log {
 	unsigned char 		*buffer;/* the ring buffer itself */
 	struct miscdevice	misc;	/* misc device representing the log */
 	wait_queue_head_t	wq;	/* wait queue for readers */
 	struct list_head	readers; /* this log's readers */
-	struct mutex		mutex;	/* mutex protecting buffer */
+	spinlock_t		lock;	/* lock protecting the offsets */
 	size_t			w_off;	/* current write head offset */
 	size_t			head;	/* new readers start here */
 	size_t			size;	/* size of the log */
@@ -51,14 +53,31 @@ struct logger_log {
  * struct logger_reader - a logging device open for reading
  *
  * This object lives from open to release, so we don't need additional
- * reference counting. The structure is protected by log->mutex.
+ * reference counting. The structure is protected by log->lock.
  */
 struct logger_reader {
 	struct logger_log	*log;	/* associated log */
 	struct list_head	list;	/* entry in logger_log's list */
 	size_t			r_off;	/* current read head offset */
+	int			lapped;	/* r_off was pulled forward */
 };
 
+/*
+ * The state of an entry lives in its __pad field while it is in the log.
+ * Room for an entry is reserved with its header, which is then committed
+ * once the payload is in. Readers stop at the first entry not committed
+ * yet and skip the discarded ones. Committed entries read back with
+ * __pad == 0, as before.
+ *
+ * A flush cannot drop an entry which is still being written, since the
+ * writer will touch it again. It marks it flushed instead, and the writer
+ * discards it rather than committing it, see logger_flush().
+ */
+#define LOGGER_ENTRY_COMMITTED	0
+#define LOGGER_ENTRY_RESERVED	0xffff
+#define LOGGER_ENTRY_DISCARDED	0xfffe
+#define LOGGER_ENTRY_FLUSHED	0xfffd
+
 /* logger_offset - returns index 'n' into the log via (optimized) modulus */
 #define logger_offset(n)	((n) & (log->size - 1))
 
@@ -86,12 +105,12 @@ static inline struct logger_log *file_get_log(struct file *file)
 }
 
 /*
- * get_entry_len - Grabs the length of the payload of the next entry starting
- * from 'off'.
+ * get_entry_u16 - Grabs the 16-bit header field at 'off', which may wrap
+ * around the end of the log.
  *
- * Caller needs to hold log->mutex.
+ * Caller needs to hold log->lock.
  */
-static __u32 get_entry_len(struct logger_log *log, size_t off)
+static __u16 get_entry_u16(struct logger_log *log, size_t off)
 {
 	__u16 val;
 
@@ -104,19 +123,63 @@ static __u32 get_entry_len(struct logger_log *log, size_t off)
 		memcpy(&val, log->buffer + off, 2);
 	}
 
-	return sizeof(struct logger_entry) + val;
+	return val;
 }
 
 /*
- * do_read_log_to_user - reads exactly 'count' bytes from 'log' into the
- * user-space buffer 'buf'. Returns 'count' on success.
+ * get_entry_len - Grabs the length of the payload of the next entry starting
+ * from 'off'.
  *
- * Caller must hold log->mutex.
+ * Caller needs to hold log->lock.
  */
-static ssize_t do_read_log_to_user(struct logger_log *log,
-				   struct logger_reader *reader,
-				   char __user *buf,
-				   size_t count)
+static __u32 get_entry_len(struct logger_log *log, size_t off)
+{
+	return sizeof(struct logger_entry) + get_entry_u16(log, off);
+}
+
+/*
+ * get_entry_state - Grabs the LOGGER_ENTRY_* state of the entry at 'off'.
+ *
+ * Caller needs to hold log->lock.
+ */
+static __u16 get_entry_state(struct logger_log *log, size_t off)
+{
+	return get_entry_u16(log, logger_offset(off +
+				offsetof(struct logger_entry, __pad)));
+}
+
+/*
+ * entry_ready - skips the discarded entries at the reader's read head and
+ * returns nonzero if a committed entry follows.
+ *
+ * Caller needs to hold log->lock.
+ */
+static int entry_ready(struct logger_log *log, struct logger_reader *reader)
+{
+	while (log->w_off != reader->r_off) {
+		switch (get_entry_state(log, reader->r_off)) {
+		case LOGGER_ENTRY_COMMITTED:
+			return 1;
+		case LOGGER_ENTRY_DISCARDED:
+			reader->r_off = logger_offset(reader->r_off +
+					get_entry_len(log, reader->r_off));
+			break;
+		default:
+			return 0;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * do_read_log_to_user - reads exactly 'count' bytes from 'log' at 'off' into
+ * the user-space buffer 'buf'. Returns 'count' on success.
+ *
+ * Called without log->lock, the caller checks reader->lapped afterwards.
+ */
+static ssize_t do_read_log_to_user(struct logger_log *log, size_t off,
+				   char __user *buf, size_t count)
 {
 	size_t len;
 
@@ -125,8 +188,8 @@ static ssize_t do_read_log_to_user(struct logger_log *log,
 	 * the current read head offset up to 'count' bytes or to the end of
 	 * the log, whichever comes first.
 	 */
-	len = min(count, log->size - reader->r_off);
-	if (copy_to_user(buf, log->buffer + reader->r_off, len))
+	len = min(count, log->size - off);
+	if (copy_to_user(buf, log->buffer + off, len))
 		return -EFAULT;
 
 	/*
@@ -137,8 +200,6 @@ static ssize_t do_read_log_to_user(struct logger_log *log,
 		if (copy_to_user(buf + len, log->buffer, count - len))
 			return -EFAULT;
 
-	reader->r_off = logger_offset(reader->r_off + count);
-
 	return count;
 }
 
@@ -159,6 +220,7 @@ static ssize_t logger_read(struct file *file, char __user *buf,
 {
 	struct logger_reader *reader = file->private_data;
 	struct logger_log *log = reader->log;
+	size_t off;
 	ssize_t ret;
 	DEFINE_WAIT(wait);
 
@@ -166,9 +228,9 @@ start:
 	while (1) {
 		prepare_to_wait(&log->wq, &wait, TASK_INTERRUPTIBLE);
 
-		mutex_lock(&log->mutex);
-		ret = (log->w_off == reader->r_off);
-		mutex_unlock(&log->mutex);
+		spin_lock(&log->lock);
+		ret = !entry_ready(log, reader);
+		spin_unlock(&log->lock);
 		if (!ret)
 			break;
 
@@ -189,26 +251,37 @@ start:
 	if (ret)
 		return ret;
 
-	mutex_lock(&log->mutex);
+	spin_lock(&log->lock);
 
 	/* is there still something to read or did we race? */
-	if (unlikely(log->w_off == reader->r_off)) {
-		mutex_unlock(&log->mutex);
+	if (unlikely(!entry_ready(log, reader))) {
+		spin_unlock(&log->lock);
 		goto start;
 	}
 
 	/* get the size of the next entry */
 	ret = get_entry_len(log, reader->r_off);
 	if (count < ret) {
-		ret = -EINVAL;
-		goto out;
+		spin_unlock(&log->lock);
+		return -EINVAL;
 	}
+	off = reader->r_off;
+	reader->lapped = 0;
+	spin_unlock(&log->lock);
 
 	/* get exactly one entry from the log */
-	ret = do_read_log_to_user(log, reader, buf, ret);
+	ret = do_read_log_to_user(log, off, buf, ret);
+	if (ret < 0)
+		return ret;
 
-out:
-	mutex_unlock(&log->mutex);
+	spin_lock(&log->lock);
+	if (unlikely(reader->lapped)) {
+		/* a writer overwrote the entry while we copied it */
+		spin_unlock(&log->lock);
+		goto start;
+	}
+	reader->r_off = logger_offset(off + ret);
+	spin_unlock(&log->lock);
 
 	return ret;
 }
@@ -217,7 +290,7 @@ out:
  * get_next_entry - return the offset of the first valid entry at least 'len'
  * bytes after 'off'.
  *
- * Caller must hold log->mutex.
+ * Caller must hold log->lock.
  */
 static size_t get_next_entry(struct logger_log *log, size_t off, size_t len)
 {
@@ -249,13 +322,44 @@ static inline int clock_interval(size_t a, size_t b, size_t c)
 	return 0;
 }
 
+/*
+ * overwrites_reserved - would writing 'len' bytes at the write head clobber
+ * an entry which is still being written? Walks the same entries as
+ * fix_up_readers() does for the start head, which all readers are behind.
+ *
+ * The caller needs to hold log->lock.
+ */
+static int overwrites_reserved(struct logger_log *log, size_t len)
+{
+	size_t old = log->w_off;
+	size_t new = logger_offset(old + len);
+	size_t off = log->head;
+	size_t count = 0;
+
+	if (!clock_interval(old, new, off))
+		return 0;
+
+	do {
+		size_t nr = get_entry_len(log, off);
+		switch (get_entry_state(log, off)) {
+		case LOGGER_ENTRY_RESERVED:
+		case LOGGER_ENTRY_FLUSHED:
+			return 1;
+		}
+		off = logger_offset(off + nr);
+		count += nr;
+	} while (count < len);
+
+	return 0;
+}
+
 /*
  * fix_up_readers - walk the list of all readers and "fix up" any who were
  * lapped by the writer; also do the same for the default "start head".
  * We do this by "pulling forward" the readers and start head to the first
  * entry after the new write head.
  *
- * The caller needs to hold log->mutex.
+ * The caller needs to hold log->lock.
  */
 static void fix_up_readers(struct logger_log *log, size_t len)
 {
@@ -267,53 +371,85 @@ static void fix_up_readers(struct logger_log *log, size_t len)
 		log->head = get_next_entry(log, log->head, len);
 
 	list_for_each_entry(reader, &log->readers, list)
-		if (clock_interval(old, new, reader->r_off))
+		if (clock_interval(old, new, reader->r_off)) {
 			reader->r_off = get_next_entry(log, reader->r_off, len);
+			reader->lapped = 1;
+		}
 }
 
 /*
- * do_write_log - writes 'len' bytes from 'buf' to 'log'
+ * do_write_log - writes 'len' bytes from 'buf' to 'log' at 'off'
  *
- * The caller needs to hold log->mutex.
+ * The caller needs to hold log->lock, or to have reserved the room.
  */
-static void do_write_log(struct logger_log *log, const void *buf, size_t count)
+static void do_write_log(struct logger_log *log, size_t off,
+			 const void *buf, size_t count)
 {
 	size_t len;
 
-	len = min(count, log->size - log->w_off);
-	memcpy(log->buffer + log->w_off, buf, len);
+	len = min(count, log->size - off);
+	memcpy(log->buffer + off, buf, len);
 
 	if (count != len)
 		memcpy(log->buffer, buf + len, count - len);
-
-	log->w_off = logger_offset(log->w_off + count);
-
 }
 
 /*
- * do_write_log_user - writes 'len' bytes from the user-space buffer 'buf' to
- * the log 'log'
- *
- * The caller needs to hold log->mutex.
+ * copy_payload_from_user - gathers 'count' bytes of the user-space vectors
+ * 'iov' into 'buf', so that nothing can fault once room is reserved.
  *
  * Returns 'count' on success, negative error code on failure.
  */
-static ssize_t do_write_log_from_user(struct logger_log *log,
-				      const void __user *buf, size_t count)
+static ssize_t copy_payload_from_user(void *buf, const struct iovec *iov,
+				      unsigned long nr_segs, size_t count)
 {
-	size_t len;
+	size_t done = 0;
 
-	len = min(count, log->size - log->w_off);
-	if (len && copy_from_user(log->buffer + log->w_off, buf, len))
-		return -EFAULT;
+	while (nr_segs-- > 0 && done < count) {
+		size_t len = min_t(size_t, iov->iov_len, count - done);
 
-	if (count != len)
-		if (copy_from_user(log->buffer, buf + len, count - len))
+		if (copy_from_user(buf + done, iov->iov_base, len))
 			return -EFAULT;
 
-	log->w_off = logger_offset(log->w_off + count);
+		done += len;
+		iov++;
+	}
 
-	return count;
+	return done;
+}
+
+/*
+ * wait_for_commit - spins until writing 'len' bytes at the write head does
+ * not clobber an entry which is still being written. Writers fill in their
+ * reserved room from a bounce buffer with preemption disabled, so this is
+ * only ever a memcpy() away, and only on SMP.
+ *
+ * Called and returns with log->lock held.
+ */
+static void wait_for_commit(struct logger_log *log, size_t len)
+{
+	while (overwrites_reserved(log, len)) {
+		spin_unlock(&log->lock);
+		cpu_relax();
+		spin_lock(&log->lock);
+	}
+}
+
+/*
+ * set_entry_state - sets the LOGGER_ENTRY_* state of the entry at 'off' and
+ * wakes up the readers. An entry flushed while it was written is discarded
+ * instead of committed.
+ */
+static void set_entry_state(struct logger_log *log, size_t off, __u16 state)
+{
+	spin_lock(&log->lock);
+	if (get_entry_state(log, off) == LOGGER_ENTRY_FLUSHED)
+		state = LOGGER_ENTRY_DISCARDED;
+	do_write_log(log, logger_offset(off +
+		     offsetof(struct logger_entry, __pad)), &state, sizeof(state));
+	spin_unlock(&log->lock);
+
+	wake_up_interruptible(&log->wq);
 }
 
 /*
@@ -325,10 +461,12 @@ ssize_t logger_aio_write(struct kiocb *iocb, const struct iovec *iov,
 			 unsigned long nr_segs, loff_t ppos)
 {
 	struct logger_log *log = file_get_log(iocb->ki_filp);
-	size_t orig = log->w_off;
 	struct logger_entry header;
 	struct timespec now;
-	ssize_t ret = 0;
+	size_t entry_len;
+	size_t off;
+	void *payload;
+	ssize_t ret;
 
 	now = current_kernel_time();
 
@@ -337,12 +475,27 @@ ssize_t logger_aio_write(struct kiocb *iocb, const struct iovec *iov,
 	header.sec = now.tv_sec;
 	header.nsec = now.tv_nsec;
 	header.len = min_t(size_t, iocb->ki_left, LOGGER_ENTRY_MAX_PAYLOAD);
+	header.__pad = LOGGER_ENTRY_RESERVED;
 
 	/* null writes succeed, return zero */
 	if (unlikely(!header.len))
 		return 0;
 
-	mutex_lock(&log->mutex);
+	entry_len = sizeof(struct logger_entry) + header.len;
+
+	/* fault the payload in before any room is reserved */
+	payload = kmalloc(header.len, GFP_KERNEL);
+	if (unlikely(!payload))
+		return -ENOMEM;
+
+	ret = copy_payload_from_user(payload, iov, nr_segs, header.len);
+	if (unlikely(ret < 0))
+		goto out;
+
+	spin_lock(&log->lock);
+
+	if (unlikely(overwrites_reserved(log, entry_len)))
+		wait_for_commit(log, entry_len);
 
 	/*
 	 * Fix up any readers, pulling them forward to the first readable
@@ -350,34 +503,29 @@ ssize_t logger_aio_write(struct kiocb *iocb, const struct iovec *iov,
 	 * because if we partially fail, we can end up with clobbered log
 	 * entries that encroach on readable buffer.
 	 */
-	fix_up_readers(log, sizeof(struct logger_entry) + header.len);
-
-	do_write_log(log, &header, sizeof(struct logger_entry));
-
-	while (nr_segs-- > 0) {
-		size_t len;
-		ssize_t nr;
+	fix_up_readers(log, entry_len);
 
-		/* figure out how much of this vector we can keep */
-		len = min_t(size_t, iov->iov_len, header.len - ret);
+	/*
+	 * Reserve the room for the entry, then fill it in unlocked. No
+	 * preemption until it is committed, so that other writers never
+	 * wait for long on a reserved entry.
+	 */
+	off = log->w_off;
+	do_write_log(log, off, &header, sizeof(struct logger_entry));
+	log->w_off = logger_offset(off + entry_len);
 
-		/* write out this segment's payload */
-		nr = do_write_log_from_user(log, iov->iov_base, len);
-		if (unlikely(nr < 0)) {
-			log->w_off = orig;
-			mutex_unlock(&log->mutex);
-			return nr;
-		}
+	preempt_disable();
+	spin_unlock(&log->lock);
 
-		iov++;
-		ret += nr;
-	}
-
-	mutex_unlock(&log->mutex);
+	do_write_log(log, logger_offset(off + sizeof(struct logger_entry)),
+		     payload, ret);
 
-	/* wake up any blocked readers */
-	wake_up_interruptible(&log->wq);
+	/* publish the entry and wake up any blocked readers */
+	set_entry_state(log, off, LOGGER_ENTRY_COMMITTED);
+	preempt_enable();
 
+out:
+	kfree(payload);
 	return ret;
 }
 
@@ -409,12 +557,13 @@ static int logger_open(struct inode *inode, struct file *file)
 			return -ENOMEM;
 
 		reader->log = log;
+		reader->lapped = 0;
 		INIT_LIST_HEAD(&reader->list);
 
-		mutex_lock(&log->mutex);
+		spin_lock(&log->lock);
 		reader->r_off = log->head;
 		list_add_tail(&reader->list, &log->readers);
-		mutex_unlock(&log->mutex);
+		spin_unlock(&log->lock);
 
 		file->private_data = reader;
 	} else
@@ -432,7 +581,11 @@ static int logger_release(struct inode *ignored, struct file *file)
 {
 	if (file->f_mode & FMODE_READ) {
 		struct logger_reader *reader = file->private_data;
+		struct logger_log *log = reader->log;
+
+		spin_lock(&log->lock);
 		list_del(&reader->list);
+		spin_unlock(&log->lock);
 		kfree(reader);
 	}
 
@@ -462,21 +615,65 @@ static unsigned int logger_poll(struct file *file, poll_table *wait)
 
 	poll_wait(file, &log->wq, wait);
 
-	mutex_lock(&log->mutex);
-	if (log->w_off != reader->r_off)
+	spin_lock(&log->lock);
+	if (entry_ready(log, reader))
 		ret |= POLLIN | POLLRDNORM;
-	mutex_unlock(&log->mutex);
+	spin_unlock(&log->lock);
 
 	return ret;
 }
 
+/*
+ * logger_flush - drops all entries in the log. Entries still being written
+ * are left in place, marked flushed, and so is everything after the first
+ * of them; the start head and the readers stop there until they are
+ * discarded by their writers. Readers in the middle of a copy are marked
+ * lapped so that they do not move their read head back behind the flush.
+ *
+ * The caller needs to hold log->lock.
+ */
+static void logger_flush(struct logger_log *log)
+{
+	struct logger_reader *reader;
+	size_t off = log->head;
+	size_t head = log->w_off;
+	int pending = 0;
+
+	while (off != log->w_off) {
+		__u16 state = get_entry_state(log, off);
+
+		/* a previous flush may have left entries behind, too */
+		if (!pending && (state == LOGGER_ENTRY_RESERVED ||
+				 state == LOGGER_ENTRY_FLUSHED)) {
+			head = off;
+			pending = 1;
+		}
+		if (pending && state != LOGGER_ENTRY_FLUSHED) {
+			if (state == LOGGER_ENTRY_RESERVED)
+				state = LOGGER_ENTRY_FLUSHED;
+			else
+				state = LOGGER_ENTRY_DISCARDED;
+			do_write_log(log, logger_offset(off +
+				     offsetof(struct logger_entry, __pad)),
+				     &state, sizeof(state));
+		}
+		off = logger_offset(off + get_entry_len(log, off));
+	}
+
+	list_for_each_entry(reader, &log->readers, list) {
+		reader->r_off = head;
+		reader->lapped = 1;
+	}
+	log->head = head;
+}
+
 static long logger_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 {
 	struct logger_log *log = file_get_log(file);
 	struct logger_reader *reader;
 	long ret = -ENOTTY;
 
-	mutex_lock(&log->mutex);
+	spin_lock(&log->lock);
 
 	switch (cmd) {
 	case LOGGER_GET_LOG_BUF_SIZE:
@@ -499,7 +696,7 @@ static long logger_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 			break;
 		}
 		reader = file->private_data;
-		if (log->w_off != reader->r_off)
+		if (entry_ready(log, reader))
 			ret = get_entry_len(log, reader->r_off);
 		else
 			ret = 0;
@@ -509,14 +706,12 @@ static long logger_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 			ret = -EBADF;
 			break;
 		}
-		list_for_each_entry(reader, &log->readers, list)
-			reader->r_off = log->w_off;
-		log->head = log->w_off;
+		logger_flush(log);
 		ret = 0;
 		break;
 	}
 
-	mutex_unlock(&log->mutex);
+	spin_unlock(&log->lock);
 
 	return ret;
 }
@@ -549,7 +744,7 @@ static struct logger_log VAR = { \
 	}, \
 	.wq = __WAIT_QUEUE_HEAD_INITIALIZER(VAR .wq), \
 	.readers = LIST_HEAD_INIT(VAR .readers), \
-	.mutex = __MUTEX_INITIALIZER(VAR .mutex), \
+	.lock = __SPIN_LOCK_UNLOCKED(VAR .lock), \
 	.w_off = 0, \
 	.head = 0, \
 	.size = SIZE, \
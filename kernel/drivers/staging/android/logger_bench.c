@@ -0,0 +1,159 @@
+/*
+ * drivers/staging/android/logger_bench.c
+ *
+ * Write throughput benchmark for the Android log driver.
+ *
+ * 'threads' kernel threads write short entries round robin to the main,
+ * radio and events logs for 'seconds', the way liblog does, and the
+ * number of entries per second is reported for each log and in total.
+ * Run logcat at the same time to measure with a reader in the way.
+ *
+ * Load the module to run the benchmark; the results go to the kernel log.
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ */
+
+#include <linux/delay.h>
+#include <linux/err.h>
+#include <linux/fs.h>
+#include <linux/init.h>
+#include <linux/kthread.h>
+#include <linux/ktime.h>
+#include <linux/module.h>
+#include <linux/sched.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <asm/atomic.h>
+
+static int threads = 4;
+module_param(threads, int, 0444);
+MODULE_PARM_DESC(threads, "number of writer threads");
+
+static int seconds = 5;
+module_param(seconds, int, 0444);
+MODULE_PARM_DESC(seconds, "duration of the run");
+
+static char *dir = "/dev/log";
+module_param(dir, charp, 0444);
+MODULE_PARM_DESC(dir, "directory of the log devices");
+
+static const char *logger_bench_names[] = { "main", "radio", "events" };
+
+#define LOGGER_BENCH_LOGS	ARRAY_SIZE(logger_bench_names)
+
+static struct file *logger_bench_filp[LOGGER_BENCH_LOGS];
+static atomic_t logger_bench_entries[LOGGER_BENCH_LOGS];
+static atomic_t logger_bench_errors;
+
+/* priority, tag and message, as written by liblog */
+static const char logger_bench_msg[] =
+	"\x04" "logger_bench\0" "the quick brown fox jumps over the lazy dog";
+
+static int logger_bench_thread(void *data)
+{
+	int i = (long)data % LOGGER_BENCH_LOGS;
+	mm_segment_t old_fs;
+	loff_t pos;
+	ssize_t ret;
+
+	old_fs = get_fs();
+	set_fs(KERNEL_DS);
+
+	while (!kthread_should_stop()) {
+		pos = 0;
+		ret = vfs_write(logger_bench_filp[i],
+				(const char __user *)logger_bench_msg,
+				sizeof(logger_bench_msg), &pos);
+		if (ret == sizeof(logger_bench_msg))
+			atomic_inc(&logger_bench_entries[i]);
+		else
+			atomic_inc(&logger_bench_errors);
+
+		i = (i + 1) % LOGGER_BENCH_LOGS;
+		cond_resched();
+	}
+
+	set_fs(old_fs);
+	return 0;
+}
+
+static int __init logger_bench_init(void)
+{
+	struct task_struct **tasks;
+	char path[64];
+	ktime_t start;
+	s64 elapsed_us;
+	unsigned long total = 0;
+	int i, n, ret = 0;
+
+	if (threads <= 0 || seconds <= 0)
+		return -EINVAL;
+
+	tasks = kcalloc(threads, sizeof(*tasks), GFP_KERNEL);
+	if (!tasks)
+		return -ENOMEM;
+
+	for (i = 0; i < LOGGER_BENCH_LOGS; i++) {
+		snprintf(path, sizeof(path), "%s/%s", dir,
+			 logger_bench_names[i]);
+		logger_bench_filp[i] = filp_open(path, O_WRONLY, 0);
+		if (IS_ERR(logger_bench_filp[i])) {
+			printk(KERN_ERR "logger_bench: cannot open %s\n", path);
+			ret = PTR_ERR(logger_bench_filp[i]);
+			goto out_close;
+		}
+		atomic_set(&logger_bench_entries[i], 0);
+	}
+	atomic_set(&logger_bench_errors, 0);
+
+	start = ktime_get();
+	for (n = 0; n < threads; n++) {
+		tasks[n] = kthread_run(logger_bench_thread, (void *)(long)n,
+				       "logger_bench/%d", n);
+		if (IS_ERR(tasks[n])) {
+			ret = PTR_ERR(tasks[n]);
+			break;
+		}
+	}
+
+	if (!ret)
+		msleep(seconds * MSEC_PER_SEC);
+
+	while (n--)
+		kthread_stop(tasks[n]);
+	elapsed_us = ktime_to_us(ktime_sub(ktime_get(), start));
+
+	if (ret)
+		goto out_close;
+
+	for (i = 0; i < LOGGER_BENCH_LOGS; i++) {
+		unsigned long entries = atomic_read(&logger_bench_entries[i]);
+
+		printk(KERN_INFO "logger_bench: %-6s %lu entries, %llu/s\n",
+		       logger_bench_names[i], entries,
+		       div64_u64((u64)entries * USEC_PER_SEC, elapsed_us));
+		total += entries;
+	}
+	printk(KERN_INFO "logger_bench: %d threads, %lu entries in %lld us, "
+	       "%llu/s, %d errors\n", threads, total, elapsed_us,
+	       div64_u64((u64)total * USEC_PER_SEC, elapsed_us),
+	       atomic_read(&logger_bench_errors));
+
+out_close:
+	while (i--)
+		filp_close(logger_bench_filp[i], NULL);
+	kfree(tasks);
+	return ret;
+}
+
+static void __exit logger_bench_exit(void)
+{
+}
+
+module_init(logger_bench_init);
+module_exit(logger_bench_exit);
+
+MODULE_DESCRIPTION("Android log driver write benchmark");
+MODULE_LICENSE("GPL");
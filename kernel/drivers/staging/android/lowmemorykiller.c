@@ -16,6 +16,11 @@
  * percentage of the cached memory is locked this can be very inaccurate
  * and processes may not get killed until the normal oom killer is triggered.
  *
+ * Candidates are kept in an index bucketed by oom_adj and ordered by RSS within
+ * a bucket, updated on fork, exec, oom_adj writes and task free. The RSS of
+ * indexed tasks is refreshed at most every rss_refresh_ms while the killer is
+ * active, so picking a victim does not walk the whole task list.
+ *
  * Copyright (C) 2007-2008 Google, Inc.
  *
  * This software is licensed under the terms of the GNU General Public
@@ -35,6 +40,12 @@
 #include <linux/oom.h>
 #include <linux/sched.h>
 #include <linux/notifier.h>
+#include <linux/spinlock.h>
+#include <linux/list.h>
+#include <linux/list_sort.h>
+#include <linux/ktime.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 
 static uint32_t lowmem_debug_level = 2;
 static int lowmem_adj[6] = {
@@ -54,6 +65,28 @@ static int lowmem_minfree_size = 4;
 
 static struct task_struct *lowmem_deathpending;
 static unsigned long lowmem_deathpending_timeout;
+static ktime_t lowmem_deathpending_start;
+
+/* One bucket per oom_adj value, each sorted by lowmem_rss, largest first */
+#define LOWMEM_INDEX_SIZE	(OOM_ADJUST_MAX - OOM_DISABLE + 1)
+#define LOWMEM_SELECT_TRIES	8
+
+static struct list_head lowmem_index[LOWMEM_INDEX_SIZE];
+static DEFINE_SPINLOCK(lowmem_index_lock);
+static int lowmem_index_ready;
+static int lowmem_index_count;
+static unsigned long lowmem_rss_stamp;
+static uint32_t lowmem_rss_refresh_ms = 500;
+
+/* Latency histograms, slot n counts values in [2^(n-1), 2^n) us */
+#define LOWMEM_HIST_SLOTS	24
+
+struct lowmem_hist {
+	unsigned int slot[LOWMEM_HIST_SLOTS];
+};
+
+static struct lowmem_hist lowmem_select_hist;	/* victim lookup */
+static struct lowmem_hist lowmem_kill_hist;	/* SIGKILL until task free */
 
 #define lowmem_print(level, x...)			\
 	do {						\
@@ -68,27 +101,217 @@ static struct notifier_block task_nb = {
 	.notifier_call	= task_notify_func,
 };
 
+static void lowmem_hist_add(struct lowmem_hist *h, s64 us)
+{
+	int i = us > 0 ? fls(min_t(s64, us, INT_MAX)) : 0;
+
+	h->slot[min(i, LOWMEM_HIST_SLOTS - 1)]++;
+}
+
+/* Insert p into the bucket for adj, keeping the bucket sorted by RSS */
+static void __lowmem_index_link(struct task_struct *p, int adj)
+{
+	struct list_head *head = &lowmem_index[adj - OOM_DISABLE];
+	struct task_struct *q;
+
+	list_for_each_entry(q, head, lowmem_node) {
+		if (q->lowmem_rss < p->lowmem_rss)
+			break;
+	}
+	list_add_tail(&p->lowmem_node, &q->lowmem_node);
+	p->lowmem_adj = adj;
+	lowmem_index_count++;
+}
+
+static void __lowmem_index_unlink(struct task_struct *p)
+{
+	list_del_init(&p->lowmem_node);
+	lowmem_index_count--;
+}
+
+/* Move p to its current place, or drop it once it has no mm */
+static void lowmem_index_set(struct task_struct *p, int adj,
+			     unsigned long rss, int has_mm)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&lowmem_index_lock, flags);
+	if (!list_empty(&p->lowmem_node))
+		__lowmem_index_unlink(p);
+	if (has_mm) {
+		p->lowmem_rss = rss;
+		__lowmem_index_link(p, adj);
+	}
+	spin_unlock_irqrestore(&lowmem_index_lock, flags);
+}
+
+/*
+ * Called on fork, exec and oom_adj writes. Only thread group leaders are
+ * indexed, oom_adj is per process, so a thread updates its leader. The
+ * leader is released after all of its threads, hence after p if p is
+ * still alive.
+ */
+void lowmem_index_update(struct task_struct *p)
+{
+	struct task_struct *leader;
+	unsigned long rss = 0;
+	int has_mm;
+
+	if (!lowmem_index_ready)
+		return;
+
+	rcu_read_lock();
+	if (!pid_alive(p)) {
+		rcu_read_unlock();
+		return;
+	}
+	leader = p->group_leader;
+	get_task_struct(leader);
+	rcu_read_unlock();
+
+	task_lock(leader);
+	has_mm = leader->mm != NULL;
+	if (has_mm)
+		rss = get_mm_rss(leader->mm);
+	task_unlock(leader);
+
+	lowmem_index_set(leader, leader->signal->oom_adj, rss, has_mm);
+	put_task_struct(leader);
+}
+
+/* list_sort() order of a bucket, largest RSS first */
+static int lowmem_rss_cmp(void *priv, struct list_head *a, struct list_head *b)
+{
+	struct task_struct *p = list_entry(a, struct task_struct, lowmem_node);
+	struct task_struct *q = list_entry(b, struct task_struct, lowmem_node);
+
+	if (p->lowmem_rss == q->lowmem_rss)
+		return 0;
+	return p->lowmem_rss < q->lowmem_rss ? 1 : -1;
+}
+
+/*
+ * Re-read the RSS of every indexed task, moving each to the tail of its
+ * bucket, then sort every bucket once.
+ */
+static void lowmem_index_refresh(void)
+{
+	struct task_struct *p;
+	unsigned long rss, flags;
+	int i, adj, has_mm;
+
+	read_lock(&tasklist_lock);
+	for_each_process(p) {
+		if (list_empty(&p->lowmem_node))
+			continue;
+
+		task_lock(p);
+		has_mm = p->mm != NULL;
+		rss = has_mm ? get_mm_rss(p->mm) : 0;
+		task_unlock(p);
+		adj = p->signal->oom_adj;
+
+		spin_lock_irqsave(&lowmem_index_lock, flags);
+		if (!list_empty(&p->lowmem_node)) {
+			if (has_mm) {
+				p->lowmem_rss = rss;
+				p->lowmem_adj = adj;
+				list_move_tail(&p->lowmem_node,
+					       &lowmem_index[adj - OOM_DISABLE]);
+			} else {
+				__lowmem_index_unlink(p);
+			}
+		}
+		spin_unlock_irqrestore(&lowmem_index_lock, flags);
+	}
+	read_unlock(&tasklist_lock);
+
+	spin_lock_irqsave(&lowmem_index_lock, flags);
+	for (i = 0; i < LOWMEM_INDEX_SIZE; i++)
+		list_sort(NULL, &lowmem_index[i], lowmem_rss_cmp);
+	spin_unlock_irqrestore(&lowmem_index_lock, flags);
+
+	lowmem_rss_stamp = jiffies;
+}
+
+/*
+ * Pick the largest task of the highest non-empty bucket at or above
+ * min_adj. The index may lag behind RSS changes and exits, so the pick
+ * is checked under task_lock() and the index fixed up if it was stale.
+ * Returns the task with a reference held.
+ */
+static struct task_struct *lowmem_select(int min_adj, int *adjp, int *sizep)
+{
+	struct task_struct *p = NULL;
+	unsigned long flags;
+	int tries, adj, oom_adj, tasksize, has_mm;
+
+	for (tries = 0; tries < LOWMEM_SELECT_TRIES; tries++) {
+		spin_lock_irqsave(&lowmem_index_lock, flags);
+		for (adj = OOM_ADJUST_MAX; adj >= min_adj; adj--) {
+			struct list_head *head = &lowmem_index[adj - OOM_DISABLE];
+
+			if (!list_empty(head)) {
+				p = list_first_entry(head, struct task_struct,
+						     lowmem_node);
+				get_task_struct(p);
+				break;
+			}
+		}
+		spin_unlock_irqrestore(&lowmem_index_lock, flags);
+
+		if (adj < min_adj)
+			return NULL;
+
+		task_lock(p);
+		has_mm = p->mm != NULL;
+		tasksize = has_mm ? get_mm_rss(p->mm) : 0;
+		task_unlock(p);
+
+		oom_adj = p->signal->oom_adj;
+		if (has_mm && tasksize > 0 && oom_adj == adj) {
+			*adjp = oom_adj;
+			*sizep = tasksize;
+			return p;
+		}
+		lowmem_index_set(p, oom_adj, tasksize, has_mm);
+		put_task_struct(p);
+	}
+
+	return NULL;
+}
+
 static int
 task_notify_func(struct notifier_block *self, unsigned long val, void *data)
 {
 	struct task_struct *task = data;
+	unsigned long flags;
+
+	if (!list_empty(&task->lowmem_node)) {
+		spin_lock_irqsave(&lowmem_index_lock, flags);
+		if (!list_empty(&task->lowmem_node))
+			__lowmem_index_unlink(task);
+		spin_unlock_irqrestore(&lowmem_index_lock, flags);
+	}
 
-	if (task == lowmem_deathpending)
+	if (task == lowmem_deathpending) {
 		lowmem_deathpending = NULL;
+		lowmem_hist_add(&lowmem_kill_hist, ktime_us_delta(ktime_get(),
+						lowmem_deathpending_start));
+	}
 
 	return NOTIFY_OK;
 }
 
 static int lowmem_shrink(struct shrinker *s, int nr_to_scan, gfp_t gfp_mask)
 {
-	struct task_struct *p;
-	struct task_struct *selected = NULL;
+	struct task_struct *selected;
 	int rem = 0;
-	int tasksize;
 	int i;
 	int min_adj = OOM_ADJUST_MAX + 1;
 	int selected_tasksize = 0;
-	int selected_oom_adj;
+	int selected_oom_adj = 0;
+	ktime_t start;
 	int array_size = ARRAY_SIZE(lowmem_adj);
 	int other_free = global_page_state(NR_FREE_PAGES);
 	int other_file = global_page_state(NR_FILE_PAGES) -
@@ -129,55 +352,28 @@ static int lowmem_shrink(struct shrinker *s, int nr_to_scan, gfp_t gfp_mask)
 			     nr_to_scan, gfp_mask, rem);
 		return rem;
 	}
-	selected_oom_adj = min_adj;
-
-	read_lock(&tasklist_lock);
-	for_each_process(p) {
-		struct mm_struct *mm;
-		struct signal_struct *sig;
-		int oom_adj;
+	start = ktime_get();
+	if (time_after(jiffies, lowmem_rss_stamp +
+		       msecs_to_jiffies(lowmem_rss_refresh_ms)))
+		lowmem_index_refresh();
+	selected = lowmem_select(min_adj, &selected_oom_adj,
+				 &selected_tasksize);
+	lowmem_hist_add(&lowmem_select_hist,
+			ktime_us_delta(ktime_get(), start));
 
-		task_lock(p);
-		mm = p->mm;
-		sig = p->signal;
-		if (!mm || !sig) {
-			task_unlock(p);
-			continue;
-		}
-		oom_adj = sig->oom_adj;
-		if (oom_adj < min_adj) {
-			task_unlock(p);
-			continue;
-		}
-		tasksize = get_mm_rss(mm);
-		task_unlock(p);
-		if (tasksize <= 0)
-			continue;
-		if (selected) {
-			if (oom_adj < selected_oom_adj)
-				continue;
-			if (oom_adj == selected_oom_adj &&
-			    tasksize <= selected_tasksize)
-				continue;
-		}
-		selected = p;
-		selected_tasksize = tasksize;
-		selected_oom_adj = oom_adj;
-		lowmem_print(2, "select %d (%s), adj %d, size %d, to kill\n",
-			     p->pid, p->comm, oom_adj, tasksize);
-	}
 	if (selected) {
 		lowmem_print(1, "send sigkill to %d (%s), adj %d, size %d\n",
 			     selected->pid, selected->comm,
 			     selected_oom_adj, selected_tasksize);
 		lowmem_deathpending = selected;
 		lowmem_deathpending_timeout = jiffies + HZ;
+		lowmem_deathpending_start = ktime_get();
 		force_sig(SIGKILL, selected);
 		rem -= selected_tasksize;
+		put_task_struct(selected);
 	}
 	lowmem_print(4, "lowmem_shrink %d, %x, return %d\n",
 		     nr_to_scan, gfp_mask, rem);
-	read_unlock(&tasklist_lock);
 	return rem;
 }
 
@@ -186,15 +382,105 @@ static struct shrinker lowmem_shrinker = {
 	.seeks = DEFAULT_SEEKS * 16
 };
 
+#ifdef CONFIG_DEBUG_FS
+static struct dentry *lowmem_debugfs;
+
+static int lowmem_hist_show(struct seq_file *s, void *unused)
+{
+	struct lowmem_hist *h = s->private;
+	int i;
+
+	for (i = 0; i < LOWMEM_HIST_SLOTS - 1; i++)
+		seq_printf(s, "< %8u us: %u\n", 1U << i, h->slot[i]);
+	seq_printf(s, ">= %7u us: %u\n", 1U << i, h->slot[i]);
+
+	return 0;
+}
+
+static int lowmem_hist_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, lowmem_hist_show, inode->i_private);
+}
+
+static const struct file_operations lowmem_hist_fops = {
+	.open		= lowmem_hist_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int lowmem_index_show(struct seq_file *s, void *unused)
+{
+	struct task_struct *p;
+	unsigned long flags;
+	int adj;
+
+	spin_lock_irqsave(&lowmem_index_lock, flags);
+	seq_printf(s, "%d tasks\n", lowmem_index_count);
+	for (adj = OOM_ADJUST_MAX; adj >= OOM_DISABLE; adj--) {
+		list_for_each_entry(p, &lowmem_index[adj - OOM_DISABLE],
+				    lowmem_node)
+			seq_printf(s, "%3d %5d %8lu %s\n", adj, p->pid,
+				   p->lowmem_rss, p->comm);
+	}
+	spin_unlock_irqrestore(&lowmem_index_lock, flags);
+
+	return 0;
+}
+
+static int lowmem_index_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, lowmem_index_show, NULL);
+}
+
+static const struct file_operations lowmem_index_fops = {
+	.open		= lowmem_index_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static void lowmem_debugfs_init(void)
+{
+	lowmem_debugfs = debugfs_create_dir("lowmemorykiller", NULL);
+	if (IS_ERR_OR_NULL(lowmem_debugfs))
+		return;
+
+	debugfs_create_file("select_latency", S_IRUGO, lowmem_debugfs,
+			    &lowmem_select_hist, &lowmem_hist_fops);
+	debugfs_create_file("kill_latency", S_IRUGO, lowmem_debugfs,
+			    &lowmem_kill_hist, &lowmem_hist_fops);
+	debugfs_create_file("index", S_IRUGO, lowmem_debugfs, NULL,
+			    &lowmem_index_fops);
+}
+
+static void lowmem_debugfs_exit(void)
+{
+	debugfs_remove_recursive(lowmem_debugfs);
+}
+#else
+static inline void lowmem_debugfs_init(void) { }
+static inline void lowmem_debugfs_exit(void) { }
+#endif
+
 static int __init lowmem_init(void)
 {
+	int i;
+
+	for (i = 0; i < LOWMEM_INDEX_SIZE; i++)
+		INIT_LIST_HEAD(&lowmem_index[i]);
+	lowmem_rss_stamp = jiffies;
+	lowmem_index_ready = 1;
+
 	task_free_register(&task_nb);
 	register_shrinker(&lowmem_shrinker);
+	lowmem_debugfs_init();
 	return 0;
 }
 
 static void __exit lowmem_exit(void)
 {
+	lowmem_debugfs_exit();
 	unregister_shrinker(&lowmem_shrinker);
 	task_free_unregister(&task_nb);
 }
@@ -205,6 +491,8 @@ module_param_array_named(adj, lowmem_adj, int, &lowmem_adj_size,
 module_param_array_named(minfree, lowmem_minfree, uint, &lowmem_minfree_size,
 			 S_IRUGO | S_IWUSR);
 module_param_named(debug_level, lowmem_debug_level, uint, S_IRUGO | S_IWUSR);
+module_param_named(rss_refresh_ms, lowmem_rss_refresh_ms, uint,
+		   S_IRUGO | S_IWUSR);
 
 module_init(lowmem_init);
 module_exit(lowmem_exit);
@@ -25,26 +25,36 @@
 #include <linux/bitops.h>
 #include <linux/blkdev.h>
 #include <linux/buffer_head.h>
+#include <linux/completion.h>
+#include <linux/fs.h>
 #include <linux/device.h>
 #include <linux/genhd.h>
 #include <linux/highmem.h>
+#include <linux/jhash.h>
+#include <linux/ktime.h>
+#include <linux/log2.h>
 #include <linux/slab.h>
 #include <linux/string.h>
 #include <linux/vmalloc.h>
+#include <linux/wait.h>
+#include <linux/workqueue.h>
 
 #include "zram_drv.h"
 
-#if defined(CONFIG_ZRAM_LZO)
 #include <linux/lzo.h>
-#define WMSIZE		LZO1X_MEM_COMPRESS
-#define COMPRESS(s, sl, d, dl, wm)	\
-	lzo1x_1_compress(s, sl, d, dl, wm)
-#define DECOMPRESS(s, sl, d, dl)	\
-	lzo1x_decompress_safe(s, sl, d, dl)
-#elif defined(CONFIG_ZRAM_SNAPPY)
+#ifdef CONFIG_ZRAM_SNAPPY
 #include "../snappy/csnappy.h" /* if built in drivers/staging */
+#endif
+
+static const struct zram_comp_ops zram_lzo_ops = {
+	.name		= "lzo",
+	.wmsize		= LZO1X_MEM_COMPRESS,
+	.compress	= lzo1x_1_compress,
+	.decompress	= lzo1x_decompress_safe,
+};
+
+#ifdef CONFIG_ZRAM_SNAPPY
 #define WMSIZE_ORDER	((PAGE_SHIFT > 14) ? (15) : (PAGE_SHIFT+1))
-#define WMSIZE		(1 << WMSIZE_ORDER)
 static int
 snappy_compress_(
 	const unsigned char *src,
@@ -70,49 +80,205 @@ snappy_decompress_(
 	*dst_len = (size_t)dst_len_;
 	return ret;
 }
-#define COMPRESS(s, sl, d, dl, wm)	\
-	snappy_compress_(s, sl, d, dl, wm)
-#define DECOMPRESS(s, sl, d, dl)	\
-	snappy_decompress_(s, sl, d, dl)
-#else
-#error either CONFIG_ZRAM_LZO or CONFIG_ZRAM_SNAPPY must be defined
+
+static const struct zram_comp_ops zram_snappy_ops = {
+	.name		= "snappy",
+	.wmsize		= 1 << WMSIZE_ORDER,
+	.compress	= snappy_compress_,
+	.decompress	= snappy_decompress_,
+};
+#endif
+
+static const struct zram_comp_ops *zram_comp_ops_list[] = {
+	&zram_lzo_ops,
+#ifdef CONFIG_ZRAM_SNAPPY
+	&zram_snappy_ops,
 #endif
+};
 
+#ifdef CONFIG_ZRAM_SNAPPY
+static const struct zram_comp_ops *zram_default_comp_ops = &zram_snappy_ops;
+#else
+static const struct zram_comp_ops *zram_default_comp_ops = &zram_lzo_ops;
+#endif
 
 /* Globals */
 static int zram_major;
 struct zram *zram_devices;
+static struct kmem_cache *zram_dedup_cache;
+static struct workqueue_struct *zram_wq;
 
 /* Module params (documentation at end) */
 unsigned int zram_num_devices;
 
-static void zram_stat_inc(u32 *v)
+static void zram_stat_add(struct zram *zram,
+			enum zram_stats_index idx, s64 val)
 {
-	*v = *v + 1;
+	struct zram_stats_cpu *stats;
+
+	preempt_disable();
+	stats = this_cpu_ptr(zram->stats);
+	write_seqcount_begin(&stats->syncp);
+	stats->count[idx] += val;
+	write_seqcount_end(&stats->syncp);
+	preempt_enable();
 }
 
-static void zram_stat_dec(u32 *v)
+static void zram_stat_inc(struct zram *zram, enum zram_stats_index idx)
 {
-	*v = *v - 1;
+	zram_stat_add(zram, idx, 1);
 }
 
-static void zram_stat64_add(struct zram *zram, u64 *v, u64 inc)
+static void zram_stat_dec(struct zram *zram, enum zram_stats_index idx)
 {
-	spin_lock(&zram->stat64_lock);
-	*v = *v + inc;
-	spin_unlock(&zram->stat64_lock);
+	zram_stat_add(zram, idx, -1);
+}
+
+static void zram_stat_reset(struct zram *zram)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct zram_stats_cpu *stats = per_cpu_ptr(zram->stats, cpu);
+
+		memset(stats->count, 0, sizeof(stats->count));
+	}
 }
 
-static void zram_stat64_sub(struct zram *zram, u64 *v, u64 dec)
+static void *zram_xv_create_pool(void)
+{
+	return xv_create_pool();
+}
+
+static void zram_xv_destroy_pool(void *pool)
+{
+	xv_destroy_pool(pool);
+}
+
+static int zram_xv_malloc(void *pool, u32 size, struct page **page,
+			u32 *offset, gfp_t flags)
+{
+	return xv_malloc(pool, size, page, offset, flags);
+}
+
+static void zram_xv_free(void *pool, struct page *page, u32 offset)
+{
+	xv_free(pool, page, offset);
+}
+
+static u64 zram_xv_total_size(void *pool)
+{
+	return xv_get_total_size_bytes(pool);
+}
+
+static const struct zram_mem_ops zram_xv_ops = {
+	.name		= "xvmalloc",
+	.create_pool	= zram_xv_create_pool,
+	.destroy_pool	= zram_xv_destroy_pool,
+	.malloc		= zram_xv_malloc,
+	.free		= zram_xv_free,
+	.total_size	= zram_xv_total_size,
+};
+
+static void *zram_zs_create_pool(void)
 {
-	spin_lock(&zram->stat64_lock);
-	*v = *v - dec;
-	spin_unlock(&zram->stat64_lock);
+	return zs_create_pool();
 }
 
-static void zram_stat64_inc(struct zram *zram, u64 *v)
+static void zram_zs_destroy_pool(void *pool)
 {
-	zram_stat64_add(zram, v, 1);
+	zs_destroy_pool(pool);
+}
+
+static int zram_zs_malloc(void *pool, u32 size, struct page **page,
+			u32 *offset, gfp_t flags)
+{
+	return zs_malloc(pool, size, page, offset, flags);
+}
+
+static void zram_zs_free(void *pool, struct page *page, u32 offset)
+{
+	zs_free(pool, page, offset);
+}
+
+static u64 zram_zs_total_size(void *pool)
+{
+	return zs_get_total_size_bytes(pool);
+}
+
+static int zram_zs_begin_compact(void *pool)
+{
+	return zs_begin_compact(pool);
+}
+
+static unsigned long zram_zs_end_compact(void *pool)
+{
+	return zs_end_compact(pool);
+}
+
+static const struct zram_mem_ops zram_zs_ops = {
+	.name		= "zsmalloc",
+	.create_pool	= zram_zs_create_pool,
+	.destroy_pool	= zram_zs_destroy_pool,
+	.malloc		= zram_zs_malloc,
+	.free		= zram_zs_free,
+	.total_size	= zram_zs_total_size,
+	.begin_compact	= zram_zs_begin_compact,
+	.page_isolated	= zs_page_isolated,
+	.end_compact	= zram_zs_end_compact,
+};
+
+static const struct zram_mem_ops *zram_mem_ops_list[] = {
+	&zram_xv_ops,
+	&zram_zs_ops,
+};
+
+#ifdef CONFIG_ZRAM_DEFAULT_ZSMALLOC
+static const struct zram_mem_ops *zram_default_mem_ops = &zram_zs_ops;
+#else
+static const struct zram_mem_ops *zram_default_mem_ops = &zram_xv_ops;
+#endif
+
+const struct zram_mem_ops *zram_find_mem_ops(const char *name)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(zram_mem_ops_list); i++) {
+		if (sysfs_streq(name, zram_mem_ops_list[i]->name))
+			return zram_mem_ops_list[i];
+	}
+
+	return NULL;
+}
+
+const struct zram_comp_ops *zram_find_comp_ops(const char *name)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(zram_comp_ops_list); i++) {
+		if (sysfs_streq(name, zram_comp_ops_list[i]->name))
+			return zram_comp_ops_list[i];
+	}
+
+	return NULL;
+}
+
+ssize_t zram_show_comp_ops(struct zram *zram, char *buf)
+{
+	int i;
+	ssize_t sz = 0;
+
+	for (i = 0; i < ARRAY_SIZE(zram_comp_ops_list); i++) {
+		const struct zram_comp_ops *ops = zram_comp_ops_list[i];
+
+		if (ops == zram->comp)
+			sz += sprintf(buf + sz, "[%s] ", ops->name);
+		else
+			sz += sprintf(buf + sz, "%s ", ops->name);
+	}
+	sz += sprintf(buf + sz, "\n");
+
+	return sz;
 }
 
 static int zram_test_flag(struct zram *zram, u32 index,
@@ -163,14 +329,397 @@ static void zram_set_disksize(struct zram *zram, u64 size_bytes)
 	set_capacity(zram->disk, size_bytes >> SECTOR_SHIFT);
 }
 
+/* Location of the object stored for a compressed table entry */
+static struct page *zram_get_obj(struct zram *zram, u32 index,
+				u32 *offset, u32 *size)
+{
+	struct table *entry = &zram->table[index];
+
+	if (zram_test_flag(zram, index, ZRAM_DEDUP)) {
+		*offset = entry->entry->offset;
+		*size = entry->entry->size;
+		return entry->entry->page;
+	}
+
+	*offset = entry->offset;
+	*size = entry->size;
+	return entry->page;
+}
+
+static struct hlist_head *zram_dedup_bucket(struct zram *zram, u32 checksum)
+{
+	return &zram->dedup_table[checksum & ((1 << zram->dedup_bits) - 1)];
+}
+
+/*
+ * Look for an object holding the same compressed data as src and
+ * take a reference to it. slot_lock keeps compaction from moving the
+ * objects while they are compared.
+ */
+static struct zram_dedup_entry *zram_dedup_find(struct zram *zram,
+			const unsigned char *src, size_t clen, u32 checksum)
+{
+	int match = 0;
+	unsigned char *cmem;
+	struct hlist_node *pos;
+	struct zram_dedup_entry *entry;
+
+	spin_lock(&zram->slot_lock);
+	spin_lock(&zram->dedup_lock);
+	hlist_for_each_entry(entry, pos, zram_dedup_bucket(zram, checksum),
+			     node) {
+		if (entry->checksum != checksum ||
+		    entry->size != clen + sizeof(struct zobj_header))
+			continue;
+
+		cmem = kmap_atomic(entry->page, KM_USER1) + entry->offset;
+		match = !memcmp(cmem + sizeof(struct zobj_header), src, clen);
+		kunmap_atomic(cmem, KM_USER1);
+
+		if (match) {
+			entry->refcount++;
+			break;
+		}
+	}
+	spin_unlock(&zram->dedup_lock);
+	spin_unlock(&zram->slot_lock);
+
+	return match ? entry : NULL;
+}
+
+static void zram_dedup_insert(struct zram *zram,
+			struct zram_dedup_entry *entry, struct page *page,
+			u32 offset, u32 size, u32 checksum)
+{
+	entry->page = page;
+	entry->offset = offset;
+	entry->size = size;
+	entry->checksum = checksum;
+	entry->refcount = 1;
+
+	spin_lock(&zram->dedup_lock);
+	hlist_add_head(&entry->node, zram_dedup_bucket(zram, checksum));
+	spin_unlock(&zram->dedup_lock);
+}
+
+/*
+ * Drop a reference to a shared object. If it was the last one,
+ * returns 1 along with the object location for the caller to free.
+ */
+static int zram_dedup_put(struct zram *zram, struct zram_dedup_entry *entry,
+			struct page **page, u32 *offset, u32 *size)
+{
+	spin_lock(&zram->dedup_lock);
+	if (--entry->refcount) {
+		spin_unlock(&zram->dedup_lock);
+		return 0;
+	}
+	hlist_del(&entry->node);
+	spin_unlock(&zram->dedup_lock);
+
+	*page = entry->page;
+	*offset = entry->offset;
+	*size = entry->size;
+	kmem_cache_free(zram_dedup_cache, entry);
+
+	return 1;
+}
+
+/*
+ * After an incompressible page, store the next ones as-is without
+ * trying to compress them, backing off exponentially for as long as
+ * the data stays incompressible.
+ */
+static void zram_update_skip(struct zram *zram, int incompressible)
+{
+	int run, new_run;
+
+	if (!incompressible) {
+		atomic_set(&zram->incompressible_run, 0);
+		return;
+	}
+
+	do {
+		run = atomic_read(&zram->incompressible_run);
+		new_run = min(run + 1, ZRAM_SKIP_MAX_SHIFT);
+	} while (atomic_cmpxchg(&zram->incompressible_run,
+				run, new_run) != run);
+	atomic_set(&zram->skip_left, (1 << new_run) - 1);
+}
+
+static void zram_stream_free(struct zram_comp_stream *strm)
+{
+	kfree(strm->workmem);
+	free_pages((unsigned long)strm->buffer, 1);
+	kfree(strm);
+}
+
+static struct zram_comp_stream *zram_stream_alloc(struct zram *zram,
+						gfp_t flags)
+{
+	struct zram_comp_stream *strm;
+
+	strm = kzalloc(sizeof(*strm), flags);
+	if (!strm)
+		return NULL;
+
+	strm->workmem = kzalloc(zram->comp->wmsize, flags);
+	/* Compressors may write past PAGE_SIZE on incompressible data */
+	strm->buffer = (void *)__get_free_pages(flags | __GFP_ZERO, 1);
+	if (!strm->workmem || !strm->buffer) {
+		zram_stream_free(strm);
+		return NULL;
+	}
+
+	return strm;
+}
+
+/*
+ * Get an idle compression stream. Up to max_comp_streams are created
+ * on demand, beyond that writers wait for one to be released.
+ */
+static struct zram_comp_stream *zram_stream_get(struct zram *zram)
+{
+	struct zram_comp_stream *strm;
+
+	while (1) {
+		spin_lock(&zram->strm_lock);
+		if (!list_empty(&zram->idle_strm)) {
+			strm = list_first_entry(&zram->idle_strm,
+					struct zram_comp_stream, list);
+			list_del(&strm->list);
+			spin_unlock(&zram->strm_lock);
+			return strm;
+		}
+
+		if (zram->avail_strm < zram->max_strm) {
+			zram->avail_strm++;
+			spin_unlock(&zram->strm_lock);
+
+			strm = zram_stream_alloc(zram, GFP_NOIO);
+			if (strm)
+				return strm;
+
+			spin_lock(&zram->strm_lock);
+			zram->avail_strm--;
+		}
+		spin_unlock(&zram->strm_lock);
+
+		wait_event(zram->strm_wait, !list_empty(&zram->idle_strm));
+	}
+}
+
+static void zram_stream_put(struct zram *zram, struct zram_comp_stream *strm)
+{
+	spin_lock(&zram->strm_lock);
+	if (zram->avail_strm > zram->max_strm) {
+		zram->avail_strm--;
+		spin_unlock(&zram->strm_lock);
+		zram_stream_free(strm);
+		return;
+	}
+	list_add(&strm->list, &zram->idle_strm);
+	spin_unlock(&zram->strm_lock);
+
+	wake_up(&zram->strm_wait);
+}
+
+/* Free idle streams above the limit */
+static void zram_streams_trim(struct zram *zram, int max)
+{
+	struct zram_comp_stream *strm;
+
+	spin_lock(&zram->strm_lock);
+	while (zram->avail_strm > max && !list_empty(&zram->idle_strm)) {
+		strm = list_first_entry(&zram->idle_strm,
+				struct zram_comp_stream, list);
+		list_del(&strm->list);
+		zram->avail_strm--;
+		spin_unlock(&zram->strm_lock);
+
+		zram_stream_free(strm);
+		spin_lock(&zram->strm_lock);
+	}
+	spin_unlock(&zram->strm_lock);
+}
+
+void zram_set_max_streams(struct zram *zram, int max)
+{
+	spin_lock(&zram->strm_lock);
+	zram->max_strm = max;
+	spin_unlock(&zram->strm_lock);
+
+	zram_streams_trim(zram, max);
+}
+
+static int zram_compress(struct zram *zram, struct zram_comp_stream *strm,
+			const unsigned char *src, size_t *dst_len)
+{
+	int ret;
+	ktime_t start = ktime_get();
+
+	ret = zram->comp->compress(src, PAGE_SIZE, strm->buffer, dst_len,
+				   strm->workmem);
+
+	zram_stat_add(zram, ZRAM_STAT_COMP_NS,
+		ktime_to_ns(ktime_sub(ktime_get(), start)));
+	zram_stat_inc(zram, ZRAM_STAT_COMP_PAGES);
+	zram_stat_add(zram, ZRAM_STAT_COMP_OUT, *dst_len);
+
+	return ret;
+}
+
+static int zram_decompress(struct zram *zram, const unsigned char *src,
+			size_t src_len, unsigned char *dst, size_t *dst_len)
+{
+	int ret;
+	ktime_t start = ktime_get();
+
+	ret = zram->comp->decompress(src, src_len, dst, dst_len);
+
+	zram_stat_add(zram, ZRAM_STAT_DECOMP_NS,
+		ktime_to_ns(ktime_sub(ktime_get(), start)));
+	zram_stat_inc(zram, ZRAM_STAT_DECOMP_PAGES);
+
+	return ret;
+}
+
+static void zram_reset_backing_dev(struct zram *zram)
+{
+	if (!zram->backing_bdev)
+		return;
+
+	close_bdev_exclusive(zram->backing_bdev, FMODE_READ | FMODE_WRITE);
+	zram->backing_bdev = NULL;
+	vfree(zram->bd_bitmap);
+	zram->bd_bitmap = NULL;
+	kfree(zram->backing_path);
+	zram->backing_path = NULL;
+}
+
+/*
+ * Reserve nr contiguous blocks on the backing device, fewer if there
+ * is no such run. Returns the first block, 0 when the device is full.
+ */
+static unsigned long zram_bd_alloc(struct zram *zram, int *nr)
+{
+	unsigned long blk;
+
+	spin_lock(&zram->bd_lock);
+	while (*nr) {
+		blk = bitmap_find_next_zero_area(zram->bd_bitmap,
+				zram->bd_nr_blocks, zram->bd_next, *nr, 0);
+		if (blk + *nr > zram->bd_nr_blocks)
+			blk = bitmap_find_next_zero_area(zram->bd_bitmap,
+				zram->bd_nr_blocks, 1, *nr, 0);
+
+		if (blk + *nr <= zram->bd_nr_blocks) {
+			bitmap_set(zram->bd_bitmap, blk, *nr);
+			zram->bd_next = blk + *nr;
+			spin_unlock(&zram->bd_lock);
+			return blk;
+		}
+		*nr /= 2;
+	}
+	spin_unlock(&zram->bd_lock);
+
+	return 0;
+}
+
+static void zram_bd_free(struct zram *zram, unsigned long blk, int nr)
+{
+	spin_lock(&zram->bd_lock);
+	bitmap_clear(zram->bd_bitmap, blk, nr);
+	spin_unlock(&zram->bd_lock);
+}
+
+static void zram_bd_end_io(struct bio *bio, int err)
+{
+	complete(bio->bi_private);
+}
+
+/*
+ * Synchronously transfer nr pages to or from consecutive blocks.
+ * Must not be called below zram_make_request(): bios submitted there
+ * are only dispatched once it returns, so the wait would never end.
+ */
+static int zram_bd_rw(struct zram *zram, struct page **pages, int nr,
+			unsigned long blk, int rw)
+{
+	int i, ret;
+	struct bio *bio;
+	DECLARE_COMPLETION_ONSTACK(done);
+
+	bio = bio_alloc(GFP_NOIO, nr);
+	if (!bio)
+		return -ENOMEM;
+
+	bio->bi_bdev = zram->backing_bdev;
+	bio->bi_sector = blk << SECTORS_PER_PAGE_SHIFT;
+	bio->bi_end_io = zram_bd_end_io;
+	bio->bi_private = &done;
+
+	for (i = 0; i < nr; i++) {
+		if (bio_add_page(bio, pages[i], PAGE_SIZE, 0) != PAGE_SIZE) {
+			bio_put(bio);
+			return -EIO;
+		}
+	}
+
+	submit_bio(rw, bio);
+	wait_for_completion(&done);
+
+	ret = test_bit(BIO_UPTODATE, &bio->bi_flags) ? 0 : -EIO;
+	bio_put(bio);
+
+	zram_stat_add(zram, rw == WRITE ? ZRAM_STAT_BD_WRITES :
+				ZRAM_STAT_BD_READS, nr);
+
+	return ret;
+}
+
+/* Read a written back page into mem */
+static int zram_bd_read(struct zram *zram, u32 index, unsigned char *mem)
+{
+	int ret;
+	unsigned char *src;
+	struct page *page;
+
+	page = alloc_page(GFP_NOIO);
+	if (!page)
+		return -ENOMEM;
+
+	ret = zram_bd_rw(zram, &page, 1, zram->table[index].block, READ);
+	if (!ret) {
+		src = kmap_atomic(page, KM_USER1);
+		memcpy(mem, src, PAGE_SIZE);
+		kunmap_atomic(src, KM_USER1);
+	}
+	__free_page(page);
+
+	if (ret)
+		pr_err("Backing device read failed! err=%d, page=%u\n",
+			ret, index);
+	return ret;
+}
+
 static void zram_free_page(struct zram *zram, size_t index)
 {
-	u32 clen;
-	void *obj;
+	u32 clen, size;
 
 	struct page *page = zram->table[index].page;
 	u32 offset = zram->table[index].offset;
 
+	zram_clear_flag(zram, index, ZRAM_IDLE);
+	zram_clear_flag(zram, index, ZRAM_UNDER_WB);
+
+	if (unlikely(zram_test_flag(zram, index, ZRAM_WB))) {
+		zram_bd_free(zram, zram->table[index].block, 1);
+		zram_clear_flag(zram, index, ZRAM_WB);
+		zram_stat_dec(zram, ZRAM_STAT_BD_COUNT);
+		goto shared;
+	}
+
 	if (unlikely(!page)) {
 		/*
 		 * No memory is allocated for zero filled pages.
@@ -178,7 +727,7 @@ static void zram_free_page(struct zram *zram, size_t index)
 		 */
 		if (zram_test_flag(zram, index, ZRAM_ZERO)) {
 			zram_clear_flag(zram, index, ZRAM_ZERO);
-			zram_stat_dec(&zram->stats.pages_zero);
+			zram_stat_dec(zram, ZRAM_STAT_PAGES_ZERO);
 		}
 		return;
 	}
@@ -187,24 +736,35 @@ static void zram_free_page(struct zram *zram, size_t index)
 		clen = PAGE_SIZE;
 		__free_page(page);
 		zram_clear_flag(zram, index, ZRAM_UNCOMPRESSED);
-		zram_stat_dec(&zram->stats.pages_expand);
+		zram_stat_dec(zram, ZRAM_STAT_PAGES_EXPAND);
 		goto out;
 	}
 
-	obj = kmap_atomic(page, KM_USER0) + offset;
-	clen = xv_get_object_size(obj) - sizeof(struct zobj_header);
-	kunmap_atomic(obj, KM_USER0);
+	size = zram->table[index].size;
+	if (zram_test_flag(zram, index, ZRAM_DEDUP)) {
+		zram_clear_flag(zram, index, ZRAM_DEDUP);
+		if (!zram_dedup_put(zram, zram->table[index].entry,
+				    &page, &offset, &size)) {
+			/* Object still used by other table entries */
+			zram_stat_dec(zram, ZRAM_STAT_PAGES_DUP);
+			goto shared;
+		}
+	}
+
+	clen = size - sizeof(struct zobj_header);
 
-	xv_free(zram->mem_pool, page, offset);
+	zram->mem_ops->free(zram->mem_pool, page, offset);
 	if (clen <= PAGE_SIZE / 2)
-		zram_stat_dec(&zram->stats.good_compress);
+		zram_stat_dec(zram, ZRAM_STAT_GOOD_COMPRESS);
 
 out:
-	zram_stat64_sub(zram, &zram->stats.compr_size, clen);
-	zram_stat_dec(&zram->stats.pages_stored);
+	zram_stat_add(zram, ZRAM_STAT_COMPR_SIZE, -(s64)clen);
+shared:
+	zram_stat_dec(zram, ZRAM_STAT_PAGES_STORED);
 
 	zram->table[index].page = NULL;
 	zram->table[index].offset = 0;
+	zram->table[index].size = 0;
 }
 
 static void handle_zero_page(struct bio_vec *bvec)
@@ -245,17 +805,49 @@ static int zram_bvec_read(struct zram *zram, struct bio_vec *bvec,
 {
 	int ret;
 	size_t clen;
-	struct page *page;
+	u32 obj_offset, obj_size;
+	struct page *page, *obj_page;
 	struct zobj_header *zheader;
 	unsigned char *user_mem, *cmem, *uncmem = NULL;
 
 	page = bvec->bv_page;
 
+	if (unlikely(zram_test_flag(zram, index, ZRAM_IDLE))) {
+		spin_lock(&zram->slot_lock);
+		zram_clear_flag(zram, index, ZRAM_IDLE);
+		spin_unlock(&zram->slot_lock);
+	}
+
 	if (zram_test_flag(zram, index, ZRAM_ZERO)) {
 		handle_zero_page(bvec);
 		return 0;
 	}
 
+	/* Page was written back, read it from the backing device */
+	if (unlikely(zram_test_flag(zram, index, ZRAM_WB))) {
+		if (current->bio_list)
+			return -EAGAIN;
+
+		if (!is_partial_io(bvec)) {
+			ret = zram_bd_rw(zram, &page, 1,
+					 zram->table[index].block, READ);
+			goto out;
+		}
+
+		uncmem = kmalloc(PAGE_SIZE, GFP_NOIO);
+		if (!uncmem)
+			return -ENOMEM;
+		ret = zram_bd_read(zram, index, uncmem);
+		if (!ret) {
+			user_mem = kmap_atomic(page, KM_USER0);
+			memcpy(user_mem + bvec->bv_offset, uncmem + offset,
+			       bvec->bv_len);
+			kunmap_atomic(user_mem, KM_USER0);
+		}
+		kfree(uncmem);
+		goto out;
+	}
+
 	/* Requested page is not present in compressed area */
 	if (unlikely(!zram->table[index].page)) {
 		pr_debug("Read before write: sector=%lu, size=%u",
@@ -284,12 +876,12 @@ static int zram_bvec_read(struct zram *zram, struct bio_vec *bvec,
 		uncmem = user_mem;
 	clen = PAGE_SIZE;
 
-	cmem = kmap_atomic(zram->table[index].page, KM_USER1) +
-		zram->table[index].offset;
+	obj_page = zram_get_obj(zram, index, &obj_offset, &obj_size);
+	cmem = kmap_atomic(obj_page, KM_USER1) + obj_offset;
 
-	ret = DECOMPRESS(
+	ret = zram_decompress(zram,
 			cmem + sizeof(*zheader),
-			xv_get_object_size(cmem) - sizeof(*zheader),
+			obj_size - sizeof(*zheader),
 			uncmem, &clen);
 
 	if (is_partial_io(bvec)) {
@@ -302,9 +894,12 @@ static int zram_bvec_read(struct zram *zram, struct bio_vec *bvec,
 	kunmap_atomic(user_mem, KM_USER0);
 
 	/* Should NEVER happen. Return bio error if it does. */
-	if (unlikely(ret)) {
+	if (unlikely(ret))
 		pr_err("Decompression failed! err=%d, page=%u\n", ret, index);
-		zram_stat64_inc(zram, &zram->stats.failed_reads);
+
+out:
+	if (unlikely(ret)) {
+		zram_stat_inc(zram, ZRAM_STAT_FAILED_READS);
 		return ret;
 	}
 
@@ -317,6 +912,8 @@ static int zram_read_before_write(struct zram *zram, char *mem, u32 index)
 {
 	int ret;
 	size_t clen = PAGE_SIZE;
+	u32 obj_offset, obj_size;
+	struct page *obj_page;
 	struct zobj_header *zheader;
 	unsigned char *cmem;
 
@@ -326,8 +923,18 @@ static int zram_read_before_write(struct zram *zram, char *mem, u32 index)
 		return 0;
 	}
 
-	cmem = kmap_atomic(zram->table[index].page, KM_USER0) +
-		zram->table[index].offset;
+	if (unlikely(zram_test_flag(zram, index, ZRAM_WB))) {
+		if (current->bio_list)
+			return -EAGAIN;
+
+		ret = zram_bd_read(zram, index, mem);
+		if (ret)
+			zram_stat_inc(zram, ZRAM_STAT_FAILED_READS);
+		return ret;
+	}
+
+	obj_page = zram_get_obj(zram, index, &obj_offset, &obj_size);
+	cmem = kmap_atomic(obj_page, KM_USER0) + obj_offset;
 
 	/* Page is stored uncompressed since it's incompressible */
 	if (unlikely(zram_test_flag(zram, index, ZRAM_UNCOMPRESSED))) {
@@ -336,15 +943,15 @@ static int zram_read_before_write(struct zram *zram, char *mem, u32 index)
 		return 0;
 	}
 
-	ret = DECOMPRESS(cmem + sizeof(*zheader),
-			xv_get_object_size(cmem) - sizeof(*zheader),
+	ret = zram_decompress(zram, cmem + sizeof(*zheader),
+			obj_size - sizeof(*zheader),
 			mem, &clen);
 	kunmap_atomic(cmem, KM_USER0);
 
 	/* Should NEVER happen. Return bio error if it does. */
 	if (unlikely(ret)) {
 		pr_err("Decompression failed! err=%d, page=%u\n", ret, index);
-		zram_stat64_inc(zram, &zram->stats.failed_reads);
+		zram_stat_inc(zram, ZRAM_STAT_FAILED_READS);
 		return ret;
 	}
 
@@ -354,15 +961,17 @@ static int zram_read_before_write(struct zram *zram, char *mem, u32 index)
 static int zram_bvec_write(struct zram *zram, struct bio_vec *bvec, u32 index,
 			   int offset)
 {
-	int ret;
-	u32 store_offset;
-	size_t clen;
+	int ret = 0;
+	u32 store_offset = 0, checksum = 0;
+	size_t clen = PAGE_SIZE;
+	u8 flags = 0;
 	struct zobj_header *zheader;
-	struct page *page, *page_store;
+	struct zram_comp_stream *strm;
+	struct zram_dedup_entry *entry = NULL, *dup = NULL;
+	struct page *page, *page_store = NULL;
 	unsigned char *user_mem, *cmem, *src, *uncmem = NULL;
 
 	page = bvec->bv_page;
-	src = zram->compress_buffer;
 
 	if (is_partial_io(bvec)) {
 		/*
@@ -375,20 +984,19 @@ static int zram_bvec_write(struct zram *zram, struct bio_vec *bvec, u32 index,
 			ret = -ENOMEM;
 			goto out;
 		}
+		down_read(&zram->lock);
 		ret = zram_read_before_write(zram, uncmem, index);
-		if (ret) {
-			kfree(uncmem);
+		up_read(&zram->lock);
+		if (ret)
 			goto out;
-		}
 	}
 
 	/*
-	 * System overwrites unused sectors. Free memory associated
-	 * with this sector now.
+	 * Compression runs without zram->lock, each writer with its
+	 * own stream. The table is only locked to swap in the result.
 	 */
-	if (zram->table[index].page ||
-	    zram_test_flag(zram, index, ZRAM_ZERO))
-		zram_free_page(zram, index);
+	strm = zram_stream_get(zram);
+	src = strm->buffer;
 
 	user_mem = kmap_atomic(page, KM_USER0);
 
@@ -400,24 +1008,24 @@ static int zram_bvec_write(struct zram *zram, struct bio_vec *bvec, u32 index,
 
 	if (page_zero_filled(uncmem)) {
 		kunmap_atomic(user_mem, KM_USER0);
-		if (is_partial_io(bvec))
-			kfree(uncmem);
-		zram_stat_inc(&zram->stats.pages_zero);
-		zram_set_flag(zram, index, ZRAM_ZERO);
-		ret = 0;
-		goto out;
+		zram_stream_put(zram, strm);
+		flags = BIT(ZRAM_ZERO);
+		goto update;
 	}
 
-	COMPRESS(uncmem, PAGE_SIZE, src, &clen,
-		zram->compress_workmem);
-	ret = 0;
+	if (zram->comp_skip && atomic_add_unless(&zram->skip_left, -1, 0)) {
+		zram_stat_inc(zram, ZRAM_STAT_COMP_SKIPPED);
+	} else {
+		ret = zram_compress(zram, strm, uncmem, &clen);
+		if (zram->comp_skip)
+			zram_update_skip(zram, clen > max_zpage_size);
+	}
 
 	kunmap_atomic(user_mem, KM_USER0);
-	if (is_partial_io(bvec))
-			kfree(uncmem);
 
 	if (unlikely(ret != 0)) {
 		pr_err("Compression failed! err=%d\n", ret);
+		zram_stream_put(zram, strm);
 		goto out;
 	}
 
@@ -427,6 +1035,7 @@ static int zram_bvec_write(struct zram *zram, struct bio_vec *bvec, u32 index,
 	 * errors which has side effect of hanging the system.
 	 */
 	if (unlikely(clen > max_zpage_size)) {
+		zram_stream_put(zram, strm);
 		clen = PAGE_SIZE;
 		page_store = alloc_page(GFP_NOIO | __GFP_HIGHMEM);
 		if (unlikely(!page_store)) {
@@ -437,31 +1046,46 @@ static int zram_bvec_write(struct zram *zram, struct bio_vec *bvec, u32 index,
 		}
 
 		store_offset = 0;
-		zram_set_flag(zram, index, ZRAM_UNCOMPRESSED);
-		zram_stat_inc(&zram->stats.pages_expand);
-		zram->table[index].page = page_store;
-		src = kmap_atomic(page, KM_USER0);
+		flags = BIT(ZRAM_UNCOMPRESSED);
+		zram_stat_inc(zram, ZRAM_STAT_PAGES_EXPAND);
+		if (is_partial_io(bvec))
+			src = uncmem;
+		else
+			src = kmap_atomic(page, KM_USER0);
 		goto memstore;
 	}
 
-	if (xv_malloc(zram->mem_pool, clen + sizeof(*zheader),
-		      &zram->table[index].page, &store_offset,
+	if (zram->dedup_table) {
+		checksum = jhash(src, clen, 0);
+		dup = zram_dedup_find(zram, src, clen, checksum);
+		if (dup) {
+			zram_stream_put(zram, strm);
+			flags = BIT(ZRAM_DEDUP);
+			goto update;
+		}
+
+		/* Without an entry, the page is simply not shared */
+		entry = kmem_cache_alloc(zram_dedup_cache, GFP_NOIO);
+	}
+
+	if (zram->mem_ops->malloc(zram->mem_pool, clen + sizeof(*zheader),
+		      &page_store, &store_offset,
 		      GFP_NOIO | __GFP_HIGHMEM)) {
 		pr_info("Error allocating memory for compressed "
 			"page: %u, size=%zu\n", index, clen);
+		zram_stream_put(zram, strm);
+		if (entry)
+			kmem_cache_free(zram_dedup_cache, entry);
 		ret = -ENOMEM;
 		goto out;
 	}
 
 memstore:
-	zram->table[index].offset = store_offset;
-
-	cmem = kmap_atomic(zram->table[index].page, KM_USER1) +
-		zram->table[index].offset;
+	cmem = kmap_atomic(page_store, KM_USER1) + store_offset;
 
 #if 0
 	/* Back-reference needed for memory defragmentation */
-	if (!zram_test_flag(zram, index, ZRAM_UNCOMPRESSED)) {
+	if (!(flags & BIT(ZRAM_UNCOMPRESSED))) {
 		zheader = (struct zobj_header *)cmem;
 		zheader->table_idx = index;
 		cmem += sizeof(*zheader);
@@ -471,20 +1095,63 @@ memstore:
 	memcpy(cmem, src, clen);
 
 	kunmap_atomic(cmem, KM_USER1);
-	if (unlikely(zram_test_flag(zram, index, ZRAM_UNCOMPRESSED)))
-		kunmap_atomic(src, KM_USER0);
+	if (unlikely(flags & BIT(ZRAM_UNCOMPRESSED))) {
+		if (!is_partial_io(bvec))
+			kunmap_atomic(src, KM_USER0);
+	} else {
+		zram_stream_put(zram, strm);
+	}
+
+	if (entry) {
+		zram_dedup_insert(zram, entry, page_store, store_offset,
+				  clen + sizeof(*zheader), checksum);
+		dup = entry;
+		flags = BIT(ZRAM_DEDUP);
+	}
 
 	/* Update stats */
-	zram_stat64_add(zram, &zram->stats.compr_size, clen);
-	zram_stat_inc(&zram->stats.pages_stored);
+	zram_stat_add(zram, ZRAM_STAT_COMPR_SIZE, clen);
 	if (clen <= PAGE_SIZE / 2)
-		zram_stat_inc(&zram->stats.good_compress);
+		zram_stat_inc(zram, ZRAM_STAT_GOOD_COMPRESS);
 
-	return 0;
+update:
+	down_write(&zram->lock);
+
+	/*
+	 * System overwrites unused sectors. Free memory associated
+	 * with this sector now.
+	 */
+	if (zram->table[index].page ||
+	    zram_test_flag(zram, index, ZRAM_ZERO))
+		zram_free_page(zram, index);
+
+	zram->table[index].flags |= flags;
+	if (flags & BIT(ZRAM_DEDUP)) {
+		zram->table[index].entry = dup;
+	} else {
+		zram->table[index].page = page_store;
+		zram->table[index].offset = store_offset;
+		if (page_store)
+			zram->table[index].size = clen;
+		if (page_store && !(flags & BIT(ZRAM_UNCOMPRESSED)))
+			zram->table[index].size += sizeof(*zheader);
+	}
+
+	up_write(&zram->lock);
+
+	if (flags & BIT(ZRAM_ZERO)) {
+		zram_stat_inc(zram, ZRAM_STAT_PAGES_ZERO);
+	} else {
+		zram_stat_inc(zram, ZRAM_STAT_PAGES_STORED);
+		if (dup && dup != entry)
+			zram_stat_inc(zram, ZRAM_STAT_PAGES_DUP);
+	}
 
 out:
-	if (ret)
-		zram_stat64_inc(zram, &zram->stats.failed_writes);
+	if (is_partial_io(bvec))
+		kfree(uncmem);
+	if (ret && ret != -EAGAIN)
+		zram_stat_inc(zram, ZRAM_STAT_FAILED_WRITES);
 	return ret;
 }
 
@@ -498,9 +1165,7 @@ static int zram_bvec_rw(struct zram *zram, struct bio_vec *bvec, u32 index,
 		ret = zram_bvec_read(zram, bvec, index, offset, bio);
 		up_read(&zram->lock);
 	} else {
-		down_write(&zram->lock);
 		ret = zram_bvec_write(zram, bvec, index, offset);
-		up_write(&zram->lock);
 	}
 
 	return ret;
@@ -513,21 +1178,14 @@ static void update_position(u32 *index, int *offset, struct bio_vec *bvec)
 	*offset = (*offset + bvec->bv_len) % PAGE_SIZE;
 }
 
+static void zram_queue_bd(struct zram *zram, struct bio *bio);
+
 static void __zram_make_request(struct zram *zram, struct bio *bio, int rw)
 {
-	int i, offset;
+	int i, offset, ret = 0;
 	u32 index;
 	struct bio_vec *bvec;
 
-	switch (rw) {
-	case READ:
-		zram_stat64_inc(zram, &zram->stats.num_reads);
-		break;
-	case WRITE:
-		zram_stat64_inc(zram, &zram->stats.num_writes);
-		break;
-	}
-
 	index = bio->bi_sector >> SECTORS_PER_PAGE_SHIFT;
 	offset = (bio->bi_sector & (SECTORS_PER_PAGE - 1)) << SECTOR_SHIFT;
 
@@ -545,27 +1203,143 @@ static void __zram_make_request(struct zram *zram, struct bio *bio, int rw)
 			bv.bv_len = max_transfer_size;
 			bv.bv_offset = bvec->bv_offset;
 
-			if (zram_bvec_rw(zram, &bv, index, offset, bio, rw) < 0)
+			ret = zram_bvec_rw(zram, &bv, index, offset, bio, rw);
+			if (ret < 0)
 				goto out;
 
 			bv.bv_len = bvec->bv_len - max_transfer_size;
 			bv.bv_offset += max_transfer_size;
-			if (zram_bvec_rw(zram, &bv, index+1, 0, bio, rw) < 0)
+			ret = zram_bvec_rw(zram, &bv, index+1, 0, bio, rw);
+			if (ret < 0)
 				goto out;
-		} else
-			if (zram_bvec_rw(zram, bvec, index, offset, bio, rw)
-			    < 0)
+		} else {
+			ret = zram_bvec_rw(zram, bvec, index, offset, bio, rw);
+			if (ret < 0)
 				goto out;
+		}
 
 		update_position(&index, &offset, bvec);
 	}
 
+out:
+	/*
+	 * A written back page was hit inside zram_make_request(), where
+	 * the backing device read cannot be waited for. Redo the whole
+	 * bio from zram_wq; segments already done are simply done again.
+	 */
+	if (unlikely(ret == -EAGAIN)) {
+		zram_queue_bd(zram, bio);
+		return;
+	}
+
+	switch (rw) {
+	case READ:
+		zram_stat_inc(zram, ZRAM_STAT_NUM_READS);
+		break;
+	case WRITE:
+		zram_stat_inc(zram, ZRAM_STAT_NUM_WRITES);
+		break;
+	}
+
+	if (ret < 0) {
+		bio_io_error(bio);
+		return;
+	}
+
 	set_bit(BIO_UPTODATE, &bio->bi_flags);
 	bio_endio(bio, 0);
-	return;
+}
 
-out:
-	bio_io_error(bio);
+/*
+ * With several compression streams, writes are handed to zram_wq so
+ * that the submitter (usually reclaim) does not wait for compression.
+ * Once max_queued_writes are pending, writers compress themselves.
+ */
+static int zram_queue_write(struct zram *zram, struct bio *bio)
+{
+	if (zram->max_strm <= 1)
+		return 0;
+
+	spin_lock(&zram->write_lock);
+	if (zram->queued_writes >= max_queued_writes) {
+		spin_unlock(&zram->write_lock);
+		return 0;
+	}
+	bio_list_add(&zram->write_list, bio);
+	zram->queued_writes++;
+	spin_unlock(&zram->write_lock);
+
+	queue_work(zram_wq, &zram->write_work);
+	return 1;
+}
+
+static void zram_write_work(struct work_struct *work)
+{
+	struct bio *bio;
+	struct zram *zram = container_of(work, struct zram, write_work);
+
+	down_read(&zram->init_lock);
+	while (1) {
+		spin_lock(&zram->write_lock);
+		bio = bio_list_pop(&zram->write_list);
+		if (bio)
+			zram->queued_writes--;
+		spin_unlock(&zram->write_lock);
+
+		if (!bio)
+			break;
+
+		if (likely(zram->init_done))
+			__zram_make_request(zram, bio, WRITE);
+		else
+			bio_io_error(bio);
+	}
+	up_read(&zram->init_lock);
+}
+
+static void zram_queue_bd(struct zram *zram, struct bio *bio)
+{
+	spin_lock(&zram->write_lock);
+	bio_list_add(&zram->bd_list, bio);
+	spin_unlock(&zram->write_lock);
+
+	queue_work(zram_wq, &zram->bd_work);
+}
+
+/*
+ * Bios that need a page from the backing device. The worker has no
+ * current->bio_list, so zram_bd_rw() is dispatched and waited for.
+ */
+static void zram_bd_work(struct work_struct *work)
+{
+	struct bio *bio;
+	struct zram *zram = container_of(work, struct zram, bd_work);
+
+	down_read(&zram->init_lock);
+	while (1) {
+		spin_lock(&zram->write_lock);
+		bio = bio_list_pop(&zram->bd_list);
+		spin_unlock(&zram->write_lock);
+
+		if (!bio)
+			break;
+
+		if (likely(zram->init_done))
+			__zram_make_request(zram, bio, bio_data_dir(bio));
+		else
+			bio_io_error(bio);
+	}
+	up_read(&zram->init_lock);
+}
+
+/*
+ * Wait for queued writes and backing device reads. Must not be called
+ * with init_lock held.
+ */
+void zram_flush_writes(struct zram *zram)
+{
+	flush_work(&zram->write_work);
+	flush_work(&zram->bd_work);
 }
 
 /*
@@ -600,10 +1374,15 @@ static int zram_make_request(struct request_queue *queue, struct bio *bio)
 		goto error_unlock;
 
 	if (!valid_io_request(zram, bio)) {
-		zram_stat64_inc(zram, &zram->stats.invalid_io);
+		zram_stat_inc(zram, ZRAM_STAT_INVALID_IO);
 		goto error_unlock;
 	}
 
+	if (bio_data_dir(bio) == WRITE && zram_queue_write(zram, bio)) {
+		up_read(&zram->init_lock);
+		return 0;
+	}
+
 	__zram_make_request(zram, bio, bio_data_dir(bio));
 	up_read(&zram->init_lock);
 
@@ -623,43 +1402,55 @@ void __zram_reset_device(struct zram *zram)
 	zram->init_done = 0;
 
 	/* Free various per-device buffers */
-	kfree(zram->compress_workmem);
-	free_pages((unsigned long)zram->compress_buffer, 1);
-
-	zram->compress_workmem = NULL;
-	zram->compress_buffer = NULL;
+	zram_streams_trim(zram, 0);
 
 	/* Free all pages that are still in this zram device */
 	for (index = 0; index < zram->disksize >> PAGE_SHIFT; index++) {
 		struct page *page;
-		u16 offset;
+		u32 offset, size;
 
 		page = zram->table[index].page;
 		offset = zram->table[index].offset;
 
-		if (!page)
+		if (!page || zram_test_flag(zram, index, ZRAM_WB))
 			continue;
 
-		if (unlikely(zram_test_flag(zram, index, ZRAM_UNCOMPRESSED)))
+		if (unlikely(zram_test_flag(zram, index, ZRAM_UNCOMPRESSED))) {
 			__free_page(page);
-		else
-			xv_free(zram->mem_pool, page, offset);
+			continue;
+		}
+
+		if (zram_test_flag(zram, index, ZRAM_DEDUP) &&
+		    !zram_dedup_put(zram, zram->table[index].entry,
+				    &page, &offset, &size))
+			continue;
+
+		zram->mem_ops->free(zram->mem_pool, page, offset);
 	}
 
 	vfree(zram->table);
 	zram->table = NULL;
 
-	xv_destroy_pool(zram->mem_pool);
+	vfree(zram->dedup_table);
+	zram->dedup_table = NULL;
+	atomic_set(&zram->incompressible_run, 0);
+	atomic_set(&zram->skip_left, 0);
+
+	if (zram->mem_pool)
+		zram->mem_ops->destroy_pool(zram->mem_pool);
 	zram->mem_pool = NULL;
 
+	zram_reset_backing_dev(zram);
+
 	/* Reset stats */
-	memset(&zram->stats, 0, sizeof(zram->stats));
+	zram_stat_reset(zram);
 
 	zram_set_disksize(zram, zram_default_disksize_bytes());
 }
 
 void zram_reset_device(struct zram *zram)
 {
+	zram_flush_writes(zram);
 	down_write(&zram->init_lock);
 	__zram_reset_device(zram);
 	up_write(&zram->init_lock);
@@ -669,6 +1460,7 @@ int zram_init_device(struct zram *zram)
 {
 	int ret;
 	size_t num_pages;
+	struct zram_comp_stream *strm;
 
 	down_write(&zram->init_lock);
 
@@ -677,20 +1469,15 @@ int zram_init_device(struct zram *zram)
 		return 0;
 	}
 
-	zram->compress_workmem = kzalloc(WMSIZE, GFP_KERNEL);
-	if (!zram->compress_workmem) {
-		pr_err("Error allocating compressor working memory!\n");
-		ret = -ENOMEM;
-		goto fail_no_table;
-	}
-
-	zram->compress_buffer =
-		(void *)__get_free_pages(GFP_KERNEL | __GFP_ZERO, 1);
-	if (!zram->compress_buffer) {
-		pr_err("Error allocating compressor buffer space\n");
+	/* Further streams are created on demand, up to max_comp_streams */
+	strm = zram_stream_alloc(zram, GFP_KERNEL);
+	if (!strm) {
+		pr_err("Error allocating compression stream\n");
 		ret = -ENOMEM;
 		goto fail_no_table;
 	}
+	zram->avail_strm = 1;
+	list_add(&strm->list, &zram->idle_strm);
 
 	num_pages = zram->disksize >> PAGE_SHIFT;
 	zram->table = vzalloc(num_pages * sizeof(*zram->table));
@@ -700,10 +1487,23 @@ int zram_init_device(struct zram *zram)
 		goto fail_no_table;
 	}
 
+	if (zram->dedup) {
+		zram->dedup_bits = ilog2(num_pages ?: 1);
+		zram->dedup_bits = zram->dedup_bits > 8 ?
+					zram->dedup_bits - 2 : 6;
+		zram->dedup_table = vzalloc(sizeof(*zram->dedup_table) <<
+					    zram->dedup_bits);
+		if (!zram->dedup_table) {
+			pr_err("Error allocating dedup table\n");
+			ret = -ENOMEM;
+			goto fail;
+		}
+	}
+
 	/* zram devices sort of resembles non-rotational disks */
 	queue_flag_set_unlocked(QUEUE_FLAG_NONROT, zram->disk->queue);
 
-	zram->mem_pool = xv_create_pool();
+	zram->mem_pool = zram->mem_ops->create_pool();
 	if (!zram->mem_pool) {
 		pr_err("Error creating memory pool\n");
 		ret = -ENOMEM;
@@ -726,14 +1526,331 @@ fail:
 	return ret;
 }
 
+/*
+ * Move the object of a table entry out of a page isolated for
+ * compaction. Called with zram->lock held for write, so only a
+ * swap slot free notification may change the entry meanwhile.
+ */
+static void zram_move_object(struct zram *zram, u32 index)
+{
+	u32 offset, size, newoffset;
+	struct page *page, *newpage;
+	unsigned char *src, *dst;
+
+	spin_lock(&zram->slot_lock);
+	page = zram->table[index].page;
+	if (!page || zram_test_flag(zram, index, ZRAM_UNCOMPRESSED) ||
+	    zram_test_flag(zram, index, ZRAM_WB)) {
+		spin_unlock(&zram->slot_lock);
+		return;
+	}
+	page = zram_get_obj(zram, index, &offset, &size);
+	spin_unlock(&zram->slot_lock);
+
+	if (!zram->mem_ops->page_isolated(page))
+		return;
+
+	if (zram->mem_ops->malloc(zram->mem_pool, size, &newpage, &newoffset,
+				  GFP_NOIO | __GFP_HIGHMEM))
+		return;
+
+	spin_lock(&zram->slot_lock);
+	if (unlikely(!zram->table[index].page ||
+		     zram_test_flag(zram, index, ZRAM_WB) ||
+		     zram_get_obj(zram, index, &offset, &size) != page)) {
+		spin_unlock(&zram->slot_lock);
+		zram->mem_ops->free(zram->mem_pool, newpage, newoffset);
+		return;
+	}
+
+	src = kmap_atomic(page, KM_USER0);
+	dst = kmap_atomic(newpage, KM_USER1);
+	memcpy(dst + newoffset, src + offset, size);
+	kunmap_atomic(dst, KM_USER1);
+	kunmap_atomic(src, KM_USER0);
+
+	if (zram_test_flag(zram, index, ZRAM_DEDUP)) {
+		zram->table[index].entry->page = newpage;
+		zram->table[index].entry->offset = newoffset;
+	} else {
+		zram->table[index].page = newpage;
+		zram->table[index].offset = newoffset;
+	}
+	zram->mem_ops->free(zram->mem_pool, page, offset);
+	spin_unlock(&zram->slot_lock);
+}
+
+void zram_compact(struct zram *zram)
+{
+	size_t index;
+	unsigned long compacted;
+	const struct zram_mem_ops *ops = zram->mem_ops;
+
+	if (!ops->begin_compact)
+		return;
+
+	down_write(&zram->lock);
+	if (ops->begin_compact(zram->mem_pool)) {
+		for (index = 0; index < zram->disksize >> PAGE_SHIFT; index++)
+			zram_move_object(zram, index);
+	}
+	compacted = ops->end_compact(zram->mem_pool);
+	up_write(&zram->lock);
+
+	zram_stat_add(zram, ZRAM_STAT_PAGES_COMPACTED, compacted);
+	pr_debug("Compaction released %lu pages\n", compacted);
+}
+
+/* Called with init_lock held for write, before the device is initialized */
+int zram_set_backing_dev(struct zram *zram, const char *path)
+{
+	int ret;
+	struct block_device *bdev;
+	unsigned long nr_blocks, *bitmap;
+	char *name;
+
+	zram_reset_backing_dev(zram);
+	if (!strcmp(path, "none"))
+		return 0;
+
+	name = kstrdup(path, GFP_KERNEL);
+	if (!name)
+		return -ENOMEM;
+
+	bdev = open_bdev_exclusive(name, FMODE_READ | FMODE_WRITE, zram);
+	if (IS_ERR(bdev)) {
+		pr_info("Cannot open backing device %s\n", name);
+		kfree(name);
+		return PTR_ERR(bdev);
+	}
+
+	nr_blocks = i_size_read(bdev->bd_inode) >> PAGE_SHIFT;
+	bitmap = vzalloc(BITS_TO_LONGS(nr_blocks) * sizeof(long));
+	if (nr_blocks < 2 || !bitmap) {
+		ret = nr_blocks < 2 ? -EINVAL : -ENOMEM;
+		vfree(bitmap);
+		close_bdev_exclusive(bdev, FMODE_READ | FMODE_WRITE);
+		kfree(name);
+		return ret;
+	}
+
+	/* Block 0 is reserved, table[].block == 0 is not a valid slot */
+	set_bit(0, bitmap);
+
+	zram->backing_bdev = bdev;
+	zram->backing_path = name;
+	zram->bd_bitmap = bitmap;
+	zram->bd_nr_blocks = nr_blocks;
+	zram->bd_next = 1;
+	zram->bd_batch = min_t(int, ZRAM_WB_BATCH,
+		queue_max_sectors(bdev_get_queue(bdev)) >>
+			SECTORS_PER_PAGE_SHIFT);
+	if (zram->bd_batch < 1)
+		zram->bd_batch = 1;
+
+	pr_info("Using %s for writeback, %lu pages\n", name, nr_blocks - 1);
+
+	return 0;
+}
+
+void zram_mark_idle(struct zram *zram)
+{
+	size_t index;
+
+	down_write(&zram->lock);
+	for (index = 0; index < zram->disksize >> PAGE_SHIFT; index++) {
+		spin_lock(&zram->slot_lock);
+		if (zram->table[index].page &&
+		    !zram_test_flag(zram, index, ZRAM_WB))
+			zram_set_flag(zram, index, ZRAM_IDLE);
+		spin_unlock(&zram->slot_lock);
+	}
+	up_write(&zram->lock);
+}
+
+/*
+ * Copy the data of a slot matching mode into page and flag it
+ * ZRAM_UNDER_WB. Anything freeing the slot clears that flag again.
+ */
+static int zram_wb_prepare(struct zram *zram, u32 index, int mode,
+			struct page *page)
+{
+	int ret = 0;
+	size_t clen = PAGE_SIZE;
+	unsigned char *src, *dst;
+
+	down_write(&zram->lock);
+	spin_lock(&zram->slot_lock);
+
+	if (!zram->table[index].page ||
+	    zram_test_flag(zram, index, ZRAM_WB) ||
+	    zram_test_flag(zram, index, ZRAM_DEDUP))
+		goto out;
+
+	if (!((mode & ZRAM_WB_HUGE) &&
+	      zram_test_flag(zram, index, ZRAM_UNCOMPRESSED)) &&
+	    !((mode & ZRAM_WB_IDLE) &&
+	      zram_test_flag(zram, index, ZRAM_IDLE)))
+		goto out;
+
+	dst = kmap_atomic(page, KM_USER0);
+	src = kmap_atomic(zram->table[index].page, KM_USER1) +
+		zram->table[index].offset;
+
+	if (zram_test_flag(zram, index, ZRAM_UNCOMPRESSED))
+		memcpy(dst, src, PAGE_SIZE);
+	else
+		ret = zram_decompress(zram,
+			src + sizeof(struct zobj_header),
+			zram->table[index].size - sizeof(struct zobj_header),
+			dst, &clen);
+
+	kunmap_atomic(src, KM_USER1);
+	kunmap_atomic(dst, KM_USER0);
+
+	if (unlikely(ret)) {
+		pr_err("Decompression failed! err=%d, page=%u\n", ret, index);
+		ret = 0;
+		goto out;
+	}
+
+	zram_set_flag(zram, index, ZRAM_UNDER_WB);
+	ret = 1;
+
+out:
+	spin_unlock(&zram->slot_lock);
+	up_write(&zram->lock);
+
+	return ret;
+}
+
+/*
+ * Write out a batch prepared by zram_wb_prepare() to consecutive
+ * blocks and release the memory of slots that were not freed or
+ * rewritten meanwhile.
+ */
+static int zram_wb_flush(struct zram *zram, struct page **pages, u32 *idx,
+			int n)
+{
+	int i, nr, done = 0, ret = 0;
+	unsigned long blk;
+
+	while (done < n) {
+		nr = n - done;
+		blk = zram_bd_alloc(zram, &nr);
+		if (!blk) {
+			ret = -ENOSPC;
+			break;
+		}
+
+		ret = zram_bd_rw(zram, pages + done, nr, blk, WRITE);
+		if (ret) {
+			zram_bd_free(zram, blk, nr);
+			break;
+		}
+
+		down_write(&zram->lock);
+		for (i = 0; i < nr; i++) {
+			u32 index = idx[done + i];
+
+			spin_lock(&zram->slot_lock);
+			if (!zram_test_flag(zram, index, ZRAM_UNDER_WB)) {
+				spin_unlock(&zram->slot_lock);
+				zram_bd_free(zram, blk + i, 1);
+				continue;
+			}
+
+			zram_free_page(zram, index);
+			zram->table[index].block = blk + i;
+			zram_set_flag(zram, index, ZRAM_WB);
+			zram_stat_inc(zram, ZRAM_STAT_PAGES_STORED);
+			zram_stat_inc(zram, ZRAM_STAT_BD_COUNT);
+			spin_unlock(&zram->slot_lock);
+		}
+		up_write(&zram->lock);
+
+		done += nr;
+	}
+
+	if (done < n) {
+		down_write(&zram->lock);
+		spin_lock(&zram->slot_lock);
+		for (i = done; i < n; i++)
+			zram_clear_flag(zram, idx[i], ZRAM_UNDER_WB);
+		spin_unlock(&zram->slot_lock);
+		up_write(&zram->lock);
+	}
+
+	return ret;
+}
+
+/*
+ * Move incompressible (ZRAM_WB_HUGE) and/or idle (ZRAM_WB_IDLE) pages
+ * to the backing device, in batches of up to bd_batch pages written
+ * to consecutive blocks.
+ */
+int zram_writeback(struct zram *zram, int mode)
+{
+	int i, n = 0, ret = 0;
+	size_t index;
+	u32 idx[ZRAM_WB_BATCH];
+	struct page *pages[ZRAM_WB_BATCH];
+
+	if (!zram->backing_bdev)
+		return -ENODEV;
+
+	mutex_lock(&zram->wb_mutex);
+
+	memset(pages, 0, sizeof(pages));
+	for (i = 0; i < zram->bd_batch; i++) {
+		pages[i] = alloc_page(GFP_KERNEL);
+		if (!pages[i]) {
+			ret = -ENOMEM;
+			goto out;
+		}
+	}
+
+	for (index = 0; index < zram->disksize >> PAGE_SHIFT; index++) {
+		/* Unlocked peek, zram_wb_prepare() checks again */
+		if (!zram->table[index].page ||
+		    zram_test_flag(zram, index, ZRAM_WB))
+			continue;
+
+		if (!zram_wb_prepare(zram, index, mode, pages[n]))
+			continue;
+
+		idx[n++] = index;
+		if (n == zram->bd_batch) {
+			ret = zram_wb_flush(zram, pages, idx, n);
+			n = 0;
+			if (ret)
+				break;
+		}
+	}
+
+	if (n)
+		ret = zram_wb_flush(zram, pages, idx, n);
+
+out:
+	for (i = 0; i < zram->bd_batch; i++) {
+		if (pages[i])
+			__free_page(pages[i]);
+	}
+	mutex_unlock(&zram->wb_mutex);
+
+	return ret;
+}
+
 static void zram_slot_free_notify(struct block_device *bdev,
 				unsigned long index)
 {
 	struct zram *zram;
 
 	zram = bdev->bd_disk->private_data;
+	spin_lock(&zram->slot_lock);
 	zram_free_page(zram, index);
-	zram_stat64_inc(zram, &zram->stats.notify_free);
+	spin_unlock(&zram->slot_lock);
+	zram_stat_inc(zram, ZRAM_STAT_NOTIFY_FREE);
 }
 
 static const struct block_device_operations zram_devops = {
@@ -747,12 +1864,37 @@ static int create_device(struct zram *zram, int device_id)
 
 	init_rwsem(&zram->lock);
 	init_rwsem(&zram->init_lock);
-	spin_lock_init(&zram->stat64_lock);
+	spin_lock_init(&zram->slot_lock);
+
+	zram->mem_ops = zram_default_mem_ops;
+	zram->comp = zram_default_comp_ops;
+	spin_lock_init(&zram->dedup_lock);
+	spin_lock_init(&zram->strm_lock);
+	INIT_LIST_HEAD(&zram->idle_strm);
+	init_waitqueue_head(&zram->strm_wait);
+	zram->max_strm = 1;
+	spin_lock_init(&zram->bd_lock);
+	mutex_init(&zram->wb_mutex);
+	spin_lock_init(&zram->write_lock);
+	bio_list_init(&zram->write_list);
+	INIT_WORK(&zram->write_work, zram_write_work);
+	bio_list_init(&zram->bd_list);
+	INIT_WORK(&zram->bd_work, zram_bd_work);
+#ifdef CONFIG_ZRAM_DEFAULT_DEDUP
+	zram->dedup = 1;
+#endif
+	zram->stats = alloc_percpu(struct zram_stats_cpu);
+	if (!zram->stats) {
+		pr_err("Error allocating stats for device %d\n", device_id);
+		ret = -ENOMEM;
+		goto out;
+	}
 
 	zram->queue = blk_alloc_queue(GFP_KERNEL);
 	if (!zram->queue) {
 		pr_err("Error allocating disk queue for device %d\n",
 			device_id);
+		free_percpu(zram->stats);
 		ret = -ENOMEM;
 		goto out;
 	}
@@ -764,6 +1906,7 @@ static int create_device(struct zram *zram, int device_id)
 	zram->disk = alloc_disk(1);
 	if (!zram->disk) {
 		blk_cleanup_queue(zram->queue);
+		free_percpu(zram->stats);
 		pr_warning("Error allocating disk structure for device %d\n",
 			device_id);
 		ret = -ENOMEM;
@@ -841,11 +1984,23 @@ static int __init zram_init(void)
 		goto out;
 	}
 
+	zram_dedup_cache = KMEM_CACHE(zram_dedup_entry, 0);
+	if (!zram_dedup_cache) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	zram_wq = create_singlethread_workqueue("zram");
+	if (!zram_wq) {
+		ret = -ENOMEM;
+		goto free_cache;
+	}
+
 	zram_major = register_blkdev(0, "zram");
 	if (zram_major <= 0) {
 		pr_warning("Unable to get major number\n");
 		ret = -EBUSY;
-		goto out;
+		goto destroy_wq;
 	}
 
 	/* Allocate the device array and initialize each one */
@@ -867,11 +2022,17 @@ static int __init zram_init(void)
 	return 0;
 
 free_devices:
-	while (dev_id)
+	while (dev_id) {
 		destroy_device(&zram_devices[--dev_id]);
+		free_percpu(zram_devices[dev_id].stats);
+	}
 	kfree(zram_devices);
 unregister:
 	unregister_blkdev(zram_major, "zram");
+destroy_wq:
+	destroy_workqueue(zram_wq);
+free_cache:
+	kmem_cache_destroy(zram_dedup_cache);
 out:
 	return ret;
 }
@@ -887,11 +2048,17 @@ static void __exit zram_exit(void)
 		destroy_device(zram);
 		if (zram->init_done)
 			zram_reset_device(zram);
+		else
+			zram_reset_backing_dev(zram);
+		/* The reset above still clears the stats */
+		free_percpu(zram->stats);
 	}
 
 	unregister_blkdev(zram_major, "zram");
 
 	kfree(zram_devices);
+	destroy_workqueue(zram_wq);
+	kmem_cache_destroy(zram_dedup_cache);
 	pr_debug("Cleanup done!\n");
 }
 
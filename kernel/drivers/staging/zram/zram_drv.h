@@ -17,8 +17,13 @@
 
 #include <linux/spinlock.h>
 #include <linux/mutex.h>
+#include <linux/seqlock.h>
+#include <linux/bio.h>
+#include <linux/wait.h>
+#include <linux/workqueue.h>
 
 #include "xvmalloc.h"
+#include "zsmalloc.h"
 
 /*
  * Some arbitrary value. This is just to catch
@@ -53,8 +58,27 @@ static const size_t max_zpage_size = PAGE_SIZE / 4 * 3;
  * NOTE: max_zpage_size must be less than or equal to:
  *   XV_MAX_ALLOC_SIZE - sizeof(struct zobj_header)
  * otherwise, xv_malloc() would always return failure.
+ * The same holds for ZS_MAX_ALLOC_SIZE and zs_malloc().
  */
 
+/*
+ * With comp_skip set, at most this many (1 << ZRAM_SKIP_MAX_SHIFT) - 1
+ * pages following an incompressible one are stored without trying.
+ */
+#define ZRAM_SKIP_MAX_SHIFT	5
+
+/*
+ * With more than one compression stream, up to this many write
+ * requests per device are queued for compression in the background.
+ */
+static const unsigned max_queued_writes = 16;
+
+/* Upper bound for max_comp_streams, each stream takes three pages */
+static const unsigned max_comp_streams = 8;
+
+/* Pages written to the backing device with a single request, at most */
+#define ZRAM_WB_BATCH		32
+
 /*-- End of configurable params */
 
 #define SECTOR_SHIFT		9
@@ -74,41 +98,151 @@ enum zram_pageflags {
 	/* Page consists entirely of zeros */
 	ZRAM_ZERO,
 
+	/* Page shares an object with others, table[].entry is valid */
+	ZRAM_DEDUP,
+
+	/* Page is on the backing device, table[].block is valid */
+	ZRAM_WB,
+
+	/* Page was not accessed since it was last marked idle */
+	ZRAM_IDLE,
+
+	/* Page is being copied to the backing device */
+	ZRAM_UNDER_WB,
+
 	__NR_ZRAM_PAGEFLAGS,
 };
 
 /*-- Data structures */
 
+/* Allocated for each distinct compressed object when dedup is enabled */
+struct zram_dedup_entry {
+	struct hlist_node node;
+	u32 checksum;
+	u32 refcount;
+	struct page *page;
+	u16 offset;
+	u16 size;
+};
+
 /* Allocated for each disk page */
 struct table {
-	struct page *page;
+	union {
+		struct page *page;
+		struct zram_dedup_entry *entry;	/* ZRAM_DEDUP */
+		unsigned long block;		/* ZRAM_WB, never 0 */
+	};
 	u16 offset;
+	u16 size;	/* object size, including zobj_header */
 	u8 count;	/* object ref count (not yet used) */
 	u8 flags;
 } __attribute__((aligned(4)));
 
-struct zram_stats {
-	u64 compr_size;		/* compressed size of pages stored */
-	u64 num_reads;		/* failed + successful */
-	u64 num_writes;		/* --do-- */
-	u64 failed_reads;	/* should NEVER! happen */
-	u64 failed_writes;	/* can happen when memory is too low */
-	u64 invalid_io;		/* non-page-aligned I/O requests */
-	u64 notify_free;	/* no. of swap slot free notifications */
-	u32 pages_zero;		/* no. of zero filled pages */
-	u32 pages_stored;	/* no. of pages currently stored */
-	u32 good_compress;	/* % of pages with compression ratio<=50% */
-	u32 pages_expand;	/* % of incompressible pages */
+enum zram_stats_index {
+	ZRAM_STAT_COMPR_SIZE,	/* compressed size of pages stored */
+	ZRAM_STAT_NUM_READS,	/* failed + successful */
+	ZRAM_STAT_NUM_WRITES,	/* --do-- */
+	ZRAM_STAT_FAILED_READS,	/* should NEVER! happen */
+	ZRAM_STAT_FAILED_WRITES,	/* can happen when memory is too low */
+	ZRAM_STAT_INVALID_IO,	/* non-page-aligned I/O requests */
+	ZRAM_STAT_NOTIFY_FREE,	/* no. of swap slot free notifications */
+	ZRAM_STAT_PAGES_ZERO,	/* no. of zero filled pages */
+	ZRAM_STAT_PAGES_STORED,	/* no. of pages currently stored */
+	ZRAM_STAT_GOOD_COMPRESS,	/* no. of pages with compression ratio<=50% */
+	ZRAM_STAT_PAGES_EXPAND,	/* no. of incompressible pages */
+	ZRAM_STAT_PAGES_COMPACTED,	/* pool pages released by compaction */
+	ZRAM_STAT_PAGES_DUP,	/* no. of pages sharing another's object */
+	ZRAM_STAT_COMP_PAGES,	/* no. of pages run through compressor */
+	ZRAM_STAT_COMP_OUT,	/* compressor output bytes */
+	ZRAM_STAT_COMP_NS,	/* time spent compressing */
+	ZRAM_STAT_COMP_SKIPPED,	/* pages stored as-is without trying */
+	ZRAM_STAT_DECOMP_PAGES,
+	ZRAM_STAT_DECOMP_NS,
+	ZRAM_STAT_BD_COUNT,	/* no. of pages on the backing device */
+	ZRAM_STAT_BD_READS,
+	ZRAM_STAT_BD_WRITES,
+	ZRAM_STAT_NSTATS,
+};
+
+/*
+ * Updated by the local CPU only and summed up when read from sysfs.
+ * Single counters may go negative, only their sum is meaningful.
+ */
+struct zram_stats_cpu {
+	s64 count[ZRAM_STAT_NSTATS];
+	seqcount_t syncp;	/* 64-bit reads on 32-bit */
+};
+
+/* Backend allocator for compressed objects */
+struct zram_mem_ops {
+	const char *name;
+	void *(*create_pool)(void);
+	void (*destroy_pool)(void *pool);
+	int (*malloc)(void *pool, u32 size, struct page **page,
+			u32 *offset, gfp_t flags);
+	void (*free)(void *pool, struct page *page, u32 offset);
+	u64 (*total_size)(void *pool);
+	/* Optional, see zs_begin_compact() */
+	int (*begin_compact)(void *pool);
+	int (*page_isolated)(struct page *page);
+	unsigned long (*end_compact)(void *pool);
+};
+
+/* Compression algorithm */
+struct zram_comp_ops {
+	const char *name;
+	size_t wmsize;		/* compressor working memory */
+	int (*compress)(const unsigned char *src, size_t src_len,
+			unsigned char *dst, size_t *dst_len, void *wmem);
+	int (*decompress)(const unsigned char *src, size_t src_len,
+			unsigned char *dst, size_t *dst_len);
+};
+
+/* Compressor working memory and output buffer for one writer */
+struct zram_comp_stream {
+	void *workmem;
+	void *buffer;
+	struct list_head list;
 };
 
 struct zram {
-	struct xv_pool *mem_pool;
-	void *compress_workmem;
-	void *compress_buffer;
+	const struct zram_mem_ops *mem_ops;
+	const struct zram_comp_ops *comp;
+	void *mem_pool;
 	struct table *table;
-	spinlock_t stat64_lock;	/* protect 64-bit stats */
-	struct rw_semaphore lock; /* protect compression buffers and table
-				   * against concurrent read and writes */
+	struct zram_stats_cpu *stats;	/* percpu */
+	struct rw_semaphore lock; /* protect table against concurrent read
+				   * and writes */
+	spinlock_t strm_lock;	/* protect idle_strm and stream counts */
+	struct list_head idle_strm;
+	wait_queue_head_t strm_wait;
+	int avail_strm;		/* streams allocated */
+	int max_strm;		/* max_comp_streams */
+	spinlock_t write_lock;	/* protect write_list and bd_list */
+	struct bio_list write_list;	/* writes queued for compression */
+	unsigned queued_writes;
+	struct work_struct write_work;
+	struct bio_list bd_list;	/* bios that read the backing device */
+	struct work_struct bd_work;
+	/* Backing device for writeback, set before init */
+	struct block_device *backing_bdev;
+	char *backing_path;
+	unsigned long *bd_bitmap;	/* blocks in use, block 0 is reserved */
+	unsigned long bd_nr_blocks;
+	unsigned long bd_next;	/* where to look for free blocks next */
+	int bd_batch;		/* pages per request */
+	spinlock_t bd_lock;	/* protect bd_bitmap */
+	struct mutex wb_mutex;	/* serialize writeback runs */
+	spinlock_t slot_lock;	/* protect objects moved by compaction against
+				 * swap slot free notifications and dedup
+				 * lookups; taken before dedup_lock */
+	int dedup;		/* merge identical pages, set before init */
+	u32 dedup_bits;
+	struct hlist_head *dedup_table;
+	spinlock_t dedup_lock;	/* protect dedup_table and refcounts */
+	int comp_skip;		/* skip compressing after incompressible pages */
+	atomic_t incompressible_run;
+	atomic_t skip_left;
 	struct request_queue *queue;
 	struct gendisk *disk;
 	int init_done;
@@ -119,8 +253,6 @@ struct zram {
 	 * we can store in a disk.
 	 */
 	u64 disksize;	/* bytes */
-
-	struct zram_stats stats;
 };
 
 extern struct zram *zram_devices;
@@ -131,5 +263,18 @@ extern struct attribute_group zram_disk_attr_group;
 
 extern int zram_init_device(struct zram *zram);
 extern void __zram_reset_device(struct zram *zram);
+extern void zram_compact(struct zram *zram);
+extern void zram_set_max_streams(struct zram *zram, int max);
+extern void zram_flush_writes(struct zram *zram);
+extern int zram_set_backing_dev(struct zram *zram, const char *path);
+extern void zram_mark_idle(struct zram *zram);
+extern int zram_writeback(struct zram *zram, int mode);
+
+/* zram_writeback() modes */
+#define ZRAM_WB_HUGE	(1 << 0)	/* incompressible pages */
+#define ZRAM_WB_IDLE	(1 << 1)	/* pages marked idle */
+extern const struct zram_mem_ops *zram_find_mem_ops(const char *name);
+extern const struct zram_comp_ops *zram_find_comp_ops(const char *name);
+extern ssize_t zram_show_comp_ops(struct zram *zram, char *buf);
 
 #endif
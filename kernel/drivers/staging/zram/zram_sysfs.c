@@ -18,15 +18,26 @@
 
 #include "zram_drv.h"
 
-static u64 zram_stat64_read(struct zram *zram, u64 *v)
+/* Fold the per-cpu counters of a stat */
+static u64 zram_stat_read(struct zram *zram, enum zram_stats_index idx)
 {
-	u64 val;
+	int cpu;
+	s64 val = 0;
 
-	spin_lock(&zram->stat64_lock);
-	val = *v;
-	spin_unlock(&zram->stat64_lock);
+	for_each_possible_cpu(cpu) {
+		unsigned int start;
+		s64 v;
+		struct zram_stats_cpu *stats = per_cpu_ptr(zram->stats, cpu);
 
-	return val;
+		do {
+			start = read_seqcount_begin(&stats->syncp);
+			v = stats->count[idx];
+		} while (read_seqcount_retry(&stats->syncp, start));
+
+		val += v;
+	}
+
+	return val < 0 ? 0 : val;
 }
 
 static struct zram *dev_to_zram(struct device *dev)
@@ -109,6 +120,7 @@ static ssize_t reset_store(struct device *dev,
 	/* Make sure all pending I/O is finished */
 	if (bdev)
 		fsync_bdev(bdev);
+	zram_flush_writes(zram);
 
 	down_write(&zram->init_lock);
 	if (zram->init_done)
@@ -124,7 +136,7 @@ static ssize_t num_reads_show(struct device *dev,
 	struct zram *zram = dev_to_zram(dev);
 
 	return sprintf(buf, "%llu\n",
-		zram_stat64_read(zram, &zram->stats.num_reads));
+		zram_stat_read(zram, ZRAM_STAT_NUM_READS));
 }
 
 static ssize_t num_writes_show(struct device *dev,
@@ -133,7 +145,7 @@ static ssize_t num_writes_show(struct device *dev,
 	struct zram *zram = dev_to_zram(dev);
 
 	return sprintf(buf, "%llu\n",
-		zram_stat64_read(zram, &zram->stats.num_writes));
+		zram_stat_read(zram, ZRAM_STAT_NUM_WRITES));
 }
 
 static ssize_t invalid_io_show(struct device *dev,
@@ -142,7 +154,7 @@ static ssize_t invalid_io_show(struct device *dev,
 	struct zram *zram = dev_to_zram(dev);
 
 	return sprintf(buf, "%llu\n",
-		zram_stat64_read(zram, &zram->stats.invalid_io));
+		zram_stat_read(zram, ZRAM_STAT_INVALID_IO));
 }
 
 static ssize_t notify_free_show(struct device *dev,
@@ -151,7 +163,7 @@ static ssize_t notify_free_show(struct device *dev,
 	struct zram *zram = dev_to_zram(dev);
 
 	return sprintf(buf, "%llu\n",
-		zram_stat64_read(zram, &zram->stats.notify_free));
+		zram_stat_read(zram, ZRAM_STAT_NOTIFY_FREE));
 }
 
 static ssize_t zero_pages_show(struct device *dev,
@@ -159,7 +171,8 @@ static ssize_t zero_pages_show(struct device *dev,
 {
 	struct zram *zram = dev_to_zram(dev);
 
-	return sprintf(buf, "%u\n", zram->stats.pages_zero);
+	return sprintf(buf, "%llu\n",
+		zram_stat_read(zram, ZRAM_STAT_PAGES_ZERO));
 }
 
 static ssize_t orig_data_size_show(struct device *dev,
@@ -168,7 +181,7 @@ static ssize_t orig_data_size_show(struct device *dev,
 	struct zram *zram = dev_to_zram(dev);
 
 	return sprintf(buf, "%llu\n",
-		(u64)(zram->stats.pages_stored) << PAGE_SHIFT);
+		zram_stat_read(zram, ZRAM_STAT_PAGES_STORED) << PAGE_SHIFT);
 }
 
 static ssize_t compr_data_size_show(struct device *dev,
@@ -177,7 +190,7 @@ static ssize_t compr_data_size_show(struct device *dev,
 	struct zram *zram = dev_to_zram(dev);
 
 	return sprintf(buf, "%llu\n",
-		zram_stat64_read(zram, &zram->stats.compr_size));
+		zram_stat_read(zram, ZRAM_STAT_COMPR_SIZE));
 }
 
 static ssize_t mem_used_total_show(struct device *dev,
@@ -187,13 +200,310 @@ static ssize_t mem_used_total_show(struct device *dev,
 	struct zram *zram = dev_to_zram(dev);
 
 	if (zram->init_done) {
-		val = xv_get_total_size_bytes(zram->mem_pool) +
-			((u64)(zram->stats.pages_expand) << PAGE_SHIFT);
+		val = zram->mem_ops->total_size(zram->mem_pool) +
+			(zram_stat_read(zram, ZRAM_STAT_PAGES_EXPAND)
+				<< PAGE_SHIFT);
 	}
 
 	return sprintf(buf, "%llu\n", val);
 }
 
+static ssize_t mem_allocator_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return sprintf(buf, "%s\n", zram->mem_ops->name);
+}
+
+static ssize_t mem_allocator_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	const struct zram_mem_ops *ops;
+	struct zram *zram = dev_to_zram(dev);
+
+	ops = zram_find_mem_ops(buf);
+	if (!ops)
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (zram->init_done) {
+		up_write(&zram->init_lock);
+		pr_info("Cannot change allocator for initialized device\n");
+		return -EBUSY;
+	}
+
+	zram->mem_ops = ops;
+	up_write(&zram->init_lock);
+
+	return len;
+}
+
+static ssize_t comp_algorithm_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return zram_show_comp_ops(zram, buf);
+}
+
+static ssize_t comp_algorithm_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	const struct zram_comp_ops *comp;
+	struct zram *zram = dev_to_zram(dev);
+
+	comp = zram_find_comp_ops(buf);
+	if (!comp)
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (zram->init_done) {
+		up_write(&zram->init_lock);
+		pr_info("Cannot change algorithm for initialized device\n");
+		return -EBUSY;
+	}
+
+	zram->comp = comp;
+	up_write(&zram->init_lock);
+
+	return len;
+}
+
+static ssize_t comp_skip_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return sprintf(buf, "%d\n", zram->comp_skip);
+}
+
+static ssize_t comp_skip_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	int ret;
+	unsigned long val;
+	struct zram *zram = dev_to_zram(dev);
+
+	ret = strict_strtoul(buf, 10, &val);
+	if (ret)
+		return ret;
+
+	zram->comp_skip = !!val;
+
+	return len;
+}
+
+/*
+ * <pages compressed> <output bytes> <compress ns> <pages skipped>
+ * <pages decompressed> <decompress ns>
+ */
+static ssize_t comp_stats_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return sprintf(buf, "%llu %llu %llu %llu %llu %llu\n",
+		zram_stat_read(zram, ZRAM_STAT_COMP_PAGES),
+		zram_stat_read(zram, ZRAM_STAT_COMP_OUT),
+		zram_stat_read(zram, ZRAM_STAT_COMP_NS),
+		zram_stat_read(zram, ZRAM_STAT_COMP_SKIPPED),
+		zram_stat_read(zram, ZRAM_STAT_DECOMP_PAGES),
+		zram_stat_read(zram, ZRAM_STAT_DECOMP_NS));
+}
+
+static ssize_t dedup_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return sprintf(buf, "%d\n", zram->dedup);
+}
+
+static ssize_t dedup_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	int ret;
+	unsigned long val;
+	struct zram *zram = dev_to_zram(dev);
+
+	ret = strict_strtoul(buf, 10, &val);
+	if (ret)
+		return ret;
+
+	down_write(&zram->init_lock);
+	if (zram->init_done) {
+		up_write(&zram->init_lock);
+		pr_info("Cannot change dedup for initialized device\n");
+		return -EBUSY;
+	}
+
+	zram->dedup = !!val;
+	up_write(&zram->init_lock);
+
+	return len;
+}
+
+static ssize_t dup_pages_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return sprintf(buf, "%llu\n",
+		zram_stat_read(zram, ZRAM_STAT_PAGES_DUP));
+}
+
+static ssize_t max_comp_streams_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return sprintf(buf, "%d\n", zram->max_strm);
+}
+
+static ssize_t max_comp_streams_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	int ret;
+	unsigned long num;
+	struct zram *zram = dev_to_zram(dev);
+
+	ret = strict_strtoul(buf, 10, &num);
+	if (ret)
+		return ret;
+
+	if (num < 1 || num > max_comp_streams)
+		return -EINVAL;
+
+	zram_set_max_streams(zram, num);
+
+	return len;
+}
+
+static ssize_t backing_dev_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	ssize_t ret;
+	struct zram *zram = dev_to_zram(dev);
+
+	down_read(&zram->init_lock);
+	ret = sprintf(buf, "%s\n",
+		zram->backing_path ? zram->backing_path : "none");
+	up_read(&zram->init_lock);
+
+	return ret;
+}
+
+static ssize_t backing_dev_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	int ret;
+	char path[64];
+	struct zram *zram = dev_to_zram(dev);
+
+	if (len >= sizeof(path))
+		return -EINVAL;
+	strlcpy(path, buf, sizeof(path));
+	strim(path);
+	if (!path[0])
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (zram->init_done) {
+		up_write(&zram->init_lock);
+		pr_info("Cannot change backing device for initialized device\n");
+		return -EBUSY;
+	}
+
+	ret = zram_set_backing_dev(zram, path);
+	up_write(&zram->init_lock);
+
+	return ret ? ret : len;
+}
+
+static ssize_t idle_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	if (!sysfs_streq(buf, "all"))
+		return -EINVAL;
+
+	down_read(&zram->init_lock);
+	if (!zram->init_done) {
+		up_read(&zram->init_lock);
+		return -EINVAL;
+	}
+
+	zram_mark_idle(zram);
+	up_read(&zram->init_lock);
+
+	return len;
+}
+
+static ssize_t writeback_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	int ret, mode;
+	struct zram *zram = dev_to_zram(dev);
+
+	if (sysfs_streq(buf, "idle"))
+		mode = ZRAM_WB_IDLE;
+	else if (sysfs_streq(buf, "huge"))
+		mode = ZRAM_WB_HUGE;
+	else
+		return -EINVAL;
+
+	down_read(&zram->init_lock);
+	if (!zram->init_done) {
+		up_read(&zram->init_lock);
+		return -EINVAL;
+	}
+
+	ret = zram_writeback(zram, mode);
+	up_read(&zram->init_lock);
+
+	return ret ? ret : len;
+}
+
+/* <pages on backing device> <pages read> <pages written> */
+static ssize_t bd_stat_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return sprintf(buf, "%llu %llu %llu\n",
+		zram_stat_read(zram, ZRAM_STAT_BD_COUNT),
+		zram_stat_read(zram, ZRAM_STAT_BD_READS),
+		zram_stat_read(zram, ZRAM_STAT_BD_WRITES));
+}
+
+static ssize_t compact_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	down_read(&zram->init_lock);
+	if (!zram->init_done) {
+		up_read(&zram->init_lock);
+		return -EINVAL;
+	}
+
+	zram_compact(zram);
+	up_read(&zram->init_lock);
+
+	return len;
+}
+
+static ssize_t pages_compacted_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return sprintf(buf, "%llu\n",
+		zram_stat_read(zram, ZRAM_STAT_PAGES_COMPACTED));
+}
+
 static DEVICE_ATTR(disksize, S_IRUGO | S_IWUSR,
 		disksize_show, disksize_store);
 static DEVICE_ATTR(initstate, S_IRUGO, initstate_show, NULL);
@@ -206,6 +516,24 @@ static DEVICE_ATTR(zero_pages, S_IRUGO, zero_pages_show, NULL);
 static DEVICE_ATTR(orig_data_size, S_IRUGO, orig_data_size_show, NULL);
 static DEVICE_ATTR(compr_data_size, S_IRUGO, compr_data_size_show, NULL);
 static DEVICE_ATTR(mem_used_total, S_IRUGO, mem_used_total_show, NULL);
+static DEVICE_ATTR(mem_allocator, S_IRUGO | S_IWUSR,
+		mem_allocator_show, mem_allocator_store);
+static DEVICE_ATTR(comp_algorithm, S_IRUGO | S_IWUSR,
+		comp_algorithm_show, comp_algorithm_store);
+static DEVICE_ATTR(comp_skip, S_IRUGO | S_IWUSR,
+		comp_skip_show, comp_skip_store);
+static DEVICE_ATTR(comp_stats, S_IRUGO, comp_stats_show, NULL);
+static DEVICE_ATTR(dedup, S_IRUGO | S_IWUSR, dedup_show, dedup_store);
+static DEVICE_ATTR(dup_pages, S_IRUGO, dup_pages_show, NULL);
+static DEVICE_ATTR(max_comp_streams, S_IRUGO | S_IWUSR,
+		max_comp_streams_show, max_comp_streams_store);
+static DEVICE_ATTR(compact, S_IWUSR, NULL, compact_store);
+static DEVICE_ATTR(pages_compacted, S_IRUGO, pages_compacted_show, NULL);
+static DEVICE_ATTR(backing_dev, S_IRUGO | S_IWUSR,
+		backing_dev_show, backing_dev_store);
+static DEVICE_ATTR(idle, S_IWUSR, NULL, idle_store);
+static DEVICE_ATTR(writeback, S_IWUSR, NULL, writeback_store);
+static DEVICE_ATTR(bd_stat, S_IRUGO, bd_stat_show, NULL);
 
 static struct attribute *zram_disk_attrs[] = {
 	&dev_attr_disksize.attr,
@@ -219,6 +547,19 @@ static struct attribute *zram_disk_attrs[] = {
 	&dev_attr_orig_data_size.attr,
 	&dev_attr_compr_data_size.attr,
 	&dev_attr_mem_used_total.attr,
+	&dev_attr_mem_allocator.attr,
+	&dev_attr_comp_algorithm.attr,
+	&dev_attr_comp_skip.attr,
+	&dev_attr_comp_stats.attr,
+	&dev_attr_dedup.attr,
+	&dev_attr_dup_pages.attr,
+	&dev_attr_max_comp_streams.attr,
+	&dev_attr_compact.attr,
+	&dev_attr_pages_compacted.attr,
+	&dev_attr_backing_dev.attr,
+	&dev_attr_idle.attr,
+	&dev_attr_writeback.attr,
+	&dev_attr_bd_stat.attr,
 	NULL,
 };
 
@@ -0,0 +1,390 @@
+/*
+ * zsmalloc size-class memory allocator
+ *
+ * This code is released using a dual license strategy: BSD/GPL
+ * You can choose the licence that better fits your requirements.
+ *
+ * Released under the terms of 3-clause BSD License
+ * Released under the terms of GNU General Public License Version 2.0
+ *
+ * Objects are rounded up to one of ZS_NR_CLASSES sizes and packed into
+ * pages dedicated to that size. Each class has its own lock, so unlike
+ * xvmalloc, allocations of different sizes do not serialize on a single
+ * pool lock, and freeing an object never has to merge neighbours.
+ */
+
+#ifdef CONFIG_ZRAM_DEBUG
+#define DEBUG
+#endif
+
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/errno.h>
+#include <linux/highmem.h>
+#include <linux/mm.h>
+#include <linux/slab.h>
+
+#include "zsmalloc.h"
+#include "zsmalloc_int.h"
+
+static u16 get_freelist(struct page *page)
+{
+	return page_private(page) & ZS_PRIV_FREE_MASK;
+}
+
+static void set_freelist(struct page *page, u16 offset)
+{
+	set_page_private(page, (page_private(page) & ~ZS_PRIV_FREE_MASK) |
+				offset);
+}
+
+static u32 get_class_index(struct page *page)
+{
+	return (page_private(page) >> ZS_PRIV_CLASS_SHIFT) &
+		ZS_PRIV_CLASS_MASK;
+}
+
+static int test_isolated(struct page *page)
+{
+	return !!(page_private(page) & ZS_PRIV_ISOLATED);
+}
+
+static void set_isolated(struct page *page)
+{
+	set_page_private(page, page_private(page) | ZS_PRIV_ISOLATED);
+}
+
+static void clear_isolated(struct page *page)
+{
+	set_page_private(page, page_private(page) & ~ZS_PRIV_ISOLATED);
+}
+
+static u32 get_size_index(u32 size)
+{
+	if (size < ZS_MIN_ALLOC_SIZE)
+		size = ZS_MIN_ALLOC_SIZE;
+	return DIV_ROUND_UP(size - ZS_MIN_ALLOC_SIZE, ZS_ALIGN);
+}
+
+/*
+ * Allocate a page for the given class and thread all of its objects
+ * on the page freelist. Called without the class lock.
+ */
+static struct page *alloc_class_page(struct size_class *class, gfp_t flags)
+{
+	u32 i, offset;
+	struct page *page;
+	unsigned char *base;
+
+	page = alloc_page(flags);
+	if (unlikely(!page))
+		return NULL;
+
+	base = kmap_atomic(page, KM_USER0);
+	for (i = 0, offset = 0; i < class->objs_per_page; i++) {
+		u16 next = offset + class->size;
+
+		if (i == class->objs_per_page - 1)
+			next = ZS_FREE_END;
+		*(u16 *)(base + offset) = next;
+		offset += class->size;
+	}
+	kunmap_atomic(base, KM_USER0);
+
+	set_page_private(page, class->index << ZS_PRIV_CLASS_SHIFT);
+	page->index = 0;
+	INIT_LIST_HEAD(&page->lru);
+
+	return page;
+}
+
+static void free_class_page(struct page *page)
+{
+	set_page_private(page, 0);
+	page->index = 0;
+	__free_page(page);
+}
+
+static void free_page_list(struct list_head *head)
+{
+	struct page *page, *tmp;
+
+	list_for_each_entry_safe(page, tmp, head, lru) {
+		list_del(&page->lru);
+		free_class_page(page);
+	}
+}
+
+/*
+ * Create a memory pool. Sets up the size classes, merging neighbours
+ * that would fit the same number of objects in a page.
+ */
+struct zs_pool *zs_create_pool(void)
+{
+	int i;
+	u32 ovhd_size;
+	struct zs_pool *pool;
+
+	BUILD_BUG_ON(ZS_NR_CLASSES > ZS_PRIV_CLASS_MASK + 1);
+
+	ovhd_size = roundup(sizeof(*pool), PAGE_SIZE);
+	pool = kzalloc(ovhd_size, GFP_KERNEL);
+	if (!pool)
+		return NULL;
+
+	for (i = ZS_NR_CLASSES - 1; i >= 0; i--) {
+		struct size_class *class = &pool->classes[i];
+		u32 size = ZS_MIN_ALLOC_SIZE + i * ZS_ALIGN;
+
+		if (i < ZS_NR_CLASSES - 1 &&
+		    PAGE_SIZE / size == pool->class[i + 1]->objs_per_page) {
+			pool->class[i] = pool->class[i + 1];
+			continue;
+		}
+
+		spin_lock_init(&class->lock);
+		class->size = size;
+		class->index = i;
+		class->objs_per_page = PAGE_SIZE / size;
+		INIT_LIST_HEAD(&class->partial);
+		INIT_LIST_HEAD(&class->full);
+		INIT_LIST_HEAD(&class->isolated);
+		pool->class[i] = class;
+	}
+
+	return pool;
+}
+EXPORT_SYMBOL_GPL(zs_create_pool);
+
+void zs_destroy_pool(struct zs_pool *pool)
+{
+	int i;
+
+	for (i = 0; i < ZS_NR_CLASSES; i++) {
+		struct size_class *class = pool->class[i];
+
+		if (class->index != i)
+			continue;
+
+		if (class->pages)
+			pr_debug("zsmalloc: class %u destroyed with %lu pages\n",
+				class->size, class->pages);
+		free_page_list(&class->partial);
+		free_page_list(&class->full);
+		free_page_list(&class->isolated);
+	}
+
+	kfree(pool);
+}
+EXPORT_SYMBOL_GPL(zs_destroy_pool);
+
+/**
+ * zs_malloc - Allocate block of given size from pool.
+ * @pool: pool to allocate from
+ * @size: size of block to allocate
+ * @page: page no. that holds the object
+ * @offset: location of object within page
+ *
+ * On success, <page, offset> identifies block allocated
+ * and 0 is returned. On failure, <page, offset> is set to
+ * 0 and -ENOMEM is returned.
+ *
+ * Allocation requests with size > ZS_MAX_ALLOC_SIZE will fail.
+ */
+int zs_malloc(struct zs_pool *pool, u32 size, struct page **page,
+		u32 *offset, gfp_t flags)
+{
+	u16 next;
+	unsigned char *base;
+	struct page *newpage = NULL;
+	struct size_class *class;
+
+	*page = NULL;
+	*offset = 0;
+
+	if (unlikely(!size || size > ZS_MAX_ALLOC_SIZE))
+		return -ENOMEM;
+
+	class = pool->class[get_size_index(size)];
+
+	spin_lock(&class->lock);
+	while (list_empty(&class->partial)) {
+		if (newpage) {
+			list_add(&newpage->lru, &class->partial);
+			class->pages++;
+			newpage = NULL;
+			break;
+		}
+
+		spin_unlock(&class->lock);
+		newpage = alloc_class_page(class, flags);
+		if (unlikely(!newpage))
+			return -ENOMEM;
+		spin_lock(&class->lock);
+	}
+
+	*page = list_first_entry(&class->partial, struct page, lru);
+	*offset = get_freelist(*page);
+
+	base = kmap_atomic(*page, KM_USER0);
+	next = *(u16 *)(base + *offset);
+	kunmap_atomic(base, KM_USER0);
+
+	set_freelist(*page, next);
+	(*page)->index++;
+	if (next == ZS_FREE_END)
+		list_move(&(*page)->lru, &class->full);
+	spin_unlock(&class->lock);
+
+	/* Someone else refilled the class while we were allocating */
+	if (newpage)
+		free_class_page(newpage);
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(zs_malloc);
+
+/*
+ * Free block identified with <page, offset>
+ */
+void zs_free(struct zs_pool *pool, struct page *page, u32 offset)
+{
+	int was_full;
+	unsigned char *base;
+	struct size_class *class;
+
+	class = &pool->classes[get_class_index(page)];
+
+	spin_lock(&class->lock);
+
+	BUG_ON(!page->index);
+
+	if (!--page->index) {
+		list_del(&page->lru);
+		class->pages--;
+		if (test_isolated(page))
+			class->compacted++;
+		spin_unlock(&class->lock);
+
+		free_class_page(page);
+		return;
+	}
+
+	was_full = get_freelist(page) == ZS_FREE_END;
+
+	base = kmap_atomic(page, KM_USER0);
+	*(u16 *)(base + offset) = get_freelist(page);
+	kunmap_atomic(base, KM_USER0);
+	set_freelist(page, offset);
+
+	if (was_full && !test_isolated(page))
+		list_move(&page->lru, &class->partial);
+
+	spin_unlock(&class->lock);
+}
+EXPORT_SYMBOL_GPL(zs_free);
+
+/*
+ * Returns total memory used by allocator (userdata + metadata)
+ */
+u64 zs_get_total_size_bytes(struct zs_pool *pool)
+{
+	int i;
+	u64 pages = 0;
+
+	for (i = 0; i < ZS_NR_CLASSES; i++) {
+		if (pool->class[i]->index == i)
+			pages += pool->class[i]->pages;
+	}
+
+	return pages << PAGE_SHIFT;
+}
+EXPORT_SYMBOL_GPL(zs_get_total_size_bytes);
+
+/*
+ * Start a compaction pass: in every class, take sparsely used pages
+ * off the partial list as long as the remaining partial pages have
+ * room for all of their objects. No new objects are placed in these
+ * pages until zs_end_compact().
+ *
+ * The caller then moves every object living in a page for which
+ * zs_page_isolated() is true (zs_malloc a new copy and zs_free the
+ * old one), which releases the isolated pages as they drain.
+ *
+ * Returns the number of pages isolated.
+ */
+int zs_begin_compact(struct zs_pool *pool)
+{
+	int i, isolated = 0;
+
+	for (i = 0; i < ZS_NR_CLASSES; i++) {
+		unsigned long room = 0, moving = 0;
+		struct size_class *class = pool->class[i];
+		struct page *page, *tmp;
+
+		if (class->index != i)
+			continue;
+
+		spin_lock(&class->lock);
+		list_for_each_entry(page, &class->partial, lru)
+			room += class->objs_per_page - page->index;
+
+		list_for_each_entry_safe(page, tmp, &class->partial, lru) {
+			unsigned long free = class->objs_per_page - page->index;
+
+			if (page->index * ZS_SPARSE_DIV > class->objs_per_page)
+				continue;
+			if (moving + page->index > room - free)
+				continue;
+
+			room -= free;
+			moving += page->index;
+			set_isolated(page);
+			list_move(&page->lru, &class->isolated);
+			isolated++;
+		}
+		spin_unlock(&class->lock);
+	}
+
+	return isolated;
+}
+EXPORT_SYMBOL_GPL(zs_begin_compact);
+
+int zs_page_isolated(struct page *page)
+{
+	return test_isolated(page);
+}
+EXPORT_SYMBOL_GPL(zs_page_isolated);
+
+/*
+ * Finish a compaction pass. Pages still holding objects go back on
+ * their class lists. Returns the number of pages released.
+ */
+unsigned long zs_end_compact(struct zs_pool *pool)
+{
+	int i;
+	unsigned long compacted = 0;
+
+	for (i = 0; i < ZS_NR_CLASSES; i++) {
+		struct size_class *class = pool->class[i];
+		struct page *page, *tmp;
+
+		if (class->index != i)
+			continue;
+
+		spin_lock(&class->lock);
+		list_for_each_entry_safe(page, tmp, &class->isolated, lru) {
+			clear_isolated(page);
+			if (get_freelist(page) == ZS_FREE_END)
+				list_move(&page->lru, &class->full);
+			else
+				list_move(&page->lru, &class->partial);
+		}
+		compacted += class->compacted;
+		class->compacted = 0;
+		spin_unlock(&class->lock);
+	}
+
+	return compacted;
+}
+EXPORT_SYMBOL_GPL(zs_end_compact);
@@ -0,0 +1,31 @@
+/*
+ * zsmalloc size-class memory allocator
+ *
+ * This code is released using a dual license strategy: BSD/GPL
+ * You can choose the licence that better fits your requirements.
+ *
+ * Released under the terms of 3-clause BSD License
+ * Released under the terms of GNU General Public License Version 2.0
+ */
+
+#ifndef _ZS_MALLOC_H_
+#define _ZS_MALLOC_H_
+
+#include <linux/types.h>
+
+struct zs_pool;
+
+struct zs_pool *zs_create_pool(void);
+void zs_destroy_pool(struct zs_pool *pool);
+
+int zs_malloc(struct zs_pool *pool, u32 size, struct page **page,
+			u32 *offset, gfp_t flags);
+void zs_free(struct zs_pool *pool, struct page *page, u32 offset);
+
+u64 zs_get_total_size_bytes(struct zs_pool *pool);
+
+int zs_begin_compact(struct zs_pool *pool);
+int zs_page_isolated(struct page *page);
+unsigned long zs_end_compact(struct zs_pool *pool);
+
+#endif
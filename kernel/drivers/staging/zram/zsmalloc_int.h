@@ -0,0 +1,75 @@
+/*
+ * zsmalloc size-class memory allocator
+ *
+ * This code is released using a dual license strategy: BSD/GPL
+ * You can choose the licence that better fits your requirements.
+ *
+ * Released under the terms of 3-clause BSD License
+ * Released under the terms of GNU General Public License Version 2.0
+ */
+
+#ifndef _ZS_MALLOC_INT_H_
+#define _ZS_MALLOC_INT_H_
+
+#include <linux/kernel.h>
+#include <linux/list.h>
+#include <linux/spinlock.h>
+#include <linux/types.h>
+
+/* User configurable params */
+
+/* Size classes are separated by ZS_ALIGN bytes. Must be power of two */
+#define ZS_ALIGN_SHIFT	4
+#define ZS_ALIGN	(1 << ZS_ALIGN_SHIFT)
+
+/* This must be at least sizeof(u16), free objects hold the freelist link */
+#define ZS_MIN_ALLOC_SIZE	32
+#define ZS_MAX_ALLOC_SIZE	PAGE_SIZE
+
+#define ZS_NR_CLASSES	((ZS_MAX_ALLOC_SIZE - ZS_MIN_ALLOC_SIZE) \
+				/ ZS_ALIGN + 1)
+
+/*
+ * Pages at most this full (in 1/ZS_SPARSE_DIV of their objects) are
+ * emptied by compaction when the rest of their class has room for them.
+ */
+#define ZS_SPARSE_DIV	2
+
+/* End of user params */
+
+/*
+ * Every page of the pool belongs to exactly one size class and holds
+ * PAGE_SIZE / size objects of that class. Per-page metadata lives in
+ * struct page itself:
+ *   page->lru	   - links the page on its class partial/full/isolated list
+ *   page->index   - number of objects in use
+ *   page->private - freelist head offset, class index and flags
+ */
+#define ZS_FREE_END		0xffff
+#define ZS_PRIV_FREE_MASK	0xffff
+#define ZS_PRIV_CLASS_SHIFT	16
+#define ZS_PRIV_CLASS_MASK	0xff
+#define ZS_PRIV_ISOLATED	(1UL << 24)
+
+struct size_class {
+	spinlock_t lock;
+	u16 size;		/* object size */
+	u16 index;		/* index of this class in pool->classes */
+	u16 objs_per_page;
+	struct list_head partial;	/* pages with free objects */
+	struct list_head full;
+	struct list_head isolated;	/* being emptied by compaction */
+	unsigned long pages;	/* stats */
+	unsigned long compacted;
+};
+
+struct zs_pool {
+	/*
+	 * Neighbouring sizes that fit the same number of objects in a page
+	 * share one size_class, class[i] points at the one serving index i.
+	 */
+	struct size_class *class[ZS_NR_CLASSES];
+	struct size_class classes[ZS_NR_CLASSES];
+};
+
+#endif
@@ -292,6 +292,8 @@ static int omapfb_update_window_nolock(struct fb_info *fbi,
 	if (x + w > dw || y + h > dh)
 		return -EINVAL;
 
+	omapfb_account_update(fbi, w, h);
+
 	return display->driver->update(display, x, y, w, h);
 }
 
@@ -661,6 +663,23 @@ int omapfb_ioctl(struct fb_info *fbi, unsigned int cmd, unsigned long arg)
 				p.uwnd.width, p.uwnd.height);
 		break;
 
+	case OMAPFB_MARK_DIRTY:
+		DBG("ioctl MARK_DIRTY\n");
+		if (!display || !display->driver->update) {
+			r = -EINVAL;
+			break;
+		}
+
+		if (copy_from_user(&p.uwnd, (void __user *)arg,
+					sizeof(p.uwnd))) {
+			r = -EFAULT;
+			break;
+		}
+
+		omapfb_damage_add(fbi, p.uwnd.x, p.uwnd.y,
+				p.uwnd.width, p.uwnd.height);
+		break;
+
 	case OMAPFB_SETUP_PLANE:
 		DBG("ioctl SETUP_PLANE\n");
 		if (copy_from_user(&p.plane_info, (void __user *)arg,
@@ -30,6 +30,8 @@
 #include <linux/platform_device.h>
 #include <linux/omapfb.h>
 #include <linux/console.h>
+#include <linux/file.h>
+#include <linux/math64.h>
 
 #include <plat/display.h>
 #include <plat/vram.h>
@@ -1231,8 +1233,10 @@ static int omapfb_pan_display(struct fb_var_screeninfo *var,
 
 	omapfb_put_mem_region(ofbi->region);
 
-	if (display && display->driver->update)
+	if (display && display->driver->update) {
+		omapfb_account_update(fbi, var->xres, var->yres);
 		display->driver->update(display, 0, 0, var->xres, var->yres);
+	}
 
 	return r;
 }
@@ -1260,6 +1264,229 @@ static struct vm_operations_struct mmap_user_ops = {
 	.close = mmap_user_close,
 };
 
+/* how long marked regions are collected before they are sent */
+#define OMAPFB_DAMAGE_DELAY_MS	16
+
+static void omapfb_damage_work(struct work_struct *work)
+{
+	struct omapfb_damage *d = container_of(work, struct omapfb_damage,
+			work.work);
+	struct omapfb_info *ofbi = container_of(d, struct omapfb_info, damage);
+	struct fb_info *fbi = ofbi->fbdev->fbs[ofbi->id];
+	struct file *file;
+	u16 x, y, w, h;
+
+	spin_lock_irq(&d->lock);
+	file = d->file;
+	if (file)
+		get_file(file);
+	spin_unlock_irq(&d->lock);
+
+	/*
+	 * Drop the user mappings before taking the rectangle: a write from
+	 * now on faults the page in again, and so ends up in the next one.
+	 */
+	if (file) {
+		unmap_mapping_range(file->f_mapping, 0, fbi->fix.smem_len, 1);
+		fput(file);
+	}
+
+	spin_lock_irq(&d->lock);
+	if (!d->dirty) {
+		spin_unlock_irq(&d->lock);
+		return;
+	}
+	x = d->x1;
+	y = d->y1;
+	w = d->x2 - d->x1;
+	h = d->y2 - d->y1;
+	d->dirty = false;
+	spin_unlock_irq(&d->lock);
+
+	DBG("damage update %d,%d %dx%d\n", x, y, w, h);
+
+	omapfb_update_window(fbi, x, y, w, h);
+}
+
+void omapfb_damage_add(struct fb_info *fbi, u32 x, u32 y, u32 w, u32 h)
+{
+	struct omapfb_damage *d = &FB2OFB(fbi)->damage;
+	unsigned long flags;
+	u32 x2, y2;
+
+	if (x >= fbi->var.xres || y >= fbi->var.yres || w == 0 || h == 0)
+		return;
+
+	x2 = min(x + w, fbi->var.xres);
+	y2 = min(y + h, fbi->var.yres);
+
+	spin_lock_irqsave(&d->lock, flags);
+	if (d->dirty) {
+		d->x1 = min_t(u32, d->x1, x);
+		d->y1 = min_t(u32, d->y1, y);
+		d->x2 = max_t(u32, d->x2, x2);
+		d->y2 = max_t(u32, d->y2, y2);
+	} else {
+		d->x1 = x;
+		d->y1 = y;
+		d->x2 = x2;
+		d->y2 = y2;
+		d->dirty = true;
+	}
+	spin_unlock_irqrestore(&d->lock, flags);
+
+	schedule_delayed_work(&d->work,
+			msecs_to_jiffies(OMAPFB_DAMAGE_DELAY_MS));
+}
+
+void omapfb_account_update(struct fb_info *fbi, u32 w, u32 h)
+{
+	struct omapfb_damage *d = &FB2OFB(fbi)->damage;
+	struct omap_dss_device *display = fb2display(fbi);
+	unsigned long flags;
+	unsigned long bytes;
+	int bpp;
+
+	bpp = display && display->ctrl.pixel_size ?
+		display->ctrl.pixel_size : fbi->var.bits_per_pixel;
+	bytes = w * h * bpp / 8;
+
+	spin_lock_irqsave(&d->lock, flags);
+	d->updates++;
+	d->bytes += bytes;
+	d->window_bytes += bytes;
+	if (time_after_eq(jiffies, d->window_start + HZ)) {
+		d->bytes_per_sec = div_u64((u64)d->window_bytes * HZ,
+				jiffies - d->window_start);
+		d->window_start = jiffies;
+		d->window_bytes = 0;
+	}
+	spin_unlock_irqrestore(&d->lock, flags);
+}
+
+/* bytes per second sent to the display, over about the last second */
+unsigned long omapfb_update_rate(struct omapfb_info *ofbi)
+{
+	struct omapfb_damage *d = &ofbi->damage;
+	unsigned long rate;
+
+	spin_lock_irq(&d->lock);
+	if (time_after(jiffies, d->window_start + 2 * HZ))
+		rate = div_u64((u64)d->window_bytes * HZ,
+				jiffies - d->window_start);
+	else
+		rate = d->bytes_per_sec;
+	spin_unlock_irq(&d->lock);
+
+	return rate;
+}
+
+static void omapfb_damage_init(struct omapfb_info *ofbi)
+{
+	struct omapfb_damage *d = &ofbi->damage;
+
+	spin_lock_init(&d->lock);
+	INIT_DELAYED_WORK(&d->work, omapfb_damage_work);
+	d->window_start = jiffies;
+}
+
+static void mmap_damage_open(struct vm_area_struct *vma)
+{
+	struct fb_info *fbi = vma->vm_file->private_data;
+	struct omapfb_damage *d = &FB2OFB(fbi)->damage;
+
+	spin_lock_irq(&d->lock);
+	d->nr_tracked++;
+	spin_unlock_irq(&d->lock);
+
+	mmap_user_open(vma);
+}
+
+static void mmap_damage_close(struct vm_area_struct *vma)
+{
+	struct fb_info *fbi = vma->vm_file->private_data;
+	struct omapfb_damage *d = &FB2OFB(fbi)->damage;
+	struct file *file = NULL;
+
+	spin_lock_irq(&d->lock);
+	if (--d->nr_tracked == 0) {
+		file = d->file;
+		d->file = NULL;
+	}
+	spin_unlock_irq(&d->lock);
+
+	if (file)
+		fput(file);
+
+	mmap_user_close(vma);
+}
+
+/*
+ * The tracked mapping is populated a page at a time, and every page that
+ * gets mapped marks its lines dirty. The pages are unmapped again when the
+ * damage is sent, so reads may mark lines too: harmless, just not minimal.
+ */
+static int mmap_damage_fault(struct vm_area_struct *vma, struct vm_fault *vmf)
+{
+	struct fb_info *fbi = vma->vm_file->private_data;
+	struct omapfb_info *ofbi = FB2OFB(fbi);
+	unsigned long off = vmf->pgoff << PAGE_SHIFT;
+	u32 line = fbi->fix.line_length;
+	u32 y1, y2;
+	int r;
+
+	if (off >= fbi->fix.smem_len)
+		return VM_FAULT_SIGBUS;
+
+	r = vm_insert_pfn(vma, (unsigned long)vmf->virtual_address,
+			(omapfb_get_region_paddr(ofbi) + off) >> PAGE_SHIFT);
+	if (r && r != -EBUSY)
+		return VM_FAULT_SIGBUS;
+
+	/* lines of the page, relative to the panned part */
+	y1 = off / line;
+	y2 = (off + PAGE_SIZE + line - 1) / line;
+	if (y2 > fbi->var.yoffset && y1 < fbi->var.yoffset + fbi->var.yres) {
+		y1 = y1 > fbi->var.yoffset ? y1 - fbi->var.yoffset : 0;
+		y2 -= fbi->var.yoffset;
+		omapfb_damage_add(fbi, 0, y1, fbi->var.xres, y2 - y1);
+	}
+
+	return VM_FAULT_NOPAGE;
+}
+
+static struct vm_operations_struct mmap_damage_ops = {
+	.open = mmap_damage_open,
+	.close = mmap_damage_close,
+	.fault = mmap_damage_fault,
+};
+
+static int omapfb_mmap_damage(struct fb_info *fbi, struct vm_area_struct *vma)
+{
+	struct omapfb_damage *d = &FB2OFB(fbi)->damage;
+	struct file *old = NULL;
+
+	vma->vm_flags |= VM_IO | VM_RESERVED | VM_PFNMAP;
+	vma->vm_page_prot = pgprot_writecombine(vma->vm_page_prot);
+	vma->vm_ops = &mmap_damage_ops;
+
+	get_file(vma->vm_file);
+
+	spin_lock_irq(&d->lock);
+	if (d->nr_tracked++ == 0) {
+		old = d->file;
+		d->file = vma->vm_file;
+	} else {
+		old = vma->vm_file;
+	}
+	spin_unlock_irq(&d->lock);
+
+	if (old)
+		fput(old);
+
+	return 0;
+}
+
 static int omapfb_mmap(struct fb_info *fbi, struct vm_area_struct *vma)
 {
 	struct omapfb_info *ofbi = FB2OFB(fbi);
@@ -1290,7 +1517,11 @@ static int omapfb_mmap(struct fb_info *fbi, struct vm_area_struct *vma)
 	DBG("user mmap region start %lx, len %d, off %lx\n", start, len, off);
 
 	vma->vm_private_data = rg;
-	if (ofbi->rotation_type == OMAP_DSS_ROT_TILER) {
+	if (ofbi->damage.track_mmap && (vma->vm_flags & VM_SHARED) &&
+			ofbi->rotation_type == OMAP_DSS_ROT_DMA) {
+		/* vm_pgoff stays the offset in the fb, as the fault wants it */
+		omapfb_mmap_damage(fbi, vma);
+	} else if (ofbi->rotation_type == OMAP_DSS_ROT_TILER) {
 #ifdef CONFIG_TILER_OMAP
 		int k = 0, p = fix->line_length;
 
@@ -2200,8 +2431,10 @@ static void omapfb_free_resources(struct omapfb2_device *fbdev)
 	if (fbdev == NULL)
 		return;
 
-	for (i = 0; i < fbdev->num_fbs; i++)
+	for (i = 0; i < fbdev->num_fbs; i++) {
+		cancel_delayed_work_sync(&FB2OFB(fbdev->fbs[i])->damage.work);
 		unregister_framebuffer(fbdev->fbs[i]);
+	}
 
 	/* free the reserved fbmem */
 	omapfb_free_all_fbmem(fbdev);
@@ -2337,6 +2570,7 @@ static int omapfb_create_framebuffers(struct omapfb2_device *fbdev)
 		ofbi = FB2OFB(fbi);
 		ofbi->fbdev = fbdev;
 		ofbi->id = i;
+		omapfb_damage_init(ofbi);
 
 		ofbi->region = &fbdev->regions[i];
 		ofbi->region->id = i;
@@ -571,6 +571,61 @@ out:
 	return r;
 }
 
+static ssize_t show_damage_tracking(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct fb_info *fbi = dev_get_drvdata(dev);
+	struct omapfb_info *ofbi = FB2OFB(fbi);
+
+	return snprintf(buf, PAGE_SIZE, "%d\n", ofbi->damage.track_mmap);
+}
+
+static ssize_t store_damage_tracking(struct device *dev,
+		struct device_attribute *attr,
+		const char *buf, size_t count)
+{
+	struct fb_info *fbi = dev_get_drvdata(dev);
+	struct omapfb_info *ofbi = FB2OFB(fbi);
+	struct omapfb2_mem_region *rg;
+	bool track_mmap;
+	int r;
+
+	track_mmap = simple_strtoul(buf, NULL, 0);
+
+	if (!lock_fb_info(fbi))
+		return -ENODEV;
+
+	rg = omapfb_get_mem_region(ofbi->region);
+
+	/* the existing mappings would not be tracked */
+	if (atomic_read(&rg->map_count)) {
+		r = -EBUSY;
+		goto out;
+	}
+
+	ofbi->damage.track_mmap = track_mmap;
+
+	r = count;
+out:
+	omapfb_put_mem_region(rg);
+
+	unlock_fb_info(fbi);
+
+	return r;
+}
+
+static ssize_t show_update_stats(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct fb_info *fbi = dev_get_drvdata(dev);
+	struct omapfb_info *ofbi = FB2OFB(fbi);
+
+	return snprintf(buf, PAGE_SIZE, "updates %lu bytes %llu bytes_per_sec %lu\n",
+			ofbi->damage.updates,
+			(unsigned long long)ofbi->damage.bytes,
+			omapfb_update_rate(ofbi));
+}
+
 static struct device_attribute omapfb_attrs[] = {
 	__ATTR(rotate_type, S_IRUGO | S_IWUSR, show_rotate_type,
 			store_rotate_type),
@@ -582,6 +637,9 @@ static struct device_attribute omapfb_attrs[] = {
 			store_overlays_rotate),
 	__ATTR(phys_addr, S_IRUGO, show_phys, NULL),
 	__ATTR(virt_addr, S_IRUGO, show_virt, NULL),
+	__ATTR(damage_tracking, S_IRUGO | S_IWUSR, show_damage_tracking,
+			store_damage_tracking),
+	__ATTR(update_stats, S_IRUGO, show_update_stats, NULL),
 };
 
 int omapfb_create_sysfs(struct omapfb2_device *fbdev)
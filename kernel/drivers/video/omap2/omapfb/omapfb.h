@@ -28,6 +28,8 @@
 #endif
 
 #include <linux/rwsem.h>
+#include <linux/spinlock.h>
+#include <linux/workqueue.h>
 
 #include <plat/display.h>
 
@@ -59,6 +61,30 @@ struct omapfb2_mem_region {
 	atomic_t	lock_count;
 };
 
+/*
+ * Dirty rectangle of a framebuffer on a manual update display. Regions
+ * marked by OMAPFB_MARK_DIRTY, and the rows touched through a tracked
+ * mmap, are merged into one bounding rectangle which is sent to the
+ * display by a delayed work.
+ */
+struct omapfb_damage {
+	spinlock_t lock;
+	bool dirty;
+	u16 x1, y1, x2, y2;		/* x2 and y2 are exclusive */
+	struct delayed_work work;
+
+	bool track_mmap;		/* set through sysfs, while unmapped */
+	struct file *file;		/* of the tracked mappings */
+	int nr_tracked;
+
+	/* updates sent through omapfb */
+	unsigned long updates;
+	u64 bytes;
+	unsigned long window_start;	/* jiffies */
+	unsigned long window_bytes;
+	unsigned long bytes_per_sec;
+};
+
 /* appended to fb_info */
 struct omapfb_info {
 	int id;
@@ -70,6 +96,7 @@ struct omapfb_info {
 	u8 rotation[OMAPFB_MAX_OVL_PER_FB];
 	bool mirror;
 	bool fit_to_screen;
+	struct omapfb_damage damage;
 };
 
 struct omapfb2_device {
@@ -121,6 +148,10 @@ int omapfb_ioctl(struct fb_info *fbi, unsigned int cmd, unsigned long arg);
 int omapfb_update_window(struct fb_info *fbi,
 		u32 x, u32 y, u32 w, u32 h);
 
+void omapfb_damage_add(struct fb_info *fbi, u32 x, u32 y, u32 w, u32 h);
+void omapfb_account_update(struct fb_info *fbi, u32 w, u32 h);
+unsigned long omapfb_update_rate(struct omapfb_info *ofbi);
+
 int dss_mode_to_fb_mode(enum omap_color_mode dssmode,
 			struct fb_var_screeninfo *var);
 
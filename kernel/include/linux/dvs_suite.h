@@ -21,7 +21,8 @@
 #include <linux/sched.h>	/* For struct task_struct and wait_event* macros */
 #include <linux/slab.h>		/* For kmalloc and kfree */
 #include <linux/string.h>	/* To use string functions */
-#include <linux/times.h>	/* For struct timeval and do_gettimeofday */
+#include <linux/time.h>		/* For NSEC_PER_* */
+#include <linux/math64.h>	/* For div64_u64 */
 #include <linux/cred.h>		/* To get uid */
 #include <linux/workqueue.h>
 
@@ -400,11 +401,6 @@
 	number. Result is U(20,12) fixed point. */
 #define DS_GETFP12FRA(x)		((x)&0x00000fff)
 
-/* Definitions for compare44bits() */
-#define DS_LARGER			1
-#define DS_EQUAL 			0
-#define DS_SMALLER			-1
-
 /* A representative HRT task in a Smartphone is voice call.
  * To do. Implement it in the future. For this time, we ignore such a HRT task.
  */
@@ -455,61 +451,53 @@
  * The new type depends on conditions.
  */
 #define DS_SRT_UI_IPC_NO		3			//
-#define DS_SRT_UI_IPC_TIMEOUT	500000		// 500 msec. It should not be larger than 1sec.
-#define DS_TOUCH_TIMEOUT		980000		// 980 msec. Don't touch this. LG standard.
-
-/* The maximum allowable number of PID. 0 ~ 32767. */
-#define DS_PID_LIMIT			32768
+#define DS_SRT_UI_IPC_TIMEOUT	(500 * NSEC_PER_MSEC)	// 500 msec.
+#define DS_TOUCH_TIMEOUT		(980 * NSEC_PER_MSEC)	// 980 msec. Don't touch this. LG standard.
 
 /* Definitions for AIDVS */
-/* DS_AIDVS_SPEEDUP_THRESHOLD and DS_AIDVS_SPEEDUP_INTERVAL 
- * should be less than 1000000 */
+/* All the time lengths below are in nsec. */
 #define DS_AIDVS_MOVING_AVG_WEIGHT		3			/* 3 */
 #define DS_AIDVS_INTERVALS_IN_AN_WINDOW	100			/* 100 intervals in an window */
-#define DS_AIDVS_SPEEDUP_THRESHOLD		100000		/* 100 msec in fse */
-#define DS_AIDVS_SPEEDUP_INTERVAL		100000		/* 100 msec in fse */
+#define DS_AIDVS_SPEEDUP_THRESHOLD		(100 * NSEC_PER_MSEC)	/* 100 msec in fse */
+#define DS_AIDVS_SPEEDUP_INTERVAL		(100 * NSEC_PER_MSEC)	/* 100 msec in fse */
+#define DS_AIDVS_REBASE_TIMEOUT			NSEC_PER_SEC			/* 1 sec in elapsed */
 
 /* Definitions for GPScheDVS */
-/* Following THRESHOLD and INTERVAL values should be less than 1000000.
- */
 #define DS_GPSCHEDVS_L0_INTERVALS_IN_AN_WINDOW	100		/* Max. intervals in an window */
-#define DS_GPSCHEDVS_L0_MIN_WINDOW_LENGTH	10000		/* 10 msec in elapsed */
-#define DS_GPSCHEDVS_L0_SPEEDUP_THRESHOLD	3000		/* 3 msec in fse */
-#define DS_GPSCHEDVS_L0_SPEEDUP_INTERVAL	3000		/* 3 msec in fse */
+#define DS_GPSCHEDVS_L0_MIN_WINDOW_LENGTH	(10 * NSEC_PER_MSEC)	/* 10 msec in elapsed */
+#define DS_GPSCHEDVS_L0_SPEEDUP_THRESHOLD	(3 * NSEC_PER_MSEC)		/* 3 msec in fse */
+#define DS_GPSCHEDVS_L0_SPEEDUP_INTERVAL	(3 * NSEC_PER_MSEC)		/* 3 msec in fse */
 
 #define DS_GPSCHEDVS_L1_INTERVALS_IN_AN_WINDOW	100		/* Max. intervals in an window */
-#define DS_GPSCHEDVS_L1_MIN_WINDOW_LENGTH	30000		/* 25 msec in elapsed */
-#define DS_GPSCHEDVS_L1_SPEEDUP_THRESHOLD	5000		/* 5 msec in fse */
-#define DS_GPSCHEDVS_L1_SPEEDUP_INTERVAL	5000		/* 5 msec in fse */
+#define DS_GPSCHEDVS_L1_MIN_WINDOW_LENGTH	(30 * NSEC_PER_MSEC)	/* 30 msec in elapsed */
+#define DS_GPSCHEDVS_L1_SPEEDUP_THRESHOLD	(5 * NSEC_PER_MSEC)		/* 5 msec in fse */
+#define DS_GPSCHEDVS_L1_SPEEDUP_INTERVAL	(5 * NSEC_PER_MSEC)		/* 5 msec in fse */
 
 #define DS_GPSCHEDVS_L2_INTERVALS_IN_AN_WINDOW	100		/* Max. intervals in an window */
-#define DS_GPSCHEDVS_L2_MIN_WINDOW_LENGTH	40000		/* 50 msec in elapsed */
-#define DS_GPSCHEDVS_L2_SPEEDUP_THRESHOLD	50000		/* 10 msec in fse */
-#define DS_GPSCHEDVS_L2_SPEEDUP_INTERVAL	50000		/* 10 msec in fse */
+#define DS_GPSCHEDVS_L2_MIN_WINDOW_LENGTH	(40 * NSEC_PER_MSEC)	/* 40 msec in elapsed */
+#define DS_GPSCHEDVS_L2_SPEEDUP_THRESHOLD	(50 * NSEC_PER_MSEC)	/* 50 msec in fse */
+#define DS_GPSCHEDVS_L2_SPEEDUP_INTERVAL	(50 * NSEC_PER_MSEC)	/* 50 msec in fse */
 
 #define DS_GPSCHEDVS_L3_INTERVALS_IN_AN_WINDOW	100		/* Max. intervals in an window */
-#define DS_GPSCHEDVS_L3_MIN_WINDOW_LENGTH	80000		/* 100 msec in elapsed */
-#define DS_GPSCHEDVS_L3_SPEEDUP_THRESHOLD	100000		/* 20 msec in fse */
-#define DS_GPSCHEDVS_L3_SPEEDUP_INTERVAL	100000		/* 20 msec in fse */
+#define DS_GPSCHEDVS_L3_MIN_WINDOW_LENGTH	(80 * NSEC_PER_MSEC)	/* 80 msec in elapsed */
+#define DS_GPSCHEDVS_L3_SPEEDUP_THRESHOLD	(100 * NSEC_PER_MSEC)	/* 100 msec in fse */
+#define DS_GPSCHEDVS_L3_SPEEDUP_INTERVAL	(100 * NSEC_PER_MSEC)	/* 100 msec in fse */
 
-#define DS_MIN_CPU_OP_UPDATE_INTERVAL_U		10000			/* 10 msec */
-#define DS_MIN_CPU_OP_UPDATE_INTERVAL_D		10000			/* 10 msec */
+#define DS_MIN_CPU_OP_UPDATE_INTERVAL_U		(10 * NSEC_PER_MSEC)	/* 10 msec */
+#define DS_MIN_CPU_OP_UPDATE_INTERVAL_D		(10 * NSEC_PER_MSEC)	/* 10 msec */
 
-#define DS_INIT_DELAY_SEC					20				/* 20 seconds */
-#define DS_POST_EARLY_SUSPEND_TIMEOUT_USEC	2000000			/* 2 seconds */		
+#define DS_INIT_DELAY						(20ULL * NSEC_PER_SEC)	/* 20 seconds */
+#define DS_POST_EARLY_SUSPEND_TIMEOUT		(2ULL * NSEC_PER_SEC)	/* 2 seconds */
 
 /***************************************************************************
  * Variables and data structures
  ***************************************************************************/
 
-extern struct timeval ds_timeval;
-
 typedef struct dvs_suite_configuration DS_CONF;
 typedef struct dvs_suite_status DS_STAT;
 typedef struct dvs_suite_counter DS_COUNT;
 typedef struct dvs_suite_parameter DS_PARAM;
 
-typedef struct ds_aidvs_interval_structure DS_AIDVS_INTERVAL_STRUCT;
 typedef struct ds_aidvs_status_structure DS_AIDVS_STAT_STRUCT;
 
 typedef struct ds_aidvs_l3_status_structure DS_AIDVS_L3_STAT_STRUCT;
@@ -575,9 +563,9 @@ extern DS_CONF ds_configuration;
 	 to what the CPU is currently running at.
 
 	 Field flag_time_base_initialized indicates whether
-	 tv_usec_base were initialized or not.
-	 Field tv_usec_base holds the last read ds_timeval.tv_usec value.
-	 We use do_gettimeofday() to get the elapsed real time.
+	 time_base_ns was initialized or not.
+	 Field time_base_ns holds the last read sched_clock() value.
+	 We use sched_clock() to get the elapsed real time.
 
 	 Field cpu_op_index indicates the current CPU_OP index.
 
@@ -608,22 +596,25 @@ extern DS_CONF ds_configuration;
 	 Field ms_pid is the pid of media server.
 	 Field ss_pid is the pid of system server.
 
-	 Field *pti[DS_PID_LIMIT] is the array holding the pointers to per task
-	 information data structures.
-	 The index for pti is the PID of tasks.
-	 This data structure is used to trace the type of tasks.
+	 The per task information used to trace the type of tasks lives in
+	 task_struct->ds (struct ds_task_state, see linux/sched.h).
+	 Fields touch_timeout_ns, post_early_suspend_ns and
+	 cpu_op_last_update_ns are ds_counter.elapsed_ns based.
+
+	 Field flag_cpufreq_gov is set while LG-DVFS runs as the 'lgdvfs'
+	 cpufreq governor. Then ds_update_cpu_op() hands target_cpu_op_index
+	 over to the governor instead of setting the OPPs by itself, and
+	 cpu_op_index follows the cpufreq transitions.
  */
 struct dvs_suite_status {
 
 	int flag_run_dvs;
+	int flag_cpufreq_gov;
 
 	int ds_initialized;
 
 	int flag_time_base_initialized;
-	unsigned long tv_sec_curr;
-	unsigned long tv_usec_curr;
-	unsigned long tv_sec_base;
-	unsigned long tv_usec_base;
+	u64 time_base_ns;
 
 	unsigned int cpu_op_index;
 	unsigned int cpu_op_sf;
@@ -633,36 +624,19 @@ struct dvs_suite_status {
 
 	int flag_update_cpu_op;
 	unsigned int target_cpu_op_index;
-	unsigned long cpu_op_last_update_sec;
-	unsigned long cpu_op_last_update_usec;
+	u64 cpu_op_last_update_ns;
 
 	int current_dvs_scheme;
 
-	int scheduler[DS_PID_LIMIT];
-
-	int type[DS_PID_LIMIT];
-	int type_fixed[DS_PID_LIMIT];
-	int type_need_to_be_changed[DS_PID_LIMIT];
-
-	int tgid[DS_PID_LIMIT];
-	char tg_owner_comm[DS_PID_LIMIT][16];
-	int tgid_type_changed[DS_PID_LIMIT];
-	int tgid_type_change_causer[DS_PID_LIMIT];
-
-	unsigned long ipc_timeout_sec[DS_PID_LIMIT];
-	unsigned long ipc_timeout_usec[DS_PID_LIMIT];
-
 	int flag_touch_timeout_count;
-	unsigned long touch_timeout_sec;
-	unsigned long touch_timeout_usec;
+	u64 touch_timeout_ns;
 
 	int flag_mutex_lock_on_clock_state;
 	int mutex_lock_on_clock_state_cnt;
 	int flag_correct_cpu_op_update_path;
 
 	int flag_post_early_suspend;
-	unsigned long post_early_suspend_sec;
-	unsigned long post_early_suspend_usec;
+	u64 post_early_suspend_ns;
 	int flag_do_post_early_suspend;
 
 	unsigned long mpu_min_freq_to_lock;
@@ -672,6 +646,12 @@ struct dvs_suite_status {
 
 extern DS_STAT ds_status;
 
+/* Whether the CPU_OP is to be changed through cpufreq, i.e.,
+	 LG-DVFS is either not running or running as a cpufreq governor.
+ */
+#define DS_CPU_OP_BY_CPUFREQ() \
+	(ds_status.flag_run_dvs == 0 || ds_status.flag_cpufreq_gov == 1)
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 /* The data structure holding various counters.
@@ -679,21 +659,21 @@ extern DS_STAT ds_status;
 	 The first type of counters are time counters which holds the fractions of
 	 busy (= task + context switch + dvs suite, i.e. the overhead) and idle time
 	 at each CPU_OP.
-	 Additionally, the full speed equivalent sec and usec values are calculated
+	 Additionally, the full speed equivalent nsec values are calculated
 	 and stored.
-	 fp12_*_fse_fraction holds the fraction smaller than 1 usec in U(20,12)
-	 fixed point format.
 
-	 elapsed_sec and elapsed_usec hold the total elapsed time (wall clock time)
-	 since the system was booted.
+	 elapsed_ns holds the total elapsed time (sched_clock time)
+	 since LG-DVFS was initialized.
+
+	 hook_calls and hook_ns count the calls of the context switch hook
+	 ld_do_dvs_suite() and the time spent in it (CONFIG_LG_DVFS_HOOK_STATS).
 
 	 The second type of counters hold the occurrence number of certain events
 	 such as CPU_OP transitions, schedules, and total number of system calls
 	 and interrupts.
  */
 struct dvs_suite_counter {
-	unsigned long elapsed_sec;
-	unsigned long elapsed_usec;
+	u64 elapsed_ns;
 
 #if 0
 	unsigned long idle_sec[DS_CPU_OP_LIMIT];
@@ -704,11 +684,13 @@ struct dvs_suite_counter {
 	unsigned long busy_sec[DS_CPU_OP_LIMIT];
 	unsigned long busy_usec[DS_CPU_OP_LIMIT];
 #endif
-	unsigned long busy_total_sec;
-	unsigned long busy_total_usec;
-	unsigned long busy_fse_sec;
-	unsigned long busy_fse_usec;
-	unsigned long busy_fse_usec_fra_fp12;
+	u64 busy_total_ns;
+	u64 busy_fse_ns;
+
+#ifdef CONFIG_LG_DVFS_HOOK_STATS
+	unsigned long hook_calls;
+	u64 hook_ns;
+#endif
 
 #if 0
 	unsigned long busy_task_sec[DS_CPU_OP_LIMIT];
@@ -797,43 +779,26 @@ extern DS_PARAM ds_parameter;
 /*
  * Variables for AIDVS.
  */
-struct ds_aidvs_interval_structure {
-	unsigned long time_usec_interval;
-	unsigned long time_usec_work_fse;
-	unsigned long time_usec_work;
-//	struct ds_aidvs_interval_structure *next;
-};
-
+/* All the time fields are in nsec.
+	 utilization_fp12 is a U(20,12) fixed point number.
+ */
 struct ds_aidvs_status_structure {
 	int base_initialized;
 	int flag_in_busy_half;
 
-	unsigned long time_usec_interval;
-	unsigned long time_usec_interval_inc_base;
-	unsigned long time_sec_interval_inc_base;
-
-	unsigned long time_usec_work_fse;
-	unsigned long time_usec_work_fse_inc_base;
-	unsigned long time_usec_work_fse_lasting;
-
-	unsigned long time_usec_work;
-	unsigned long time_usec_work_inc_base;
-	unsigned long time_usec_work_lasting;
+	u64 time_ns_interval;
+	u64 time_ns_interval_inc_base;
 
-	DS_AIDVS_INTERVAL_STRUCT interval_window_array[DS_AIDVS_INTERVALS_IN_AN_WINDOW];
-	int interval_window_index;
-//	DS_AIDVS_INTERVAL_STRUCT *interval_window_head;
-//	DS_AIDVS_INTERVAL_STRUCT *interval_window_tail;
+	u64 time_ns_work_fse;
+	u64 time_ns_work_fse_inc_base;
+	u64 time_ns_work_fse_lasting;
 
-	unsigned long time_usec_interval_in_window;
-	unsigned long time_usec_work_fse_in_window;
-	unsigned long time_usec_work_in_window;
+	u64 time_ns_interval_in_window;
+	u64 time_ns_work_fse_in_window;
 
 	int consecutive_speedup_count;
-	unsigned long utilization_int_ulong;
-	unsigned long utilization_fra_fp12;
-	unsigned long time_usec_util_calc_base;
-	unsigned long time_sec_util_calc_base;
+	unsigned long utilization_fp12;
+	u64 time_ns_util_calc_base;
 
 	unsigned int cpu_op_index;
 };
@@ -867,25 +832,6 @@ extern DS_GPSCHEDVS_STAT_STRUCT ds_gpschedvs_status;
  * Function definitions
  ***************************************************************************/
 
-extern void ds_fpmul12(unsigned long, unsigned long, unsigned long *);
-extern void ds_fpdiv12(unsigned long, unsigned long,
-						 unsigned long *, unsigned long *);
-extern void ds_div32(unsigned long, unsigned long,
-					 unsigned long *, unsigned long *);
-extern int ds_find_first1_in_integer_part(unsigned long);
-extern int ds_find_first1_in_fraction_part(unsigned long);
-extern int ds_compare45bits(int, unsigned long, unsigned long,
-							int, unsigned long, unsigned long);
-extern int ds_shiftleft44bits(int, unsigned long, unsigned long,
-								int, int *, unsigned long *, unsigned long *);
-extern int ds_subtract44bits(int, unsigned long, unsigned long,
-							 int, unsigned long, unsigned long,
-							 int *, unsigned long *, unsigned long *);
-extern int ds_fpmul(unsigned long, unsigned long, unsigned long, unsigned long,
-					unsigned long *, unsigned long *);
-extern int ds_fpdiv(unsigned long, unsigned long, unsigned long, unsigned long,
-					unsigned long *, unsigned long *);
-
 extern unsigned int ds_get_next_high_cpu_op_index(unsigned long, unsigned long);
 extern unsigned int ds_get_next_low_cpu_op_index(unsigned long, unsigned long);
 
@@ -924,6 +870,16 @@ extern int ds_update_priority_rt(struct task_struct *);
 //extern void ds_update_cpu_op(void);
 extern asmlinkage void ds_update_cpu_op(void);
 extern int ds_detect_task_type(void);
+extern void ds_sync_cpu_op(unsigned int);
 extern void do_dvs_suite(void);
 
+/*
+ * The 'lgdvfs' cpufreq governor (cpufreq_lgdvfs.c).
+ */
+#ifdef CONFIG_CPU_FREQ_GOV_LGDVFS
+extern void cpufreq_lgdvfs_request(unsigned int);
+#else
+static inline void cpufreq_lgdvfs_request(unsigned int target_cpu_op_index) { }
+#endif
+
 #endif /* !(_LINUX_DVS_SUITE_H) */
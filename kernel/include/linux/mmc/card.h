@@ -34,6 +34,7 @@ struct mmc_csd {
 	unsigned int		read_blkbits;
 	unsigned int		write_blkbits;
 	unsigned int		capacity;
+	unsigned int		erase_size;	/* In sectors */
 	unsigned int		read_partial:1,
 				read_misalign:1,
 				write_partial:1,
@@ -46,6 +47,13 @@ struct mmc_ext_csd {
 	unsigned int		hs_max_dtr;
 	unsigned int		sectors;
 	unsigned int		card_type;
+	u8			erase_group_def;
+	u8			sec_feature_support;
+	u8			sec_trim_mult;		/* Secure trim multiplier */
+	u8			sec_erase_mult;		/* Secure erase multiplier */
+	unsigned int		hc_erase_size;		/* In sectors */
+	unsigned int		hc_erase_timeout;	/* In milliseconds */
+	unsigned int		trim_timeout;		/* In milliseconds */
 };
 
 struct sd_scr {
@@ -114,6 +122,9 @@ struct mmc_card {
 	struct sd_scr		scr;		/* extra SD information */
 	struct sd_switch_caps	sw_caps;	/* switch (CMD6) caps */
 
+	unsigned int		erase_size;	/* erase group size, in sectors */
+	unsigned int		erase_shift;	/* if erase_size is a power of 2 */
+
 	unsigned int		sdio_funcs;	/* number of SDIO functions */
 	struct sdio_cccr	cccr;		/* common card info */
 	struct sdio_cis		cis;		/* common tuple info */
@@ -77,6 +77,7 @@ struct mmc_command {
 
 	unsigned int		retries;	/* max number of retries */
 	unsigned int		error;		/* command error */
+	unsigned int		erase_timeout;	/* in milliseconds */
 
 /*
  * Standard errno values are used for errors, but some have specific
@@ -120,6 +121,7 @@ struct mmc_data {
 
 	unsigned int		sg_len;		/* size of scatter list */
 	struct scatterlist	*sg;		/* I/O scatter list */
+	s32			host_cookie;	/* host private data */
 };
 
 struct mmc_request {
@@ -133,12 +135,35 @@ struct mmc_request {
 
 struct mmc_host;
 struct mmc_card;
+struct completion;
 
+extern void mmc_pre_req(struct mmc_host *, struct mmc_request *, bool);
+extern void mmc_post_req(struct mmc_host *, struct mmc_request *, int);
+extern void mmc_start_req(struct mmc_host *, struct mmc_request *,
+	struct completion *);
+extern void mmc_wait_for_req_done(struct mmc_request *);
 extern void mmc_wait_for_req(struct mmc_host *, struct mmc_request *);
 extern int mmc_wait_for_cmd(struct mmc_host *, struct mmc_command *, int);
 extern int mmc_wait_for_app_cmd(struct mmc_host *, struct mmc_card *,
 	struct mmc_command *, int);
 
+#define MMC_ERASE_ARG		0x00000000
+#define MMC_SECURE_ERASE_ARG	0x80000000
+#define MMC_TRIM_ARG		0x00000001
+#define MMC_SECURE_TRIM1_ARG	0x80000001
+#define MMC_SECURE_TRIM2_ARG	0x80008000
+
+#define MMC_SECURE_ARGS		0x80000000
+#define MMC_TRIM_ARGS		0x00008001
+
+extern int mmc_erase(struct mmc_card *card, unsigned int from, unsigned int nr,
+		     unsigned int arg);
+extern int mmc_can_erase(struct mmc_card *card);
+extern int mmc_can_trim(struct mmc_card *card);
+extern int mmc_can_secure_erase_trim(struct mmc_card *card);
+extern unsigned int mmc_calc_max_discard(struct mmc_card *card,
+					 unsigned int arg);
+
 extern int mmc_set_blocklen(struct mmc_card *card, unsigned int blocklen);
 
 extern void mmc_set_data_timeout(struct mmc_data *, const struct mmc_card *);
@@ -91,6 +91,18 @@ struct mmc_host_ops {
 	 */
 	int (*enable)(struct mmc_host *host);
 	int (*disable)(struct mmc_host *host, int lazy);
+	/*
+	 * It is optional for the host to implement pre_req and post_req in
+	 * order to support double buffering of requests: 'pre_req' prepares
+	 * a request for DMA (mapping, cache maintenance, descriptors) while
+	 * another request is active, 'post_req' undoes it once the request
+	 * has completed or has been dropped. The host marks a prepared
+	 * request by setting data->host_cookie and clears it in 'post_req'.
+	 */
+	void	(*post_req)(struct mmc_host *host, struct mmc_request *req,
+			    int err);
+	void	(*pre_req)(struct mmc_host *host, struct mmc_request *req,
+			   bool is_first_req);
 	void	(*request)(struct mmc_host *host, struct mmc_request *req);
 	/*
 	 * Avoid calling these three functions too often or in a "fast path",
@@ -183,6 +195,7 @@ struct mmc_host {
 	unsigned int		max_req_size;	/* maximum number of bytes in one req */
 	unsigned int		max_blk_size;	/* maximum size of one mmc block */
 	unsigned int		max_blk_count;	/* maximum number of blocks in one req */
+	unsigned int		max_discard_to;	/* max. erase busy wait in ms, 0 = none */
 
 	/* private data */
 	spinlock_t		lock;		/* lock for claim and bus ops */
@@ -43,5 +43,14 @@ static inline void oom_killer_enable(void)
 {
 	oom_killer_disabled = false;
 }
+
+#ifdef CONFIG_ANDROID_LOW_MEMORY_KILLER
+struct task_struct;
+extern void lowmem_index_update(struct task_struct *p);
+#else
+static inline void lowmem_index_update(struct task_struct *p)
+{
+}
+#endif
 #endif /* __KERNEL__*/
 #endif /* _INCLUDE_LINUX_OOM_H */
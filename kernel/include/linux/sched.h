@@ -1163,6 +1163,18 @@ struct sched_rt_entity {
 #endif
 };
 
+/*
+ * LG-DVFS per task state (see linux/dvs_suite.h). Zeroed on fork.
+ * ipc_timeout_ns is ds_counter.elapsed_ns based.
+ */
+struct ds_task_state {
+	int type;
+	int type_fixed;
+	int type_need_to_be_changed;
+	int scheduler;
+	u64 ipc_timeout_ns;
+};
+
 struct rcu_node;
 
 struct task_struct {
@@ -1185,6 +1197,7 @@ struct task_struct {
 	const struct sched_class *sched_class;
 	struct sched_entity se;
 	struct sched_rt_entity rt;
+	struct ds_task_state ds;
 
 #ifdef CONFIG_PREEMPT_NOTIFIERS
 	/* list of struct preempt_notifier: */
@@ -1445,6 +1458,12 @@ struct task_struct {
 	struct mutex perf_event_mutex;
 	struct list_head perf_event_list;
 #endif
+#ifdef CONFIG_ANDROID_LOW_MEMORY_KILLER
+	/* lowmemorykiller candidate index, thread group leaders only */
+	struct list_head lowmem_node;
+	int lowmem_adj;
+	unsigned long lowmem_rss;
+#endif
 #ifdef CONFIG_NUMA
 	struct mempolicy *mempolicy;	/* Protected by alloc_lock */
 	short il_next;
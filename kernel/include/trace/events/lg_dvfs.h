@@ -0,0 +1,116 @@
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM lg_dvfs
+
+#if !defined(_TRACE_LG_DVFS_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _TRACE_LG_DVFS_H
+
+#include <linux/sched.h>
+#include <linux/tracepoint.h>
+
+/*
+ * Tracepoints for the decisions of LG-DVFS (drivers/cpufreq/lg_dvfs.c).
+ * CPU_OP indexes are in Hz, frequencies in kHz.
+ */
+
+TRACE_EVENT(lg_dvfs_task_type,
+
+	TP_PROTO(struct task_struct *p, int old_type, int new_type),
+
+	TP_ARGS(p, old_type, new_type),
+
+	TP_STRUCT__entry(
+		__array(	char,	comm,	TASK_COMM_LEN	)
+		__field(	pid_t,	pid			)
+		__field(	int,	old_type		)
+		__field(	int,	new_type		)
+	),
+
+	TP_fast_assign(
+		memcpy(__entry->comm, p->comm, TASK_COMM_LEN);
+		__entry->pid		= p->pid;
+		__entry->old_type	= old_type;
+		__entry->new_type	= new_type;
+	),
+
+	TP_printk("comm=%s pid=%d old_type=%d new_type=%d",
+		__entry->comm, __entry->pid,
+		__entry->old_type, __entry->new_type)
+);
+
+TRACE_EVENT(lg_dvfs_aidvs,
+
+	TP_PROTO(int static_prio, unsigned long utilization_fp12,
+		unsigned long moving_avg_fp12, unsigned int cpu_op_index),
+
+	TP_ARGS(static_prio, utilization_fp12, moving_avg_fp12, cpu_op_index),
+
+	TP_STRUCT__entry(
+		__field(	int,		static_prio		)
+		__field(	unsigned long,	utilization_fp12	)
+		__field(	unsigned long,	moving_avg_fp12		)
+		__field(	unsigned int,	cpu_op_index		)
+	),
+
+	TP_fast_assign(
+		__entry->static_prio		= static_prio;
+		__entry->utilization_fp12	= utilization_fp12;
+		__entry->moving_avg_fp12	= moving_avg_fp12;
+		__entry->cpu_op_index		= cpu_op_index;
+	),
+
+	TP_printk("static_prio=%d util=0x%lx avg=0x%lx cpu_op=%u",
+		__entry->static_prio, __entry->utilization_fp12,
+		__entry->moving_avg_fp12, __entry->cpu_op_index)
+);
+
+TRACE_EVENT(lg_dvfs_target,
+
+	TP_PROTO(unsigned int cpu_op_index, unsigned int target_cpu_op_index,
+		int touch_boost),
+
+	TP_ARGS(cpu_op_index, target_cpu_op_index, touch_boost),
+
+	TP_STRUCT__entry(
+		__field(	unsigned int,	cpu_op_index		)
+		__field(	unsigned int,	target_cpu_op_index	)
+		__field(	int,		touch_boost		)
+	),
+
+	TP_fast_assign(
+		__entry->cpu_op_index		= cpu_op_index;
+		__entry->target_cpu_op_index	= target_cpu_op_index;
+		__entry->touch_boost		= touch_boost;
+	),
+
+	TP_printk("cpu_op=%u target=%u touch=%d",
+		__entry->cpu_op_index, __entry->target_cpu_op_index,
+		__entry->touch_boost)
+);
+
+TRACE_EVENT(lg_dvfs_transition,
+
+	TP_PROTO(unsigned int old_freq, unsigned int new_freq, u64 latency_ns),
+
+	TP_ARGS(old_freq, new_freq, latency_ns),
+
+	TP_STRUCT__entry(
+		__field(	unsigned int,	old_freq	)
+		__field(	unsigned int,	new_freq	)
+		__field(	u64,		latency_ns	)
+	),
+
+	TP_fast_assign(
+		__entry->old_freq	= old_freq;
+		__entry->new_freq	= new_freq;
+		__entry->latency_ns	= latency_ns;
+	),
+
+	TP_printk("old=%u new=%u latency_ns=%llu",
+		__entry->old_freq, __entry->new_freq,
+		(unsigned long long)__entry->latency_ns)
+);
+
+#endif /* _TRACE_LG_DVFS_H */
+
+/* This part must be outside protection */
+#include <trace/define_trace.h>
@@ -116,8 +116,7 @@ static void early_suspend(struct work_struct *work)
     /* 20110331 sookyoung.kim@lge.com LG-DVFS [START_LGE] */
 	if(ds_status.flag_run_dvs == 1){
 		ds_status.flag_post_early_suspend = 1;
-		ds_status.post_early_suspend_sec = ds_counter.elapsed_sec;
-		ds_status.post_early_suspend_usec = ds_counter.elapsed_usec;
+		ds_status.post_early_suspend_ns = ds_counter.elapsed_ns;
 	}
     /* 20110331 sookyoung.kim@lge.com LG-DVFS [END_LGE] */
 
@@ -157,8 +156,7 @@ static void late_resume(struct work_struct *work)
     /* 20110331 sookyoung.kim@lge.com LG-DVFS [START_LGE] */
 	if(ds_status.flag_run_dvs == 1){
 		ds_status.flag_post_early_suspend = 0;
-		ds_status.post_early_suspend_sec = 0;
-		ds_status.post_early_suspend_usec = 0;
+		ds_status.post_early_suspend_ns = 0;
 		ds_status.flag_do_post_early_suspend = 0;
 	}
     /* 20110331 sookyoung.kim@lge.com LG-DVFS [END_LGE] */
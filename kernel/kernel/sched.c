@@ -2441,6 +2441,9 @@ static void __sched_fork(struct task_struct *p)
 	p->se.on_rq = 0;
 	INIT_LIST_HEAD(&p->se.group_node);
 
+	/* LG-DVFS re-detects the type of every new task. */
+	memset(&p->ds, 0, sizeof(p->ds));
+
 #ifdef CONFIG_PREEMPT_NOTIFIERS
 	INIT_HLIST_HEAD(&p->preempt_notifiers);
 #endif
@@ -3690,7 +3693,7 @@ need_resched_nonpreemptible:
 #if 0   // WARNING: This code will cause a severe performance degradation!!!
 if(next->pid == 0)
 printk(KERN_WARNING "%d %5d %16s %3d\n",
-ds_status.type[prev->pid],
+prev->ds.type,
 prev->pid,
 prev->comm,
 //prev->prio,
@@ -3700,7 +3703,7 @@ prev->static_prio
 #if 0   // WARNING: This code will cause a severe performance degradation!!!
 if(prev->pid == 0)
 printk(KERN_WARNING "%d %5d %16s %3d\n",
-ds_status.type[next->pid],
+next->ds.type,
 next->pid,
 next->comm,
 //next->prio,